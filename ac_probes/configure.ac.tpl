@@ -234,6 +234,30 @@ AC_CHECK_LIB([bz2], [BZ2_bzReadOpen],
 	])
 AM_CONDITIONAL([HAVE_BZIP2], [test "x${HAVE_BZIP2}" = xyes])
 
+echo
+echo '* Checking for lzma library (optional dependency of libopenscap)'
+AC_CHECK_LIB([lzma], [lzma_stream_decoder],
+	[
+	        AC_DEFINE([HAVE_LZMA], [1], [Define to 1 if there is liblzma available.])
+	        LIBS="$LIBS -llzma"
+		AC_CHECK_PROG([HAVE_XZ],[xz],[yes],,,)
+	],[
+	        AC_MSG_NOTICE([!!! liblzma not found. Xz support will be disabled !!!])
+	])
+AM_CONDITIONAL([HAVE_XZ], [test "x${HAVE_XZ}" = xyes])
+
+echo
+echo '* Checking for zstd library (optional dependency of libopenscap)'
+AC_CHECK_LIB([zstd], [ZSTD_compressStream2],
+	[
+	        AC_DEFINE([HAVE_ZSTD], [1], [Define to 1 if there is libzstd available.])
+	        LIBS="$LIBS -lzstd"
+		AC_CHECK_PROG([ZSTD_PROG],[zstd],[yes],,,)
+	],[
+	        AC_MSG_NOTICE([!!! libzstd not found. Zstd support will be disabled !!!])
+	])
+AM_CONDITIONAL([HAVE_ZSTD], [test "x${ZSTD_PROG}" = xyes])
+
 
 @@@@PROBE_HEADERS@@@@
 
@@ -33,6 +33,7 @@
 #include "CPE/public/cpe_dict.h"
 #include "CPE/public/cpe_lang.h"
 #include "OVAL/public/oval_agent_api.h"
+#include "OVAL/oval_agent_api_impl.h"
 #include "source/public/oscap_source.h"
 #include "source/oscap_source_priv.h"
 
@@ -53,6 +54,7 @@ struct cpe_session *cpe_session_new(void)
 	cpe->lang_models = oscap_list_new();
 	cpe->oval_sessions = oscap_htable_new();
 	cpe->applicable_platforms = oscap_htable_new();
+	cpe->platform_results = oscap_htable_new();
 	cpe->thin_results = false;
 	if (!cpe_session_add_default_cpe(cpe)) {
 		oscap_seterr(OSCAP_EFAMILY_XCCDF, "Failed to add default CPE to newly created CPE Session.");
@@ -75,6 +77,7 @@ void cpe_session_free(struct cpe_session *session)
 		oscap_list_free(session->lang_models, (oscap_destruct_func) cpe_lang_model_free);
 		oscap_htable_free(session->oval_sessions, (oscap_destruct_func) _xccdf_policy_destroy_cpe_oval_session);
 		oscap_htable_free(session->applicable_platforms, NULL);
+		oscap_htable_free(session->platform_results, free);
 		free(session);
 	}
 }
@@ -114,7 +117,7 @@ struct oval_agent_session *cpe_session_lookup_oval_session(struct cpe_session *c
 			return NULL;
 		}
 
-		session = oval_agent_new_session(oval_model, prefixed_href);
+		session = oval_agent_new_session_with_cache(oval_model, prefixed_href, cpe->collection_cache);
 		if (session == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Cannot create OVAL session for '%s' for CPE applicability checking", prefixed_href);
 			return NULL;
@@ -136,15 +139,33 @@ struct oval_agent_session *cpe_session_lookup_oval_session(struct cpe_session *c
 	return session;
 }
 
+static inline void _cpe_session_reset_platform_results(struct cpe_session *session)
+{
+	// A new dictionary or lang model may make more platforms applicable
+	oscap_htable_free(session->platform_results, free);
+	session->platform_results = oscap_htable_new();
+}
+
+void cpe_session_reset_results(struct cpe_session *session)
+{
+	oscap_htable_free(session->oval_sessions, (oscap_destruct_func) _xccdf_policy_destroy_cpe_oval_session);
+	session->oval_sessions = oscap_htable_new();
+	oscap_htable_free(session->applicable_platforms, NULL);
+	session->applicable_platforms = oscap_htable_new();
+	_cpe_session_reset_platform_results(session);
+}
+
 bool cpe_session_add_cpe_lang_model_source(struct cpe_session *session, struct oscap_source *source)
 {
 	struct cpe_lang_model *lang_model = cpe_lang_model_import_source(source);
+	_cpe_session_reset_platform_results(session);
 	return oscap_list_add(session->lang_models, lang_model);
 }
 
 bool cpe_session_add_cpe_dict_source(struct cpe_session *session, struct oscap_source *source)
 {
 	struct cpe_dict_model *dict = cpe_dict_model_import_source(source);
+	_cpe_session_reset_platform_results(session);
 	return oscap_list_add(session->dicts, dict);
 }
 
@@ -166,3 +187,8 @@ void cpe_session_set_cache(struct cpe_session *session, struct oscap_htable *sou
 {
 	session->sources_cache = sources_cache;
 }
+
+void cpe_session_set_collection_cache(struct cpe_session *session, struct oval_collection_cache *collection_cache)
+{
+	session->collection_cache = collection_cache;
+}
@@ -32,23 +32,33 @@
 
 OSCAP_HIDDEN_START;
 
+struct oval_collection_cache;
+
 struct cpe_session {
 	struct oscap_list *dicts;                       ///< All CPE dictionaries except the one embedded in XCCDF
 	struct oscap_list *lang_models;                 ///< All CPE lang models except the one embedded in XCCDF
 	struct oscap_htable *oval_sessions;             ///< Caches CPE OVAL check results
 	struct oscap_htable *applicable_platforms;
+	struct oscap_htable *platform_results;          ///< Caches applicability of platforms [platform -> bool]
 	struct oscap_htable *sources_cache;             ///< Not owned cache [path -> oscap_source]
+	struct oval_collection_cache *collection_cache; ///< Not owned cache of collected OVAL objects
 	bool thin_results;                              ///< Should OVAL results related to CPE be exported as THIN?
 };
 
 struct cpe_session *cpe_session_new(void);
 void cpe_session_free(struct cpe_session *session);
 void cpe_session_set_thin_results(struct cpe_session *session, bool thin_results);
+/**
+ * Forget the outcome of all the CPE checks and shut down their OVAL sessions,
+ * e.g. before another system gets scanned.
+ */
+void cpe_session_reset_results(struct cpe_session *session);
 struct oval_agent_session *cpe_session_lookup_oval_session(struct cpe_session *cpe, const char *prefixed_href);
 bool cpe_session_add_cpe_lang_model_source(struct cpe_session *session, struct oscap_source *source);
 bool cpe_session_add_cpe_dict_source(struct cpe_session *session, struct oscap_source *source);
 bool cpe_session_add_cpe_autodetect_source(struct cpe_session *session, struct oscap_source *source);
 void cpe_session_set_cache(struct cpe_session *session, struct oscap_htable *sources_cache);
+void cpe_session_set_collection_cache(struct cpe_session *session, struct oval_collection_cache *collection_cache);
 
 OSCAP_HIDDEN_END;
 #endif
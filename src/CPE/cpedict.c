@@ -103,34 +103,39 @@ void cpe_dict_model_export(const struct cpe_dict_model *dict, const char *file)
 
 }
 
-bool cpe_name_match_dict(struct cpe_name * cpe, struct cpe_dict_model * dict)
+/* Does any of the items in the list match (in terms of cpe_name_match_one) the given name? */
+static bool cpe_items_match_name(struct oscap_list *items, const struct cpe_name *cpe)
 {
-	// FIXME: We could match faster by matching per component and storing all
-	//        cpe_dict items in a big tree where leaves contain cpe_items and
-	//        inner nodes are the components.
-
-	__attribute__nonnull__(cpe);
-	__attribute__nonnull__(dict);
-
-	if (cpe == NULL || dict == NULL)
+	if (items == NULL)
 		return false;
 
-	struct cpe_item_iterator *items = cpe_dict_model_get_items(dict);
-
 	bool ret = false;
-	while (cpe_item_iterator_has_more(items)) {
-		struct cpe_item* item = cpe_item_iterator_next(items);
-		struct cpe_name* name = cpe_item_get_name(item);
-
-		if (cpe_name_match_one(name, cpe)) {
+	struct oscap_iterator *it = oscap_iterator_new(items);
+	while (oscap_iterator_has_more(it)) {
+		struct cpe_item *item = oscap_iterator_next(it);
+		if (cpe_name_match_one(cpe_item_get_name(item), cpe)) {
 			ret = true;
 			break;
 		}
 	}
-	cpe_item_iterator_free(items);
+	oscap_iterator_free(it);
 	return ret;
 }
 
+bool cpe_name_match_dict(struct cpe_name * cpe, struct cpe_dict_model * dict)
+{
+	__attribute__nonnull__(cpe);
+	__attribute__nonnull__(dict);
+
+	if (cpe == NULL || dict == NULL)
+		return false;
+
+	// Only the items with the same part, vendor and product can match, unless
+	// some of these components are missing in the item.
+	return cpe_items_match_name(cpe_dict_model_get_items_by_name(dict, cpe), cpe) ||
+		cpe_items_match_name(cpe_dict_model_get_wildcard_items(dict), cpe);
+}
+
 bool cpe_name_match_dict_str(const char *cpestr, struct cpe_dict_model * dict)
 {
 	__attribute__nonnull__(cpestr);
@@ -149,24 +154,31 @@ bool cpe_name_match_dict_str(const char *cpestr, struct cpe_dict_model * dict)
 
 bool cpe_name_applicable_dict(struct cpe_name *cpe, struct cpe_dict_model *dict, cpe_check_fn cb, void* usr)
 {
-	// FIXME: We could match faster by matching per component and storing all
-	//        cpe_dict items in a big tree where leaves contain cpe_items and
-	//        inner nodes are the components.
-
 	__attribute__nonnull__(cpe);
 	__attribute__nonnull__(dict);
 
 	if (cpe == NULL || dict == NULL)
 		return false;
 
-	struct cpe_item_iterator *items = cpe_dict_model_get_items(dict);
+	// When the part, vendor and product of the name are given, only the items
+	// with the very same ones can match. Otherwise we have to try all of them.
+	struct oscap_iterator *items;
+	if (cpe_name_get_part(cpe) != CPE_PART_NONE &&
+			cpe_name_get_vendor(cpe) != NULL && cpe_name_get_product(cpe) != NULL) {
+		struct oscap_list *candidates = cpe_dict_model_get_items_by_name(dict, cpe);
+		if (candidates == NULL)
+			return false;
+		items = oscap_iterator_new(candidates);
+	} else {
+		items = (struct oscap_iterator *) cpe_dict_model_get_items(dict);
+	}
 
 	// essentially, we want at least one applicable match so as soon as we find
 	// a match we break and return true
 
 	bool ret = false;
-	while (cpe_item_iterator_has_more(items)) {
-		struct cpe_item* item = cpe_item_iterator_next(items);
+	while (oscap_iterator_has_more(items)) {
+		struct cpe_item* item = oscap_iterator_next(items);
 		struct cpe_name* name = cpe_item_get_name(item);
 
 		if (cpe_name_match_one(cpe, name) && cpe_item_is_applicable(item, cb, usr)) {
@@ -174,7 +186,7 @@ bool cpe_name_applicable_dict(struct cpe_name *cpe, struct cpe_dict_model *dict,
 			break;
 		}
 	}
-	cpe_item_iterator_free(items);
+	oscap_iterator_free(items);
 	return ret;
 }
 
@@ -219,7 +231,6 @@ char *cpe_dict_detect_version_priv(xmlTextReader *reader)
 	const char* elm_name = (const char *) xmlTextReaderConstLocalName(reader);
 	if (!elm_name || strcmp("cpe-list", elm_name)) {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Expected root element name 'cpe-list', found '%s'.", elm_name);
-		xmlFreeTextReader(reader);
 		return NULL;
 	}
 	const char* ns_uri = (const char *) xmlTextReaderConstNamespaceUri(reader);
@@ -157,9 +157,93 @@ OSCAP_ACCESSOR_STRING(cpe_generator, product_name)
 
 OSCAP_GETTER(struct cpe_generator *, cpe_dict_model, generator)
 OSCAP_ACCESSOR_SIMPLE(int, cpe_dict_model, base_version)
-OSCAP_IGETINS_GEN(cpe_item, cpe_dict_model, items, item) OSCAP_ITERATOR_REMOVE_F(cpe_item)
+OSCAP_IGETTER_GEN(cpe_item, cpe_dict_model, items) OSCAP_ITERATOR_REMOVE_F(cpe_item)
 OSCAP_IGETINS_GEN(cpe_vendor, cpe_dict_model, vendors, vendor) OSCAP_ITERATOR_REMOVE_F(cpe_vendor)
 
+static void cpe_dict_model_drop_index(struct cpe_dict_model *dict)
+{
+	oscap_htable_free(dict->name_index, (oscap_destruct_func) oscap_list_free0);
+	dict->name_index = NULL;
+	oscap_list_free0(dict->wildcard_items);
+	dict->wildcard_items = NULL;
+}
+
+bool cpe_dict_model_add_item(struct cpe_dict_model *dict, struct cpe_item *item)
+{
+	cpe_dict_model_drop_index(dict);
+	oscap_list_add(dict->items, item);
+	return true;
+}
+
+/* Key of the name index, missing components are the same as empty ones
+ * and components are compared case-insensitively, see cpe_name_match_one */
+static char *cpe_name_index_key(const struct cpe_name *name)
+{
+	const char *vendor = cpe_name_get_vendor(name);
+	const char *product = cpe_name_get_product(name);
+	char *key = oscap_sprintf("%d:%s:%s", cpe_name_get_part(name),
+			vendor ? vendor : "", product ? product : "");
+	for (char *c = key; *c != '\0'; ++c)
+		*c = tolower((unsigned char) *c);
+	return key;
+}
+
+static void cpe_dict_model_build_index(struct cpe_dict_model *dict)
+{
+	cpe_dict_model_drop_index(dict);
+
+	const int count = oscap_list_get_itemcount(dict->items);
+	/* The hash table does not grow, size it after the dictionary */
+	dict->name_index = oscap_htable_new1(strcmp, count > 0 ? count : 1);
+	dict->wildcard_items = oscap_list_new();
+	dict->indexed_items = count;
+
+	struct oscap_iterator *it = oscap_iterator_new(dict->items);
+	while (oscap_iterator_has_more(it)) {
+		struct cpe_item *item = oscap_iterator_next(it);
+		const struct cpe_name *name = item->name;
+		if (name == NULL)
+			continue;
+
+		char *key = cpe_name_index_key(name);
+		struct oscap_list *bucket = oscap_htable_get(dict->name_index, key);
+		if (bucket == NULL) {
+			bucket = oscap_list_new();
+			oscap_htable_add(dict->name_index, key, bucket);
+		}
+		oscap_list_add(bucket, item);
+		free(key);
+
+		if (cpe_name_get_part(name) == CPE_PART_NONE ||
+				cpe_name_get_vendor(name) == NULL || cpe_name_get_product(name) == NULL)
+			oscap_list_add(dict->wildcard_items, item);
+	}
+	oscap_iterator_free(it);
+}
+
+static void cpe_dict_model_refresh_index(struct cpe_dict_model *dict)
+{
+	/* Items are added only through cpe_dict_model_add_item, which drops
+	 * the index, removal through the iterator changes the count */
+	if (dict->name_index == NULL || dict->indexed_items != oscap_list_get_itemcount(dict->items))
+		cpe_dict_model_build_index(dict);
+}
+
+struct oscap_list *cpe_dict_model_get_items_by_name(struct cpe_dict_model *dict, const struct cpe_name *name)
+{
+	cpe_dict_model_refresh_index(dict);
+	char *key = cpe_name_index_key(name);
+	struct oscap_list *bucket = oscap_htable_get(dict->name_index, key);
+	free(key);
+	return bucket;
+}
+
+struct oscap_list *cpe_dict_model_get_wildcard_items(struct cpe_dict_model *dict)
+{
+	cpe_dict_model_refresh_index(dict);
+	return dict->wildcard_items;
+}
+
 /* ****************************************
  * Component-tree structures
  * ***************************************/
@@ -1307,6 +1391,7 @@ void cpe_dict_model_free(struct cpe_dict_model *dict)
 	if (dict == NULL)
 		return;
 
+	cpe_dict_model_drop_index(dict);
 	oscap_list_free(dict->items, (oscap_destruct_func) cpe_item_free);
 	oscap_list_free(dict->vendors, (oscap_destruct_func) cpe_vendor_free);
 	cpe_generator_free(dict->generator);
@@ -40,6 +40,7 @@
 
 #include "../common/public/oscap.h"
 #include "../common/util.h"
+#include "../common/list.h"
 #include "../common/elements.h"
 
 /**
@@ -121,6 +122,26 @@ void cpe_item_export(const struct cpe_item *item, xmlTextWriterPtr writer, int b
  */
 void cpe_vendor_export(const struct cpe_vendor *vendor, xmlTextWriterPtr writer);
 
+/**
+ * Find dictionary items with the same part, vendor and product as the given name.
+ * Components are compared case-insensitively and a missing component equals
+ * an empty one, like in cpe_name_match_one. The index is built on the first
+ * lookup and rebuilt after items have been added or removed, names of items
+ * must not be changed in the meantime.
+ * @param dict CPE dictionary
+ * @param name CPE name
+ * @return list of items (not owned) in document order, NULL if there is none
+ */
+struct oscap_list *cpe_dict_model_get_items_by_name(struct cpe_dict_model *dict, const struct cpe_name *name);
+
+/**
+ * Get dictionary items with missing part, vendor or product.
+ * These may match names which are not among cpe_dict_model_get_items_by_name.
+ * @param dict CPE dictionary
+ * @return list of items (not owned) in document order
+ */
+struct oscap_list *cpe_dict_model_get_wildcard_items(struct cpe_dict_model *dict);
+
 /* <cpe-list>
  * */
 struct cpe_dict_model {		// the main node
@@ -129,6 +150,9 @@ struct cpe_dict_model {		// the main node
 	int base_version;
 	struct cpe_generator *generator;
 	char* origin_file;
+	struct oscap_htable *name_index;	// "part:vendor:product" -> list of items, built on first lookup
+	struct oscap_list *wildcard_items;	// items with missing part, vendor or product
+	int indexed_items;	// number of items when the index was built
 };
 
 /** 
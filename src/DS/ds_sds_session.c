@@ -41,12 +41,15 @@
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 #include "source/xslt_priv.h"
+#include <fcntl.h>
 #include <libgen.h>
 #include <libxml/tree.h>
+#include <unistd.h>
 
 struct ds_sds_session {
 	struct oscap_source *source;            ///< Source DataStream raw representation
 	struct ds_sds_index *index;             ///< Source DataStream index
+	xmlDoc *datastreams;                    ///< Data-streams read without components (using index)
 	char *temp_dir;                         ///< Temp directory managed by the session
 	const char *target_dir;                 ///< Target directory for current split
 	const char *datastream_id;              ///< ID of selected datastream
@@ -81,6 +84,7 @@ void ds_sds_session_free(struct ds_sds_session *sds_session)
 {
 	if (sds_session != NULL) {
 		ds_sds_index_free(sds_session->index);
+		xmlFreeDoc(sds_session->datastreams);
 		if (sds_session->temp_dir != NULL) {
 			oscap_acquire_cleanup_dir(&(sds_session->temp_dir));
 		}
@@ -101,6 +105,14 @@ void ds_sds_session_reset(struct ds_sds_session *session)
 struct ds_sds_index *ds_sds_session_get_sds_idx(struct ds_sds_session *session)
 {
 	if (session->index == NULL) {
+		// Unless the DOM is already there, index the file without building it.
+		const char *filepath = oscap_source_get_origin_file(session->source);
+		if (filepath != NULL && !oscap_source_has_xmlDoc(session->source)) {
+			session->index = ds_sds_index_cache_get(filepath);
+			if (session->index != NULL)
+				return session->index;
+		}
+
 		xmlTextReader *reader = oscap_source_get_xmlTextReader(session->source);
 		if (reader == NULL) {
 			return NULL;
@@ -231,9 +243,44 @@ struct oscap_source *ds_sds_session_select_tailoring(struct ds_sds_session *sess
 	return tailoring;
 }
 
+/*
+ * Get document with data-streams of the collection. If the file has not been
+ * parsed yet we use offsets from the index to read only the data-streams and
+ * leave the (much larger) components for ds_sds_session_read_component.
+ */
+static xmlDoc *ds_sds_session_get_datastreams_doc(struct ds_sds_session *session)
+{
+	if (session->datastreams == NULL && !oscap_source_has_xmlDoc(session->source)) {
+		struct ds_sds_index *index = ds_sds_session_get_sds_idx(session);
+		const char *filepath = oscap_source_get_origin_file(session->source);
+		if (index != NULL && filepath != NULL && ds_sds_index_has_offsets(index)) {
+			int fd = open(filepath, O_RDONLY);
+			if (fd >= 0) {
+				session->datastreams = ds_sds_index_read_datastreams(index, fd, filepath);
+				close(fd);
+			}
+		}
+	}
+	return session->datastreams != NULL ? session->datastreams : oscap_source_get_xmlDoc(session->source);
+}
+
+xmlDoc *ds_sds_session_read_component(struct ds_sds_session *session, const char *component_id)
+{
+	if (session->datastreams == NULL || component_id == NULL)
+		return NULL;
+
+	const char *filepath = oscap_source_get_origin_file(session->source);
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	xmlDoc *doc = ds_sds_index_read_component(session->index, fd, filepath, component_id);
+	close(fd);
+	return doc;
+}
+
 xmlNode *ds_sds_session_get_selected_datastream(struct ds_sds_session *session)
 {
-	xmlDoc *doc = oscap_source_get_xmlDoc(session->source);
+	xmlDoc *doc = ds_sds_session_get_datastreams_doc(session);
 	xmlNode *datastream = ds_sds_lookup_datastream_in_collection(doc, session->datastream_id);
 	if (datastream == NULL) {
 		char *error = session->datastream_id ?
@@ -284,11 +284,15 @@ static xmlNodePtr ds_sds_get_component_root_by_id(xmlDoc *doc, const char* compo
 
 static int ds_sds_dump_local_component(const char* component_id, struct ds_sds_session *session, const char *target_filename_dirname, const char *relative_filepath)
 {
-	xmlDoc *doc = ds_sds_session_get_xmlDoc(session);
+	// Reading just the component is much cheaper than parsing the whole collection.
+	xmlDoc *component_doc = ds_sds_session_read_component(session, component_id);
+	xmlDoc *doc = component_doc != NULL ? component_doc : ds_sds_session_get_xmlDoc(session);
 
 	xmlNodePtr inner_root = ds_sds_get_component_root_by_id(doc, component_id);
 
-	return ds_sds_register_component(session, doc, inner_root, component_id, target_filename_dirname, relative_filepath);
+	int ret = ds_sds_register_component(session, doc, inner_root, component_id, target_filename_dirname, relative_filepath);
+	xmlFreeDoc(component_doc);
+	return ret;
 }
 
 static int ds_sds_dump_file_component(const char* external_file, const char* component_id, struct ds_sds_session *session, const char *target_filename_dirname, const char *relative_filepath)
@@ -33,8 +33,20 @@
 #include "source/oscap_source_priv.h"
 #include "source/public/oscap_source.h"
 
+#include <libxml/parserInternals.h>
 #include <libxml/xmlreader.h>
+#include <libxml/xmlsave.h>
+#include <fcntl.h>
+#include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+
+/* Byte range of an element within the file the index has been built from */
+struct ds_sds_index_range
+{
+	long start;	///< offset of the '<' starting the element
+	long end;	///< offset right after the end of the element
+};
 
 struct ds_stream_index
 {
@@ -48,8 +60,29 @@ struct ds_stream_index
 	struct oscap_stringlist* extended_components;
 
 	struct oscap_htable *component_id_to_component_ref_id;
+
+	/* component-refs in document order, kept for the index sidecar */
+	struct oscap_list *component_refs;
+	struct ds_sds_index_range range;
+};
+
+/* Records just enough about a ds:component-ref to rebuild the stream index */
+struct ds_component_ref_entry
+{
+	const char *container;
+	char *id;
+	char *href;
 };
 
+static void ds_component_ref_entry_free(struct ds_component_ref_entry *entry)
+{
+	if (entry != NULL) {
+		free(entry->id);
+		free(entry->href);
+		free(entry);
+	}
+}
+
 struct ds_stream_index* ds_stream_index_new(void)
 {
 	struct ds_stream_index* ret = malloc(sizeof(struct ds_stream_index));
@@ -65,6 +98,10 @@ struct ds_stream_index* ds_stream_index_new(void)
 
 	ret->component_id_to_component_ref_id = oscap_htable_new();
 
+	ret->component_refs = oscap_list_new();
+	ret->range.start = -1;
+	ret->range.end = -1;
+
 	return ret;
 }
 
@@ -80,6 +117,7 @@ void ds_stream_index_free(struct ds_stream_index* s)
 	oscap_stringlist_free(s->extended_components);
 
 	oscap_htable_free(s->component_id_to_component_ref_id, (oscap_destruct_func)free);
+	oscap_list_free(s->component_refs, (oscap_destruct_func)ds_component_ref_entry_free);
 
 	free(s);
 }
@@ -119,6 +157,72 @@ struct oscap_string_iterator* ds_stream_index_get_extended_components(struct ds_
 	return oscap_iterator_new((struct oscap_list*)s->extended_components);
 }
 
+static const char *ds_stream_containers[] = {
+	"checklists", "checks", "dictionaries", "extended-components", NULL
+};
+
+/* Returns static copy of the container name, NULL if it is not a container */
+static const char *ds_stream_container_name(const char *name)
+{
+	for (const char **container = ds_stream_containers; *container != NULL; ++container) {
+		if (strcmp(*container, name) == 0)
+			return *container;
+	}
+	return NULL;
+}
+
+static struct oscap_stringlist *ds_stream_index_get_container(struct ds_stream_index *s, const char *container_name)
+{
+	if (strcmp(container_name, "checklists") == 0)
+		return s->checklist_components;
+	else if (strcmp(container_name, "checks") == 0)
+		return s->check_components;
+	else if (strcmp(container_name, "dictionaries") == 0)
+		return s->dictionary_components;
+	else if (strcmp(container_name, "extended-components") == 0)
+		return s->extended_components;
+	return NULL;
+}
+
+static void ds_stream_index_add_component_ref(struct ds_stream_index *s, const char *container_name, const char *id, const char *href)
+{
+	container_name = container_name != NULL ? ds_stream_container_name(container_name) : NULL;
+	struct oscap_stringlist *cref_target = container_name != NULL ? ds_stream_index_get_container(s, container_name) : NULL;
+
+	// sanity check
+	if (cref_target == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_XML,
+		             "Encountered <ds:component-ref> but it is either not inside "
+		             "any container element or container elements interleave. "
+		             "Please make sure the datastream is valid!");
+		return;
+	}
+
+	// this copies the id string
+	oscap_stringlist_add_string(cref_target, id);
+
+	struct ds_component_ref_entry *entry = calloc(1, sizeof(struct ds_component_ref_entry));
+	entry->container = ds_stream_container_name(container_name);
+	entry->id = oscap_strdup(id);
+	entry->href = oscap_strdup(href);
+	oscap_list_add(s->component_refs, entry);
+
+	// because of the leading '#' in the href preceding the component id
+	const char *component_id = href && href[0] ? href + 1 : NULL;
+	if (component_id == NULL)
+		return;
+
+	char *mapped_id = oscap_strdup(id);
+	if (!oscap_htable_add(s->component_id_to_component_ref_id, component_id, mapped_id)) {
+		oscap_seterr(OSCAP_EFAMILY_XML,
+		             "There is already a mapping from component id '%s' to component-ref id '%s'. "
+		             "Having multiple mappings is legal in a datastream but it may prove problematic "
+		             "when selecting component-refs using XCCDF Benchmark IDs.",
+		             component_id, id);
+		free(mapped_id);
+	}
+}
+
 static struct ds_stream_index* ds_stream_index_parse(xmlTextReaderPtr reader)
 {
 	// sanity check
@@ -143,7 +247,7 @@ static struct ds_stream_index* ds_stream_index_parse(xmlTextReaderPtr reader)
 	// The parser can be broken with invalid content such as:
 	// .. <checklists><checks/><component-ref ../></checklists> ..
 
-	struct oscap_stringlist* cref_target = NULL;
+	const char *container_name = NULL;
 	while (xmlTextReaderRead(reader) == 1)
 	{
 		int node_type = xmlTextReaderNodeType(reader);
@@ -156,67 +260,58 @@ static struct ds_stream_index* ds_stream_index_parse(xmlTextReaderPtr reader)
 			break;
 		}
 		// the following code switches where we push component refs
-		else if (strcmp(local_name, "checklists") == 0)
-		{
-			cref_target = node_type == XML_READER_TYPE_ELEMENT ? ret->checklist_components : NULL;
-		}
-		else if (strcmp(local_name, "checks") == 0)
-		{
-			cref_target = node_type == XML_READER_TYPE_ELEMENT ? ret->check_components : NULL;
-		}
-		else if (strcmp(local_name, "dictionaries") == 0)
-		{
-			cref_target = node_type == XML_READER_TYPE_ELEMENT ? ret->dictionary_components : NULL;
-		}
-		else if (strcmp(local_name, "extended-components") == 0)
+		else if (ds_stream_container_name(local_name) != NULL)
 		{
-			cref_target = node_type == XML_READER_TYPE_ELEMENT ? ret->extended_components : NULL;
+			container_name = node_type == XML_READER_TYPE_ELEMENT ? ds_stream_container_name(local_name) : NULL;
 		}
 		// reading of the component refs, we only care about their ID
 		else if (strcmp(local_name, "component-ref") == 0 &&
 		         node_type == XML_READER_TYPE_ELEMENT)
 		{
-			// sanity check
-			if (cref_target == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_XML,
-				             "Encountered <ds:component-ref> but it is either not inside "
-				             "any container element or container elements interleave. "
-				             "Please make sure the datastream is valid!");
-			}
-			else {
-				xmlChar *id_attr = xmlTextReaderGetAttribute(reader, BAD_CAST "id");
-				xmlChar *href_attr = xmlTextReaderGetAttributeNs(reader, BAD_CAST "href", BAD_CAST "http://www.w3.org/1999/xlink");
-
-				// this copies the id_attr string
-				oscap_stringlist_add_string(cref_target, (const char*)id_attr);
-
-				// because of the leading '#' in the href preceding the component id
-				const char *component_id = (const char*)(href_attr && href_attr[0] ? (href_attr + 1 * sizeof(char)) : NULL);
-				if (!component_id || !oscap_htable_add(ret->component_id_to_component_ref_id, component_id, (char*)id_attr)) {
-					if (component_id) {
-						oscap_seterr(OSCAP_EFAMILY_XML,
-				             "There is already a mapping from component id '%s' to component-ref id '%s'. "
-							 "Having multiple mappings is legal in a datastream but it may prove problematic "
-							"when selecting component-refs using XCCDF Benchmark IDs.",
-							component_id, id_attr);
-					}
-
-					xmlFree(id_attr);
-				}
+			xmlChar *id_attr = xmlTextReaderGetAttribute(reader, BAD_CAST "id");
+			xmlChar *href_attr = xmlTextReaderGetAttributeNs(reader, BAD_CAST "href", BAD_CAST "http://www.w3.org/1999/xlink");
 
-				xmlFree(href_attr);
-			}
+			ds_stream_index_add_component_ref(ret, container_name, (const char *) id_attr, (const char *) href_attr);
+
+			xmlFree(id_attr);
+			xmlFree(href_attr);
 		}
 	}
 
 	return ret;
 }
 
+/* Location of a ds:component or ds:extended-component within the file */
+struct ds_component_entry
+{
+	char *id;
+	char *benchmark_id;
+	struct ds_sds_index_range range;
+};
+
+static void ds_component_entry_free(struct ds_component_entry *entry)
+{
+	if (entry != NULL) {
+		free(entry->id);
+		free(entry->benchmark_id);
+		free(entry);
+	}
+}
+
 struct ds_sds_index
 {
 	struct oscap_list *streams;
 
 	struct oscap_htable *benchmark_id_to_component_id;
+
+	// Following is only known when the index has been built by
+	// ds_sds_index_parse_fd(). It allows us to read a single data-stream
+	// or component from the file without parsing the rest of it.
+	bool has_offsets;
+	char *root_name;                        ///< qualified name of the root element
+	struct ds_sds_index_range root_tag;     ///< start tag of the root element
+	struct oscap_list *components;          ///< ds_component_entry in document order
+	struct oscap_htable *component_by_id;   ///< component id -> ds_component_entry
 };
 
 struct ds_sds_index* ds_sds_index_new(void)
@@ -226,6 +321,13 @@ struct ds_sds_index* ds_sds_index_new(void)
 
 	ret->benchmark_id_to_component_id = oscap_htable_new();
 
+	ret->has_offsets = false;
+	ret->root_name = NULL;
+	ret->root_tag.start = -1;
+	ret->root_tag.end = -1;
+	ret->components = oscap_list_new();
+	ret->component_by_id = oscap_htable_new();
+
 	return ret;
 }
 
@@ -236,10 +338,45 @@ void ds_sds_index_free(struct ds_sds_index* s)
 
 		oscap_htable_free(s->benchmark_id_to_component_id, (oscap_destruct_func)free);
 
+		free(s->root_name);
+		oscap_htable_free0(s->component_by_id);
+		oscap_list_free(s->components, (oscap_destruct_func)ds_component_entry_free);
+
 		free(s);
 	}
 }
 
+static void ds_sds_index_map_benchmark(struct ds_sds_index *s, const char *benchmark_id, const char *component_id)
+{
+	char *mapped_id = oscap_strdup(component_id);
+	if (!oscap_htable_add(s->benchmark_id_to_component_id, benchmark_id, mapped_id)) {
+		// This benchmark ID was already in the map, therefore there must be 2 components
+		// with Benchmarks in them that have the same IDs. In this case, all bets are off
+		// when it comes to selecting a component-ref using Benchmark ID.
+		//
+		// To establish a well defined behavior, we don't "overwrite" it with the newly
+		// found benchmark but instead use the first benchmark with such ID there.
+
+		// TODO: Warning?
+		/*oscap_seterr(OSCAP_EFAMILY_XML, "There are at least two components containing "
+			"an XCCDF Benchmark with exactly the same ID ('%s'). Selecting a component-ref "
+			"using Benchmark ID will use the first component encountered and ignore "
+			"the subsequent ones with the same ID.", benchmark_id);*/
+
+		free(mapped_id);
+	}
+}
+
+static void ds_sds_index_add_component(struct ds_sds_index *s, struct ds_component_entry *component)
+{
+	if (component->benchmark_id != NULL && component->id != NULL)
+		ds_sds_index_map_benchmark(s, component->benchmark_id, component->id);
+
+	oscap_list_add(s->components, component);
+	if (component->id != NULL)
+		oscap_htable_add(s->component_by_id, component->id, component);
+}
+
 static void ds_sds_index_add_stream(struct ds_sds_index* s, struct ds_stream_index* stream)
 {
 	oscap_list_add(s->streams, stream);
@@ -364,31 +501,11 @@ struct ds_sds_index* ds_sds_index_parse(xmlTextReaderPtr reader)
 			char *component_id = (char*)xmlTextReaderGetAttribute(reader, BAD_CAST "id");
 			char *benchmark_id = ds_sds_component_dig_benchmark_id(reader);
 
-			if (benchmark_id == NULL) {
-				free(component_id);
-			}
-			else {
-				if (!oscap_htable_add(ret->benchmark_id_to_component_id, benchmark_id, component_id)) {
-					// This benchmark ID was already in the map, therefore there must be 2 components
-					// with Benchmarks in them that have the same IDs. In this case, all bets are off
-					// when it comes to selecting a component-ref using Benchmark ID.
-					//
-					// To establish a well defined behavior, we don't "overwrite" it with the newly
-					// found benchmark but instead use the first benchmark with such ID there.
-
-					// TODO: Warning?
-					/*oscap_seterr(OSCAP_EFAMILY_XML, "There are at least two components containing "
-						"an XCCDF Benchmark with exactly the same ID ('%s'). Selecting a component-ref "
-						"using Benchmark ID will use the first component encountered and ignore "
-						"the subsequent ones with the same ID.", benchmark_id);*/
-
-					free(component_id);
-				}
+			if (benchmark_id != NULL && component_id != NULL)
+				ds_sds_index_map_benchmark(ret, benchmark_id, component_id);
 
-				free(benchmark_id);
-			}
-
-			// we are going to free the component_id string later (in ds_sds_index_free)
+			free(component_id);
+			free(benchmark_id);
 		}
 		else if (strcmp(name, "extended-component") == 0) {
 			// ignore, extended-component can't be an XCCDF, therefore we are sure
@@ -407,6 +524,534 @@ struct ds_sds_index* ds_sds_index_parse(xmlTextReaderPtr reader)
 	return ret;
 }
 
+/* State of the SAX handler building the index in ds_sds_index_parse_fd */
+struct ds_sds_index_sax
+{
+	xmlParserCtxt *ctxt;
+	int fd;
+	struct ds_sds_index *index;
+	int depth;
+	bool failed;                            ///< the document is not a data-stream-collection
+	struct ds_stream_index *stream;         ///< data-stream being read
+	const char *container_name;             ///< container where component-refs go
+	struct ds_component_entry *component;   ///< component being read
+	bool extended;                          ///< whether component is an extended-component
+};
+
+static char *ds_sds_index_sax_get_attr(struct ds_sds_index_sax *sax, int nb_attributes, const xmlChar **attributes, const char *name, const char *ns_uri)
+{
+	// attributes are quintuples (localname, prefix, URI, value, end)
+	for (int i = 0; i < nb_attributes; i++) {
+		const xmlChar **attr = attributes + 5 * i;
+		if (strcmp((const char *) attr[0], name) != 0)
+			continue;
+		if (!oscap_streq((const char *) attr[2], ns_uri))
+			continue;
+		// Without entity substitution libxml2 passes '&' as a character reference,
+		// let it decode the value the same way the regular parser does.
+		return (char *) xmlStringLenDecodeEntities(sax->ctxt, attr[3], attr[4] - attr[3], XML_SUBSTITUTE_REF, 0, 0, 0);
+	}
+	return NULL;
+}
+
+/*
+ * The parser has just read a start tag. Look for the '<' opening it, it is
+ * the closest one since '<' can't appear within the tag.
+ */
+static long ds_sds_index_sax_tag_start(struct ds_sds_index_sax *sax)
+{
+	char buffer[4096];
+	long pos = xmlByteConsumed(sax->ctxt);
+	while (pos > 0) {
+		size_t len = pos < (long) sizeof(buffer) ? (size_t) pos : sizeof(buffer);
+		pos -= len;
+		if (pread(sax->fd, buffer, len, pos) != (ssize_t) len)
+			return -1;
+		for (size_t i = len; i > 0; i--) {
+			if (buffer[i - 1] == '<')
+				return pos + i - 1;
+		}
+	}
+	return -1;
+}
+
+/* Find end of the start tag beginning at given offset, '>' may be quoted */
+static long ds_sds_index_sax_tag_end(struct ds_sds_index_sax *sax, long start)
+{
+	char buffer[4096];
+	char quote = '\0';
+	long pos = start;
+	ssize_t len;
+	while (start >= 0 && (len = pread(sax->fd, buffer, sizeof(buffer), pos)) > 0) {
+		for (ssize_t i = 0; i < len; i++) {
+			if (quote != '\0') {
+				if (buffer[i] == quote)
+					quote = '\0';
+			}
+			else if (buffer[i] == '"' || buffer[i] == '\'') {
+				quote = buffer[i];
+			}
+			else if (buffer[i] == '>') {
+				return pos + i + 1;
+			}
+		}
+		pos += len;
+	}
+	return -1;
+}
+
+static void ds_sds_index_sax_start(void *ctx, const xmlChar *localname, const xmlChar *prefix, const xmlChar *URI,
+		int nb_namespaces, const xmlChar **namespaces, int nb_attributes, int nb_defaulted, const xmlChar **attributes)
+{
+	struct ds_sds_index_sax *sax = ctx;
+	const char *name = (const char *) localname;
+	int depth = sax->depth++;
+
+	if (sax->failed)
+		return;
+
+	if (depth == 0) {
+		if (strcmp(name, "data-stream-collection") != 0) {
+			sax->failed = true;
+			xmlStopParser(sax->ctxt);
+			return;
+		}
+		sax->index->root_name = prefix != NULL ?
+			oscap_sprintf("%s:%s", (const char *) prefix, name) : oscap_strdup(name);
+		sax->index->root_tag.start = ds_sds_index_sax_tag_start(sax);
+		sax->index->root_tag.end = ds_sds_index_sax_tag_end(sax, sax->index->root_tag.start);
+	}
+	else if (depth == 1) {
+		if (strcmp(name, "data-stream") == 0) {
+			sax->stream = ds_stream_index_new();
+			sax->stream->id = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "id", NULL);
+			sax->stream->timestamp = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "timestamp", NULL);
+			sax->stream->version = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "scap-version", NULL);
+			sax->stream->range.start = ds_sds_index_sax_tag_start(sax);
+			sax->container_name = NULL;
+		}
+		else if (strcmp(name, "component") == 0 || strcmp(name, "extended-component") == 0) {
+			sax->component = calloc(1, sizeof(struct ds_component_entry));
+			sax->component->id = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "id", NULL);
+			sax->component->range.start = ds_sds_index_sax_tag_start(sax);
+			// extended-component can't be an XCCDF, we don't dig Benchmark @id from it
+			sax->extended = strcmp(name, "extended-component") == 0;
+		}
+		else if (strcmp(name, "Signature") == 0) {
+			// ignore, Signatures are to be checked externally, we don't load them in
+		}
+		else {
+			oscap_seterr(OSCAP_EFAMILY_XML, "Unknown element '%s' encountered while parsing Source DataStream to ds_sds_index, skipping...", name);
+		}
+	}
+	else if (sax->stream != NULL) {
+		if (ds_stream_container_name(name) != NULL) {
+			sax->container_name = ds_stream_container_name(name);
+		}
+		else if (strcmp(name, "component-ref") == 0) {
+			char *id = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "id", NULL);
+			char *href = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "href", "http://www.w3.org/1999/xlink");
+			ds_stream_index_add_component_ref(sax->stream, sax->container_name, id, href);
+			free(id);
+			free(href);
+		}
+	}
+	else if (sax->component != NULL && !sax->extended && strcmp(name, "Benchmark") == 0) {
+		if (sax->component->benchmark_id != NULL) {
+			oscap_seterr(OSCAP_EFAMILY_XML,
+			             "Found 2 Benchmark elements inside a single sds:component element! "
+			             "Please make sure your datastream is valid. Skipping the second Benchmark.");
+		}
+		else {
+			sax->component->benchmark_id = ds_sds_index_sax_get_attr(sax, nb_attributes, attributes, "id", NULL);
+		}
+	}
+}
+
+static void ds_sds_index_sax_end(void *ctx, const xmlChar *localname, const xmlChar *prefix, const xmlChar *URI)
+{
+	struct ds_sds_index_sax *sax = ctx;
+	int depth = --sax->depth;
+
+	if (sax->failed)
+		return;
+
+	if (depth == 1) {
+		if (sax->stream != NULL) {
+			sax->stream->range.end = xmlByteConsumed(sax->ctxt);
+			ds_sds_index_add_stream(sax->index, sax->stream);
+			sax->stream = NULL;
+		}
+		else if (sax->component != NULL) {
+			sax->component->range.end = xmlByteConsumed(sax->ctxt);
+			ds_sds_index_add_component(sax->index, sax->component);
+			sax->component = NULL;
+		}
+	}
+	else if (sax->stream != NULL && ds_stream_container_name((const char *) localname) != NULL) {
+		sax->container_name = NULL;
+	}
+}
+
+static void ds_sds_index_sax_internal_subset(void *ctx, const xmlChar *name, const xmlChar *ExternalID, const xmlChar *SystemID)
+{
+	// Entities defined in DTD would not be known when we parse just a part
+	// of the document, hence we can't use offsets of such documents.
+	struct ds_sds_index_sax *sax = ctx;
+	sax->index->has_offsets = false;
+}
+
+static void ds_sds_index_sax_error(void *ctx, xmlErrorPtr error)
+{
+	// Errors are reported once the document is parsed the regular way.
+}
+
+static bool ds_sds_index_offsets_valid(struct ds_sds_index *s)
+{
+	if (s->root_tag.start < 0)
+		return false;
+
+	struct oscap_iterator *it = oscap_iterator_new(s->streams);
+	bool valid = true;
+	while (valid && oscap_iterator_has_more(it)) {
+		struct ds_stream_index *stream = oscap_iterator_next(it);
+		valid = stream->range.start >= 0 && stream->range.end > stream->range.start;
+	}
+	oscap_iterator_free(it);
+
+	it = oscap_iterator_new(s->components);
+	while (valid && oscap_iterator_has_more(it)) {
+		struct ds_component_entry *component = oscap_iterator_next(it);
+		valid = component->range.start >= 0 && component->range.end > component->range.start;
+	}
+	oscap_iterator_free(it);
+	return valid;
+}
+
+struct ds_sds_index *ds_sds_index_parse_fd(int fd, const char *url)
+{
+	xmlSAXHandler handler;
+	memset(&handler, 0, sizeof(handler));
+	handler.initialized = XML_SAX2_MAGIC;
+	handler.startElementNs = ds_sds_index_sax_start;
+	handler.endElementNs = ds_sds_index_sax_end;
+	handler.internalSubset = ds_sds_index_sax_internal_subset;
+	handler.serror = ds_sds_index_sax_error;
+
+	struct ds_sds_index_sax sax;
+	memset(&sax, 0, sizeof(sax));
+	sax.fd = fd;
+	sax.index = ds_sds_index_new();
+	sax.index->has_offsets = true;
+	sax.ctxt = xmlCreatePushParserCtxt(&handler, &sax, NULL, 0, url);
+	if (sax.ctxt == NULL) {
+		ds_sds_index_free(sax.index);
+		return NULL;
+	}
+
+	char buffer[65536];
+	off_t offset = 0;
+	ssize_t len;
+	while ((len = pread(fd, buffer, sizeof(buffer), offset)) > 0) {
+		offset += len;
+		if (xmlParseChunk(sax.ctxt, buffer, len, 0) != 0 || sax.failed)
+			break;
+	}
+	if (len == 0)
+		xmlParseChunk(sax.ctxt, NULL, 0, 1);
+
+	bool ok = len == 0 && !sax.failed && sax.ctxt->wellFormed;
+	// Parts of the file are later parsed as standalone UTF-8 snippets.
+	const char *encoding = (const char *) sax.ctxt->encoding;
+	if (encoding != NULL && strcasecmp(encoding, "UTF-8") != 0)
+		sax.index->has_offsets = false;
+	xmlFreeParserCtxt(sax.ctxt);
+
+	// Element being read when the parser stopped is not owned by the index.
+	if (sax.stream != NULL)
+		ds_stream_index_free(sax.stream);
+	ds_component_entry_free(sax.component);
+
+	if (!ok) {
+		ds_sds_index_free(sax.index);
+		return NULL;
+	}
+	if (sax.index->has_offsets)
+		sax.index->has_offsets = ds_sds_index_offsets_valid(sax.index);
+	return sax.index;
+}
+
+bool ds_sds_index_has_offsets(const struct ds_sds_index *s)
+{
+	return s->has_offsets;
+}
+
+/*
+ * Make a standalone document consisting of the root start tag (it declares
+ * the namespaces), given byte ranges of the file and the root end tag.
+ */
+static xmlDoc *ds_sds_index_read_ranges(struct ds_sds_index *s, int fd, const char *url, const struct ds_sds_index_range **ranges, size_t count)
+{
+	size_t size = s->root_tag.end - s->root_tag.start;
+	for (size_t i = 0; i < count; i++)
+		size += ranges[i]->end - ranges[i]->start;
+	char *end_tag = oscap_sprintf("</%s>", s->root_name);
+	size_t end_tag_size = strlen(end_tag);
+
+	char *buffer = malloc(size + end_tag_size);
+	size_t pos = 0;
+	bool ok = pread(fd, buffer, s->root_tag.end - s->root_tag.start, s->root_tag.start) == s->root_tag.end - s->root_tag.start;
+	pos += s->root_tag.end - s->root_tag.start;
+	for (size_t i = 0; ok && i < count; i++) {
+		ssize_t len = ranges[i]->end - ranges[i]->start;
+		ok = pread(fd, buffer + pos, len, ranges[i]->start) == len;
+		pos += len;
+	}
+	memcpy(buffer + pos, end_tag, end_tag_size);
+	free(end_tag);
+
+	xmlDoc *doc = ok ? xmlReadMemory(buffer, size + end_tag_size, url, "UTF-8", 0) : NULL;
+	free(buffer);
+	return doc;
+}
+
+xmlDoc *ds_sds_index_read_datastreams(struct ds_sds_index *s, int fd, const char *url)
+{
+	if (!s->has_offsets)
+		return NULL;
+
+	size_t count = oscap_list_get_itemcount(s->streams);
+	const struct ds_sds_index_range **ranges = calloc(count + 1, sizeof(struct ds_sds_index_range *));
+	size_t i = 0;
+	struct oscap_iterator *it = oscap_iterator_new(s->streams);
+	while (oscap_iterator_has_more(it)) {
+		struct ds_stream_index *stream = oscap_iterator_next(it);
+		ranges[i++] = &stream->range;
+	}
+	oscap_iterator_free(it);
+
+	xmlDoc *doc = ds_sds_index_read_ranges(s, fd, url, ranges, count);
+	free(ranges);
+	if (doc == NULL)
+		return NULL;
+
+	// Make sure the file still matches the index.
+	bool matches = true;
+	xmlNode *datastream = xmlDocGetRootElement(doc)->children;
+	it = oscap_iterator_new(s->streams);
+	while (matches && oscap_iterator_has_more(it)) {
+		struct ds_stream_index *stream = oscap_iterator_next(it);
+		while (datastream != NULL && datastream->type != XML_ELEMENT_NODE)
+			datastream = datastream->next;
+		char *id = datastream != NULL ? (char *) xmlGetProp(datastream, BAD_CAST "id") : NULL;
+		matches = id != NULL && oscap_streq(id, stream->id);
+		xmlFree(id);
+		if (datastream != NULL)
+			datastream = datastream->next;
+	}
+	oscap_iterator_free(it);
+
+	if (!matches) {
+		xmlFreeDoc(doc);
+		doc = NULL;
+	}
+	return doc;
+}
+
+xmlDoc *ds_sds_index_read_component(struct ds_sds_index *s, int fd, const char *url, const char *component_id)
+{
+	struct ds_component_entry *component = s->has_offsets ? oscap_htable_get(s->component_by_id, component_id) : NULL;
+	if (component == NULL)
+		return NULL;
+
+	const struct ds_sds_index_range *range = &component->range;
+	xmlDoc *doc = ds_sds_index_read_ranges(s, fd, url, &range, 1);
+
+	// Make sure the file still matches the index.
+	xmlNode *node = doc != NULL ? xmlDocGetRootElement(doc)->children : NULL;
+	while (node != NULL && node->type != XML_ELEMENT_NODE)
+		node = node->next;
+	char *id = node != NULL ? (char *) xmlGetProp(node, BAD_CAST "id") : NULL;
+	if (id == NULL || strcmp(id, component_id) != 0) {
+		xmlFreeDoc(doc);
+		doc = NULL;
+	}
+	xmlFree(id);
+	return doc;
+}
+
+#define DS_SDS_INDEX_SIDECAR_NS "http://open-scap.org/page/SDS_index"
+#define DS_SDS_INDEX_SIDECAR_VERSION "1"
+
+static void ds_sds_index_sidecar_set_range(xmlNode *node, const struct ds_sds_index_range *range)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%ld", range->start);
+	xmlNewProp(node, BAD_CAST "start", BAD_CAST buffer);
+	snprintf(buffer, sizeof(buffer), "%ld", range->end);
+	xmlNewProp(node, BAD_CAST "end", BAD_CAST buffer);
+}
+
+static bool ds_sds_index_sidecar_get_range(xmlNode *node, struct ds_sds_index_range *range)
+{
+	char *start = (char *) xmlGetProp(node, BAD_CAST "start");
+	char *end = (char *) xmlGetProp(node, BAD_CAST "end");
+	char *start_end = NULL, *end_end = NULL;
+	if (start != NULL && end != NULL) {
+		range->start = strtol(start, &start_end, 10);
+		range->end = strtol(end, &end_end, 10);
+	}
+	bool ok = start_end != NULL && *start_end == '\0' && end_end != NULL && *end_end == '\0' &&
+		range->start >= 0 && range->end > range->start;
+	xmlFree(start);
+	xmlFree(end);
+	return ok;
+}
+
+static void ds_sds_index_sidecar_set_prop(xmlNode *node, const char *name, const char *value)
+{
+	if (value != NULL)
+		xmlNewProp(node, BAD_CAST name, BAD_CAST value);
+}
+
+int ds_sds_index_save(struct ds_sds_index *s, int fd, const char *key)
+{
+	if (!s->has_offsets)
+		return -1;
+
+	xmlDoc *doc = xmlNewDoc(BAD_CAST "1.0");
+	xmlNode *root = xmlNewNode(NULL, BAD_CAST "sds-index");
+	xmlDocSetRootElement(doc, root);
+	xmlSetNs(root, xmlNewNs(root, BAD_CAST DS_SDS_INDEX_SIDECAR_NS, NULL));
+	xmlNewProp(root, BAD_CAST "version", BAD_CAST DS_SDS_INDEX_SIDECAR_VERSION);
+	xmlNewProp(root, BAD_CAST "key", BAD_CAST key);
+
+	xmlNode *collection = xmlNewTextChild(root, NULL, BAD_CAST "collection", NULL);
+	xmlNewProp(collection, BAD_CAST "name", BAD_CAST s->root_name);
+	ds_sds_index_sidecar_set_range(collection, &s->root_tag);
+
+	struct oscap_iterator *streams = oscap_iterator_new(s->streams);
+	while (oscap_iterator_has_more(streams)) {
+		struct ds_stream_index *stream = oscap_iterator_next(streams);
+		xmlNode *stream_node = xmlNewTextChild(root, NULL, BAD_CAST "data-stream", NULL);
+		ds_sds_index_sidecar_set_prop(stream_node, "id", stream->id);
+		ds_sds_index_sidecar_set_prop(stream_node, "timestamp", stream->timestamp);
+		ds_sds_index_sidecar_set_prop(stream_node, "scap-version", stream->version);
+		ds_sds_index_sidecar_set_range(stream_node, &stream->range);
+
+		struct oscap_iterator *crefs = oscap_iterator_new(stream->component_refs);
+		while (oscap_iterator_has_more(crefs)) {
+			struct ds_component_ref_entry *entry = oscap_iterator_next(crefs);
+			xmlNode *cref_node = xmlNewTextChild(stream_node, NULL, BAD_CAST "component-ref", NULL);
+			ds_sds_index_sidecar_set_prop(cref_node, "container", entry->container);
+			ds_sds_index_sidecar_set_prop(cref_node, "id", entry->id);
+			ds_sds_index_sidecar_set_prop(cref_node, "href", entry->href);
+		}
+		oscap_iterator_free(crefs);
+	}
+	oscap_iterator_free(streams);
+
+	struct oscap_iterator *components = oscap_iterator_new(s->components);
+	while (oscap_iterator_has_more(components)) {
+		struct ds_component_entry *component = oscap_iterator_next(components);
+		xmlNode *component_node = xmlNewTextChild(root, NULL, BAD_CAST "component", NULL);
+		ds_sds_index_sidecar_set_prop(component_node, "id", component->id);
+		ds_sds_index_sidecar_set_prop(component_node, "benchmark", component->benchmark_id);
+		ds_sds_index_sidecar_set_range(component_node, &component->range);
+	}
+	oscap_iterator_free(components);
+
+	int ret = -1;
+	xmlSaveCtxt *save = xmlSaveToFd(fd, "UTF-8", XML_SAVE_FORMAT);
+	if (save != NULL) {
+		ret = xmlSaveDoc(save, doc) < 0 ? -1 : 0;
+		if (xmlSaveClose(save) < 0)
+			ret = -1;
+	}
+	xmlFreeDoc(doc);
+	return ret;
+}
+
+static struct ds_stream_index *ds_sds_index_load_stream(xmlNode *node)
+{
+	struct ds_stream_index *stream = ds_stream_index_new();
+	stream->id = (char *) xmlGetProp(node, BAD_CAST "id");
+	stream->timestamp = (char *) xmlGetProp(node, BAD_CAST "timestamp");
+	stream->version = (char *) xmlGetProp(node, BAD_CAST "scap-version");
+	if (stream->id == NULL || !ds_sds_index_sidecar_get_range(node, &stream->range)) {
+		ds_stream_index_free(stream);
+		return NULL;
+	}
+
+	for (xmlNode *cref = node->children; cref != NULL; cref = cref->next) {
+		if (cref->type != XML_ELEMENT_NODE || strcmp((const char *) cref->name, "component-ref") != 0)
+			continue;
+		char *container = (char *) xmlGetProp(cref, BAD_CAST "container");
+		char *id = (char *) xmlGetProp(cref, BAD_CAST "id");
+		char *href = (char *) xmlGetProp(cref, BAD_CAST "href");
+		ds_stream_index_add_component_ref(stream, container, id, href);
+		xmlFree(container);
+		xmlFree(id);
+		xmlFree(href);
+	}
+	return stream;
+}
+
+struct ds_sds_index *ds_sds_index_load(const char *filename, const char *key)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	xmlDoc *doc = xmlReadFd(fd, NULL, NULL, XML_PARSE_NONET | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	close(fd);
+	if (doc == NULL)
+		return NULL;
+
+	xmlNode *root = xmlDocGetRootElement(doc);
+	char *version = (char *) xmlGetProp(root, BAD_CAST "version");
+	char *doc_key = (char *) xmlGetProp(root, BAD_CAST "key");
+	bool ok = root->ns != NULL && oscap_streq((const char *) root->ns->href, DS_SDS_INDEX_SIDECAR_NS) &&
+		oscap_streq(version, DS_SDS_INDEX_SIDECAR_VERSION) && oscap_streq(doc_key, key);
+	xmlFree(version);
+	xmlFree(doc_key);
+
+	struct ds_sds_index *index = ds_sds_index_new();
+	index->has_offsets = true;
+	for (xmlNode *node = root->children; ok && node != NULL; node = node->next) {
+		if (node->type != XML_ELEMENT_NODE)
+			continue;
+
+		if (strcmp((const char *) node->name, "collection") == 0) {
+			free(index->root_name);
+			index->root_name = (char *) xmlGetProp(node, BAD_CAST "name");
+			ok = index->root_name != NULL && ds_sds_index_sidecar_get_range(node, &index->root_tag);
+		}
+		else if (strcmp((const char *) node->name, "data-stream") == 0) {
+			struct ds_stream_index *stream = ds_sds_index_load_stream(node);
+			if (stream != NULL)
+				ds_sds_index_add_stream(index, stream);
+			ok = stream != NULL;
+		}
+		else if (strcmp((const char *) node->name, "component") == 0) {
+			struct ds_component_entry *component = calloc(1, sizeof(struct ds_component_entry));
+			component->id = (char *) xmlGetProp(node, BAD_CAST "id");
+			component->benchmark_id = (char *) xmlGetProp(node, BAD_CAST "benchmark");
+			ok = component->id != NULL && ds_sds_index_sidecar_get_range(node, &component->range);
+			if (ok)
+				ds_sds_index_add_component(index, component);
+			else
+				ds_component_entry_free(component);
+		}
+	}
+	xmlFreeDoc(doc);
+
+	if (!ok || index->root_name == NULL) {
+		ds_sds_index_free(index);
+		return NULL;
+	}
+	return index;
+}
+
 struct ds_sds_index *ds_sds_index_import(const char* file)
 {
 	struct oscap_source *source = oscap_source_new_from_file(file);
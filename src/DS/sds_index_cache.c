@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common/debug_priv.h"
+#include "common/util.h"
+#include "sds_index_priv.h"
+#include "source/compress_priv.h"
+
+/*
+ * Indexes of data streams are kept next to each other in a cache directory
+ * given by $OSCAP_SDS_INDEX_CACHE, the cache is not used unless it is set.
+ * Sidecar of a file is named by its device and inode and is valid as long as
+ * digest of the file content doesn't change. Size and mtime are not enough,
+ * offsets of a stale index would make us read wrong parts of the file.
+ * Cache is an optimization only, any failure to use it just makes us build
+ * the index from scratch.
+ */
+
+static char *ds_sds_index_cache_dir(void)
+{
+	const char *dir = getenv("OSCAP_SDS_INDEX_CACHE");
+	return dir != NULL && *dir != '\0' ? oscap_strdup(dir) : NULL;
+}
+
+static int ds_sds_index_cache_mkdir(const char *dir)
+{
+	char *path = oscap_strdup(dir);
+	for (char *sep = strchr(path + 1, '/'); ; sep = strchr(sep + 1, '/')) {
+		if (sep != NULL)
+			*sep = '\0';
+		if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+			free(path);
+			return -1;
+		}
+		if (sep == NULL)
+			break;
+		*sep = '/';
+	}
+	free(path);
+	return 0;
+}
+
+/*
+ * The key only needs to tell revisions of the file apart, hashing it with
+ * 64-bit FNV-1a is much cheaper than parsing it.
+ */
+static char *ds_sds_index_cache_key(int fd)
+{
+	unsigned char buffer[65536];
+	uint64_t digest = UINT64_C(14695981039346656037);
+	off_t size = 0;
+	ssize_t len;
+	while ((len = pread(fd, buffer, sizeof(buffer), size)) > 0) {
+		for (ssize_t i = 0; i < len; i++) {
+			digest ^= buffer[i];
+			digest *= UINT64_C(1099511628211);
+		}
+		size += len;
+	}
+	if (len < 0)
+		return NULL;
+	return oscap_sprintf("%jd-%016" PRIx64, (intmax_t) size, digest);
+}
+
+static void ds_sds_index_cache_store(struct ds_sds_index *index, const char *dir, const char *sidecar, const char *key)
+{
+	if (ds_sds_index_cache_mkdir(dir) != 0) {
+		dD("Could not create SDS index cache directory '%s': %s", dir, strerror(errno));
+		return;
+	}
+
+	// Write to a temporary file first, concurrent readers never see partial index.
+	char *temp = oscap_sprintf("%s.XXXXXX", sidecar);
+	int fd = mkstemp(temp);
+	if (fd < 0) {
+		dD("Could not create SDS index cache file '%s': %s", temp, strerror(errno));
+		free(temp);
+		return;
+	}
+	int ret = ds_sds_index_save(index, fd, key);
+	if (close(fd) != 0)
+		ret = -1;
+	if (ret != 0 || rename(temp, sidecar) != 0) {
+		dD("Could not store SDS index to cache file '%s'.", sidecar);
+		unlink(temp);
+	}
+	free(temp);
+}
+
+struct ds_sds_index *ds_sds_index_cache_get(const char *filepath)
+{
+	int fd = open(filepath, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	// Offsets would not be of any use within compressed files.
+	if (oscap_codec_detect_fd(fd) != NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	struct ds_sds_index *index = NULL;
+	char *dir = ds_sds_index_cache_dir();
+	char *key = NULL;
+	char *sidecar = NULL;
+	struct stat st;
+	if (dir != NULL && fstat(fd, &st) == 0)
+		key = ds_sds_index_cache_key(fd);
+	if (key != NULL)
+		sidecar = oscap_sprintf("%s/%ju-%ju.xml", dir, (uintmax_t) st.st_dev, (uintmax_t) st.st_ino);
+
+	if (sidecar != NULL) {
+		index = ds_sds_index_load(sidecar, key);
+		if (index != NULL)
+			dD("Loaded index of '%s' from cache file '%s'.", filepath, sidecar);
+	}
+	if (index == NULL) {
+		index = ds_sds_index_parse_fd(fd, filepath);
+		if (index != NULL && sidecar != NULL && ds_sds_index_has_offsets(index)) {
+			// Don't store the index under the key if the file changed meanwhile.
+			char *parsed_key = ds_sds_index_cache_key(fd);
+			if (oscap_streq(parsed_key, key))
+				ds_sds_index_cache_store(index, dir, sidecar, key);
+			free(parsed_key);
+		}
+	}
+
+	free(sidecar);
+	free(key);
+	free(dir);
+	close(fd);
+	return index;
+}
@@ -34,5 +34,58 @@ OSCAP_HIDDEN_START;
 
 struct ds_sds_index* ds_sds_index_parse(xmlTextReaderPtr reader);
 
+/**
+ * Build the index by a single streaming pass over an uncompressed file.
+ * Unlike ds_sds_index_parse the index also records byte offsets of every
+ * data-stream and component, see ds_sds_index_has_offsets.
+ * @param fd file descriptor of the data stream collection, its offset is not changed
+ * @param url path to the file, used in messages
+ * @returns index or NULL if the file is not a well-formed data stream collection
+ */
+struct ds_sds_index *ds_sds_index_parse_fd(int fd, const char *url);
+
+/**
+ * Find out whether parts of the file can be read by ds_sds_index_read_datastreams
+ * and ds_sds_index_read_component. Offsets are not available when the index has
+ * been built from DOM or when the file is not encoded in UTF-8 or has a DTD.
+ */
+bool ds_sds_index_has_offsets(const struct ds_sds_index *s);
+
+/**
+ * Read all data-stream elements (but no components) from the file the index
+ * has been built from.
+ * @returns document with the collection root and data-streams, or NULL if
+ * the file no longer matches the index
+ */
+xmlDoc *ds_sds_index_read_datastreams(struct ds_sds_index *s, int fd, const char *url);
+
+/**
+ * Read a single component (or extended-component) from the file the index
+ * has been built from, without parsing the rest of the collection.
+ * @returns document with the collection root and the component, or NULL if
+ * the component is not indexed or the file no longer matches the index
+ */
+xmlDoc *ds_sds_index_read_component(struct ds_sds_index *s, int fd, const char *url, const char *component_id);
+
+/**
+ * Serialize the index (including offsets) to a sidecar file.
+ * @param key identification of the indexed file revision, checked by ds_sds_index_load
+ * @returns 0 on success
+ */
+int ds_sds_index_save(struct ds_sds_index *s, int fd, const char *key);
+
+/**
+ * Load index from a sidecar file written by ds_sds_index_save.
+ * @returns index or NULL if the sidecar is unusable or has been made for other content
+ */
+struct ds_sds_index *ds_sds_index_load(const char *filename, const char *key);
+
+/**
+ * Get index of a plain data stream file, reusing the on-disk sidecar cache.
+ * The cache is used only if $OSCAP_SDS_INDEX_CACHE names its directory.
+ * @returns index with offsets, or NULL if the file is compressed or can't be indexed
+ */
+struct ds_sds_index *ds_sds_index_cache_get(const char *filepath);
+
 OSCAP_HIDDEN_END;
 #endif
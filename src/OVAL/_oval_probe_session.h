@@ -45,8 +45,17 @@ struct oval_probe_session {
         struct oval_syschar_model *sys_model; /**< system characteristics model */
         char         *dir;  /**< probe session directory */
         uint32_t      flg;  /**< probe session flags */
+        struct oval_collection_cache *cache; /**< collected objects shared with other sessions */
+        struct oval_string_map *var_refs; /**< object id -> variables the object refers to */
 };
 
+/**
+ * Get the variables referred by the entities, sets and filters of an object.
+ * The map is computed once per object and owned by the session.
+ * @return map of variable id -> struct oval_variable
+ */
+struct oval_string_map *oval_probe_session_get_var_refs(oval_probe_session_t *sess, struct oval_object *object);
+
 #endif /* _OVAL_PROBE_SESSION */
 
 /// @}
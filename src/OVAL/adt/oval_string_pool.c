@@ -0,0 +1,173 @@
+/**
+ * @file oval_string_pool.c
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oval_string_pool_impl.h"
+
+#define OVAL_STRING_POOL_BLOCK_SIZE (64 * 1024)
+#define OVAL_STRING_POOL_INITIAL_SLOTS 256
+
+struct oval_string_pool_block {
+	struct oval_string_pool_block *next;
+	size_t used;
+	size_t size;
+	char data[];
+};
+
+struct oval_string_pool {
+	const char **slots;                    ///< open addressing table, size is a power of 2
+	size_t slot_count;
+	size_t count;                          ///< number of used slots
+	struct oval_string_pool_block *blocks; ///< the current block comes first
+};
+
+static uint32_t _oval_string_pool_hash(const char *str)
+{
+	/* FNV-1a */
+	uint32_t hash = 2166136261u;
+	for (; *str != '\0'; str++) {
+		hash ^= (unsigned char) *str;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+struct oval_string_pool *oval_string_pool_new(void)
+{
+	struct oval_string_pool *pool = calloc(1, sizeof(struct oval_string_pool));
+	if (pool == NULL)
+		return NULL;
+	pool->slots = calloc(OVAL_STRING_POOL_INITIAL_SLOTS, sizeof(const char *));
+	if (pool->slots == NULL) {
+		free(pool);
+		return NULL;
+	}
+	pool->slot_count = OVAL_STRING_POOL_INITIAL_SLOTS;
+	return pool;
+}
+
+void oval_string_pool_free(struct oval_string_pool *pool)
+{
+	if (pool == NULL)
+		return;
+	struct oval_string_pool_block *block = pool->blocks;
+	while (block != NULL) {
+		struct oval_string_pool_block *next = block->next;
+		free(block);
+		block = next;
+	}
+	free(pool->slots);
+	free(pool);
+}
+
+static const char **_oval_string_pool_lookup(const char **slots, size_t slot_count, const char *str)
+{
+	size_t n = _oval_string_pool_hash(str) & (slot_count - 1);
+	while (slots[n] != NULL && strcmp(slots[n], str) != 0)
+		n = (n + 1) & (slot_count - 1);
+	return &slots[n];
+}
+
+static bool _oval_string_pool_grow(struct oval_string_pool *pool)
+{
+	size_t slot_count = 2 * pool->slot_count;
+	const char **slots = calloc(slot_count, sizeof(const char *));
+	if (slots == NULL)
+		return false;
+	for (size_t n = 0; n < pool->slot_count; n++) {
+		if (pool->slots[n] != NULL)
+			*_oval_string_pool_lookup(slots, slot_count, pool->slots[n]) = pool->slots[n];
+	}
+	free(pool->slots);
+	pool->slots = slots;
+	pool->slot_count = slot_count;
+	return true;
+}
+
+static char *_oval_string_pool_alloc(struct oval_string_pool *pool, size_t len)
+{
+	struct oval_string_pool_block *block = pool->blocks;
+	if (block == NULL || block->size - block->used < len) {
+		/* Strings too long to share a block get a block of their own
+		 * which is put behind the current one. */
+		size_t size = len > OVAL_STRING_POOL_BLOCK_SIZE / 4 ? len : OVAL_STRING_POOL_BLOCK_SIZE;
+		struct oval_string_pool_block *new_block = malloc(sizeof(struct oval_string_pool_block) + size);
+		if (new_block == NULL)
+			return NULL;
+		new_block->used = 0;
+		new_block->size = size;
+		if (block != NULL && size != OVAL_STRING_POOL_BLOCK_SIZE) {
+			new_block->next = block->next;
+			block->next = new_block;
+		} else {
+			new_block->next = block;
+			pool->blocks = new_block;
+		}
+		block = new_block;
+	}
+	char *str = block->data + block->used;
+	block->used += len;
+	return str;
+}
+
+const char *oval_string_pool_intern(struct oval_string_pool *pool, const char *str)
+{
+	if (str == NULL)
+		return NULL;
+
+	const char **slot = _oval_string_pool_lookup(pool->slots, pool->slot_count, str);
+	if (*slot != NULL)
+		return *slot;
+
+	/* Keep the load factor under 3/4 */
+	if (4 * (pool->count + 1) > 3 * pool->slot_count) {
+		if (!_oval_string_pool_grow(pool))
+			return NULL;
+		slot = _oval_string_pool_lookup(pool->slots, pool->slot_count, str);
+	}
+
+	size_t len = strlen(str) + 1;
+	char *copy = _oval_string_pool_alloc(pool, len);
+	if (copy == NULL)
+		return NULL;
+	memcpy(copy, str, len);
+	*slot = copy;
+	pool->count++;
+	return copy;
+}
+
+size_t oval_string_pool_get_count(const struct oval_string_pool *pool)
+{
+	return pool->count;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file oval_string_pool_impl.h
+ * \brief Open Vulnerability and Assessment Language
+ *
+ * See more details at http://oval.mitre.org/
+ */
+
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef OVAL_STRING_POOL_IMPL_H_
+#define OVAL_STRING_POOL_IMPL_H_
+
+#include <stddef.h>
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * Pool of interned strings.
+ *
+ * Every distinct string is stored only once, packed together with other
+ * strings in large blocks. The strings live until the pool is freed.
+ */
+struct oval_string_pool;
+
+struct oval_string_pool *oval_string_pool_new(void);
+void oval_string_pool_free(struct oval_string_pool *pool);
+
+/**
+ * Get the pooled copy of the given string, add it to the pool if needed.
+ * @returns pooled string which must not be modified nor freed, NULL if str is NULL
+ */
+const char *oval_string_pool_intern(struct oval_string_pool *pool, const char *str);
+
+/// @returns number of distinct strings in the pool
+size_t oval_string_pool_get_count(const struct oval_string_pool *pool);
+
+OSCAP_HIDDEN_END;
+
+#endif				/* OVAL_STRING_POOL_IMPL_H_ */
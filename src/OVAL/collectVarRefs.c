@@ -48,12 +48,15 @@ static void _comp_collect_var_refs(struct oval_component *comp, struct oval_stri
 	case OVAL_FUNCTION_ARITHMETIC:
 	case OVAL_FUNCTION_BEGIN:
 	case OVAL_FUNCTION_CONCAT:
+	case OVAL_FUNCTION_COUNT:
 	case OVAL_FUNCTION_END:
 	case OVAL_FUNCTION_ESCAPE_REGEX:
+	case OVAL_FUNCTION_GLOB_TO_REGEX:
 	case OVAL_FUNCTION_REGEX_CAPTURE:
 	case OVAL_FUNCTION_SPLIT:
 	case OVAL_FUNCTION_SUBSTRING:
 	case OVAL_FUNCTION_TIMEDIF:
+	case OVAL_FUNCTION_UNIQUE:
 		cmp_itr = oval_component_get_function_components(comp);
 		while (oval_component_iterator_has_more(cmp_itr)) {
 			struct oval_component *cmp;
@@ -97,6 +100,11 @@ static void _ent_collect_var_refs(struct oval_entity *ent, struct oval_string_ma
 	}
 }
 
+void oval_var_collect_var_refs(struct oval_variable *var, struct oval_string_map *vm)
+{
+	_var_collect_var_refs(var, vm);
+}
+
 void oval_ste_collect_var_refs(struct oval_state *ste, struct oval_string_map *vm)
 {
 	struct oval_state_content_iterator *cont_itr;
@@ -33,6 +33,7 @@ OSCAP_HIDDEN_START;
  * recursively. They are stored as pairs of (var id, var pointer).
  */
 void oval_obj_collect_var_refs(struct oval_object *obj, struct oval_string_map *vm);
+void oval_var_collect_var_refs(struct oval_variable *var, struct oval_string_map *vm);
 void oval_ste_collect_var_refs(struct oval_state *ste, struct oval_string_map *vm);
 
 OSCAP_HIDDEN_END;
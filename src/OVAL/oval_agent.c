@@ -43,6 +43,7 @@
 #include "adt/oval_string_map_impl.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
+#include "oval_collection_cache.h"
 #include "results/oval_results_impl.h"
 #include "common/list.h"
 #include "common/util.h"
@@ -60,6 +61,7 @@ struct oval_agent_session {
 	struct oval_syschar_model    * sys_models[2];
 	struct oval_results_model    * res_model;
 	oval_probe_session_t  * psess;
+	struct oval_collection_cache *cache;
 };
 
 
@@ -87,6 +89,10 @@ static const struct oval_result_to_xccdf_spec XCCDF_OVAL_RESULTS_MAP[] = {
 };
 
 oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *model, const char * name) {
+	return oval_agent_new_session_with_cache(model, name, NULL);
+}
+
+oval_agent_session_t *oval_agent_new_session_with_cache(struct oval_definition_model *model, const char *name, struct oval_collection_cache *cache) {
 	oval_agent_session_t *ag_sess;
 	struct oval_sysinfo *sysinfo;
 	struct oval_generator *generator;
@@ -103,6 +109,8 @@ oval_agent_session_t * oval_agent_new_session(struct oval_definition_model *mode
 	ag_sess->cur_var_model = NULL;
 	ag_sess->sys_model = oval_syschar_model_new(model);
 	ag_sess->psess     = oval_probe_session_new(ag_sess->sys_model);
+	ag_sess->cache     = cache;
+	oval_probe_session_set_cache(ag_sess->psess, cache);
 
 	/* probe sysinfo */
 	ret = oval_probe_query_sysinfo(ag_sess->psess, &sysinfo);
@@ -230,8 +238,14 @@ int oval_agent_reset_session(oval_agent_session_t * ag_sess) {
 
 	/* We have to reset probe_session inplace, because
 	 * ag_sess->res_model points to old probe_session
-	 * and we are not able to update the reference clearly */
-	oval_probe_session_reinit(ag_sess->psess, ag_sess->sys_model);
+	 * and we are not able to update the reference clearly.
+	 * The running probes only drop their caches, they are
+	 * restarted only if that fails. */
+	if (oval_probe_session_reset(ag_sess->psess, ag_sess->sys_model) != 0)
+		oval_probe_session_reinit(ag_sess->psess, ag_sess->sys_model);
+
+	/* The system might have changed, collect the objects again */
+	oval_collection_cache_clear(ag_sess->cache);
 
 	return 0;
 }
@@ -393,7 +407,7 @@ static void _oval_agent_resolve_variables_conflict(struct oval_agent_session *se
 	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(dict);
 	struct oval_definition_model *def_model =
 			oval_results_model_get_definition_model(oval_agent_get_results_model(session));
-	while (!conflict && oscap_htable_iterator_has_more(hit)) {
+	while (oscap_htable_iterator_has_more(hit)) {
 		oscap_htable_iterator_next_kv(hit, &var_name, (void*) &value_list);
 		struct oval_variable *variable = oval_definition_model_get_variable(def_model, var_name);
 		if (variable != NULL) {
@@ -443,7 +457,7 @@ static void _oval_agent_resolve_variables_conflict(struct oval_agent_session *se
 						int instance = oval_result_definition_get_instance(r_definition);
 						oval_result_definition_set_variable_instance_hint(r_definition, instance + 1);
 						struct oval_definition *definition = oval_result_definition_get_definition(r_definition);
-						oval_probe_hint_definition(session->psess, definition, instance + 1);
+						oval_probe_hint_definition(session->psess, definition, variable, instance + 1);
 					}
 					else {
 						// TODO: We really need oval_agent_session wide variable_instance attribute
@@ -588,6 +602,116 @@ xccdf_test_result_type_t oval_agent_eval_rule(struct xccdf_policy *policy, const
         }
 }
 
+/**
+ * Find out whether the value bindings would compel new variable model,
+ * see _oval_agent_resolve_variables_conflict.
+ */
+static bool _oval_agent_bindings_conflict(struct oval_agent_session *session, struct xccdf_value_binding_iterator *it)
+{
+	const char *var_name = NULL;
+	struct oscap_stringlist *value_list = NULL;
+	bool conflict = false;
+	struct oscap_htable *dict = _binding_iterator_to_dict(it);
+	struct oscap_htable_iterator *hit = oscap_htable_iterator_new(dict);
+	while (!conflict && oscap_htable_iterator_has_more(hit)) {
+		oscap_htable_iterator_next_kv(hit, &var_name, (void*) &value_list);
+		struct oval_variable *variable = oval_definition_model_get_variable(session->def_model, var_name);
+		if (variable != NULL) {
+			struct oval_value_iterator *value_it = oval_variable_get_values(variable);
+			conflict = _stringlist_conflicts_with_value_it(value_list, value_it);
+			oval_value_iterator_free(value_it);
+		}
+	}
+	oscap_htable_iterator_free(hit);
+	oscap_htable_free(dict, (oscap_destruct_func) oscap_stringlist_free);
+	return conflict;
+}
+
+/**
+ * Collect objects of all tests within the criteria in the order in which
+ * the evaluation would query them. Unlike oval_probe_query_definition, this
+ * does not stop at the first object which cannot be collected.
+ * @returns 0 on success; -1 on error
+ */
+static int _oval_agent_collect_criteria(struct oval_agent_session *sess, struct oval_criteria_node *cnode)
+{
+	int ret = 0;
+
+	switch (oval_criteria_node_get_type(cnode)) {
+	case OVAL_NODETYPE_CRITERION: {
+		struct oval_test *test = oval_criteria_node_get_test(cnode);
+		if (test != NULL && oval_probe_query_test(sess->psess, test) == -1)
+			ret = -1;
+	} break;
+	case OVAL_NODETYPE_CRITERIA: {
+		struct oval_criteria_node_iterator *cnode_it = oval_criteria_node_get_subnodes(cnode);
+		while (ret == 0 && oval_criteria_node_iterator_has_more(cnode_it))
+			ret = _oval_agent_collect_criteria(sess, oval_criteria_node_iterator_next(cnode_it));
+		oval_criteria_node_iterator_free(cnode_it);
+	} break;
+	case OVAL_NODETYPE_EXTENDDEF: {
+		struct oval_definition *definition = oval_criteria_node_get_definition(cnode);
+		struct oval_criteria_node *criteria = definition ? oval_definition_get_criteria(definition) : NULL;
+		if (criteria != NULL)
+			ret = _oval_agent_collect_criteria(sess, criteria);
+	} break;
+	default:
+		break;
+	}
+	return ret;
+}
+
+static int _oval_agent_collect_definition(struct oval_agent_session *sess, struct oval_definition *definition)
+{
+	struct oval_criteria_node *criteria = oval_definition_get_criteria(definition);
+	return criteria == NULL ? 0 : _oval_agent_collect_criteria(sess, criteria);
+}
+
+/**
+ * Collect the system characteristics for a batch of XCCDF checks at once,
+ * before the checks are evaluated by oval_agent_eval_rule. The objects are
+ * collected in the same order the evaluation would do it, so the results
+ * do not differ. Collection stops at the first check whose value bindings
+ * conflict with the bound variables: such a check resets the session when
+ * it gets evaluated and anything collected for it now would be lost.
+ */
+static int
+_oval_agent_eval_batch(struct xccdf_policy *policy, const char *href, struct xccdf_policy_batch_check_iterator *checks_it, void *usr)
+{
+	__attribute__nonnull__(usr);
+	struct oval_agent_session *sess = (struct oval_agent_session *) usr;
+	if (strcmp(sess->filename, href))
+		return 0;
+
+	int ret = 0;
+	int count = 0;
+	while (ret == 0 && xccdf_policy_batch_check_iterator_has_more(checks_it)) {
+		struct xccdf_policy_batch_check *check = xccdf_policy_batch_check_iterator_next(checks_it);
+		struct xccdf_value_binding_iterator *binding_it = xccdf_policy_batch_check_get_value_bindings(check);
+		if (_oval_agent_bindings_conflict(sess, binding_it)) {
+			xccdf_value_binding_iterator_free(binding_it);
+			break;
+		}
+		ret = oval_agent_resolve_variables(sess, binding_it);
+		xccdf_value_binding_iterator_free(binding_it);
+
+		const char *id = xccdf_policy_batch_check_get_name(check);
+		if (id != NULL) {
+			struct oval_definition *definition = oval_definition_model_get_definition(sess->def_model, id);
+			if (ret == 0 && definition != NULL)
+				ret = _oval_agent_collect_definition(sess, definition);
+		} else {
+			struct oval_definition_iterator *def_it = oval_definition_model_get_definitions(sess->def_model);
+			while (ret == 0 && oval_definition_iterator_has_more(def_it))
+				ret = _oval_agent_collect_definition(sess, oval_definition_iterator_next(def_it));
+			oval_definition_iterator_free(def_it);
+		}
+		count++;
+	}
+	dI("Collected objects of %d XCCDF checks from '%s' in advance.", count, href);
+	return ret;
+}
+
 static void *
 _oval_agent_list_definitions(void *usr, xccdf_policy_engine_query_t query_type, void *query_data)
 {
@@ -611,8 +735,8 @@ _oval_agent_list_definitions(void *usr, xccdf_policy_engine_query_t query_type,
 bool xccdf_policy_model_register_engine_oval(struct xccdf_policy_model * model, struct oval_agent_session * usr)
 {
 
-    return xccdf_policy_model_register_engine_and_query_callback(model, "http://oval.mitre.org/XMLSchema/oval-definitions-5",
-		oval_agent_eval_rule, (void *) usr, _oval_agent_list_definitions);
+    return xccdf_policy_model_register_engine_and_batch_callback(model, "http://oval.mitre.org/XMLSchema/oval-definitions-5",
+		oval_agent_eval_rule, (void *) usr, _oval_agent_list_definitions, _oval_agent_eval_batch);
 }
 
 void oval_agent_export_sysinfo_to_xccdf_result(struct oval_agent_session * sess, struct xccdf_result * ritem)
@@ -36,6 +36,17 @@ OSCAP_HIDDEN_START;
 
 #define OVAL_ENUMERATION_INVALID (-1)
 
+struct oval_definition_model;
+struct oval_agent_session;
+struct oval_collection_cache;
+
+/**
+ * Create new OVAL agent session which shares collected objects with other
+ * sessions using the same collection cache.
+ * @param cache not owned by the session, NULL behaves as oval_agent_new_session()
+ */
+struct oval_agent_session *oval_agent_new_session_with_cache(struct oval_definition_model *model, const char *name, struct oval_collection_cache *cache);
+
 #define OVAL_SUPPORTED "5.11.1"
 
 #define OVAL_COMMON_NAMESPACE      BAD_CAST "http://oval.mitre.org/XMLSchema/oval-common-5"
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <seap.h>
+
+#include "common/list.h"
+#include "common/debug_priv.h"
+#include "probes/public/probe-api.h"
+#include "oval_collection_cache.h"
+
+struct oval_collection_cache {
+	struct oscap_htable *replies; ///< key -> struct oval_collection_entry
+};
+
+struct oval_collection_entry {
+	SEXP_t *obj;   ///< object without its ID, guards against key collisions
+	SEXP_t *reply; ///< collected object as returned by the probe
+};
+
+static void oval_collection_entry_free(struct oval_collection_entry *entry)
+{
+	if (entry == NULL)
+		return;
+
+	SEXP_free(entry->obj);
+	SEXP_free(entry->reply);
+	free(entry);
+}
+
+struct oval_collection_cache *oval_collection_cache_new(void)
+{
+	struct oval_collection_cache *cache = malloc(sizeof(struct oval_collection_cache));
+
+	cache->replies = oscap_htable_new();
+	return cache;
+}
+
+void oval_collection_cache_free(struct oval_collection_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	oscap_htable_free(cache->replies, (oscap_destruct_func) oval_collection_entry_free);
+	free(cache);
+}
+
+void oval_collection_cache_clear(struct oval_collection_cache *cache)
+{
+	if (cache == NULL)
+		return;
+
+	oscap_htable_free(cache->replies, (oscap_destruct_func) oval_collection_entry_free);
+	cache->replies = oscap_htable_new();
+}
+
+/*
+ * Replace the object header (name :id ... :oval_version ...) with
+ * (name oval_version) so that identical objects with different IDs
+ * compare equal.
+ */
+static SEXP_t *oval_collection_cache_normalize(const SEXP_t *obj)
+{
+	SEXP_t *head, *name, *version, *rest, *norm, *r0;
+
+	if (probe_obj_attrexists(obj, "skip_eval"))
+		return NULL;
+
+	if ((r0 = probe_obj_getent(obj, "set", 1)) != NULL
+	    || (r0 = probe_obj_getent(obj, "filter", 1)) != NULL) {
+		SEXP_free(r0);
+		return NULL;
+	}
+
+	head = SEXP_list_first(obj);
+	if (head == NULL)
+		return NULL;
+
+	name = SEXP_listp(head) ? SEXP_list_first(head) : SEXP_ref(head);
+	version = probe_obj_getattrval(obj, "oval_version");
+	if (version == NULL)
+		version = SEXP_string_new("", 0);
+
+	r0 = SEXP_list_new(name, version, NULL);
+	rest = SEXP_list_rest(obj);
+	norm = SEXP_list_join(r0, rest);
+	SEXP_vfree(head, name, version, rest, r0, NULL);
+
+	return norm;
+}
+
+static char *oval_collection_cache_key(SEXP_t *norm)
+{
+	strbuf_t *sb = strbuf_new(SEAP_STRBUF_MAX);
+	char *key = NULL;
+
+	if (SEXP_sbprintf_t(norm, sb) == 0) {
+		size_t len = strbuf_length(sb);
+
+		key = malloc(len + 1);
+		strbuf_copy(sb, key, len);
+		key[len] = '\0';
+	}
+
+	strbuf_free(sb);
+	return key;
+}
+
+SEXP_t *oval_collection_cache_get(struct oval_collection_cache *cache, const SEXP_t *obj)
+{
+	struct oval_collection_entry *entry = NULL;
+	SEXP_t *norm;
+	char *key;
+
+	if (cache == NULL || (norm = oval_collection_cache_normalize(obj)) == NULL)
+		return NULL;
+
+	if ((key = oval_collection_cache_key(norm)) != NULL)
+		entry = oscap_htable_get(cache->replies, key);
+
+	if (entry != NULL && !SEXP_deepcmp(entry->obj, norm))
+		entry = NULL;
+
+	free(key);
+	SEXP_free(norm);
+
+	return entry != NULL ? SEXP_ref(entry->reply) : NULL;
+}
+
+void oval_collection_cache_put(struct oval_collection_cache *cache, const SEXP_t *obj, const SEXP_t *reply)
+{
+	struct oval_collection_entry *entry;
+	SEXP_t *norm;
+	char *key;
+
+	if (cache == NULL || reply == NULL || (norm = oval_collection_cache_normalize(obj)) == NULL)
+		return;
+
+	if ((key = oval_collection_cache_key(norm)) == NULL) {
+		SEXP_free(norm);
+		return;
+	}
+
+	entry = malloc(sizeof(struct oval_collection_entry));
+	entry->obj = norm;
+	entry->reply = SEXP_ref(reply);
+
+	/* The first reply wins, a colliding key is simply not cached */
+	if (!oscap_htable_add(cache->replies, key, entry))
+		oval_collection_entry_free(entry);
+
+	free(key);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file   oval_collection_cache.h
+ * @brief  Collected objects shared between OVAL agent sessions
+ *
+ * @addtogroup OVAL
+ * @{
+ */
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OVAL_COLLECTION_CACHE_H
+#define OVAL_COLLECTION_CACHE_H
+
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Probe replies keyed by the content of the object which was sent to the
+ * probe. The object ID is not a part of the key, so the same object defined
+ * in several OVAL documents is collected only once. Objects referencing
+ * other objects or states by ID (set and filter content) are never cached.
+ *
+ * The cache is owned by the caller (e.g. XCCDF session) and shared by all
+ * OVAL agent sessions which scan the same system.
+ */
+struct oval_collection_cache;
+struct SEXP; /* SEXP_t, not included to keep this header usable outside of OVAL */
+
+struct oval_collection_cache *oval_collection_cache_new(void);
+void oval_collection_cache_free(struct oval_collection_cache *cache);
+
+/**
+ * Drop all cached replies, e.g. when the scanned system might have changed
+ */
+void oval_collection_cache_clear(struct oval_collection_cache *cache);
+
+/**
+ * Get the cached probe reply for the object
+ * @return new reference to the reply or NULL if not cached
+ */
+struct SEXP *oval_collection_cache_get(struct oval_collection_cache *cache, const struct SEXP *obj);
+
+/**
+ * Remember the probe reply for the object
+ * Nothing is stored if the object cannot be shared.
+ */
+void oval_collection_cache_put(struct oval_collection_cache *cache, const struct SEXP *obj, const struct SEXP *reply);
+
+OSCAP_HIDDEN_END;
+
+#endif /* OVAL_COLLECTION_CACHE_H */
+/// @}
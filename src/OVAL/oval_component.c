@@ -1363,7 +1363,7 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_OBJECTREF(oval_ar
 			while (oval_sysent_iterator_has_more(sysent_itr)) {
 				oval_datatype_t dt;
 				struct oval_sysent *sysent = oval_sysent_iterator_next(sysent_itr);
-				char *sysent_name = oval_sysent_get_name(sysent);
+				const char *sysent_name = oval_sysent_get_name(sysent);
 
 				if (strcmp(ifield_name, sysent_name))
 					continue;
@@ -1420,7 +1420,7 @@ static oval_syschar_collection_flag_t _oval_component_evaluate_OBJECTREF(oval_ar
 					}
 					oval_record_field_iterator_free(rf_itr);
 				} else {
-					char *txtval;
+					const char *txtval;
 					struct oval_value *val;
 
 					txtval = oval_sysent_get_value(sysent);
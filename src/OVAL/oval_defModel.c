@@ -39,6 +39,7 @@
 #include "oval_agent_api_impl.h"
 #include "oval_parser_impl.h"
 #include "adt/oval_string_map_impl.h"
+#include "collectVarRefs_impl.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
 #include "common/util.h"
@@ -58,6 +59,7 @@ typedef struct oval_definition_model {
 	struct oval_collection *bound_variable_models;
         char *schema;
 	struct oval_string_map *vardef_map;		///< look-up table for efficient @variable_instance processing
+	struct oval_collection *extvar_locals;		///< local variables whose values depend on external variables
 } oval_definition_model_t;
 
 /* failed   - NULL
@@ -78,6 +80,7 @@ struct oval_definition_model *oval_definition_model_new()
 	newmodel->bound_variable_models = NULL;
 	newmodel->schema = oscap_strdup(OVAL_DEF_SCHEMA_LOCATION);
 	newmodel->vardef_map = NULL;
+	newmodel->extvar_locals = NULL;
 
 	return newmodel;
 }
@@ -131,6 +134,8 @@ void oval_definition_model_free(struct oval_definition_model *model)
 		oval_string_map_free(model->variable_map, (oscap_destruct_func) oval_variable_free);
 		if (model->vardef_map != NULL)
 			oval_string_map_free(model->vardef_map, (oscap_destruct_func) oval_string_map_free0);
+		if (model->extvar_locals != NULL)
+			oval_collection_free(model->extvar_locals);
 		if (model->bound_variable_models)
 			oval_collection_free_items(model->bound_variable_models,
 					   (oscap_destruct_func) oval_variable_model_free);
@@ -353,6 +358,32 @@ struct oval_variable_model_iterator *oval_definition_model_get_variable_models(s
 		return (struct oval_variable_model_iterator *) oval_collection_iterator_new();
 }
 
+static struct oval_collection *_oval_definition_model_build_extvar_locals(struct oval_definition_model *model)
+{
+	struct oval_collection *locals = oval_collection_new();
+	struct oval_variable_iterator *vars_itr = oval_definition_model_get_variables(model);
+	while (oval_variable_iterator_has_more(vars_itr)) {
+		struct oval_variable *var = oval_variable_iterator_next(vars_itr);
+		if (oval_variable_get_type(var) != OVAL_VARIABLE_LOCAL)
+			continue;
+
+		/* Both variable and object components are followed */
+		struct oval_string_map *refs = oval_string_map_new();
+		oval_var_collect_var_refs(var, refs);
+		struct oval_variable_iterator *refs_itr = (struct oval_variable_iterator *) oval_string_map_values(refs);
+		while (oval_variable_iterator_has_more(refs_itr)) {
+			if (oval_variable_get_type(oval_variable_iterator_next(refs_itr)) == OVAL_VARIABLE_EXTERNAL) {
+				oval_collection_add(locals, var);
+				break;
+			}
+		}
+		oval_variable_iterator_free(refs_itr);
+		oval_string_map_free0(refs);
+	}
+	oval_variable_iterator_free(vars_itr);
+	return locals;
+}
+
 void oval_definition_model_clear_external_variables(struct oval_definition_model *model)
 {
 	struct oval_variable_iterator *vars_itr;
@@ -368,6 +399,15 @@ void oval_definition_model_clear_external_variables(struct oval_definition_model
 		oval_variable_clear_values(var);
 	}
 	oval_variable_iterator_free(vars_itr);
+
+	/* Values computed from the old values of the external variables are stale */
+	if (model->extvar_locals == NULL)
+		model->extvar_locals = _oval_definition_model_build_extvar_locals(model);
+	struct oval_variable_iterator *locals_itr =
+		(struct oval_variable_iterator *) oval_collection_iterator(model->extvar_locals);
+	while (oval_variable_iterator_has_more(locals_itr))
+		oval_variable_clear_values(oval_variable_iterator_next(locals_itr));
+	oval_variable_iterator_free(locals_itr);
 }
 
 struct oval_definition_iterator *oval_definition_model_get_definitions(struct oval_definition_model
@@ -248,7 +248,15 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 	sysc = oval_syschar_model_get_syschar(model, oid);
 	if (sysc != NULL) {
 		int variable_instance_hint = oval_syschar_get_variable_instance_hint(sysc);
-		if (oval_syschar_get_variable_instance_hint(sysc) != oval_syschar_get_variable_instance(sysc)) {
+		if (oval_syschar_get_variable_instance_hint(sysc) != oval_syschar_get_variable_instance(sysc) &&
+		    oval_syschar_get_variable_instance_shared(sysc) && oval_syschar_get_flag(sysc) != SYSCHAR_FLAG_UNKNOWN) {
+			dI("Sharing the items of %s_object '%s' with variable_instance=%d.", type_name, oid, variable_instance_hint);
+			sysc = oval_syschar_new_instance(sysc, variable_instance_hint);
+			if (out_syschar)
+				*out_syschar = sysc;
+			return 0;
+		}
+		else if (oval_syschar_get_variable_instance_hint(sysc) != oval_syschar_get_variable_instance(sysc)) {
 			dI("Creating another syschar for variable_instance=%d)", variable_instance_hint);
 			sysc = oval_syschar_new(model, object);
 			oval_syschar_set_variable_instance(sysc, variable_instance_hint);
@@ -290,10 +298,8 @@ int oval_probe_query_object(oval_probe_session_t *psess, struct oval_object *obj
 	}
 
 	if (!(flags & OVAL_PDFLAG_NOREPLY)) {
-		vm = oval_string_map_new();
-		oval_obj_collect_var_refs(object, vm);
+		vm = oval_probe_session_get_var_refs(psess, object);
 		_syschar_add_bindings(sysc, vm);
-		oval_string_map_free(vm, NULL);
 	}
 
 	return 0;
@@ -75,9 +75,19 @@ oval_pext_t *oval_pext_new(void)
         if (pext->probe_dir == NULL)
                 pext->probe_dir = OVAL_PROBE_DIR;
 
+        /*
+         * Probes of a probe host scan the system they were started on,
+         * so they can't be used to scan a different root.
+         */
+        if (getenv("OSCAP_PROBE_ROOT") == NULL)
+                pext->host_dir = getenv("OSCAP_PROBE_HOST_DIR");
+        else
+                pext->host_dir = NULL;
+
         pext->pdtbl     = NULL;
         pext->pdsc      = NULL;
         pext->pdsc_cnt  = 0;
+        pext->cache     = NULL;
 
         return(pext);
 }
@@ -596,6 +606,30 @@ static int oval_probe_comm(SEAP_CTX_t *ctx, oval_pd_t *pd, const SEXP_t *s_iobj,
 	return (0);
 }
 
+/*
+ * Answer the object from the collection cache shared with other sessions
+ * if possible. The probe is not even started when the reply is cached.
+ */
+static int oval_probe_comm_cached(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, const SEXP_t *s_iobj, int flags, SEXP_t **out_sexp)
+{
+	int ret;
+
+	if (pext->cache == NULL || (flags & OVAL_PDFLAG_NOREPLY))
+		return oval_probe_comm(ctx, pd, s_iobj, flags, out_sexp);
+
+	*out_sexp = oval_collection_cache_get(pext->cache, s_iobj);
+	if (*out_sexp != NULL) {
+		dI("Object collected by another session, probe %s not queried.", pd->uri);
+		return (0);
+	}
+
+	ret = oval_probe_comm(ctx, pd, s_iobj, flags, out_sexp);
+	if (ret == 0)
+		oval_collection_cache_put(pext->cache, s_iobj, *out_sexp);
+
+	return (ret);
+}
+
 static int oval_pdsc_typecmp(oval_subtype_t *a, oval_pdsc_t *b)
 {
         return (*a - b->type);
@@ -612,8 +646,28 @@ static oval_pdsc_t *oval_pdsc_lookup(oval_pdsc_t pdsc[], int count, oval_subtype
                            (int (*)(void *, void *))oval_pdsc_typecmp);
 }
 
-static int oval_probe_sys_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, struct oval_syschar_model *model, struct oval_sysinfo **out_sysinf)
+/*
+ * Use the probe host if it serves the probe, otherwise the probe is
+ * spawned for this session.
+ */
+static size_t oval_probe_uri(const oval_pext_t *pext, const oval_pdsc_t *dsc, char *uri, size_t size)
+{
+	if (pext->host_dir != NULL) {
+		struct stat st;
+		int len = snprintf(uri, size, "%s/%s", pext->host_dir, dsc->file);
+
+		if (len > 0 && (size_t)len < size && stat(uri, &st) == 0 && S_ISSOCK(st.st_mode))
+			return snprintf(uri, size, "unix://%s/%s", pext->host_dir, dsc->file);
+
+		dD("No probe host socket for %s in %s.", dsc->file, pext->host_dir);
+	}
+
+	return snprintf(uri, size, "%s://%s/%s", OVAL_PROBE_SCHEME, pext->probe_dir, dsc->file);
+}
+
+static int oval_probe_sys_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struct oval_sysinfo **out_sysinf)
 {
+	struct oval_syschar_model *model = *(pext->model);
 	struct oval_sysinfo *sysinf;
 	struct oval_sysint *ife;
 	SEXP_t *s_obj, *s_sinf, *ent, *r0, *r1;
@@ -637,7 +691,7 @@ static int oval_probe_sys_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, struct oval_sysch
                 SEXP_free (r0);
         }
 
-        ret = oval_probe_comm(ctx, pd, s_obj, 0, &r0);
+        ret = oval_probe_comm_cached(ctx, pd, pext, s_obj, 0, &r0);
         SEXP_free(s_obj);
 
 	if (ret != 0)
@@ -767,17 +821,15 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
                 }
 
                 assume_r(pd != NULL, -1);
-		ret = oval_probe_sys_eval(pext->pdtbl->ctx, pd, *(pext->model), inf);
+		ret = oval_probe_sys_eval(pext->pdtbl->ctx, pd, pext, inf);
                 break;
         }
         case PROBE_HANDLER_ACT_OPEN:
         {
                 char         probe_uri[PATH_MAX + 1];
                 size_t       probe_urilen;
-                char        *probe_dir;
                 oval_pdsc_t *probe_dsc;
 
-                probe_dir = pext->probe_dir;
                 probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, type);
 
 		if (probe_dsc == NULL) {
@@ -787,8 +839,7 @@ int oval_probe_sys_handler(oval_subtype_t type, void *ptr, int act, ...)
 			break;
 		}
 
-                probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                        "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
+                probe_urilen = oval_probe_uri(pext, probe_dsc, probe_uri, sizeof probe_uri);
 
                 if (probe_urilen >= sizeof probe_uri) {
                         oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
@@ -841,10 +892,8 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
                 if (pd == NULL) {
                         char         probe_uri[PATH_MAX + 1];
                         size_t       probe_urilen;
-                        char        *probe_dir;
                         oval_pdsc_t *probe_dsc;
 
-                        probe_dir = pext->probe_dir;
                         probe_dsc = oval_pdsc_lookup(pext->pdsc, pext->pdsc_cnt, oval_object_get_subtype(obj));
 
 			if (probe_dsc == NULL) {
@@ -854,8 +903,7 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
 				return (1);
 			}
 
-                        probe_urilen = snprintf(probe_uri, sizeof probe_uri,
-                                                "%s://%s/%s", OVAL_PROBE_SCHEME, probe_dir, probe_dsc->file);
+                        probe_urilen = oval_probe_uri(pext, probe_dsc, probe_uri, sizeof probe_uri);
 
                         if (probe_urilen >= sizeof probe_uri) {
                                 oscap_seterr (OSCAP_EFAMILY_GLIBC, "probe URI too long");
@@ -914,6 +962,12 @@ int oval_probe_ext_handler(oval_subtype_t type, void *ptr, int act, ...)
         case PROBE_HANDLER_ACT_RESET:
 	case PROBE_HANDLER_ACT_ABORT:
         {
+                if (pext->do_init) {
+                        /* No probe has been started yet */
+                        va_end(ap);
+                        return(0);
+                }
+
                 if (type == OVAL_SUBTYPE_ALL) {
                         /*
                          * Iterate thru probe descriptor table and execute the reset operation
@@ -1064,7 +1118,7 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 	if (ret != 0)
 		return (1);
 
-	ret = oval_probe_comm(ctx, pd, s_obj, flags, &s_sys);
+	ret = oval_probe_comm_cached(ctx, pd, pext, s_obj, flags, &s_sys);
 	SEXP_free(s_obj);
 
 	if (ret != 0) {
@@ -1102,6 +1156,9 @@ int oval_probe_ext_eval(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext, struc
 
 int oval_probe_ext_reset(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 {
+        if (pd->sd == -1)
+                return (0);
+
         SEAP_cmd_exec(ctx, pd->sd, SEAP_EXEC_RECV, PROBECMD_RESET, NULL, SEAP_CMDTYPE_SYNC, NULL, NULL);
 
         return (0);
@@ -1143,6 +1200,13 @@ int oval_probe_ext_abort(SEAP_CTX_t *ctx, oval_pd_t *pd, oval_pext_t *pext)
 
 		break;
 	}
+	case SCH_UNIX:
+		dI("Shutting down connection to the probe host");
+
+		if (sch_unix_abort(dsc) != 0)
+			dW("shutdown(%d): %u, %s", pd->sd, errno, strerror(errno));
+
+		break;
 	default:
 		return (-1);
 	}
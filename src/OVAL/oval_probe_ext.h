@@ -28,6 +28,7 @@
 #include "oval_probe_impl.h"
 #include "oval_system_characteristics_impl.h"
 #include "common/util.h"
+#include "oval_collection_cache.h"
 
 typedef struct {
 	oval_subtype_t subtype;
@@ -58,6 +59,8 @@ struct oval_pext {
         size_t        pdsc_cnt;
         oval_pdtbl_t *pdtbl;
         char         *probe_dir;
+        char         *host_dir; /**< directory with sockets of a probe host, see `probe_X --listen' */
+        struct oval_collection_cache *cache; /**< replies shared with other sessions, not owned */
 
         void *sess_ptr;
         struct oval_syschar_model **model;
@@ -28,10 +28,12 @@
 #include "public/oval_system_characteristics.h"
 #include "oval_system_characteristics_impl.h"
 #include "oval_probe_impl.h"
+#include "adt/oval_string_map_impl.h"
+#include "common/debug_priv.h"
 #include "_oval_probe_session.h"
 
-static int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_node *cnode, int variable_instance_hint);
-static int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *object, int variable_instance_hint);
+static int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_node *cnode, struct oval_variable *variable, int variable_instance_hint);
+static int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *object, struct oval_variable *variable, int variable_instance_hint);
 
 /**
  * Finds all the oval_syschars (collected objects) assigned with a given definition
@@ -39,10 +41,13 @@ static int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_obje
  * collected objects with the hint that a new round of collection might be needed
  * when these objects are again probed by @ref oval_probe_query_object. That is
  * usefull when a new variable instance is injected into the oval_agent_session.
+ * Objects which do not depend on the given variable are not collected again,
+ * their next variable instance refers to the items already collected.
+ * @param variable variable with the new values, NULL to hint all the objects
  * @param variable_instance_hint new hint to set
  * @returns 0 on success; -1 on error; 1 on warning
  */
-int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, int variable_instance_hint)
+int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, struct oval_variable *variable, int variable_instance_hint)
 {
 	if (definition == NULL)
 		return -1;
@@ -50,10 +55,10 @@ int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definitio
 	if (cnode == NULL)
 		return -1;
 
-	return _oval_probe_hint_criteria(sess, cnode, variable_instance_hint);
+	return _oval_probe_hint_criteria(sess, cnode, variable, variable_instance_hint);
 }
 
-int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_node *cnode, int variable_instance_hint)
+int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_node *cnode, struct oval_variable *variable, int variable_instance_hint)
 {
 	switch (oval_criteria_node_get_type(cnode)) {
 	case OVAL_NODETYPE_CRITERION:{
@@ -64,7 +69,7 @@ int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_n
 		if (object == NULL)
 			return 0;
 		// TODO: Do we need to similarly hint all the object refereced like: test->state->variable->object?
-		return _oval_probe_hint_object(sess, object, variable_instance_hint);
+		return _oval_probe_hint_object(sess, object, variable, variable_instance_hint);
 	}
 	case OVAL_NODETYPE_CRITERIA:{
 		struct oval_criteria_node_iterator *cnode_it = oval_criteria_node_get_subnodes(cnode);
@@ -73,14 +78,14 @@ int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_n
 		int ret = 0;
 		while (ret == 0 && oval_criteria_node_iterator_has_more(cnode_it)) {
 			struct oval_criteria_node *node = oval_criteria_node_iterator_next(cnode_it);
-			ret = _oval_probe_hint_criteria(sess, node, variable_instance_hint);
+			ret = _oval_probe_hint_criteria(sess, node, variable, variable_instance_hint);
 		}
 		oval_criteria_node_iterator_free(cnode_it);
 		return ret;
 	}
 	case OVAL_NODETYPE_EXTENDDEF:{
 		struct oval_definition *oval_def = oval_criteria_node_get_definition(cnode);
-		return oval_probe_hint_definition(sess, oval_def, variable_instance_hint);
+		return oval_probe_hint_definition(sess, oval_def, variable, variable_instance_hint);
 	}
 	case OVAL_NODETYPE_UNKNOWN:{
 		assert(false);
@@ -90,12 +95,20 @@ int _oval_probe_hint_criteria(oval_probe_session_t *sess, struct oval_criteria_n
 	return -1;
 }
 
-int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *object, int variable_instance_hint)
+int _oval_probe_hint_object(oval_probe_session_t *psess, struct oval_object *object, struct oval_variable *variable, int variable_instance_hint)
 {
 	const char *oid = oval_object_get_id(object);
 	struct oval_syschar *syschar = oval_syschar_model_get_syschar(psess->sys_model, oid);
-	if (syschar != NULL) {
-		oval_syschar_set_variable_instance_hint(syschar, variable_instance_hint);
+	if (syschar == NULL)
+		return 0;
+
+	if (variable != NULL &&
+	    oval_string_map_get_value(oval_probe_session_get_var_refs(psess, object), oval_variable_get_id(variable)) == NULL) {
+		dI("Collected object '%s' does not depend on variable '%s', variable instance %d may share its items.",
+			oid, oval_variable_get_id(variable), variable_instance_hint);
+		oval_syschar_set_variable_instance_hint_shared(syschar, variable_instance_hint);
+		return 0;
 	}
+	oval_syschar_set_variable_instance_hint(syschar, variable_instance_hint);
 	return 0;
 }
@@ -57,6 +57,14 @@ OSCAP_HIDDEN_START;
 
 int oval_probe_query_test(oval_probe_session_t *sess, struct oval_test *test);
 
+struct oval_collection_cache;
+
+/**
+ * Share collected objects with other probe sessions using the same cache
+ * @param cache not owned by the session, NULL disables sharing
+ */
+void oval_probe_session_set_cache(oval_probe_session_t *sess, struct oval_collection_cache *cache);
+
 OSCAP_HIDDEN_END;
 
 extern probe_ncache_t *OSCAP_GSYM(ncache);
@@ -70,7 +78,7 @@ void oval_probe_tblinit(void);
 const char *oval_subtype_to_str(oval_subtype_t subtype);
 oval_subtype_t oval_str_to_subtype(const char *str);
 
-int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, int variable_instance_hint);
+int oval_probe_hint_definition(oval_probe_session_t *sess, struct oval_definition *definition, struct oval_variable *variable, int variable_instance_hint);
 
 #endif /* OVAL_PROBE_IMPL_H */
 /// @}
@@ -48,6 +48,8 @@
 #include "oval_probe_impl.h"
 #include "oval_probe_ext.h"
 #include "oval_probe_meta.h"
+#include "collectVarRefs_impl.h"
+#include "adt/oval_string_map_impl.h"
 
 #if defined(OSCAP_THREAD_SAFE)
 #include <pthread.h>
@@ -129,6 +131,8 @@ static void oval_probe_session_init(oval_probe_session_t *sess, struct oval_sysc
         sess->pext = oval_pext_new();
         sess->pext->model    = &sess->sys_model;
         sess->pext->sess_ptr = sess;
+        sess->pext->cache    = sess->cache;
+        sess->var_refs = oval_string_map_new();
 
         __init_once();
 
@@ -151,10 +155,17 @@ static void oval_probe_session_init(oval_probe_session_t *sess, struct oval_sysc
 oval_probe_session_t *oval_probe_session_new(struct oval_syschar_model *model)
 {
         oval_probe_session_t *sess = oscap_talloc(oval_probe_session_t);
+        sess->cache = NULL;
         oval_probe_session_init(sess, model);
         return sess;
 }
 
+static void oval_probe_var_refs_free(struct oval_string_map *vm)
+{
+	/* The variables are owned by the definition model */
+	oval_string_map_free(vm, NULL);
+}
+
 static void oval_probe_session_free(oval_probe_session_t *sess)
 {
 	if (sess == NULL) {
@@ -164,6 +175,20 @@ static void oval_probe_session_free(oval_probe_session_t *sess)
 
 	oval_phtbl_free(sess->ph);
 	oval_pext_free(sess->pext);
+	oval_string_map_free(sess->var_refs, (oscap_destruct_func) oval_probe_var_refs_free);
+}
+
+struct oval_string_map *oval_probe_session_get_var_refs(oval_probe_session_t *sess, struct oval_object *object)
+{
+	const char *oid = oval_object_get_id(object);
+	struct oval_string_map *vm = oval_string_map_get_value(sess->var_refs, oid);
+
+	if (vm == NULL) {
+		vm = oval_string_map_new();
+		oval_obj_collect_var_refs(object, vm);
+		oval_string_map_put(sess->var_refs, oid, vm);
+	}
+	return vm;
 }
 
 void oval_probe_session_reinit(oval_probe_session_t *sess, struct oval_syschar_model *model)
@@ -221,6 +246,12 @@ int oval_probe_session_sethandler(oval_probe_session_t *sess, oval_subtype_t typ
         return(-1);
 }
 
+void oval_probe_session_set_cache(oval_probe_session_t *sess, struct oval_collection_cache *cache)
+{
+	sess->cache = cache;
+	sess->pext->cache = cache;
+}
+
 struct oval_syschar_model *oval_probe_session_getmodel(oval_probe_session_t *sess)
 {
 	if (sess == NULL) {
@@ -31,6 +31,8 @@
 #include <config.h>
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -45,16 +47,34 @@
 #include "common/debug_priv.h"
 #include "common/elements.h"
 
+/*
+ * Names and values of the entities are interned in the string pool of the
+ * syschar model, the same name or value of many items is stored only once.
+ * Only entities without a model own their strings.
+ */
 typedef struct oval_sysent {
 	struct oval_syschar_model *model;
-	char *name;
-	char *value;
+	const char *name;
+	const char *value;
 	struct oval_collection *record_fields;
-	int mask;
-	oval_datatype_t datatype;
-	oval_syschar_status_t status;
+	uint8_t datatype;                      ///< oval_datatype_t
+	uint8_t status;                        ///< oval_syschar_status_t
+	bool mask;
 } oval_sysent_t;
 
+static const char *_oval_sysent_store_string(struct oval_sysent *sysent, const char *str)
+{
+	if (sysent->model == NULL)
+		return oscap_strdup(str);
+	return oval_syschar_model_intern_string(sysent->model, str);
+}
+
+static void _oval_sysent_release_string(struct oval_sysent *sysent, const char *str)
+{
+	if (sysent->model == NULL)
+		free((char *) str);
+}
+
 struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
 {
 	oval_sysent_t *sysent = (oval_sysent_t *) malloc(sizeof(oval_sysent_t));
@@ -66,7 +86,7 @@ struct oval_sysent *oval_sysent_new(struct oval_syschar_model *model)
 	sysent->record_fields = NULL;
 	sysent->status = SYSCHAR_STATUS_UNKNOWN;
 	sysent->datatype = OVAL_DATATYPE_UNKNOWN;
-	sysent->mask = 0;
+	sysent->mask = false;
 	sysent->model = model;
 	return sysent;
 }
@@ -75,14 +95,14 @@ struct oval_sysent *oval_sysent_clone(struct oval_syschar_model *new_model, stru
 {
 	struct oval_sysent *new_item = oval_sysent_new(new_model);
 
-	char *old_value = oval_sysent_get_value(old_item);
+	const char *old_value = oval_sysent_get_value(old_item);
 	if (old_value) {
 		oval_sysent_set_value(new_item, old_value);
 	}
 
-	char *old_name = oval_sysent_get_name(old_item);
+	const char *old_name = oval_sysent_get_name(old_item);
 	if (old_name) {
-		oval_sysent_set_name(new_item, oscap_strdup(old_name));
+		new_item->name = _oval_sysent_store_string(new_item, old_name);
 	}
 
 	oval_sysent_set_datatype(new_item, oval_sysent_get_datatype(old_item));
@@ -97,10 +117,8 @@ void oval_sysent_free(struct oval_sysent *sysent)
 	if (sysent == NULL)
 		return;
 
-	if (sysent->name != NULL)
-		free(sysent->name);
-	if (sysent->value != NULL)
-		free(sysent->value);
+	_oval_sysent_release_string(sysent, sysent->name);
+	_oval_sysent_release_string(sysent, sysent->value);
 	if (sysent->record_fields)
 		oval_collection_free_items(sysent->record_fields, (oscap_destruct_func) oval_record_field_free);
 
@@ -127,7 +145,7 @@ void oval_sysent_iterator_free(struct oval_sysent_iterator *oc_sysent)
 	oval_collection_iterator_free((struct oval_iterator *)oc_sysent);
 }
 
-char *oval_sysent_get_name(struct oval_sysent *sysent)
+const char *oval_sysent_get_name(struct oval_sysent *sysent)
 {
 	__attribute__nonnull__(sysent);
 
@@ -141,7 +159,7 @@ oval_syschar_status_t oval_sysent_get_status(struct oval_sysent * sysent)
 	return sysent->status;
 }
 
-char *oval_sysent_get_value(struct oval_sysent *sysent)
+const char *oval_sysent_get_value(struct oval_sysent *sysent)
 {
 	__attribute__nonnull__(sysent);
 
@@ -174,9 +192,13 @@ int oval_sysent_get_mask(struct oval_sysent *sysent)
 void oval_sysent_set_name(struct oval_sysent *sysent, char *name)
 {
 	__attribute__nonnull__(sysent);
-	if (sysent->name != NULL)
-		free(sysent->name);
-	sysent->name = name;
+	_oval_sysent_release_string(sysent, sysent->name);
+	if (sysent->model == NULL) {
+		sysent->name = name;
+	} else {
+		sysent->name = oval_syschar_model_intern_string(sysent->model, name);
+		free(name);
+	}
 }
 
 void oval_sysent_set_status(struct oval_sysent *sysent, oval_syschar_status_t status)
@@ -194,15 +216,14 @@ void oval_sysent_set_datatype(struct oval_sysent *sysent, oval_datatype_t dataty
 void oval_sysent_set_mask(struct oval_sysent *sysent, int mask)
 {
 	__attribute__nonnull__(sysent);
-	sysent->mask = mask;
+	sysent->mask = mask != 0;
 }
 
-void oval_sysent_set_value(struct oval_sysent *sysent, char *value)
+void oval_sysent_set_value(struct oval_sysent *sysent, const char *value)
 {
 	__attribute__nonnull__(sysent);
-	if (sysent->value != NULL)
-		free(sysent->value);
-	sysent->value = oscap_strdup(value);
+	_oval_sysent_release_string(sysent, sysent->value);
+	sysent->value = _oval_sysent_store_string(sysent, value);
 }
 
 void oval_sysent_add_record_field(struct oval_sysent *sysent, struct oval_record_field *rf)
@@ -280,8 +301,8 @@ void oval_sysent_to_dom(struct oval_sysent *sysent, xmlDoc * doc, xmlNode * pare
 	xmlNodePtr root_node = xmlDocGetRootElement(doc);
 	xmlNode *sysent_tag = NULL;
 
-	char *tagname = oval_sysent_get_name(sysent);
-	char *content = oval_sysent_get_value(sysent);
+	const char *tagname = oval_sysent_get_name(sysent);
+	const char *content = oval_sysent_get_value(sysent);
 	bool mask = oval_sysent_get_mask(sysent);
 
 	/* omit the value in oval_results if mask=true */
@@ -39,6 +39,7 @@
 #include "oval_agent_api_impl.h"
 #include "oval_parser_impl.h"
 #include "adt/oval_string_map_impl.h"
+#include "adt/oval_string_pool_impl.h"
 #include "adt/oval_smc_impl.h"
 #include "adt/oval_smc_iterator_impl.h"
 #include "oval_system_characteristics_impl.h"
@@ -57,6 +58,7 @@ typedef struct oval_syschar_model {
 	struct oval_definition_model *definition_model;
 	struct oval_smc *syschar_map;				///< Represents objects within <collected_objects> element
 	struct oval_string_map *sysitem_map;			///< Represents items within <system_data> element
+	struct oval_string_pool *sysent_strings;		///< Names and values of the item entities
         char *schema;
 } oval_syschar_model_t;						///< Represents <oval_system_characteristics> element
 
@@ -78,10 +80,11 @@ struct oval_syschar_model *oval_syschar_model_new(struct oval_definition_model *
 	newmodel->definition_model = definition_model;
 	newmodel->syschar_map = oval_smc_new();
 	newmodel->sysitem_map = oval_string_map_new();
+	newmodel->sysent_strings = oval_string_pool_new();
         newmodel->schema = oscap_strdup(OVAL_SYS_SCHEMA_LOCATION);
 
 	/* check possible allocation problems */
-	if ((newmodel->syschar_map == NULL) || (newmodel->sysitem_map == NULL) ) {
+	if ((newmodel->syschar_map == NULL) || (newmodel->sysitem_map == NULL) || (newmodel->sysent_strings == NULL)) {
 		oval_syschar_model_free(newmodel);
 		return NULL;
 	}
@@ -141,6 +144,7 @@ void oval_syschar_model_free(struct oval_syschar_model *model)
 		oval_smc_free(model->syschar_map, (oscap_destruct_func) oval_syschar_free);
 		if (model->sysitem_map)
 			oval_string_map_free(model->sysitem_map, (oscap_destruct_func) oval_sysitem_free);
+		oval_string_pool_free(model->sysent_strings);
 		free(model->schema);
 		oval_generator_free(model->generator);
 		free(model);
@@ -155,6 +159,16 @@ void oval_syschar_model_reset(struct oval_syschar_model *model)
                 oval_string_map_free(model->sysitem_map, (oscap_destruct_func) oval_sysitem_free);
         model->syschar_map = oval_smc_new();
         model->sysitem_map = oval_string_map_new();
+	/* No entity refers to the pooled strings any more */
+	oval_string_pool_free(model->sysent_strings);
+	model->sysent_strings = oval_string_pool_new();
+}
+
+const char *oval_syschar_model_intern_string(struct oval_syschar_model *model, const char *str)
+{
+	__attribute__nonnull__(model);
+
+	return oval_string_pool_intern(model->sysent_strings, str);
 }
 
 struct oval_generator *oval_syschar_model_get_generator(struct oval_syschar_model *model)
@@ -54,6 +54,7 @@ typedef struct oval_syschar {
 	struct oval_collection *sysitem;		///< Represents <reference> elements
 	int variable_instance;				///< Represents variable_instance attribute
 	int variable_instance_hint;			///< Internal hint of the next possible variable_instance attribute
+	bool variable_instance_shared;			///< Internal hint that the next variable_instance can share the items
 } oval_syschar_t;					///< Represents a single collected <object> element
 
 oval_syschar_collection_flag_t oval_syschar_get_flag(struct oval_syschar
@@ -153,6 +154,7 @@ struct oval_syschar *oval_syschar_new(struct oval_syschar_model *model, struct o
 	syschar->flag = SYSCHAR_FLAG_UNKNOWN;
 	syschar->variable_instance = 1;
 	syschar->variable_instance_hint = 1;
+	syschar->variable_instance_shared = false;
 	syschar->object = object;
 	syschar->messages = oval_collection_new();
 	syschar->sysitem = oval_collection_new();
@@ -211,6 +213,38 @@ struct oval_syschar *oval_syschar_clone(struct oval_syschar_model *new_model, st
 	return new_syschar;
 }
 
+/**
+ * Add another instance of a collected object to its model. The new
+ * instance refers to the same items as the original one, it's meant for
+ * objects whose items don't depend on the variable values.
+ */
+struct oval_syschar *oval_syschar_new_instance(struct oval_syschar *syschar, int variable_instance)
+{
+	struct oval_definition_model *def_model = oval_syschar_model_get_definition_model(syschar->model);
+	struct oval_syschar *instance = oval_syschar_new(syschar->model, syschar->object);
+
+	oval_syschar_set_flag(instance, oval_syschar_get_flag(syschar));
+	oval_syschar_set_variable_instance(instance, variable_instance);
+	oval_syschar_set_variable_instance_hint(instance, variable_instance);
+
+	struct oval_message_iterator *messages = oval_syschar_get_messages(syschar);
+	while (oval_message_iterator_has_more(messages))
+		oval_syschar_add_message(instance, oval_message_clone(oval_message_iterator_next(messages)));
+	oval_message_iterator_free(messages);
+
+	struct oval_sysitem_iterator *sysitems = oval_syschar_get_sysitem(syschar);
+	while (oval_sysitem_iterator_has_more(sysitems))
+		oval_syschar_add_sysitem(instance, oval_sysitem_iterator_next(sysitems));
+	oval_sysitem_iterator_free(sysitems);
+
+	struct oval_variable_binding_iterator *bindings = oval_syschar_get_variable_bindings(syschar);
+	while (oval_variable_binding_iterator_has_more(bindings))
+		oval_syschar_add_variable_binding(instance, oval_variable_binding_clone(oval_variable_binding_iterator_next(bindings), def_model));
+	oval_variable_binding_iterator_free(bindings);
+
+	return instance;
+}
+
 void oval_syschar_free(struct oval_syschar *syschar)
 {
 	if (syschar == NULL)
@@ -396,6 +430,23 @@ void oval_syschar_set_variable_instance_hint(struct oval_syschar *syschar, int v
 {
 	__attribute__nonnull__(syschar);
 	syschar->variable_instance_hint = variable_instance_hint_in;
+	syschar->variable_instance_shared = false;
+}
+
+void oval_syschar_set_variable_instance_hint_shared(struct oval_syschar *syschar, int variable_instance_hint_in)
+{
+	__attribute__nonnull__(syschar);
+	/* Another variable might have required the object to be collected again */
+	if (syschar->variable_instance_hint == variable_instance_hint_in)
+		return;
+	syschar->variable_instance_hint = variable_instance_hint_in;
+	syschar->variable_instance_shared = true;
+}
+
+bool oval_syschar_get_variable_instance_shared(const struct oval_syschar *syschar)
+{
+	__attribute__nonnull__(syschar);
+	return syschar->variable_instance_shared;
 }
 
 const char *oval_syschar_get_id(const struct oval_syschar *syschar)
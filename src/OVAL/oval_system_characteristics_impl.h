@@ -68,6 +68,11 @@ void oval_sysent_to_print(struct oval_sysent *, char *, int);
 typedef bool oval_syschar_resolver(struct oval_syschar *, void *);
 xmlNode *oval_syschar_model_to_dom(struct oval_syschar_model *, xmlDocPtr, xmlNode *, oval_syschar_resolver, void *, bool);
 void oval_syschar_model_reset(struct oval_syschar_model *model);
+/**
+ * Intern a name or value of an item entity in the string pool of the model.
+ * @returns pooled string valid until the model is freed or reset
+ */
+const char *oval_syschar_model_intern_string(struct oval_syschar_model *model, const char *str);
 
 struct oval_syschar *oval_syschar_model_get_new_syschar(struct oval_syschar_model *, struct oval_object *);
 struct oval_sysitem *oval_syschar_model_get_new_sysitem(struct oval_syschar_model *, const char *id);
@@ -80,7 +85,16 @@ const char * oval_syschar_model_get_schema(struct oval_syschar_model * model);
 struct oval_syschar_iterator *oval_syschar_iterator_new(struct oval_smc *mapping);
 int oval_syschar_get_variable_instance_hint(const struct oval_syschar *syschar);
 void oval_syschar_set_variable_instance_hint(struct oval_syschar *syschar, int variable_instance_hint_in);
+/**
+ * Set the hint of the next variable instance for an object which doesn't
+ * depend on the changed variables. Unless the hint has already been set by
+ * oval_syschar_set_variable_instance_hint, the next instance will share the
+ * collected items, see oval_syschar_new_instance.
+ */
+void oval_syschar_set_variable_instance_hint_shared(struct oval_syschar *syschar, int variable_instance_hint_in);
+bool oval_syschar_get_variable_instance_shared(const struct oval_syschar *syschar);
 const char *oval_syschar_get_id(const struct oval_syschar *syschar);
+struct oval_syschar *oval_syschar_new_instance(struct oval_syschar *syschar, int variable_instance);
 
 OSCAP_HIDDEN_END;
 
@@ -116,7 +116,7 @@ long long oval_value_get_integer(struct oval_value *value)
 	return strtoll((const char *)value->text, &endptr, 10);
 }
 
-struct oval_value *oval_value_new(oval_datatype_t datatype, char *text_value)
+struct oval_value *oval_value_new(oval_datatype_t datatype, const char *text_value)
 {
 	oval_value_t *value = (oval_value_t *) malloc(sizeof(oval_value_t));
 	if (value == NULL)
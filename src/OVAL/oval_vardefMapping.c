@@ -25,6 +25,8 @@
 #endif
 
 #include "oval_definitions_impl.h"
+#include "collectVarRefs_impl.h"
+#include "adt/oval_string_map_impl.h"
 
 static void _oval_definition_fill_vardef(struct oval_definition *definition, struct oval_string_map *vardef);
 static void _oval_criteria_fill_vardef(struct oval_criteria_node *cnode, struct oval_string_map *vardef, const char *definition_id);
@@ -172,8 +174,17 @@ void _oval_entity_fill_vardef(struct oval_entity *entity, struct oval_string_map
 	if (oval_entity_get_varref_type(entity) == OVAL_ENTITY_VARREF_ATTRIBUTE ||
 		oval_entity_get_varref_type(entity) == OVAL_ENTITY_VARREF_ELEMENT) {
 		struct oval_variable *variable = oval_entity_get_variable(entity);
-		if (variable != NULL)
-			_vardef_insert(vardef, definition_id, oval_variable_get_id(variable));
+		if (variable == NULL)
+			return;
+		/* The definition depends also on all the variables the local
+		 * variable is computed from, including those of referenced objects */
+		struct oval_string_map *refs = oval_string_map_new();
+		oval_var_collect_var_refs(variable, refs);
+		struct oval_string_iterator *refs_it = (struct oval_string_iterator *) oval_string_map_keys(refs);
+		while (oval_string_iterator_has_more(refs_it))
+			_vardef_insert(vardef, definition_id, oval_string_iterator_next(refs_it));
+		oval_string_iterator_free(refs_it);
+		oval_string_map_free0(refs);
 	}
 }
 
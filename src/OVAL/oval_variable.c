@@ -895,11 +895,6 @@ void oval_variable_clear_values(struct oval_variable *variable)
 {
 	__attribute__nonnull__(variable);
 
-	if (variable->type != OVAL_VARIABLE_CONSTANT && variable->type != OVAL_VARIABLE_EXTERNAL) {
-		dW("Wrong variable type for this operation: %d.", variable->type);
-		return;
-        }
-
 	switch (variable->type) {
 	case OVAL_VARIABLE_CONSTANT: {
 		oval_variable_CONSTANT_t *cvar;
@@ -922,7 +917,21 @@ void oval_variable_clear_values(struct oval_variable *variable)
 
 		break;
 	}
+	case OVAL_VARIABLE_LOCAL: {
+		oval_variable_LOCAL_t *lvar;
+
+		/* The values get computed again when the variable is queried */
+		lvar = (oval_variable_LOCAL_t *) variable;
+		if (lvar->values) {
+			oval_collection_free_items(lvar->values, (oscap_destruct_func) oval_value_free);
+			lvar->values = NULL;
+		}
+		lvar->flag = SYSCHAR_FLAG_UNKNOWN;
+
+		break;
+	}
 	default:
+		dW("Wrong variable type for this operation: %d.", variable->type);
 		break;
 	}
 }
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <common/assume.h>
+
+#include "generic/common.h"
+#include "public/sm_alloc.h"
+#include "public/strbuf.h"
+#include "_sexp-types.h"
+#include "_seap-types.h"
+#include "_sexp-output.h"
+#include "_seap-scheme.h"
+#include "sch_unix.h"
+#include "seap-descriptor.h"
+
+#define DATA(ptr) ((sch_unixdata_t *)(ptr))
+
+int sch_unix_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags)
+{
+        sch_unixdata_t    *data;
+        struct sockaddr_un addr;
+        size_t             plen;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (uri  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data == NULL, -1, errno = EALREADY;);
+
+        if (strncmp (uri, "//", 2) != 0) {
+                errno = EINVAL;
+                return (-1);
+        }
+
+        uri += 2;
+        plen = strlen (uri);
+
+        if (plen == 0 || plen >= sizeof addr.sun_path) {
+                errno = ENAMETOOLONG;
+                return (-1);
+        }
+
+        memset (&addr, 0, sizeof addr);
+        addr.sun_family = AF_UNIX;
+        memcpy (addr.sun_path, uri, plen + 1);
+
+        data = sm_talloc (sch_unixdata_t);
+        data->sfd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+        if (data->sfd < 0)
+                goto fail;
+
+        if (connect (data->sfd, (struct sockaddr *)&addr, sizeof addr) != 0) {
+                protect_errno {
+                        dI("Can't connect to %s: %u, %s.", uri, errno, strerror (errno));
+                        close (data->sfd);
+                }
+                goto fail;
+        }
+
+        data->path = strdup (uri);
+        desc->scheme_data = (void *)data;
+
+        return (0);
+fail:
+        protect_errno {
+                sm_free (data);
+        }
+        return (-1);
+}
+
+int sch_unix_openfd (SEAP_desc_t *desc, int fd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+int sch_unix_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags)
+{
+        errno = EOPNOTSUPP;
+        return (-1);
+}
+
+ssize_t sch_unix_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (buf  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data != NULL, -1, errno = EBADF;);
+
+        return read (DATA(desc->scheme_data)->sfd, buf, len);
+}
+
+ssize_t sch_unix_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags)
+{
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (buf  != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data != NULL, -1, errno = EBADF;);
+
+        return write (DATA(desc->scheme_data)->sfd, buf, len);
+}
+
+ssize_t sch_unix_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags)
+{
+        ssize_t   ret;
+        strbuf_t *sb;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_d (sexp != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data != NULL, -1, errno = EBADF;);
+
+        sb = strbuf_new (SEAP_STRBUF_MAX);
+
+        if (SEXP_sbprintf_t (sexp, sb) != 0)
+                ret = -1;
+        else
+                ret = strbuf_write (sb, DATA(desc->scheme_data)->sfd);
+
+        strbuf_free (sb);
+
+        return (ret);
+}
+
+int sch_unix_close (SEAP_desc_t *desc, uint32_t flags)
+{
+        sch_unixdata_t *data;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+
+        data = DATA(desc->scheme_data);
+
+        assume_r (data != NULL, -1, errno = EBADF;);
+
+        /*
+         * The probe host keeps running, closing the connection only ends
+         * this session.
+         */
+        close (data->sfd);
+        free (data->path);
+        sm_free (data);
+
+        desc->scheme_data = NULL;
+
+        return (0);
+}
+
+int sch_unix_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags)
+{
+        fd_set *wptr, *rptr;
+        fd_set  fset;
+        int fd;
+        struct timeval *tv_ptr, tv;
+
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data != NULL, -1, errno = EBADF;);
+
+        fd = DATA(desc->scheme_data)->sfd;
+
+        FD_ZERO(&fset);
+        FD_SET(fd, &fset);
+        tv_ptr = NULL;
+        wptr   = NULL;
+        rptr   = NULL;
+
+        switch (ev) {
+        case SEAP_IO_EVREAD:
+                rptr = &fset;
+                break;
+        case SEAP_IO_EVWRITE:
+                wptr = &fset;
+                break;
+        default:
+                abort ();
+        }
+
+        if (timeout > 0) {
+                tv.tv_sec  = (time_t)timeout;
+                tv.tv_usec = 0;
+                tv_ptr = &tv;
+        }
+
+        switch (select (fd + 1, rptr, wptr, NULL, tv_ptr)) {
+        case -1:
+                return (-1);
+        case  0:
+                errno = ETIMEDOUT;
+                return (-1);
+        default:
+                return (FD_ISSET(fd, &fset) ? 0 : -1);
+        }
+}
+
+int sch_unix_abort (SEAP_desc_t *desc)
+{
+        assume_d (desc != NULL, -1, errno = EFAULT;);
+        assume_r (desc->scheme_data != NULL, -1, errno = EBADF;);
+
+        /*
+         * There is no process to signal. Shutting down the connection makes
+         * the pending receive fail and the probe host drops the session.
+         */
+        return shutdown (DATA(desc->scheme_data)->sfd, SHUT_RDWR);
+}
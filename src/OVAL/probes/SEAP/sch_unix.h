@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef SCH_UNIX_H
+#define SCH_UNIX_H
+
+#include <sys/types.h>
+#include "../../../common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * The unix scheme connects to a probe which is already running and
+ * listening on a UNIX domain socket (see `probe_X --listen PATH').
+ * URI format: unix://<path to the socket>
+ */
+typedef struct {
+        int   sfd;
+        char *path;
+} sch_unixdata_t;
+
+int sch_unix_connect (SEAP_desc_t *desc, const char *uri, uint32_t flags);
+int sch_unix_openfd (SEAP_desc_t *desc, int fd, uint32_t flags);
+int sch_unix_openfd2 (SEAP_desc_t *desc, int ifd, int ofd, uint32_t flags);
+ssize_t sch_unix_recv (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_unix_send (SEAP_desc_t *desc, void *buf, size_t len, uint32_t flags);
+ssize_t sch_unix_sendsexp (SEAP_desc_t *desc, SEXP_t *sexp, uint32_t flags);
+int sch_unix_close (SEAP_desc_t *desc, uint32_t flags);
+int sch_unix_select (SEAP_desc_t *desc, int ev, uint16_t timeout, uint32_t flags);
+int sch_unix_abort (SEAP_desc_t *desc);
+
+OSCAP_HIDDEN_END;
+
+#endif /* SCH_UNIX_H */
@@ -51,7 +51,12 @@ const SEAP_schemefn_t __schtbl[] = {
           sch_pipe_connect, sch_pipe_openfd,
           sch_pipe_openfd2, sch_pipe_recv,
           sch_pipe_send, sch_pipe_close,
-          sch_pipe_sendsexp, sch_pipe_select }
+          sch_pipe_sendsexp, sch_pipe_select },
+        { "unix",    /* This scheme is used from libopenscap to talk to a probe host */
+          sch_unix_connect, sch_unix_openfd,
+          sch_unix_openfd2, sch_unix_recv,
+          sch_unix_send, sch_unix_close,
+          sch_unix_sendsexp, sch_unix_select }
 };
 
 #define SCHTBLSIZE ((sizeof __schtbl)/sizeof (SEAP_schemefn_t))
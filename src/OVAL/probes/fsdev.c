@@ -40,6 +40,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <pthread.h>
 
 #if defined(__linux__)
 # include <mntent.h>
@@ -115,7 +116,14 @@ static int match_fs(const char *fsname, const char **fs_arr, size_t fs_cnt)
 #if defined(__linux__) || defined(_AIX)
 
 #define DEVID_ARRAY_SIZE 16
-#define DEVID_ARRAY_ADD  8
+
+#ifndef MTAB_PATH
+# define MTAB_PATH "/proc/mounts"
+#endif
+
+#ifndef MTAB_LINE_MAX
+# define MTAB_LINE_MAX 4096
+#endif
 
 #if defined(__linux__)
 static int
@@ -185,56 +193,167 @@ is_local_fs(struct mntent *ment)
 
 #endif /* _AIX */
 
-static fsdev_t *__fsdev_init(fsdev_t * lfs, const char **fs, size_t fs_cnt)
+/*
+ * The mount table is read and the mount points are stat'ed only once and
+ * the snapshot is shared by every object collected by the probe. On hosts
+ * with thousands of (bind) mounts, re-reading the table for every file
+ * object was the main cost. The snapshot is dropped by fsdev_mounts_reset()
+ * when the probe is reset, so that the next collection sees mounts made
+ * meanwhile. Users hold a reference, so a dropped snapshot lives on until
+ * the last of them releases it.
+ */
+static fsdev_mounts_t *g_mounts = NULL;
+static int g_mounts_loaded = 0;
+static pthread_mutex_t g_mounts_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static FILE *fsdev_mounts_open(void)
 {
-	int e;
+#if defined(__linux__)
 	FILE *fp;
-	size_t i;
 
+	/* The kernel's view of the mount table is the most accurate */
+	if ((fp = setmntent(MTAB_PATH, "r")) != NULL)
+		return (fp);
+#endif
+	return setmntent(_PATH_MOUNTED, "r");
+}
+
+static fsdev_mounts_t *fsdev_mounts_load(void)
+{
+	FILE *fp;
+	size_t size;
+	fsdev_mounts_t *mounts;
+#if defined(__linux__)
+	char buffer[MTAB_LINE_MAX];
+	struct mntent ment_buf;
+#endif
 	struct mntent *ment;
 	struct stat st;
 
-	fp = setmntent(_PATH_MOUNTED, "r");
-	if (fp == NULL) {
-		e = errno;
-		free(lfs);
-		errno = e;
+	fp = fsdev_mounts_open();
+	if (fp == NULL)
 		return (NULL);
+
+	size = DEVID_ARRAY_SIZE;
+	mounts = malloc(sizeof(fsdev_mounts_t));
+	mounts->mnts = malloc(sizeof(fsdev_mnt_t) * size);
+	mounts->cnt = 0;
+	mounts->refcnt = 1;
+
+#if defined(__linux__)
+	while ((ment = getmntent_r(fp, &ment_buf, buffer, sizeof buffer)) != NULL) {
+#else
+	while ((ment = getmntent(fp)) != NULL) {
+#endif
+		fsdev_mnt_t *mnt;
+
+		if (mounts->cnt >= size) {
+			size *= 2;
+			mounts->mnts = realloc(mounts->mnts, sizeof(fsdev_mnt_t) * size);
+		}
+
+		mnt = &mounts->mnts[mounts->cnt++];
+		mnt->fsname = strdup(ment->mnt_fsname);
+		mnt->dir = strdup(ment->mnt_dir);
+		mnt->type = strdup(ment->mnt_type);
+		mnt->opts = strdup(ment->mnt_opts);
+		mnt->local = is_local_fs(ment);
+
+		if (stat(ment->mnt_dir, &st) == 0) {
+			mnt->dev = st.st_dev;
+			mnt->has_dev = 1;
+		} else {
+			memset(&mnt->dev, 0, sizeof(dev_t));
+			mnt->has_dev = 0;
+		}
 	}
 
-	lfs->ids = malloc(sizeof(dev_t) * DEVID_ARRAY_SIZE);
+	endmntent(fp);
+	return (mounts);
+}
 
-	if (lfs->ids == NULL) {
-		e = errno;
+/* Drop a reference, g_mounts_lock has to be held */
+static void fsdev_mounts_unref_locked(fsdev_mounts_t *mounts)
+{
+	size_t i;
+
+	if (mounts == NULL || --mounts->refcnt > 0)
+		return;
+
+	for (i = 0; i < mounts->cnt; ++i) {
+		free(mounts->mnts[i].fsname);
+		free(mounts->mnts[i].dir);
+		free(mounts->mnts[i].type);
+		free(mounts->mnts[i].opts);
+	}
+	free(mounts->mnts);
+	free(mounts);
+}
+
+fsdev_mounts_t *fsdev_mounts(void)
+{
+	fsdev_mounts_t *mounts;
+
+	pthread_mutex_lock(&g_mounts_lock);
+	if (!g_mounts_loaded) {
+		g_mounts = fsdev_mounts_load();
+		g_mounts_loaded = 1;
+	}
+	mounts = g_mounts;
+	if (mounts != NULL)
+		mounts->refcnt++;
+	pthread_mutex_unlock(&g_mounts_lock);
+
+	return (mounts);
+}
+
+void fsdev_mounts_free(fsdev_mounts_t *mounts)
+{
+	pthread_mutex_lock(&g_mounts_lock);
+	fsdev_mounts_unref_locked(mounts);
+	pthread_mutex_unlock(&g_mounts_lock);
+}
+
+void fsdev_mounts_reset(void)
+{
+	pthread_mutex_lock(&g_mounts_lock);
+	fsdev_mounts_unref_locked(g_mounts);
+	g_mounts = NULL;
+	g_mounts_loaded = 0;
+	pthread_mutex_unlock(&g_mounts_lock);
+}
+
+static fsdev_t *__fsdev_init(fsdev_t * lfs, const char **fs, size_t fs_cnt)
+{
+	size_t i, m;
+	fsdev_mounts_t *mounts;
+
+	mounts = fsdev_mounts();
+	if (mounts == NULL) {
 		free(lfs);
-		endmntent(fp);
-		errno = e;
+		errno = ENOENT;
 		return (NULL);
 	}
 
-	lfs->cnt = DEVID_ARRAY_SIZE;
+	lfs->ids = malloc(sizeof(dev_t) * (mounts->cnt > 0 ? mounts->cnt : 1));
 	i = 0;
 
-	while ((ment = getmntent(fp)) != NULL) {
+	for (m = 0; m < mounts->cnt; ++m) {
+		const fsdev_mnt_t *mnt = &mounts->mnts[m];
+
 		if (fs == NULL) {
-			if (!is_local_fs(ment))
+			if (!mnt->local)
 				continue;
-		} else if (!match_fs(ment->mnt_type, fs, fs_cnt)) {
+		} else if (!match_fs(mnt->type, fs, fs_cnt)) {
 				continue;
 		}
-		if (stat(ment->mnt_dir, &st) != 0)
+		if (!mnt->has_dev)
 			continue;
-		if (i >= lfs->cnt) {
-			lfs->cnt += DEVID_ARRAY_ADD;
-			lfs->ids = realloc(lfs->ids, sizeof(dev_t) * lfs->cnt);
-		}
-		memcpy(&(lfs->ids[i++]), &st.st_dev, sizeof(dev_t));
+		memcpy(&(lfs->ids[i++]), &mnt->dev, sizeof(dev_t));
 	}
 
-	endmntent(fp);
-
-	lfs->ids = realloc(lfs->ids, sizeof(dev_t) * i);
-	lfs->cnt = (lfs->ids == NULL ? 0 : i);
+	lfs->cnt = i;
+	fsdev_mounts_free(mounts);
 
 	return (lfs);
 }
@@ -424,7 +543,7 @@ void fsdev_free(fsdev_t * lfs)
 
 int fsdev_search(fsdev_t * lfs, void *id)
 {
-	uint16_t w, s;
+	size_t w, s;
 	int cmp;
 
 	if (!lfs)
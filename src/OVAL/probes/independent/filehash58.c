@@ -103,7 +103,15 @@ static int mem2hex (uint8_t *mem, size_t mlen, char *str, size_t slen)
 	return (0);
 }
 
-static int filehash58_cb(const char *prefix, const char *p, const char *f, const char *h, probe_ctx *ctx)
+/*
+ * Entities known before the file is hashed. When the object filters refer
+ * only to these, files whose items would be filtered out are not hashed.
+ */
+static const char * const prefilter_ents[] = {
+	"filepath", "path", "filename", "hash_type", NULL
+};
+
+static int filehash58_cb(const char *prefix, const char *p, const char *f, const char *h, probe_ctx *ctx, bool prefilter)
 {
 	SEXP_t *itm;
 
@@ -134,6 +142,22 @@ static int filehash58_cb(const char *prefix, const char *p, const char *f, const
 	memcpy (pbuf + plen, f, sizeof (char) * flen);
 	pbuf[plen+flen] = '\0';
 
+	if (prefilter) {
+		bool filtered;
+
+		itm = probe_item_create(OVAL_INDEPENDENT_FILE_HASH58, NULL,
+					"filepath", OVAL_DATATYPE_STRING, pbuf,
+					"path",     OVAL_DATATYPE_STRING, p,
+					"filename", OVAL_DATATYPE_STRING, f,
+					"hash_type",OVAL_DATATYPE_STRING, h,
+					NULL);
+		filtered = probe_item_prefiltered(ctx, itm);
+		SEXP_free(itm);
+
+		if (filtered)
+			return (0);
+	}
+
 	/*
 	 * Open the file
 	 */
@@ -247,6 +271,7 @@ int probe_main(probe_ctx *ctx, void *mutex)
 	SEXP_t *probe_in;
 	SEXP_t *path, *filename, *behaviors, *filepath, *hash_type;
 	char hash_type_str[128];
+	bool prefilter;
 	int err = 0;
 
 	OVAL_FTS    *ofts;
@@ -290,6 +315,8 @@ int probe_main(probe_ctx *ctx, void *mutex)
 		goto cleanup;
 	}
 
+	prefilter = probe_ctx_filters_pushdown(ctx, prefilter_ents, NULL);
+
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 	if ((ofts = oval_fts_open_prefixed(prefix, path, filename, filepath, behaviors, probe_ctx_getresult(ctx))) != NULL) {
 		while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
@@ -298,7 +325,7 @@ int probe_main(probe_ctx *ctx, void *mutex)
 			while (p->value != CRAPI_INVALID) {
 				SEXP_t *crapi_hash_type_sexp = SEXP_string_new(p->string, strlen(p->string));
 				if (probe_entobj_cmp(hash_type, crapi_hash_type_sexp) == OVAL_RESULT_TRUE) {
-					filehash58_cb(prefix, ofts_ent->path, ofts_ent->file, p->string, ctx);
+					filehash58_cb(prefix, ofts_ent->path, ofts_ent->file, p->string, ctx, prefilter);
 				}
 
 				SEXP_free(crapi_hash_type_sexp);
@@ -163,6 +163,20 @@ static int get_substrings(char *str, int *ofs, regex_t *re, int want_substrs, ch
 }
 #endif
 
+static SEXP_t *create_filepath(const char *path, const char *filename)
+{
+	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.6)) < 0)
+		return NULL;
+
+	const size_t path_len = strlen(path);
+	/* Avoid 2 slashes */
+	if (path_len >= 1 && path[path_len - 1] == FILE_SEPARATOR) {
+		return SEXP_string_newf("%s%s", path, filename);
+	} else {
+		return SEXP_string_newf("%s%c%s", path, FILE_SEPARATOR, filename);
+	}
+}
+
 static SEXP_t *create_item(const char *path, const char *filename, char *pattern,
 			   int instance, char **substrs, int substr_cnt)
 {
@@ -184,17 +198,7 @@ static SEXP_t *create_item(const char *path, const char *filename, char *pattern
 		text = substrs[0];
 		se_instance = SEXP_number_newu_64((int64_t) instance);
 	}
-	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.6)) < 0) {
-		se_filepath = NULL;
-	} else {
-		const size_t path_len = strlen(path);
-		/* Avoid 2 slashes */
-		if (path_len >= 1 && path[path_len - 1] == FILE_SEPARATOR) {
-			se_filepath = SEXP_string_newf("%s%s", path, filename);
-		} else {
-			se_filepath = SEXP_string_newf("%s%c%s", path, FILE_SEPARATOR, filename);
-		}
-	}
+	se_filepath = create_filepath(path, filename);
 
         item = probe_item_create(OVAL_INDEPENDENT_TEXT_FILE_CONTENT, NULL,
                                  "filepath", OVAL_DATATYPE_SEXP, se_filepath,
@@ -214,11 +218,20 @@ static SEXP_t *create_item(const char *path, const char *filename, char *pattern
 	return item;
 }
 
+/*
+ * Entities known before the file is read. When the object filters refer only
+ * to these, files whose items would all be filtered out are not read at all.
+ */
+static const char * const prefilter_ents[] = {
+	"filepath", "path", "filename", "pattern", "line", NULL
+};
+
 struct pfdata {
 	char *pattern;
 	int re_opts;
 	SEXP_t *instance_ent;
         probe_ctx *ctx;
+	bool prefilter;
 #if defined USE_REGEX_PCRE
 	pcre *compiled_regex;
 #elif defined USE_REGEX_POSIX
@@ -226,6 +239,32 @@ struct pfdata {
 #endif
 };
 
+static bool file_prefiltered(struct pfdata *pfd, const char *path, const char *filename)
+{
+	SEXP_t *item, *se_filepath;
+	char *pattern;
+	bool filtered;
+
+	if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.4)) < 0)
+		pattern = NULL;
+	else
+		pattern = pfd->pattern;
+	se_filepath = create_filepath(path, filename);
+
+	item = probe_item_create(OVAL_INDEPENDENT_TEXT_FILE_CONTENT, NULL,
+				 "filepath", OVAL_DATATYPE_SEXP, se_filepath,
+				 "path",     OVAL_DATATYPE_STRING, path,
+				 "filename", OVAL_DATATYPE_STRING, filename,
+				 "pattern",  OVAL_DATATYPE_STRING, pattern,
+				 "line",     OVAL_DATATYPE_STRING, pattern,
+				 NULL);
+	filtered = probe_item_prefiltered(pfd->ctx, item);
+	SEXP_free(item);
+	SEXP_free(se_filepath);
+
+	return filtered;
+}
+
 static int process_file(const char *prefix, const char *path, const char *file, void *arg)
 {
 	struct pfdata *pfd = (struct pfdata *) arg;
@@ -265,6 +304,8 @@ static int process_file(const char *prefix, const char *path, const char *file,
 		goto cleanup;
 	if (!S_ISREG(st.st_mode))
 		goto cleanup;
+	if (pfd->prefilter && file_prefiltered(pfd, path, file))
+		goto cleanup;
 
 	fd = open(whole_path_with_prefix, O_RDONLY);
 	if (fd == -1) {
@@ -450,6 +491,8 @@ int probe_main(probe_ctx *ctx, void *arg)
 
 	pfd.instance_ent = inst_ent;
         pfd.ctx          = ctx;
+
+	pfd.prefilter = probe_ctx_filters_pushdown(ctx, prefilter_ents, NULL);
 #if defined USE_REGEX_PCRE
 	pfd.re_opts = PCRE_UTF8;
 	r0 = probe_ent_getattrval(bh_ent, "ignore_case");
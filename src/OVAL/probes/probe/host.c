@@ -0,0 +1,193 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <seap.h>
+
+#include "common/debug_priv.h"
+#include "host.h"
+#include "probe-api.h"
+#include "fsdev.h"
+
+extern probe_ncache_t *OSCAP_GSYM(ncache);
+
+int probe_host_listen(probe_t *probe, const char *path)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	size_t plen = strlen(path);
+	int fd;
+
+	if (plen == 0 || plen >= sizeof addr.sun_path) {
+		errno = ENAMETOOLONG;
+		return (-1);
+	}
+
+	memset(&addr, 0, sizeof addr);
+	addr.sun_family = AF_UNIX;
+	memcpy(addr.sun_path, path, plen + 1);
+
+	if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(path);
+
+	if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return (-1);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0 ||
+	    listen(fd, SOMAXCONN) != 0) {
+		int err = errno;
+
+		close(fd);
+		errno = err;
+		return (-1);
+	}
+
+	probe->listen_fd   = fd;
+	probe->listen_path = strdup(path);
+
+	dI("Probe host %s listening on %s.", probe->name, path);
+
+	return (0);
+}
+
+int probe_host_accept(probe_t *probe)
+{
+	int fd;
+
+	do {
+		fd = accept(probe->listen_fd, NULL, NULL);
+	} while (fd < 0 && (errno == EINTR || errno == ECONNABORTED));
+
+	if (fd < 0) {
+		dE("accept: %d, %s.", errno, strerror(errno));
+		return (-1);
+	}
+
+	/* The descriptor closes both of the fds */
+	probe->sd = SEAP_openfd2(probe->SEAP_ctx, fd, dup(fd), 0);
+
+	if (probe->sd < 0) {
+		dE("SEAP_openfd2: %d, %s.", errno, strerror(errno));
+		close(fd);
+		return (-1);
+	}
+
+	/*
+	 * The system may have changed since the previous session, don't let
+	 * this one see the state collected by it.
+	 */
+	if (probe->host_sessions++ > 0)
+		probe_state_reset(probe);
+
+	dD("New session, sd=%d.", probe->sd);
+
+	return (0);
+}
+
+static void probe_workers_unlock(void *arg)
+{
+	pthread_mutex_unlock(&((probe_t *)arg)->workers_lock);
+}
+
+void probe_workers_wait(probe_t *probe)
+{
+	pthread_mutex_lock(&probe->workers_lock);
+	pthread_cleanup_push(probe_workers_unlock, probe);
+	while (probe->workers_running > 0)
+		pthread_cond_wait(&probe->workers_done, &probe->workers_lock);
+	pthread_cleanup_pop(1);
+}
+
+void probe_host_close(probe_t *probe)
+{
+	/*
+	 * The workers reply on probe->sd, which must not be given to the
+	 * next session until they are done.
+	 */
+	probe_workers_wait(probe);
+
+	SEAP_close(probe->SEAP_ctx, probe->sd);
+	probe->sd = -1;
+
+	dD("Session closed.");
+}
+
+void probe_host_free(probe_t *probe)
+{
+	if (probe->listen_fd == -1)
+		return;
+
+	close(probe->listen_fd);
+	unlink(probe->listen_path);
+	free(probe->listen_path);
+
+	probe->listen_fd   = -1;
+	probe->listen_path = NULL;
+}
+
+void probe_state_reset(probe_t *probe)
+{
+	probe_rcache_free(probe->rcache);
+	probe_ncache_free(probe->ncache);
+	/* Items of the next collection get new IDs, as if the probe was restarted */
+	probe_icache_clear(probe->icache);
+
+	probe->rcache = probe_rcache_new();
+	probe->ncache = probe_ncache_new();
+
+	OSCAP_GSYM(ncache) = probe->ncache;
+
+	/*
+	 * Probes keep snapshots of the scanned system (mount table, account
+	 * database, sysctl values, ...), drop them so that the next collection
+	 * sees the current system. The rest of the probe_init() state is kept.
+	 */
+#if defined(__linux__) || defined(_AIX)
+	fsdev_mounts_reset();
+#endif
+	probe->probe_arg = probe_reset(probe->probe_arg);
+	dD("Probe reset, probe_arg=%p.", probe->probe_arg);
+}
+
+void probe_workers_inc(probe_t *probe)
+{
+	pthread_mutex_lock(&probe->workers_lock);
+	++probe->workers_running;
+	pthread_mutex_unlock(&probe->workers_lock);
+}
+
+void probe_workers_dec(probe_t *probe)
+{
+	pthread_mutex_lock(&probe->workers_lock);
+	if (--probe->workers_running == 0)
+		pthread_cond_broadcast(&probe->workers_done);
+	pthread_mutex_unlock(&probe->workers_lock);
+}
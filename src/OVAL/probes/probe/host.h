@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef PROBE_HOST_H
+#define PROBE_HOST_H
+
+#include "probe.h"
+
+/*
+ * Probe host mode. A probe started with `--listen PATH' doesn't talk to
+ * the library over its standard input and output. It listens on a UNIX
+ * domain socket instead and serves one library session after another.
+ * The caches of the probe and its snapshots of the scanned system are
+ * dropped between the sessions, see probe_reset().
+ */
+
+/**
+ * Create the listening socket of the probe host.
+ * A stale socket left at the path is replaced.
+ */
+int probe_host_listen(probe_t *probe, const char *path);
+
+/**
+ * Wait for the next session and set up probe->sd for it. The state of
+ * the probe is reset unless this is the first session.
+ */
+int probe_host_accept(probe_t *probe);
+
+/**
+ * Finish the current session: wait for the running workers and close
+ * probe->sd.
+ */
+void probe_host_close(probe_t *probe);
+
+/**
+ * Close and remove the listening socket.
+ */
+void probe_host_free(probe_t *probe);
+
+/**
+ * Reset the result, name and item caches of the probe and drop its
+ * snapshots of the scanned system by calling probe_reset().
+ * The workers must not be running.
+ */
+void probe_state_reset(probe_t *probe);
+
+void probe_workers_inc(probe_t *probe);
+void probe_workers_dec(probe_t *probe);
+
+/**
+ * Wait until all running workers are done.
+ */
+void probe_workers_wait(probe_t *probe);
+
+#endif /* PROBE_HOST_H */
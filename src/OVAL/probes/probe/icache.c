@@ -580,6 +580,24 @@ static void probe_icache_free_node(struct rbt_i64_node *n)
         return;
 }
 
+void probe_icache_clear(probe_icache_t *cache)
+{
+        if (pthread_mutex_lock(&cache->queue_mutex) != 0) {
+                dE("An error ocured while locking the queue mutex: %u, %s",
+                   errno, strerror(errno));
+                abort();
+        }
+
+        rbt_i64_free_cb(cache->tree, &probe_icache_free_node);
+        cache->tree = rbt_i64_new();
+
+        if (pthread_mutex_unlock(&cache->queue_mutex) != 0) {
+                dE("An error ocured while unlocking the queue mutex: %u, %s",
+                   errno, strerror(errno));
+                abort();
+        }
+}
+
 void probe_icache_free(probe_icache_t *cache)
 {
         void *ret = NULL;
@@ -63,4 +63,10 @@ int probe_icache_add(probe_icache_t *cache, SEXP_t *cobj, SEXP_t *item);
 int probe_icache_nop(probe_icache_t *cache);
 void probe_icache_free(probe_icache_t *cache);
 
+/**
+ * Drop all cached items. There must be no pending cache request,
+ * i.e. no worker may be running.
+ */
+void probe_icache_clear(probe_icache_t *cache);
+
 #endif /* ICACHE_H */
@@ -36,6 +36,7 @@
 #include "worker.h"
 #include "rcache.h"
 #include "input_handler.h"
+#include "host.h"
 
 /*
  * The input handler waits for incomming eval requests and either returns
@@ -43,50 +44,26 @@
  * worker thread which takes care of evaluating the request, caching the
  * result and sending it to the requestee.
  */
-void *probe_input_handler(void *arg)
-{
-        pthread_attr_t pth_attr;
-        probe_t       *probe = (probe_t *)arg;
+#define TH_CANCEL_ON  pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &cstate)
+#define TH_CANCEL_OFF pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cstate)
 
+/*
+ * Handle the requests of one session until the connection is closed.
+ */
+static void probe_input_loop(probe_t *probe, pthread_attr_t *pth_attr)
+{
         int probe_ret, cstate; /* XXX */
         SEAP_msg_t *seap_request, *seap_reply;
         SEXP_t *probe_in, *probe_out, *oid;
 
-#if defined(HAVE_PTHREAD_SETNAME_NP)
-	pthread_setname_np(pthread_self(), "input_handler");
-#endif
-
-#define TH_CANCEL_ON  pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &cstate)
-#define TH_CANCEL_OFF pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cstate)
-
-        TH_CANCEL_OFF;
-
-        if (pthread_attr_init(&pth_attr))
-                return (NULL);
-
-        if (pthread_attr_setdetachstate(&pth_attr, PTHREAD_CREATE_JOINABLE)) {
-                pthread_attr_destroy(&pth_attr);
-                return (NULL);
-        }
-
-        pthread_cleanup_push((void(*)(void *))pthread_attr_destroy, (void *)&pth_attr);
-        
-        switch (errno = pthread_barrier_wait(&OSCAP_GSYM(th_barrier)))
-        {
-        case 0:
-        case PTHREAD_BARRIER_SERIAL_THREAD:
-	        break;
-        default:
-	        dE("pthread_barrier_wait: %d, %s.",
-	           errno, strerror(errno));
-	        return (NULL);
-        }
-
 	while(1) {
                 TH_CANCEL_ON;
 
 		if (SEAP_recvmsg(probe->SEAP_ctx, probe->sd, &seap_request) == -1) {
-			dE("An error ocured while receiving SEAP message. errno=%u, %s.", errno, strerror(errno));
+			if (probe->listen_fd != -1 && errno == ECONNABORTED)
+				dD("The session has been closed.");
+			else
+				dE("An error ocured while receiving SEAP message. errno=%u, %s.", errno, strerror(errno));
 
                         /*
                          * TODO: check for abort request
@@ -179,9 +156,12 @@ void *probe_input_handler(void *arg)
 						} else {
 							/* OK */
 
-							if (pthread_create(&pair->pth->tid, &pth_attr, &probe_worker_runfn, pair))
+							probe_workers_inc(probe);
+
+							if (pthread_create(&pair->pth->tid, pth_attr, &probe_worker_runfn, pair))
 							{
 								dE("Cannot start a new worker thread: %d, %s.", errno, strerror(errno));
+								probe_workers_dec(probe);
 
 								if (rbt_i32_del(probe->workers, pair->pth->sid, NULL) != 0)
 									dE("rbt_i32_del: failed to remove worker thread (ID=%u)", pair->pth->sid);
@@ -249,6 +229,59 @@ void *probe_input_handler(void *arg)
 
 		SEAP_msg_free(seap_request);
 	} /* main loop */
+}
+
+void *probe_input_handler(void *arg)
+{
+        pthread_attr_t pth_attr;
+        probe_t       *probe = (probe_t *)arg;
+        int            cstate;
+
+#if defined(HAVE_PTHREAD_SETNAME_NP)
+	pthread_setname_np(pthread_self(), "input_handler");
+#endif
+
+        TH_CANCEL_OFF;
+
+        if (pthread_attr_init(&pth_attr))
+                return (NULL);
+
+        if (pthread_attr_setdetachstate(&pth_attr, PTHREAD_CREATE_JOINABLE)) {
+                pthread_attr_destroy(&pth_attr);
+                return (NULL);
+        }
+
+        pthread_cleanup_push((void(*)(void *))pthread_attr_destroy, (void *)&pth_attr);
+        
+        switch (errno = pthread_barrier_wait(&OSCAP_GSYM(th_barrier)))
+        {
+        case 0:
+        case PTHREAD_BARRIER_SERIAL_THREAD:
+	        break;
+        default:
+	        dE("pthread_barrier_wait: %d, %s.",
+	           errno, strerror(errno));
+	        return (NULL);
+        }
+
+        if (probe->listen_fd == -1) {
+                probe_input_loop(probe, &pth_attr);
+        } else {
+                /* probe host mode, serve one session after another */
+                for (;;) {
+                        int ret;
+
+                        TH_CANCEL_ON;
+                        ret = probe_host_accept(probe);
+                        TH_CANCEL_OFF;
+
+                        if (ret != 0)
+                                break;
+
+                        probe_input_loop(probe, &pth_attr);
+                        probe_host_close(probe);
+                }
+        }
 
         pthread_cleanup_pop(1);
         return (NULL);
@@ -41,6 +41,7 @@
 #include "worker.h"
 #include "signal_handler.h"
 #include "input_handler.h"
+#include "host.h"
 #include "probe-api.h"
 #include "option.h"
 #include <oscap_debug.h>
@@ -65,17 +66,16 @@ static int probe_optecmp(char **a, char **b)
 	return strcmp(*a, *b);
 }
 
-static SEXP_t *probe_reset(SEXP_t *arg0, void *arg1)
+static SEXP_t *probe_cmd_reset(SEXP_t *arg0, void *arg1)
 {
         probe_t *probe = (probe_t *)arg1;
         /*
-         * FIXME: implement main loop locking & worker waiting
+         * The workers use the caches and the probe state, let them
+         * finish first. No new worker is started while this command
+         * is being handled.
          */
-	probe_rcache_free(probe->rcache);
-        probe_ncache_free(probe->ncache);
-
-        probe->rcache = probe_rcache_new();
-        probe->ncache = probe_ncache_new();
+	probe_workers_wait(probe);
+	probe_state_reset(probe);
 
         return(NULL);
 }
@@ -141,6 +141,14 @@ int main(int argc, char *argv[])
 	sigset_t       sigmask;
 	probe_t        probe;
 	char *rootdir = NULL;
+	const char *listen_path = NULL;
+
+	if (argc == 3 && strcmp(argv[1], "--listen") == 0) {
+		listen_path = argv[2];
+	} else if (argc != 1) {
+		fprintf(stderr, "Usage: %s [--listen SOCKET]\n", basename(argv[0]));
+		return (EINVAL);
+	}
 
 	/* Turn on verbose mode */
 	char *verbosity_level = getenv("OSCAP_PROBE_VERBOSITY_LEVEL");
@@ -182,13 +190,25 @@ int main(int argc, char *argv[])
 	/*
 	 * Initialize SEAP stuff
 	 */
-	probe.SEAP_ctx = SEAP_CTX_new();
-	probe.sd       = SEAP_openfd2(probe.SEAP_ctx, STDIN_FILENO, STDOUT_FILENO, 0);
-
-	if (probe.sd < 0)
-		fail(errno, "SEAP_openfd2", __LINE__ - 3);
+	probe.SEAP_ctx    = SEAP_CTX_new();
+	probe.listen_fd   = -1;
+	probe.listen_path = NULL;
+	probe.host_sessions = 0;
+
+	if (listen_path != NULL) {
+		/* Probe host mode, sessions are accepted by the input handler */
+		if (probe_host_listen(&probe, listen_path) != 0)
+			fail(errno, "probe_host_listen", __LINE__ - 1);
+
+		probe.sd = -1;
+	} else {
+		probe.sd = SEAP_openfd2(probe.SEAP_ctx, STDIN_FILENO, STDOUT_FILENO, 0);
+
+		if (probe.sd < 0)
+			fail(errno, "SEAP_openfd2", __LINE__ - 3);
+	}
 
-	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RESET, 0, &probe_reset) != 0)
+	if (SEAP_cmd_register(probe.SEAP_ctx, PROBECMD_RESET, SEAP_CMDREG_USEARG, &probe_cmd_reset, &probe) != 0)
 		fail(errno, "SEAP_cmd_register", __LINE__ - 1);
 
 	/*
@@ -274,7 +294,11 @@ int main(int argc, char *argv[])
 	 * Create input handler (detached)
 	 */
         probe.workers   = rbt_i32_new();
+        probe.workers_running = 0;
+        pthread_mutex_init(&probe.workers_lock, NULL);
+        pthread_cond_init(&probe.workers_done, NULL);
         probe.probe_arg = probe_init();
+        dD("Probe initialized, probe_arg=%p.", probe.probe_arg);
 
 	pthread_attr_init(&th_attr);
 
@@ -318,10 +342,14 @@ int main(int argc, char *argv[])
         probe_icache_free(probe.icache);
 
         rbt_i32_free(probe.workers);
+        pthread_cond_destroy(&probe.workers_done);
+        pthread_mutex_destroy(&probe.workers_lock);
 
         if (probe.sd != -1)
                 SEAP_close(probe.SEAP_ctx, probe.sd);
 
+        probe_host_free(&probe);
+
 	SEAP_CTX_free(probe.SEAP_ctx);
         free(probe.option);
 
@@ -24,6 +24,8 @@
 #include <config.h>
 #endif
 
+#include <stdlib.h>
+#include <string.h>
 #include <sexp.h>
 #include "probe-api.h"
 #include "probe.h"
@@ -37,3 +39,43 @@ SEXP_t *probe_ctx_getresult(probe_ctx *ctx)
 {
         return (ctx->probe_out);
 }
+
+bool probe_ctx_filters_pushdown(probe_ctx *ctx, const char * const names[], bool needed[])
+{
+	SEXP_t *filter, *ste, *felm;
+	bool pushdown = true;
+	size_t i;
+
+	for (i = 0; needed != NULL && names[i] != NULL; ++i)
+		needed[i] = false;
+
+	if (ctx->filters == NULL || SEXP_list_length(ctx->filters) == 0)
+		return (false);
+
+	SEXP_list_foreach(filter, ctx->filters) {
+		ste = SEXP_list_nth(filter, 2);
+
+		SEXP_sublist_foreach(felm, ste, 2, SEXP_LIST_END) {
+			char *elm_name = probe_ent_getname(felm);
+
+			for (i = 0; names[i] != NULL; ++i) {
+				if (strcmp(names[i], elm_name) == 0)
+					break;
+			}
+			if (names[i] == NULL)
+				pushdown = false;
+			else if (needed != NULL)
+				needed[i] = true;
+
+			free(elm_name);
+		}
+		SEXP_free(ste);
+	}
+
+	return (pushdown);
+}
+
+bool probe_item_prefiltered(probe_ctx *ctx, const SEXP_t *item)
+{
+	return (ctx->filters != NULL && probe_item_filtered(item, ctx->filters));
+}
@@ -49,10 +49,17 @@ typedef struct {
 	SEAP_CTX_t *SEAP_ctx; /**< SEAP context */
 	int         sd;       /**< SEAP descriptor */
 
+	int         listen_fd;   /**< listening socket in the probe host mode, -1 otherwise */
+	char       *listen_path; /**< path of the listening socket */
+	unsigned int host_sessions; /**< number of sessions accepted in the probe host mode */
+
 	pthread_t th_input;
 	pthread_t th_signal;
 
         rbt_t    *workers;
+        pthread_mutex_t workers_lock;
+        pthread_cond_t  workers_done;    /**< signaled when no worker is running */
+        unsigned int    workers_running; /**< number of workers which haven't replied yet */
         uint32_t  max_threads;
         uint32_t  max_chdepth;
 
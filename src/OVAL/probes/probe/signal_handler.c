@@ -78,7 +78,8 @@ void *probe_signal_handler(void *arg)
         sigaddset(&siset, SIGPIPE);
 
 #if defined(__linux__)
-        if (prctl(PR_SET_PDEATHSIG, SIGTERM) != 0)
+        /* The probe host outlives the process which started it */
+        if (probe->listen_fd == -1 && prctl(PR_SET_PDEATHSIG, SIGTERM) != 0)
                 dW("prctl(PR_SET_PDEATHSIG, SIGTERM) failed");
 #endif
        
@@ -36,6 +36,7 @@
 #include "entcmp.h"
 
 #include "worker.h"
+#include "host.h"
 
 extern bool  OSCAP_GSYM(varref_handling);
 extern void *OSCAP_GSYM(probe_arg);
@@ -68,6 +69,7 @@ void *probe_worker_runfn(void *arg)
 
                 SEAP_msg_free(pair->pth->msg);
                 SEXP_free(probe_res);
+                probe_workers_dec(pair->probe);
                 free(pair);
 
                 return (NULL);
@@ -105,9 +107,10 @@ void *probe_worker_runfn(void *arg)
 			SEXP_free(probe_res);
 
 			/* FIXME */
-			exit(ret);
-		}
-		SEXP_free(probe_res);
+			if (pair->probe->listen_fd == -1)
+				exit(ret);
+		} else
+			SEXP_free(probe_res);
 	} else {
 		SEAP_msg_t *seap_reply;
 		/*
@@ -119,16 +122,22 @@ void *probe_worker_runfn(void *arg)
 		if (SEAP_reply(pair->probe->SEAP_ctx, pair->probe->sd, seap_reply, pair->pth->msg) == -1) {
 			int ret = errno;
 
-			SEAP_msg_free(seap_reply);
-			SEXP_free(probe_res);
+			/* The probe host just drops a reply to a session which went away */
+			if (pair->probe->listen_fd == -1) {
+				SEAP_msg_free(seap_reply);
+				SEXP_free(probe_res);
 
-			exit(ret);
+				exit(ret);
+			}
+			dW("Can't send the reply to the session: %d, %s.", ret, strerror(ret));
 		}
 
 		SEAP_msg_free(seap_reply);
                 SEXP_free(probe_res);
 	}
 
+	probe_workers_dec(pair->probe);
+
         SEAP_msg_free(pair->pth->msg);
         free(pair->pth);
 	free(pair);
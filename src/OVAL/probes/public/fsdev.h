@@ -41,9 +41,56 @@
  */
 typedef struct {
 	dev_t *ids;   /**< Sorted array of device ids   */
-	uint16_t cnt; /**< Number of items in the array */
+	size_t cnt;   /**< Number of items in the array */
 } fsdev_t;
 
+#if defined(__linux__) || defined(_AIX)
+/**
+ * Mount table entry.
+ */
+typedef struct {
+	char *fsname; /**< Mounted device or filesystem name */
+	char *dir;    /**< Mount point */
+	char *type;   /**< Filesystem type */
+	char *opts;   /**< Comma separated mount options */
+	dev_t dev;    /**< Device id of the mount point */
+	int has_dev;  /**< Whether the mount point could be stat'ed */
+	int local;    /**< Whether the filesystem is considered local */
+} fsdev_mnt_t;
+
+/**
+ * Mount table snapshot. A snapshot is shared by all its users and reference
+ * counted, it must not be modified.
+ */
+typedef struct {
+	fsdev_mnt_t *mnts;    /**< Mount table entries */
+	size_t cnt;           /**< Number of entries */
+	unsigned int refcnt;  /**< Number of references, see fsdev_mounts() */
+} fsdev_mounts_t;
+
+/**
+ * Get the mount table of the system.
+ * The table is read by the first call only, subsequent calls return a new
+ * reference to the same snapshot until fsdev_mounts_reset() is called.
+ * The reference has to be released by fsdev_mounts_free().
+ * @return mount table snapshot, NULL if the table can't be read
+ */
+fsdev_mounts_t *fsdev_mounts(void);
+
+/**
+ * Release a reference to the mount table snapshot, the snapshot is freed
+ * together with its last reference.
+ */
+void fsdev_mounts_free(fsdev_mounts_t *mounts);
+
+/**
+ * Drop the current mount table snapshot, the next fsdev_mounts() call reads
+ * the table again. Snapshots returned before stay valid until they are
+ * released, so the reset is safe while other threads use them.
+ */
+void fsdev_mounts_reset(void);
+#endif
+
 /**
  * Initialize the fsdev_t structure from an array of filesystem
  * names.
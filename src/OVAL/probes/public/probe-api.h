@@ -474,6 +474,18 @@ void probe_preload(void);
 void *probe_init(void) __attribute__ ((unused));
 void probe_fini(void *) __attribute__ ((unused));
 
+/**
+ * Drop the snapshots of the scanned system (account database, sysctl values,
+ * ...) kept in the state created by probe_init(), so that the next collection
+ * sees the current system. Everything else created by probe_init() is kept.
+ * Called when the probe is reset and between the sessions of a probe host,
+ * no worker is running at that time. Probes without such snapshots don't
+ * need to define it.
+ * @param arg the probe argument returned by probe_init() or the previous reset
+ * @return the probe argument to use from now on
+ */
+void *probe_reset(void *arg) __attribute__ ((unused));
+
 typedef struct probe_ctx probe_ctx;
 
 int probe_main(probe_ctx *, void *) __attribute__ ((nonnull(1)));
@@ -506,6 +518,30 @@ SEXP_t *probe_ctx_getobject(probe_ctx *ctx);
  */
 SEXP_t *probe_ctx_getresult(probe_ctx *ctx);
 
+/**
+ * Check whether the object filters can be evaluated before the items are
+ * built (filter pushdown). This is the case when the filter states refer
+ * only to entities which the probe is able to obtain cheaply, e.g. from
+ * the stat data of a file. The check is meant to be done once per object,
+ * i.e. in probe_main before the collection starts.
+ * @param ctx probe context
+ * @param names NULL terminated list of entity names the probe can provide
+ * @param needed array of the same length as names, an element is set to
+ *        true if the respective entity is referenced by some filter state;
+ *        NULL if the probe puts all of the entities into the partial item
+ * @return true if there are some filters and they can be pushed down
+ */
+bool probe_ctx_filters_pushdown(probe_ctx *ctx, const char * const names[], bool needed[]);
+
+/**
+ * Evaluate the object filters on a partially built item. The item needs to
+ * contain all entities marked as needed by probe_ctx_filters_pushdown. If
+ * the item would be filtered out, the probe doesn't have to build (and
+ * collect) the whole item at all. The caller keeps ownership of the item.
+ * @return true if the item would be filtered out
+ */
+bool probe_item_prefiltered(probe_ctx *ctx, const SEXP_t *item);
+
 typedef struct {
         oval_datatype_t type;
         void           *value;
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pwd.h>
+#ifdef HAVE_SHADOW_H
+#include <shadow.h>
+#endif
+#ifdef HAVE_LASTLOG_H
+#include <paths.h>
+#include <lastlog.h>
+#endif
+
+#include "SEAP/generic/rbt/rbt.h"
+#include "common/debug_priv.h"
+#include "account-db.h"
+
+/* Entries of a single name, in the order of the database */
+struct account_db_name {
+	const void **entries;
+	size_t count;
+};
+
+struct account_db {
+	struct account_db_passwd *passwd;
+	size_t passwd_count;
+	rbt_t *passwd_by_name;
+
+	struct account_db_shadow *shadow;
+	size_t shadow_count;
+	rbt_t *shadow_by_name;
+
+	int lastlog_fd;
+};
+
+static FILE *account_db_fopen(const char *root, const char *path)
+{
+	char *root_path = oscap_path_join(root, path);
+	FILE *fp = fopen(root_path, "r");
+
+	if (fp == NULL)
+		dI("Can't open %s: %s", root_path, strerror(errno));
+
+	free(root_path);
+	return fp;
+}
+
+static void account_db_index(rbt_t *index, const char *name, const void *entry)
+{
+	struct account_db_name *list = NULL;
+
+	if (rbt_str_get(index, name, (void **)&list) != 0) {
+		list = calloc(1, sizeof(struct account_db_name));
+		rbt_str_add(index, (char *)name, list);
+	}
+
+	list->entries = realloc(list->entries, (list->count + 1) * sizeof(void *));
+	list->entries[list->count++] = entry;
+}
+
+static void account_db_add_passwd(struct account_db *db, const struct passwd *pw, size_t *size)
+{
+	if (db->passwd_count == *size) {
+		*size = *size == 0 ? 64 : *size * 2;
+		db->passwd = realloc(db->passwd, *size * sizeof(struct account_db_passwd));
+	}
+
+	struct account_db_passwd *entry = &db->passwd[db->passwd_count++];
+
+	entry->name = oscap_strdup(pw->pw_name);
+	entry->passwd = oscap_strdup(pw->pw_passwd);
+	entry->uid = pw->pw_uid;
+	entry->gid = pw->pw_gid;
+	entry->gecos = oscap_strdup(pw->pw_gecos);
+	entry->dir = oscap_strdup(pw->pw_dir);
+	entry->shell = oscap_strdup(pw->pw_shell);
+}
+
+/*
+ * The local system is enumerated through NSS, the same way as the
+ * system tools see it. Files of an offline root are parsed directly.
+ */
+static void account_db_load_passwd(struct account_db *db, const char *root)
+{
+	struct passwd *pw;
+	size_t size = 0;
+
+	if (root == NULL) {
+		setpwent();
+		while ((pw = getpwent()) != NULL)
+			account_db_add_passwd(db, pw, &size);
+		endpwent();
+	} else {
+		FILE *fp = account_db_fopen(root, "/etc/passwd");
+
+		if (fp == NULL)
+			return;
+		while ((pw = fgetpwent(fp)) != NULL)
+			account_db_add_passwd(db, pw, &size);
+		fclose(fp);
+	}
+
+	/* The array doesn't move from now on */
+	for (size_t i = 0; i < db->passwd_count; ++i)
+		account_db_index(db->passwd_by_name, db->passwd[i].name, &db->passwd[i]);
+}
+
+#ifdef HAVE_SHADOW_H
+static void account_db_add_shadow(struct account_db *db, const struct spwd *sp, size_t *size)
+{
+	if (db->shadow_count == *size) {
+		*size = *size == 0 ? 64 : *size * 2;
+		db->shadow = realloc(db->shadow, *size * sizeof(struct account_db_shadow));
+	}
+
+	struct account_db_shadow *entry = &db->shadow[db->shadow_count++];
+
+	entry->name = oscap_strdup(sp->sp_namp);
+	entry->passwd = oscap_strdup(sp->sp_pwdp);
+	entry->lstchg = sp->sp_lstchg;
+	entry->min = sp->sp_min;
+	entry->max = sp->sp_max;
+	entry->warn = sp->sp_warn;
+	entry->inact = sp->sp_inact;
+	entry->expire = sp->sp_expire;
+	entry->flag = sp->sp_flag;
+}
+#endif
+
+static void account_db_load_shadow(struct account_db *db, const char *root)
+{
+#ifdef HAVE_SHADOW_H
+	struct spwd *sp;
+	size_t size = 0;
+
+	if (root == NULL) {
+		setspent();
+		while ((sp = getspent()) != NULL)
+			account_db_add_shadow(db, sp, &size);
+		endspent();
+	} else {
+		FILE *fp = account_db_fopen(root, "/etc/shadow");
+
+		if (fp == NULL)
+			return;
+		while ((sp = fgetspent(fp)) != NULL)
+			account_db_add_shadow(db, sp, &size);
+		fclose(fp);
+	}
+
+	for (size_t i = 0; i < db->shadow_count; ++i)
+		account_db_index(db->shadow_by_name, db->shadow[i].name, &db->shadow[i]);
+#endif
+}
+
+static void account_db_open_lastlog(struct account_db *db, const char *root)
+{
+#ifdef HAVE_LASTLOG_H
+	char *root_path = oscap_path_join(root, _PATH_LASTLOG);
+
+	db->lastlog_fd = open(root_path, O_RDONLY);
+	if (db->lastlog_fd == -1)
+		dI("Can't open %s: %s", root_path, strerror(errno));
+
+	free(root_path);
+#endif
+}
+
+struct account_db *account_db_new(const char *root, int flags)
+{
+	struct account_db *db = calloc(1, sizeof(struct account_db));
+
+	db->passwd_by_name = rbt_str_new();
+	db->shadow_by_name = rbt_str_new();
+	db->lastlog_fd = -1;
+
+	/* An empty root is the local system */
+	if (root != NULL && *root == '\0')
+		root = NULL;
+
+	if (flags & ACCOUNT_DB_PASSWD)
+		account_db_load_passwd(db, root);
+	if (flags & ACCOUNT_DB_SHADOW)
+		account_db_load_shadow(db, root);
+	if (flags & ACCOUNT_DB_LASTLOG)
+		account_db_open_lastlog(db, root);
+
+	dI("Account database: %zu passwd entries, %zu shadow entries.",
+	   db->passwd_count, db->shadow_count);
+
+	return db;
+}
+
+static void account_db_index_free_cb(struct rbt_str_node *node)
+{
+	struct account_db_name *list = node->data;
+
+	/* Keys are owned by the entries */
+	free(list->entries);
+	free(list);
+}
+
+void account_db_free(struct account_db *db)
+{
+	if (db == NULL)
+		return;
+
+	rbt_str_free_cb(db->passwd_by_name, account_db_index_free_cb);
+	rbt_str_free_cb(db->shadow_by_name, account_db_index_free_cb);
+
+	for (size_t i = 0; i < db->passwd_count; ++i) {
+		free(db->passwd[i].name);
+		free(db->passwd[i].passwd);
+		free(db->passwd[i].gecos);
+		free(db->passwd[i].dir);
+		free(db->passwd[i].shell);
+	}
+	free(db->passwd);
+
+	for (size_t i = 0; i < db->shadow_count; ++i) {
+		free(db->shadow[i].name);
+		free(db->shadow[i].passwd);
+	}
+	free(db->shadow);
+
+	if (db->lastlog_fd != -1)
+		close(db->lastlog_fd);
+
+	free(db);
+}
+
+const struct account_db_passwd *account_db_get_passwd(const struct account_db *db, size_t *count)
+{
+	*count = db->passwd_count;
+	return db->passwd;
+}
+
+const struct account_db_passwd **account_db_find_passwd(const struct account_db *db, const char *name, size_t *count)
+{
+	struct account_db_name *list = NULL;
+
+	if (rbt_str_get(db->passwd_by_name, name, (void **)&list) != 0) {
+		*count = 0;
+		return NULL;
+	}
+
+	*count = list->count;
+	return (const struct account_db_passwd **)list->entries;
+}
+
+const struct account_db_shadow *account_db_get_shadow(const struct account_db *db, size_t *count)
+{
+	*count = db->shadow_count;
+	return db->shadow;
+}
+
+const struct account_db_shadow **account_db_find_shadow(const struct account_db *db, const char *name, size_t *count)
+{
+	struct account_db_name *list = NULL;
+
+	if (rbt_str_get(db->shadow_by_name, name, (void **)&list) != 0) {
+		*count = 0;
+		return NULL;
+	}
+
+	*count = list->count;
+	return (const struct account_db_shadow **)list->entries;
+}
+
+int64_t account_db_last_login(const struct account_db *db, uid_t uid)
+{
+#ifdef HAVE_LASTLOG_H
+	struct lastlog ll;
+
+	if (db->lastlog_fd == -1)
+		return -1;
+
+	if (pread(db->lastlog_fd, &ll, sizeof(ll), (off_t)uid * sizeof(ll)) == sizeof(ll))
+		return (int64_t)ll.ll_time;
+#endif
+	return -1;
+}
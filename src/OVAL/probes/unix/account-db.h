@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef __ACCOUNT_DB__
+#define __ACCOUNT_DB__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/*
+ * Snapshot of the local account database of the scanned system.
+ *
+ * The accounts are read once when the snapshot is created and the
+ * entries are indexed by name. The local system is read through NSS
+ * (getpwent(), getspent()), an offline root given to account_db_new()
+ * is read from its account files. The snapshot is read-only once
+ * created and can be shared by all probe threads. It doesn't follow
+ * changes of the accounts, the probes create it in probe_init() and create it again in
+ * probe_reset() so that it's read again whenever the probe is reset.
+ */
+
+#define ACCOUNT_DB_PASSWD  0x01
+#define ACCOUNT_DB_SHADOW  0x02
+#define ACCOUNT_DB_LASTLOG 0x04
+
+struct account_db_passwd {
+	char *name;
+	char *passwd;
+	uid_t uid;
+	gid_t gid;
+	char *gecos;
+	char *dir;
+	char *shell;
+};
+
+struct account_db_shadow {
+	char *name;
+	char *passwd;
+	long lstchg;
+	long min;
+	long max;
+	long warn;
+	long inact;
+	long expire;
+	unsigned long flag;
+};
+
+struct account_db;
+
+/**
+ * Read the account databases selected by flags
+ * @param root root directory of the scanned system, NULL or empty for the local system
+ * @param flags bitwise or of ACCOUNT_DB_* values
+ * Files which cannot be read are treated as empty.
+ */
+struct account_db *account_db_new(const char *root, int flags);
+
+void account_db_free(struct account_db *db);
+
+/**
+ * Get all passwd entries in the order of the passwd file
+ * @param count is set to the number of entries
+ */
+const struct account_db_passwd *account_db_get_passwd(const struct account_db *db, size_t *count);
+
+/**
+ * Find passwd entries by user name
+ * @param count is set to the number of entries, a user may be listed more than once
+ * @return NULL if there is no such user
+ */
+const struct account_db_passwd **account_db_find_passwd(const struct account_db *db, const char *name, size_t *count);
+
+/**
+ * Get all shadow entries in the order of the shadow file
+ * @param count is set to the number of entries
+ */
+const struct account_db_shadow *account_db_get_shadow(const struct account_db *db, size_t *count);
+
+/**
+ * Find shadow entries by user name
+ * @param count is set to the number of entries, a user may be listed more than once
+ * @return NULL if there is no such user
+ */
+const struct account_db_shadow **account_db_find_shadow(const struct account_db *db, const char *name, size_t *count);
+
+/**
+ * Get time of the last login of the user from the lastlog file
+ * @return -1 if the time is not known
+ */
+int64_t account_db_last_login(const struct account_db *db, uid_t uid);
+
+OSCAP_HIDDEN_END;
+
+#endif
@@ -120,9 +120,31 @@ static SEXP_t *se_filetype (mode_t mode)
         return (NULL);
 }
 
+/*
+ * Entities known right after lstat(). Object filters referring only to these
+ * are evaluated before the item is built, see file_prefiltered().
+ */
+enum {
+	FILE_PF_FILEPATH, FILE_PF_PATH, FILE_PF_FILENAME, FILE_PF_TYPE,
+	FILE_PF_GROUP_ID, FILE_PF_USER_ID, FILE_PF_A_TIME, FILE_PF_C_TIME,
+	FILE_PF_M_TIME, FILE_PF_SIZE, FILE_PF_SUID, FILE_PF_SGID, FILE_PF_STICKY,
+	FILE_PF_UREAD, FILE_PF_UWRITE, FILE_PF_UEXEC, FILE_PF_GREAD, FILE_PF_GWRITE,
+	FILE_PF_GEXEC, FILE_PF_OREAD, FILE_PF_OWRITE, FILE_PF_OEXEC, FILE_PF_COUNT
+};
+
+static const char * const file_prefilter_ents[FILE_PF_COUNT + 1] = {
+	"filepath", "path", "filename", "type",
+	"group_id", "user_id", "a_time", "c_time",
+	"m_time", "size", "suid", "sgid", "sticky",
+	"uread", "uwrite", "uexec", "gread", "gwrite",
+	"gexec", "oread", "owrite", "oexec", NULL
+};
+
 struct cbargs {
         probe_ctx *ctx;
 	int     error;
+	bool    prefilter;                     /* filters can be evaluated on stat data */
+	bool    prefilter_needed[FILE_PF_COUNT]; /* entities referenced by the filters */
 };
 
 static rbt_t   *g_ID_cache     = NULL;
@@ -246,6 +268,7 @@ static SEXP_t *get_size(struct stat *st, SEXP_t *sexp)
 }
 
 #define MODEP(statp, bit) ((statp)->st_mode & (bit) ? gr_true : gr_false)
+#define PF_MODEP(need, statp, bit) ((need) ? MODEP(statp, bit) : NULL)
 
 static SEXP_t *has_extended_acl(const char *path)
 {
@@ -263,6 +286,72 @@ static SEXP_t *has_extended_acl(const char *path)
 #endif
 }
 
+/*
+ * Build an item consisting only of the entities referenced by the object
+ * filters and evaluate the filters on it. Items which are filtered out are
+ * never built as a whole (no ACL lookups, no item cache insertion).
+ */
+static bool file_prefiltered(struct cbargs *args, struct stat *st, const char *st_path, const char *p, const char *f)
+{
+	const bool *need = args->prefilter_needed;
+	SEXP_t *item, *se_filepath = NULL, *se_path = NULL, *se_usr_id = NULL, *se_grp_id = NULL;
+	SEXP_t  se_atime_mem, se_ctime_mem, se_mtime_mem, se_size_mem;
+	bool filtered;
+
+	if (need[FILE_PF_FILEPATH] && f != NULL
+	    && oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.6)) >= 0)
+		se_filepath = SEXP_string_newf("%s", st_path);
+	if (need[FILE_PF_PATH])
+		se_path = SEXP_string_new(p, strlen(p));
+	if (need[FILE_PF_USER_ID])
+		se_usr_id = ID_cache_get(st->st_uid);
+	if (need[FILE_PF_GROUP_ID])
+		se_grp_id = ID_cache_get(st->st_gid);
+
+	item = probe_item_create(OVAL_UNIX_FILE, NULL,
+	                         "filepath", OVAL_DATATYPE_SEXP, se_filepath,
+	                         "path",     OVAL_DATATYPE_SEXP, se_path,
+	                         "filename", OVAL_DATATYPE_STRING, need[FILE_PF_FILENAME] ? (f == NULL ? "" : f) : NULL,
+	                         "type",     OVAL_DATATYPE_SEXP, need[FILE_PF_TYPE] ? se_filetype(st->st_mode) : NULL,
+	                         "group_id", OVAL_DATATYPE_SEXP, se_grp_id,
+	                         "user_id",  OVAL_DATATYPE_SEXP, se_usr_id,
+	                         "a_time",   OVAL_DATATYPE_SEXP, need[FILE_PF_A_TIME] ? get_atime(st, &se_atime_mem) : NULL,
+	                         "c_time",   OVAL_DATATYPE_SEXP, need[FILE_PF_C_TIME] ? get_ctime(st, &se_ctime_mem) : NULL,
+	                         "m_time",   OVAL_DATATYPE_SEXP, need[FILE_PF_M_TIME] ? get_mtime(st, &se_mtime_mem) : NULL,
+	                         "size",     OVAL_DATATYPE_SEXP, need[FILE_PF_SIZE] ? get_size(st, &se_size_mem) : NULL,
+	                         "suid",     OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_SUID], st, S_ISUID),
+	                         "sgid",     OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_SGID], st, S_ISGID),
+	                         "sticky",   OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_STICKY], st, S_ISVTX),
+	                         "uread",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_UREAD], st, S_IRUSR),
+	                         "uwrite",   OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_UWRITE], st, S_IWUSR),
+	                         "uexec",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_UEXEC], st, S_IXUSR),
+	                         "gread",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_GREAD], st, S_IRGRP),
+	                         "gwrite",   OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_GWRITE], st, S_IWGRP),
+	                         "gexec",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_GEXEC], st, S_IXGRP),
+	                         "oread",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_OREAD], st, S_IROTH),
+	                         "owrite",   OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_OWRITE], st, S_IWOTH),
+	                         "oexec",    OVAL_DATATYPE_SEXP, PF_MODEP(need[FILE_PF_OEXEC], st, S_IXOTH),
+	                         NULL);
+
+	filtered = probe_item_prefiltered(args->ctx, item);
+
+	SEXP_free(item);
+	SEXP_free(se_filepath);
+	SEXP_free(se_path);
+	SEXP_free(se_usr_id);
+	SEXP_free(se_grp_id);
+	if (need[FILE_PF_A_TIME])
+		SEXP_free_r(&se_atime_mem);
+	if (need[FILE_PF_C_TIME])
+		SEXP_free_r(&se_ctime_mem);
+	if (need[FILE_PF_M_TIME])
+		SEXP_free_r(&se_mtime_mem);
+	if (need[FILE_PF_SIZE])
+		SEXP_free_r(&se_size_mem);
+
+	return filtered;
+}
+
 static int file_cb(const char *prefix, const char *p, const char *f, void *ptr)
 {
         char path_buffer[PATH_MAX];
@@ -294,6 +383,9 @@ static int file_cb(const char *prefix, const char *p, const char *f, void *ptr)
 		 */
 		free(st_path_with_prefix);
 		return 0;
+	} else if (args->prefilter && file_prefiltered(args, &st, st_path, p, f)) {
+		free(st_path_with_prefix);
+		return 0;
         } else {
                 SEXP_t *se_usr_id, *se_grp_id;
                 SEXP_t  se_atime_mem, se_ctime_mem, se_mtime_mem, se_size_mem;
@@ -439,6 +531,18 @@ void *probe_init (void)
         return (NULL);
 }
 
+void *probe_reset (void *arg)
+{
+	/*
+	 * Drop the cached user and group names, the account
+	 * database may have changed.
+	 */
+	ID_cache_free();
+	ID_cache_init(10000);
+
+	return (arg);
+}
+
 void probe_fini (void *arg)
 {
         _A((void *)arg == (void *)&__file_probe_mutex);
@@ -517,6 +621,7 @@ int probe_main (probe_ctx *ctx, void *mutex)
 
         cbargs.ctx     = ctx;
 	cbargs.error   = 0;
+	cbargs.prefilter = probe_ctx_filters_pushdown(ctx, file_prefilter_ents, cbargs.prefilter_needed);
 
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 
@@ -79,12 +79,38 @@
 
 SEXP_t gr_lastpath;
 
+/*
+ * Entities known before the value of an attribute is read. When the object
+ * filters refer only to these, values of filtered out attributes are not read.
+ */
+static const char * const prefilter_ents[] = {
+	"filepath", "path", "filename", "attribute_name", NULL
+};
+
 struct cbargs {
         probe_ctx *ctx;
 	int        error;
         SEXP_t    *attr_ent;
+	bool       prefilter;
 };
 
+static bool xattr_prefiltered(struct cbargs *args, const char *st_path, const char *f, SEXP_t *xattr_name)
+{
+	SEXP_t *item;
+	bool filtered;
+
+	item = probe_item_create(OVAL_UNIX_FILEEXTENDEDATTRIBUTE, NULL,
+				 "filepath", OVAL_DATATYPE_STRING, f == NULL ? NULL : st_path,
+				 "path",     OVAL_DATATYPE_SEXP,  &gr_lastpath,
+				 "filename", OVAL_DATATYPE_STRING, f == NULL ? "" : f,
+				 "attribute_name", OVAL_DATATYPE_SEXP, xattr_name,
+				 NULL);
+	filtered = probe_item_prefiltered(args->ctx, item);
+	SEXP_free(item);
+
+	return filtered;
+}
+
 static int file_cb(const char *prefix, const char *p, const char *f, void *ptr)
 {
         char path_buffer[PATH_MAX];
@@ -157,7 +183,8 @@ static int file_cb(const char *prefix, const char *p, const char *f, void *ptr)
         do {
                 SEXP_string_new_r(&xattr_name, xattr_buf + i, strlen(xattr_buf +i));
 
-                if (probe_entobj_cmp(args->attr_ent, &xattr_name) == OVAL_RESULT_TRUE) {
+                if (probe_entobj_cmp(args->attr_ent, &xattr_name) == OVAL_RESULT_TRUE
+                    && !(args->prefilter && xattr_prefiltered(args, st_path, f, &xattr_name))) {
                         ssize_t xattr_vallen = -1;
                         char   *xattr_val = NULL;
 
@@ -315,6 +342,8 @@ int probe_main (probe_ctx *ctx, void *mutex)
 	cbargs.error    = 0;
         cbargs.attr_ent = attribute_;
 
+	cbargs.prefilter = probe_ctx_filters_pushdown(ctx, prefilter_ents, NULL);
+
 	const char *prefix = getenv("OSCAP_PROBE_ROOT");
 
 	if ((ofts = oval_fts_open_prefixed(prefix, path, filename, filepath, behaviors, probe_ctx_getresult(ctx))) != NULL) {
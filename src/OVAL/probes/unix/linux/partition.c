@@ -32,12 +32,9 @@
 #endif
 
 #if defined(PROC_CHECK) && defined(__linux__)
-#define _XOPEN_SOURCE /* for fdopen */
 #include <sys/vfs.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <fcntl.h>
-#include <stdio.h>
 #include <linux/fs.h>
 
 #ifdef HAVE_PROC_MAGIC
@@ -57,12 +54,14 @@
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
+#include <pthread.h>
 #include <sys/statvfs.h>
 #include <probe-api.h>
 #include <probe/probe.h>
 #include <probe/option.h>
 #include <mntent.h>
 #include <pcre.h>
+#include <fsdev.h>
 
 #include "common/debug_priv.h"
 
@@ -70,10 +69,6 @@
 # define MTAB_PATH "/proc/mounts"
 #endif
 
-#ifndef MTAB_LINE_MAX
-# define MTAB_LINE_MAX 4096
-#endif
-
 const char *__OVAL_fs_types[][2] = {
 	{ "adfs",       "ADFS_SUPER_MAGIC" },
 	{ "affs",       "AFFS_SUPER_MAGIC" },
@@ -125,7 +120,7 @@ const char *__OVAL_fs_types[][2] = {
 	{ "sockfs",     "SOCKFS_MAGIC" }
 };
 
-static const char *correct_fstype(char *type)
+static const char *correct_fstype(const char *type)
 {
 	register size_t i;
 
@@ -144,38 +139,66 @@ static void add_mnt_opt(char ***mnt_opts, uint8_t mnt_ocnt, char *opt)
 	(*mnt_opts)[mnt_ocnt] = NULL;
 }
 
+/*
+ * Filesystem statistics and UUIDs of the mounts in the fsdev mount table
+ * snapshot, filled in lazily as objects match the mounts. The cache holds
+ * a reference to the snapshot, it is created by probe_init() and loaded
+ * again with a new snapshot when the probe is reset, the blkid cache is kept.
+ */
+struct partition_mnt_info {
+	bool collected;
+	int stvfs_ret;
+	struct statvfs stvfs;
+	char *uuid;
+};
+
+struct partition_cache {
+	pthread_mutex_t mutex;
+	int error;
+	fsdev_mounts_t *mounts;
+	struct partition_mnt_info *info;
 #if defined(HAVE_BLKID_GET_TAG_VALUE)
-static int collect_item(probe_ctx *ctx, oval_schema_version_t over, struct mntent *mnt_ent, blkid_cache blkcache)
-#else
-static int collect_item(probe_ctx *ctx, oval_schema_version_t over, struct mntent *mnt_ent)
+	blkid_cache blkcache;
 #endif
+};
+
+static int collect_item(probe_ctx *ctx, oval_schema_version_t over, struct partition_cache *cache, size_t idx)
 {
+        const fsdev_mnt_t *mnt = &cache->mounts->mnts[idx];
+        struct partition_mnt_info *info = &cache->info[idx];
         SEXP_t *item;
-        char   *uuid = "", *tok, *save = NULL, **mnt_opts = NULL;
+        char   *uuid = "", *opts, *tok, *save = NULL, **mnt_opts = NULL;
+        const char *fs_type;
         uint8_t mnt_ocnt;
         struct statvfs stvfs;
 
         /*
-         * Get FS stats
-         */
-        if (statvfs(mnt_ent->mnt_dir, &stvfs) != 0)
-                return (-1);
-
-        /*
-         * Get UUID
+         * Get FS stats and UUID
          */
+        pthread_mutex_lock(&cache->mutex);
+        if (!info->collected) {
+                info->stvfs_ret = statvfs(mnt->dir, &info->stvfs);
 #if defined(HAVE_BLKID_GET_TAG_VALUE)
-        uuid = blkid_get_tag_value(blkcache, "UUID", mnt_ent->mnt_fsname);
-        if (uuid == NULL) {
-	        uuid = "";
-        }
+                info->uuid = blkid_get_tag_value(cache->blkcache, "UUID", mnt->fsname);
 #endif
+                info->collected = true;
+        }
+        pthread_mutex_unlock(&cache->mutex);
+
+        if (info->stvfs_ret != 0)
+                return (-1);
+
+        stvfs = info->stvfs;
+        if (info->uuid != NULL)
+                uuid = info->uuid;
+
         /*
          * Create a NULL-terminated array from the mount options
          */
         mnt_ocnt = 0;
+        opts = strdup(mnt->opts);
 
-        tok = strtok_r(mnt_ent->mnt_opts, ",", &save);
+        tok = strtok_r(opts, ",", &save);
 
         do {
             add_mnt_opt(&mnt_opts, ++mnt_ocnt, tok);
@@ -202,17 +225,18 @@ static int collect_item(probe_ctx *ctx, oval_schema_version_t over, struct mnten
 	 * "Correct" the type (this won't be (hopefully) needed in a later version
 	 * of OVAL)
 	 */
+        fs_type = mnt->type;
         if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) < 0)
-	        mnt_ent->mnt_type = (char *)correct_fstype(mnt_ent->mnt_type);
+	        fs_type = correct_fstype(mnt->type);
 
         /*
          * Create the item
          */
         item = probe_item_create(OVAL_LINUX_PARTITION, NULL,
-                                 "mount_point",   OVAL_DATATYPE_STRING,   mnt_ent->mnt_dir,
-                                 "device",        OVAL_DATATYPE_STRING,   mnt_ent->mnt_fsname,
+                                 "mount_point",   OVAL_DATATYPE_STRING,   mnt->dir,
+                                 "device",        OVAL_DATATYPE_STRING,   mnt->fsname,
                                  "uuid",          OVAL_DATATYPE_STRING,   uuid,
-                                 "fs_type",       OVAL_DATATYPE_STRING,   mnt_ent->mnt_type,
+                                 "fs_type",       OVAL_DATATYPE_STRING,   fs_type,
                                  "mount_options", OVAL_DATATYPE_STRING_M, mnt_opts,
                                  "total_space",   OVAL_DATATYPE_INTEGER, (int64_t)stvfs.f_blocks,
                                  "space_used",    OVAL_DATATYPE_INTEGER, (int64_t)(stvfs.f_blocks - stvfs.f_bfree),
@@ -235,13 +259,85 @@ static int collect_item(probe_ctx *ctx, oval_schema_version_t over, struct mnten
 
         probe_item_collect(ctx, item);
         free(mnt_opts);
+        free(opts);
 
         return (0);
 }
 
+static void partition_cache_load(struct partition_cache *cache)
+{
+        cache->error = 0;
+#if defined(PROC_CHECK) && defined(__linux__)
+        struct statfs stfs;
+
+        if (statfs(MTAB_PATH, &stfs) != 0)
+                cache->error = PROBE_ESYSTEM;
+        else if (stfs.f_type != PROC_SUPER_MAGIC)
+                cache->error = PROBE_EFATAL;
+#endif
+        cache->mounts = fsdev_mounts();
+        if (cache->mounts == NULL && cache->error == 0)
+                cache->error = PROBE_ESYSTEM;
+
+        cache->info = calloc((cache->mounts != NULL ? cache->mounts->cnt : 0) + 1, sizeof(struct partition_mnt_info));
+
+#if defined(HAVE_BLKID_GET_TAG_VALUE)
+        if (cache->blkcache == NULL && cache->error == 0)
+                cache->error = PROBE_EUNKNOWN;
+#endif
+}
+
+static void partition_cache_clear(struct partition_cache *cache)
+{
+        for (size_t i = 0; cache->mounts != NULL && i < cache->mounts->cnt; ++i)
+                free(cache->info[i].uuid);
+        free(cache->info);
+        fsdev_mounts_free(cache->mounts);
+
+        cache->info = NULL;
+        cache->mounts = NULL;
+}
+
 void *probe_init(void)
 {
-	return (NULL);
+        struct partition_cache *cache = calloc(1, sizeof(struct partition_cache));
+
+        pthread_mutex_init(&cache->mutex, NULL);
+#if defined(HAVE_BLKID_GET_TAG_VALUE)
+        if (blkid_get_cache(&cache->blkcache, NULL) != 0)
+                cache->blkcache = NULL;
+#endif
+        partition_cache_load(cache);
+
+        return (cache);
+}
+
+void *probe_reset(void *probe_arg)
+{
+        struct partition_cache *cache = probe_arg;
+
+        if (cache != NULL) {
+                partition_cache_clear(cache);
+                partition_cache_load(cache);
+        }
+
+        return (cache);
+}
+
+void probe_fini(void *probe_arg)
+{
+        struct partition_cache *cache = probe_arg;
+
+        if (cache == NULL)
+                return;
+
+        partition_cache_clear(cache);
+#if defined(HAVE_BLKID_GET_TAG_VALUE)
+        if (cache->blkcache != NULL)
+                blkid_put_cache(cache->blkcache);
+#endif
+        pthread_mutex_destroy(&cache->mutex);
+        free(cache);
 }
 
 int probe_main(probe_ctx *ctx, void *probe_arg)
@@ -250,47 +346,24 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
         SEXP_t *mnt_entity, *mnt_opval, *mnt_entval, *probe_in;
         char    mnt_path[PATH_MAX];
         oval_operation_t mnt_op;
-        FILE *mnt_fp;
         oval_schema_version_t obj_over;
-#if defined(PROC_CHECK) && defined(__linux__)
-        int   mnt_fd;
-        struct statfs stfs;
+        struct partition_cache *cache = probe_arg;
+        pcre *re = NULL;
+        const char *estr = NULL;
+        int eoff = -1;
 
-        mnt_fd = open(MTAB_PATH, O_RDONLY);
+        if (cache == NULL)
+                return (PROBE_EINIT);
 
-        if (mnt_fd < 0)
-                return (PROBE_ESYSTEM);
+        if (cache->error != 0)
+                return (cache->error);
 
-        if (fstatfs(mnt_fd, &stfs) != 0) {
-                close(mnt_fd);
-                return (PROBE_ESYSTEM);
-        }
-
-        if (stfs.f_type != PROC_SUPER_MAGIC) {
-                close(mnt_fd);
-                return (PROBE_EFATAL);
-        }
-
-        mnt_fp = fdopen(mnt_fd, "r");
-
-        if (mnt_fp == NULL) {
-                close(mnt_fd);
-                return (PROBE_ESYSTEM);
-        }
-#else
-        mnt_fp = fopen(MTAB_PATH, "r");
-
-        if (mnt_fp == NULL)
-                return (PROBE_ESYSTEM);
-#endif
         probe_in   = probe_ctx_getobject(ctx);
         obj_over   = probe_obj_get_platform_schema_version(probe_in);
         mnt_entity = probe_obj_getent(probe_in, "mount_point", 1);
 
-        if (mnt_entity == NULL) {
-                fclose(mnt_fp);
+        if (mnt_entity == NULL)
                 return (PROBE_ENOENT);
-        }
 
         mnt_opval = probe_ent_getattrval(mnt_entity, "operation");
 
@@ -305,7 +378,6 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
         if (!SEXP_stringp(mnt_entval)) {
                 SEXP_free(mnt_entval);
                 SEXP_free(mnt_entity);
-		fclose(mnt_fp);
                 return (PROBE_EINVAL);
         }
 
@@ -313,81 +385,44 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
         SEXP_free(mnt_entval);
         SEXP_free(mnt_entity);
 
-        if (mnt_fp != NULL) {
-                char buffer[MTAB_LINE_MAX];
-                struct mntent mnt_ent, *mnt_entp;
-
-                pcre *re = NULL;
-                const char *estr = NULL;
-                int eoff = -1;
-#if defined(HAVE_BLKID_GET_TAG_VALUE)
-                blkid_cache blkcache;
+        if (mnt_op == OVAL_OPERATION_PATTERN_MATCH) {
+                re = pcre_compile(mnt_path, PCRE_UTF8, &estr, &eoff, NULL);
 
-                if (blkid_get_cache(&blkcache, NULL) != 0) {
-                        endmntent(mnt_fp);
-                        return (PROBE_EUNKNOWN);
-                }
-#endif
-                if (mnt_op == OVAL_OPERATION_PATTERN_MATCH) {
-                        re = pcre_compile(mnt_path, PCRE_UTF8, &estr, &eoff, NULL);
+                if (re == NULL)
+                        return (PROBE_EINVAL);
+        }
 
-                        if (re == NULL) {
-                                endmntent(mnt_fp);
-                                return (PROBE_EINVAL);
-                        }
-                }
+        for (size_t i = 0; cache->mounts != NULL && i < cache->mounts->cnt; ++i) {
+                const char *mnt_dir = cache->mounts->mnts[i].dir;
 
-                while ((mnt_entp = getmntent_r(mnt_fp, &mnt_ent,
-                                               buffer, sizeof buffer)) != NULL)
-                {
-			if (strcmp(mnt_entp->mnt_type, "rootfs") == 0)
-			    continue;
+                if (strcmp(cache->mounts->mnts[i].type, "rootfs") == 0)
+                        continue;
 
-                        if (mnt_op == OVAL_OPERATION_EQUALS) {
-                                if (strcmp(mnt_entp->mnt_dir, mnt_path) == 0) {
-#if defined(HAVE_BLKID_GET_TAG_VALUE)
-	                                collect_item(ctx, obj_over, mnt_entp, blkcache);
-#else
-	                                collect_item(ctx, obj_over, mnt_entp);
-#endif
+                if (mnt_op == OVAL_OPERATION_EQUALS) {
+                        if (strcmp(mnt_dir, mnt_path) == 0) {
+                                collect_item(ctx, obj_over, cache, i);
+                                break;
+                        }
+                } else if (mnt_op == OVAL_OPERATION_NOT_EQUAL) {
+                        if (strcmp(mnt_dir, mnt_path) != 0) {
+                                if (collect_item(ctx, obj_over, cache, i) != 0)
                                         break;
-                                }
-			} else if (mnt_op == OVAL_OPERATION_NOT_EQUAL) {
-				if (strcmp(mnt_entp->mnt_dir, mnt_path) != 0) {
-					if (
-#if defined(HAVE_BLKID_GET_TAG_VALUE)
-						collect_item(ctx, obj_over, mnt_entp, blkcache)
-#else
-						collect_item(ctx, obj_over, mnt_entp)
-#endif
-					!= 0)
-						break;
-                                }
-                        } else if (mnt_op == OVAL_OPERATION_PATTERN_MATCH) {
-                                int rc;
+                        }
+                } else if (mnt_op == OVAL_OPERATION_PATTERN_MATCH) {
+                        int rc;
 
-                                rc = pcre_exec(re, NULL, mnt_entp->mnt_dir,
-                                               strlen(mnt_entp->mnt_dir), 0, 0, NULL, 0);
+                        rc = pcre_exec(re, NULL, mnt_dir, strlen(mnt_dir), 0, 0, NULL, 0);
 
-                                if (rc == 0) {
-	                                if (
-#if defined(HAVE_BLKID_GET_TAG_VALUE)
-		                                collect_item(ctx, obj_over, mnt_entp, blkcache)
-#else
-		                                collect_item(ctx, obj_over, mnt_entp)
-#endif
-                                        != 0)
-		                                break;
-                                }
-                                /* XXX: check for pcre_exec error */
+                        if (rc == 0) {
+                                if (collect_item(ctx, obj_over, cache, i) != 0)
+                                        break;
                         }
+                        /* XXX: check for pcre_exec error */
                 }
-
-                endmntent(mnt_fp);
-
-                if (mnt_op == OVAL_OPERATION_PATTERN_MATCH)
-                        pcre_free(re);
         }
 
+        if (mnt_op == OVAL_OPERATION_PATTERN_MATCH)
+                pcre_free(re);
+
         return (probe_ret);
 }
@@ -36,7 +36,13 @@
 #endif
 
 #include <dbus/dbus.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "common/debug_priv.h"
+#include "SEAP/generic/rbt/rbt.h"
 
 // Old versions of libdbus API don't have DBusBasicValue and DBus8ByteStruct
 // as a public typedefs.
@@ -139,98 +145,6 @@ cleanup:
 	return ret;
 }
 
-static int get_all_systemd_units(DBusConnection* conn, int(*callback)(const char *, void *), void *cbarg)
-{
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
-	char ret = 1;
-
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		"/org/freedesktop/systemd1",
-		"org.freedesktop.systemd1.Manager",
-		"ListUnits"
-	);
-	if (msg == NULL) {
-		dI("Failed to create dbus_message via dbus_message_new_method_call!");
-		goto cleanup;
-	}
-
-	DBusMessageIter args, unit_iter;
-
-	// the args should be empty for this call
-	dbus_message_iter_init_append(msg, &args);
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dI("Failed to send message via dbus!");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dI("Invalid dbus pending call!");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dI("Failed to steal dbus pending call reply.");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dI("Failed to initialize iterator over received dbus message.");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY) {
-		dI("Expected array of structs in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_recurse(&args, &unit_iter);
-	do {
-		if (dbus_message_iter_get_arg_type(&unit_iter) != DBUS_TYPE_STRUCT) {
-			dI("Expected unit struct as elements in returned array. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_iter)));
-			goto cleanup;
-		}
-
-		DBusMessageIter unit_name;
-		dbus_message_iter_recurse(&unit_iter, &unit_name);
-
-		if (dbus_message_iter_get_arg_type(&unit_name) != DBUS_TYPE_STRING) {
-			dI("Expected string as the first element in the unit struct. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_name)));
-			goto cleanup;
-		}
-
-		_DBusBasicValue value;
-		dbus_message_iter_get_basic(&unit_name, &value);
-		char *unit_name_s = oscap_strdup(value.str);
-		int cbret = callback(unit_name_s, cbarg);
-		free(unit_name_s);
-		if (cbret != 0) {
-			goto cleanup;
-		}
-	}
-	while (dbus_message_iter_next(&unit_iter));
-
-	dbus_message_unref(msg); msg = NULL;
-
-	ret = 0;
-
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
-}
-
 static char *dbus_value_to_string(DBusMessageIter *iter)
 {
 	const int arg_type = dbus_message_iter_get_arg_type(iter);
@@ -358,4 +272,439 @@ static void disconnect_dbus(DBusConnection *conn)
 	// these connections are shared.
 }
 
+/*
+ * Cache of systemd units shared by all objects evaluated by the probe. Units
+ * are listed by a single ListUnits call, which also provides their object
+ * paths, and properties are fetched by GetAll. GetAll calls for a batch of
+ * units are all sent out before the first reply is awaited. The cache is
+ * created by probe_init(), the units are dropped by systemd_units_reset()
+ * when the probe is reset, i.e. for every scan served by a probe host, while
+ * the D-Bus connection is kept.
+ */
+
+// Number of calls in flight. dbus-daemon limits the number of pending
+// replies per connection, let's stay well below the default limit.
+#define SYSTEMD_PIPELINE_DEPTH 64
+
+struct systemd_unit_property {
+	char *name;
+	char *value;                            ///< NULL if value could not be converted to string
+};
+
+struct systemd_unit {
+	char *name;
+	char *path;                             ///< D-Bus object path, NULL if the unit could not be loaded
+	struct systemd_unit_property *properties; ///< Arrays are reported as one property per element
+	size_t properties_count;
+	bool properties_loaded;
+};
+
+struct systemd_units {
+	pthread_mutex_t mutex;                  ///< Held for the whole probe_main
+	DBusConnection *conn;
+	rbt_t *units;                           ///< unit name -> struct systemd_unit
+	struct systemd_unit **listed;           ///< Units in the order returned by ListUnits
+	size_t listed_count;
+	bool list_loaded;
+};
+
+static struct systemd_unit *systemd_unit_new(const char *name, const char *path)
+{
+	struct systemd_unit *unit = calloc(1, sizeof(struct systemd_unit));
+	unit->name = oscap_strdup(name);
+	unit->path = oscap_strdup(path);
+	return unit;
+}
+
+static void systemd_unit_free(struct systemd_unit *unit)
+{
+	for (size_t i = 0; i < unit->properties_count; ++i) {
+		free(unit->properties[i].name);
+		free(unit->properties[i].value);
+	}
+	free(unit->properties);
+	free(unit->path);
+	free(unit->name);
+	free(unit);
+}
+
+static void systemd_unit_free_cb(struct rbt_str_node *n)
+{
+	systemd_unit_free(n->data);
+}
+
+static void systemd_unit_add_property(struct systemd_unit *unit, const char *name, char *value)
+{
+	unit->properties = realloc(unit->properties, sizeof(struct systemd_unit_property) * (unit->properties_count + 1));
+	unit->properties[unit->properties_count].name = oscap_strdup(name);
+	unit->properties[unit->properties_count].value = value;
+	++unit->properties_count;
+}
+
+static struct systemd_units *systemd_units_new(void)
+{
+	struct systemd_units *units = calloc(1, sizeof(struct systemd_units));
+
+	if (pthread_mutex_init(&units->mutex, NULL) != 0) {
+		dI("Can't initialize mutex: errno=%u, %s.", errno, strerror(errno));
+		free(units);
+		return NULL;
+	}
+	units->units = rbt_str_new();
+	return units;
+}
+
+static void systemd_units_free(struct systemd_units *units)
+{
+	if (units == NULL)
+		return;
+
+	if (units->conn != NULL)
+		disconnect_dbus(units->conn);
+	rbt_str_free_cb(units->units, systemd_unit_free_cb);
+	free(units->listed);
+	pthread_mutex_destroy(&units->mutex);
+	free(units);
+}
+
+static struct systemd_units *systemd_units_reset(struct systemd_units *units)
+{
+	if (units == NULL)
+		return NULL;
+
+	rbt_str_free_cb(units->units, systemd_unit_free_cb);
+	free(units->listed);
+	units->units = rbt_str_new();
+	units->listed = NULL;
+	units->listed_count = 0;
+	units->list_loaded = false;
+	return units;
+}
+
+static struct systemd_unit *systemd_units_add(struct systemd_units *units, const char *name, const char *path)
+{
+	struct systemd_unit *unit = systemd_unit_new(name, path);
+
+	if (rbt_str_add(units->units, unit->name, unit) != 0) {
+		systemd_unit_free(unit);
+		return NULL;
+	}
+	return unit;
+}
+
+static int systemd_units_list(struct systemd_units *units)
+{
+	DBusMessage *msg = NULL;
+	DBusPendingCall *pending = NULL;
+	int ret = 1;
+
+	if (units->list_loaded)
+		return 0;
+
+	msg = dbus_message_new_method_call(
+		"org.freedesktop.systemd1",
+		"/org/freedesktop/systemd1",
+		"org.freedesktop.systemd1.Manager",
+		"ListUnits"
+	);
+	if (msg == NULL) {
+		dI("Failed to create dbus_message via dbus_message_new_method_call!");
+		goto cleanup;
+	}
+
+	DBusMessageIter args, unit_iter;
+
+	// the args should be empty for this call
+	dbus_message_iter_init_append(msg, &args);
+
+	if (!dbus_connection_send_with_reply(units->conn, msg, &pending, -1)) {
+		dI("Failed to send message via dbus!");
+		goto cleanup;
+	}
+	if (pending == NULL) {
+		dI("Invalid dbus pending call!");
+		goto cleanup;
+	}
+
+	dbus_connection_flush(units->conn);
+	dbus_message_unref(msg); msg = NULL;
+
+	dbus_pending_call_block(pending);
+	msg = dbus_pending_call_steal_reply(pending);
+	if (msg == NULL) {
+		dI("Failed to steal dbus pending call reply.");
+		goto cleanup;
+	}
+	dbus_pending_call_unref(pending); pending = NULL;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dI("Failed to initialize iterator over received dbus message.");
+		goto cleanup;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY) {
+		dI("Expected array of structs in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		goto cleanup;
+	}
+
+	dbus_message_iter_recurse(&args, &unit_iter);
+	do {
+		if (dbus_message_iter_get_arg_type(&unit_iter) != DBUS_TYPE_STRUCT) {
+			dI("Expected unit struct as elements in returned array. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_iter)));
+			goto cleanup;
+		}
+
+		// (name, description, load state, active state, sub state,
+		//  followed unit, object path, job id, job type, job path)
+		DBusMessageIter unit_field;
+		dbus_message_iter_recurse(&unit_iter, &unit_field);
+
+		if (dbus_message_iter_get_arg_type(&unit_field) != DBUS_TYPE_STRING) {
+			dI("Expected string as the first element in the unit struct. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&unit_field)));
+			goto cleanup;
+		}
+
+		_DBusBasicValue name, path;
+		dbus_message_iter_get_basic(&unit_field, &name);
+
+		path.str = NULL;
+		for (int i = 0; i < 6 && dbus_message_iter_next(&unit_field); ++i);
+		if (dbus_message_iter_get_arg_type(&unit_field) == DBUS_TYPE_OBJECT_PATH)
+			dbus_message_iter_get_basic(&unit_field, &path);
+
+		struct systemd_unit *unit = NULL;
+		if (rbt_str_get(units->units, name.str, (void *)&unit) != 0)
+			unit = systemd_units_add(units, name.str, path.str);
+		if (unit == NULL)
+			continue;
+
+		units->listed = realloc(units->listed, sizeof(struct systemd_unit *) * (units->listed_count + 1));
+		units->listed[units->listed_count++] = unit;
+	}
+	while (dbus_message_iter_next(&unit_iter));
+
+	dbus_message_unref(msg); msg = NULL;
+
+	ret = 0;
+
+cleanup:
+	if (pending != NULL)
+		dbus_pending_call_unref(pending);
+
+	if (msg != NULL)
+		dbus_message_unref(msg);
+
+	// Don't retry ListUnits for every object, the result would be the same.
+	units->list_loaded = true;
+
+	return ret;
+}
+
+/**
+ * Get unit by its name. Units which haven't been listed by ListUnits are
+ * loaded by systemd on demand.
+ */
+static struct systemd_unit *systemd_units_get(struct systemd_units *units, const char *name)
+{
+	struct systemd_unit *unit = NULL;
+
+	if (rbt_str_get(units->units, name, (void *)&unit) == 0)
+		return unit;
+
+	char *path = get_path_by_unit(units->conn, name);
+	unit = systemd_units_add(units, name, path);
+	free(path);
+
+	return unit;
+}
+
+static DBusMessage *systemd_unit_get_all_message(const struct systemd_unit *unit)
+{
+	DBusMessage *msg;
+	DBusMessageIter args;
+	const char *interface = "org.freedesktop.systemd1.Unit";
+
+	msg = dbus_message_new_method_call(
+		"org.freedesktop.systemd1",
+		unit->path,
+		"org.freedesktop.DBus.Properties",
+		"GetAll"
+	);
+	if (msg == NULL) {
+		dI("Failed to create dbus_message via dbus_message_new_method_call!");
+		return NULL;
+	}
+
+	dbus_message_iter_init_append(msg, &args);
+	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface)) {
+		dI("Failed to append interface '%s' string parameter to dbus message!", interface);
+		dbus_message_unref(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+static int systemd_unit_parse_properties(struct systemd_unit *unit, DBusMessage *msg)
+{
+	DBusMessageIter args, property_iter;
+
+	if (!dbus_message_iter_init(msg, &args)) {
+		dI("Failed to initialize iterator over received dbus message.");
+		return 1;
+	}
+
+	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY && dbus_message_iter_get_element_type(&args) != DBUS_TYPE_DICT_ENTRY) {
+		dI("Expected array of dict_entry argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
+		return 1;
+	}
+
+	dbus_message_iter_recurse(&args, &property_iter);
+	do {
+		DBusMessageIter dict_entry, value_variant;
+		dbus_message_iter_recurse(&property_iter, &dict_entry);
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_STRING) {
+			dI("Expected string as key in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			return 1;
+		}
+
+		_DBusBasicValue value;
+		dbus_message_iter_get_basic(&dict_entry, &value);
+		const char *property_name = value.str;
+
+		if (dbus_message_iter_next(&dict_entry) == false) {
+			dW("Expected another field in dict_entry.");
+			return 1;
+		}
+
+		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_VARIANT) {
+			dI("Expected variant as value in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
+			return 1;
+		}
+
+		dbus_message_iter_recurse(&dict_entry, &value_variant);
+
+		const int arg_type = dbus_message_iter_get_arg_type(&value_variant);
+		// DBUS_TYPE_ARRAY is a special case, we report each element as one value entry
+		if (arg_type == DBUS_TYPE_ARRAY) {
+			DBusMessageIter array;
+			dbus_message_iter_recurse(&value_variant, &array);
+
+			do {
+				char *element = dbus_value_to_string(&array);
+				if (element == NULL)
+					continue;
+
+				systemd_unit_add_property(unit, property_name, element);
+			}
+			while (dbus_message_iter_next(&array));
+		}
+		else {
+			systemd_unit_add_property(unit, property_name, dbus_value_to_string(&value_variant));
+		}
+	}
+	while (dbus_message_iter_next(&property_iter));
+
+	return 0;
+}
+
+/**
+ * Make sure properties of given units are loaded. GetAll calls are
+ * pipelined, up to SYSTEMD_PIPELINE_DEPTH calls are sent out before
+ * the replies are collected.
+ */
+static void systemd_units_load_properties(struct systemd_units *units, struct systemd_unit **batch, size_t count)
+{
+	DBusPendingCall *pending[SYSTEMD_PIPELINE_DEPTH];
+	struct systemd_unit *sent[SYSTEMD_PIPELINE_DEPTH];
+	size_t i = 0;
+
+	while (i < count) {
+		size_t sent_count = 0;
+
+		for (; i < count && sent_count < SYSTEMD_PIPELINE_DEPTH; ++i) {
+			struct systemd_unit *unit = batch[i];
+
+			if (unit->properties_loaded)
+				continue;
+			// Failures are not retried either.
+			unit->properties_loaded = true;
+			if (unit->path == NULL)
+				continue;
+
+			DBusMessage *msg = systemd_unit_get_all_message(unit);
+			if (msg == NULL)
+				continue;
+
+			DBusPendingCall *call = NULL;
+			if (!dbus_connection_send_with_reply(units->conn, msg, &call, -1) || call == NULL) {
+				dI("Failed to send message via dbus!");
+				dbus_message_unref(msg);
+				continue;
+			}
+			dbus_message_unref(msg);
+
+			pending[sent_count] = call;
+			sent[sent_count] = unit;
+			++sent_count;
+		}
+
+		dbus_connection_flush(units->conn);
+
+		for (size_t j = 0; j < sent_count; ++j) {
+			dbus_pending_call_block(pending[j]);
+			DBusMessage *reply = dbus_pending_call_steal_reply(pending[j]);
+			dbus_pending_call_unref(pending[j]);
+
+			if (reply == NULL) {
+				dI("Failed to steal dbus pending call reply.");
+				continue;
+			}
+			systemd_unit_parse_properties(sent[j], reply);
+			dbus_message_unref(reply);
+		}
+	}
+}
+
+/**
+ * Get unit by its name, with its properties loaded.
+ */
+static struct systemd_unit *systemd_units_get_loaded(struct systemd_units *units, const char *name)
+{
+	struct systemd_unit *unit = systemd_units_get(units, name);
+
+	if (unit != NULL)
+		systemd_units_load_properties(units, &unit, 1);
+
+	return unit;
+}
+
+/**
+ * Prepare the cache for an object evaluation: connect to the bus and list
+ * units if that hasn't been done yet. The cache is locked on success and
+ * needs to be released by systemd_units_release.
+ * @return 0 on success, 1 if the connection to the bus failed
+ */
+static int systemd_units_acquire(struct systemd_units *units)
+{
+	pthread_mutex_lock(&units->mutex);
+
+	if (units->conn == NULL) {
+		units->conn = connect_dbus();
+		if (units->conn == NULL) {
+			pthread_mutex_unlock(&units->mutex);
+			return 1;
+		}
+	}
+
+	systemd_units_list(units);
+	return 0;
+}
+
+static void systemd_units_release(struct systemd_units *units)
+{
+	pthread_mutex_unlock(&units->mutex);
+}
+
 #endif
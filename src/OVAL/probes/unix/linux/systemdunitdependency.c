@@ -33,92 +33,8 @@
 #include <probe-api.h>
 #include "probe/entcmp.h"
 #include "systemdshared.h"
-#include "common/list.h"
 #include <string.h>
 
-static char *get_property_by_unit_path(DBusConnection *conn, const char *unit_path, const char *property)
-{
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
-	char *ret = NULL;
-
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		unit_path,
-		"org.freedesktop.DBus.Properties",
-		"Get"
-	);
-	if (msg == NULL) {
-		dI("Failed to create dbus_message via dbus_message_new_method_call!");
-		goto cleanup;
-	}
-
-	DBusMessageIter args, value_iter;
-
-	const char *interface = "org.freedesktop.systemd1.Unit";
-
-	dbus_message_iter_init_append(msg, &args);
-	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface)) {
-		dI("Failed to append interface '%s' string parameter to dbus message!", interface);
-		goto cleanup;
-	}
-	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &property)) {
-		dI("Failed to append property '%s' string parameter to dbus message!", property);
-		goto cleanup;
-	}
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dI("Failed to send message via dbus!");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dI("Invalid dbus pending call!");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dI("Failed to steal dbus pending call reply.");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dI("Failed to initialize iterator over received dbus message.");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_VARIANT)
-	{
-		dI("Expected variant argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_recurse(&args, &value_iter);
-	ret = dbus_value_to_string(&value_iter);
-
-	dbus_message_unref(msg); msg = NULL;
-
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
-}
-
-struct unit_callback_vars {
-	DBusConnection *dbus_conn;
-	probe_ctx *ctx;
-	SEXP_t *unit_entity;
-};
-
 static bool is_unit_name_a_target(const char *unit)
 {
 	const char *suffix = ".target";
@@ -134,7 +50,30 @@ static bool is_unit_name_a_target(const char *unit)
 	return strncmp(unit + len - suffix_len, suffix, suffix_len) == 0;
 }
 
-static void get_all_dependencies_by_unit(DBusConnection *conn, const char *unit, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants)
+static void get_all_dependencies_by_unit(struct systemd_units *units, const char *unit, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants);
+
+static int get_dependencies_by_property(struct systemd_units *units, const struct systemd_unit *unit, const char *property_name, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants)
+{
+	for (size_t i = 0; i < unit->properties_count; ++i) {
+		const char *dependency = unit->properties[i].value;
+
+		if (strcmp(unit->properties[i].name, property_name) != 0)
+			continue;
+		if (dependency == NULL || *dependency == '\0')
+			continue;
+
+		if (callback(dependency, cbarg) != 0)
+			return 1;
+
+		get_all_dependencies_by_unit(units, dependency,
+					     callback, cbarg,
+					     include_requires, include_wants);
+	}
+
+	return 0;
+}
+
+static void get_all_dependencies_by_unit(struct systemd_units *units, const char *unit, int(*callback)(const char *, void *), void *cbarg, bool include_requires, bool include_wants)
 {
 	if (!unit || strcmp(unit, "(null)") == 0)
 		return;
@@ -143,58 +82,17 @@ static void get_all_dependencies_by_unit(DBusConnection *conn, const char *unit,
 	if (!is_unit_name_a_target(unit))
 		return;
 
-	char *path = get_path_by_unit(conn, unit);
-
-	if (include_requires) {
-		char *requires_s = get_property_by_unit_path(conn, path, "Requires");
-		if (requires_s) {
-			char **requires = oscap_split(requires_s, ", ");
-			for (int i = 0; requires[i] != NULL; ++i) {
-				if (oscap_strcmp(requires[i], "") == 0)
-					continue;
-
-				if (callback(requires[i], cbarg) == 0) {
-					get_all_dependencies_by_unit(conn, requires[i],
-									callback, cbarg,
-									include_requires, include_wants);
-				} else {
-					free(requires);
-					free(requires_s);
-					free(path);
-					return;
-				}
-			}
-			free(requires);
-		}
-		free(requires_s);
-	}
+	const struct systemd_unit *target = systemd_units_get_loaded(units, unit);
 
-	if (include_wants) {
-		char *wants_s = get_property_by_unit_path(conn, path, "Wants");
-		if (wants_s)
-		{
-			char **wants = oscap_split(wants_s, ", ");
-			for (int i = 0; wants[i] != NULL; ++i) {
-				if (oscap_strcmp(wants[i], "") == 0)
-					continue;
-
-				if (callback(wants[i], cbarg) == 0) {
-					get_all_dependencies_by_unit(conn, wants[i],
-									callback, cbarg,
-									include_requires, include_wants);
-				} else {
-					free(wants);
-					free(wants_s);
-					free(path);
-					return;
-				}
-			}
-			free(wants);
-		}
-		free(wants_s);
-	}
+	if (target == NULL)
+		return;
 
-	free(path);
+	if (include_requires &&
+	    get_dependencies_by_property(units, target, "Requires", callback, cbarg, include_requires, include_wants) != 0)
+		return;
+
+	if (include_wants)
+		get_dependencies_by_property(units, target, "Wants", callback, cbarg, include_requires, include_wants);
 }
 
 static int dependency_callback(const char *dependency, void *cbarg)
@@ -205,34 +103,29 @@ static int dependency_callback(const char *dependency, void *cbarg)
 	return 0;
 }
 
-static int unit_callback(const char *unit, void *cbarg)
+void *probe_init(void)
 {
-	struct unit_callback_vars *vars = (struct unit_callback_vars *)cbarg;
-	SEXP_t *se_unit = SEXP_string_new(unit, strlen(unit));
-
-	if (probe_entobj_cmp(vars->unit_entity, se_unit) != OVAL_RESULT_TRUE) {
-		/* Do nothing, continue with the next unit */
-		SEXP_free(se_unit);
-		return 0;
-	}
-
-	SEXP_t *item = probe_item_create(OVAL_LINUX_SYSTEMDUNITDEPENDENCY, NULL,
-					 "unit", OVAL_DATATYPE_SEXP, se_unit,
-					 NULL);
-
-	get_all_dependencies_by_unit(vars->dbus_conn, unit,
-				     dependency_callback, item, true, true);
+	return systemd_units_new();
+}
 
-	probe_item_collect(vars->ctx, item);
-	SEXP_free(se_unit);
+void *probe_reset(void *probe_arg)
+{
+	return systemd_units_reset(probe_arg);
+}
 
-	return 0;
+void probe_fini(void *probe_arg)
+{
+	systemd_units_free(probe_arg);
 }
 
 int probe_main(probe_ctx *ctx, void *probe_arg)
 {
 	SEXP_t *unit_entity, *probe_in;
 	oval_schema_version_t oval_version;
+	struct systemd_units *units = probe_arg;
+
+	if (units == NULL)
+		return PROBE_EINIT;
 
 	probe_in = probe_ctx_getobject(ctx);
 	oval_version = probe_obj_get_platform_schema_version(probe_in);
@@ -242,14 +135,7 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
 		return PROBE_EOPNOTSUPP;
 	}
 
-	DBusError dbus_error;
-	DBusConnection *dbus_conn;
-
-	dbus_error_init(&dbus_error);
-	dbus_conn = connect_dbus();
-
-	if (dbus_conn == NULL) {
-		dbus_error_free(&dbus_error);
+	if (systemd_units_acquire(units) != 0) {
 		SEXP_t *msg = probe_msg_creat(OVAL_MESSAGE_LEVEL_INFO, "DBus connection failed, could not identify systemd units.");
 		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_ERROR);
 		probe_cobj_add_msg(probe_ctx_getresult(ctx), msg);
@@ -257,19 +143,46 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
 		return 0;
 	}
 
+	/*
+	 * Dependencies are resolved through target units only, properties of
+	 * all listed targets are requested at once. Targets which are not
+	 * listed are loaded one by one as they are encountered.
+	 */
+	struct systemd_unit **targets = malloc(sizeof(struct systemd_unit *) * (units->listed_count + 1));
+	size_t targets_count = 0;
+
+	for (size_t i = 0; i < units->listed_count; ++i) {
+		if (is_unit_name_a_target(units->listed[i]->name))
+			targets[targets_count++] = units->listed[i];
+	}
+	systemd_units_load_properties(units, targets, targets_count);
+	free(targets);
+
 	unit_entity = probe_obj_getent(probe_in, "unit", 1);
 
-	struct unit_callback_vars vars;
+	for (size_t i = 0; i < units->listed_count; ++i) {
+		const char *unit = units->listed[i]->name;
+		SEXP_t *se_unit = SEXP_string_new(unit, strlen(unit));
+
+		if (probe_entobj_cmp(unit_entity, se_unit) != OVAL_RESULT_TRUE) {
+			/* Do nothing, continue with the next unit */
+			SEXP_free(se_unit);
+			continue;
+		}
+
+		SEXP_t *item = probe_item_create(OVAL_LINUX_SYSTEMDUNITDEPENDENCY, NULL,
+						 "unit", OVAL_DATATYPE_SEXP, se_unit,
+						 NULL);
 
-	vars.dbus_conn = dbus_conn;
-	vars.ctx = ctx;
-	vars.unit_entity = unit_entity;
+		get_all_dependencies_by_unit(units, unit,
+					     dependency_callback, item, true, true);
 
-	get_all_systemd_units(dbus_conn, unit_callback, &vars);
+		probe_item_collect(ctx, item);
+		SEXP_free(se_unit);
+	}
 
+	systemd_units_release(units);
 	SEXP_free(unit_entity);
-	dbus_error_free(&dbus_error);
-	disconnect_dbus(dbus_conn);
 
-        return 0;
+	return 0;
 }
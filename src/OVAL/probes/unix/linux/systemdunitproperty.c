@@ -35,226 +35,82 @@
 #include "probe/entcmp.h"
 #include "systemdshared.h"
 
-static int get_all_properties_by_unit_path(DBusConnection *conn, const char *unit_path, int(*callback)(const char *name, const char *value, void *arg), void *cbarg)
+static void collect_unit_properties(probe_ctx *ctx, SEXP_t *property_entity, const struct systemd_unit *unit)
 {
-	int ret = 1;
-	DBusMessage *msg = NULL;
-	DBusPendingCall *pending = NULL;
-
-	msg = dbus_message_new_method_call(
-		"org.freedesktop.systemd1",
-		unit_path,
-		"org.freedesktop.DBus.Properties",
-		"GetAll"
-	);
-	if (msg == NULL) {
-		dI("Failed to create dbus_message via dbus_message_new_method_call!");
-		goto cleanup;
-	}
-
-	DBusMessageIter args, property_iter;
-
-	const char *interface = "org.freedesktop.systemd1.Unit";
-
-	dbus_message_iter_init_append(msg, &args);
-	if (!dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface)) {
-		dI("Failed to append interface '%s' string parameter to dbus message!", interface);
-		goto cleanup;
-	}
-
-	if (!dbus_connection_send_with_reply(conn, msg, &pending, -1)) {
-		dI("Failed to send message via dbus!");
-		goto cleanup;
-	}
-	if (pending == NULL) {
-		dI("Invalid dbus pending call!");
-		goto cleanup;
-	}
-
-	dbus_connection_flush(conn);
-	dbus_message_unref(msg); msg = NULL;
-
-	dbus_pending_call_block(pending);
-	msg = dbus_pending_call_steal_reply(pending);
-	if (msg == NULL) {
-		dI("Failed to steal dbus pending call reply.");
-		goto cleanup;
-	}
-	dbus_pending_call_unref(pending); pending = NULL;
-
-	if (!dbus_message_iter_init(msg, &args)) {
-		dI("Failed to initialize iterator over received dbus message.");
-		goto cleanup;
-	}
-
-	if (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY && dbus_message_iter_get_element_type(&args) != DBUS_TYPE_DICT_ENTRY) {
-		dI("Expected array of dict_entry argument in reply. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&args)));
-		goto cleanup;
-	}
-
-	dbus_message_iter_recurse(&args, &property_iter);
-	do {
-		DBusMessageIter dict_entry, value_variant;
-		dbus_message_iter_recurse(&property_iter, &dict_entry);
-
-		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_STRING) {
-			dI("Expected string as key in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
-			goto cleanup;
+	SEXP_t *se_unit = SEXP_string_new(unit->name, strlen(unit->name));
+	SEXP_t *se_property = NULL;
+	SEXP_t *item = NULL;
+
+	for (size_t i = 0; i < unit->properties_count; ++i) {
+		const struct systemd_unit_property *property = &unit->properties[i];
+
+		if (se_property != NULL) {
+			//
+			// Compare the previously matched entity to the current one
+			// If they are the same, continue to fill the current item
+			// with property values. If not, collect the item and create
+			// a new one for the current property.
+			//
+			if (SEXP_strcmp(se_property, property->name) == 0) {
+				if (property->value != NULL) {
+					SEXP_t *se_value = SEXP_string_new(property->value, strlen(property->value));
+					probe_item_ent_add(item, "value", NULL, se_value);
+					SEXP_free(se_value);
+				}
+				continue;
+			} else {
+				probe_item_collect(ctx, item);
+				item = NULL;
+				SEXP_free(se_property);
+				se_property = NULL;
+			}
 		}
 
-		_DBusBasicValue value;
-		dbus_message_iter_get_basic(&dict_entry, &value);
-		char *property_name = oscap_strdup(value.str);
+		SEXP_t *se_candidate = SEXP_string_new(property->name, strlen(property->name));
 
-		if (dbus_message_iter_next(&dict_entry) == false) {
-			dW("Expected another field in dict_entry.");
-			free(property_name);
-			goto cleanup;
+		if (probe_entobj_cmp(property_entity, se_candidate) != OVAL_RESULT_TRUE) {
+			SEXP_free(se_candidate);
+			continue;
 		}
 
-		if (dbus_message_iter_get_arg_type(&dict_entry) != DBUS_TYPE_VARIANT) {
-			dI("Expected variant as value in dict_entry. Instead received: %s.", dbus_message_type_to_string(dbus_message_iter_get_arg_type(&dict_entry)));
-			free(property_name);
-			goto cleanup;
-		}
-
-		dbus_message_iter_recurse(&dict_entry, &value_variant);
-
-		int cbret = 0;
-		const int arg_type = dbus_message_iter_get_arg_type(&value_variant);
-		// DBUS_TYPE_ARRAY is a special case, we report each element as one value entry
-		if (arg_type == DBUS_TYPE_ARRAY) {
-			DBusMessageIter array;
-			dbus_message_iter_recurse(&value_variant, &array);
-
-			do {
-				char *element = dbus_value_to_string(&array);
-				if (element == NULL)
-					continue;
-
-				const int elementcbret = callback(property_name, element, cbarg);
-				if (elementcbret > cbret)
-					cbret = elementcbret;
-
-				free(element);
-			}
-			while (dbus_message_iter_next(&array));
-		}
-		else {
-			char *property_value = dbus_value_to_string(&value_variant);
-			cbret = callback(property_name, property_value, cbarg);
-			free(property_value);
-		}
-
-		free(property_name);
-		if (cbret != 0) {
-			goto cleanup;
-		}
+		se_property = se_candidate;
+		item = probe_item_create(OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL,
+					 "unit", OVAL_DATATYPE_SEXP, se_unit,
+					 "property", OVAL_DATATYPE_SEXP, se_property,
+					 "value", OVAL_DATATYPE_STRING, property->value,
+					 NULL);
 	}
-	while (dbus_message_iter_next(&property_iter));
 
-	dbus_message_unref(msg); msg = NULL;
-	ret = 0;
+	if (item != NULL)
+		probe_item_collect(ctx, item);
 
-cleanup:
-	if (pending != NULL)
-		dbus_pending_call_unref(pending);
-
-	if (msg != NULL)
-		dbus_message_unref(msg);
-
-	return ret;
+	SEXP_free(se_property);
+	SEXP_free(se_unit);
 }
 
-struct unit_callback_vars {
-	DBusConnection *dbus_conn;
-	probe_ctx *ctx;
-	SEXP_t *unit_entity;
-	SEXP_t *property_entity;
-	SEXP_t *se_unit;
-	SEXP_t *se_property;
-	SEXP_t *item;
-};
-
-static int property_callback(const char *property, const char *value, void *cbarg)
+void *probe_init(void)
 {
-	struct unit_callback_vars *vars = (struct unit_callback_vars *)cbarg;
-
-	if (vars->se_property != NULL) {
-		//
-		// Compare the previously matched entity to the current one
-		// If they are the same, continue to fill the current item
-		// with property values. If not, collect the item and create
-		// a new one for the current property.
-		//
-		if (SEXP_strcmp(vars->se_property, property) == 0) {
-			SEXP_t *se_value = SEXP_string_new(value, strlen(value));
-			probe_item_ent_add(vars->item, "value", NULL, se_value);
-			SEXP_free(se_value);
-			return 0;
-		} else {
-			probe_item_collect(vars->ctx, vars->item);
-			vars->item = NULL;
-			SEXP_free(vars->se_property);
-			vars->se_property = NULL;
-		}
-	}
-
-	SEXP_t *se_property = SEXP_string_new(property, strlen(property));
-
-	if (probe_entobj_cmp(vars->property_entity, se_property) != OVAL_RESULT_TRUE) {
-		SEXP_free(se_property);
-		return 0;
-	}
-
-	vars->se_property = se_property;
-	vars->item = probe_item_create(OVAL_LINUX_SYSTEMDUNITPROPERTY, NULL,
-				       "unit", OVAL_DATATYPE_SEXP, vars->se_unit,
-				       "property", OVAL_DATATYPE_SEXP, vars->se_property,
-				       "value", OVAL_DATATYPE_STRING, value,
-				       NULL);
-	return 0;
+	return systemd_units_new();
 }
 
-static int unit_callback(const char *unit, void *cbarg)
+void *probe_reset(void *probe_arg)
 {
-	struct unit_callback_vars *vars = (struct unit_callback_vars *)cbarg;
-	SEXP_t *se_unit = SEXP_string_new(unit, strlen(unit));
-
-	if (probe_entobj_cmp(vars->unit_entity, se_unit) != OVAL_RESULT_TRUE) {
-		/* Do nothing, continue with the next unit */
-		SEXP_free(se_unit);
-		return 0;
-	}
-
-	vars->se_unit = se_unit;
-	vars->se_property = NULL;
-	vars->item = NULL;
-
-	char *unit_path = get_path_by_unit(vars->dbus_conn, unit);
-
-	if (unit_path == NULL) {
-		return 1;
-	}
-
-	get_all_properties_by_unit_path(vars->dbus_conn, unit_path,
-					property_callback, vars);
-
-	if (vars->item != NULL) {
-		probe_item_collect(vars->ctx, vars->item);
-		vars->item = NULL;
-		SEXP_free(vars->se_property);
-		vars->se_property = NULL;
-	}
+	return systemd_units_reset(probe_arg);
+}
 
-	SEXP_free(se_unit);
-	return 0;
+void probe_fini(void *probe_arg)
+{
+	systemd_units_free(probe_arg);
 }
 
 int probe_main(probe_ctx *ctx, void *probe_arg)
 {
 	SEXP_t *unit_entity, *probe_in, *property_entity;
 	oval_schema_version_t oval_version;
+	struct systemd_units *units = probe_arg;
+
+	if (units == NULL)
+		return PROBE_EINIT;
 
 	probe_in = probe_ctx_getobject(ctx);
 	oval_version = probe_obj_get_platform_schema_version(probe_in);
@@ -264,14 +120,7 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
 		return PROBE_EOPNOTSUPP;
 	}
 
-	DBusError dbus_error;
-	DBusConnection *dbus_conn;
-
-	dbus_error_init(&dbus_error);
-	dbus_conn = connect_dbus();
-
-	if (dbus_conn == NULL) {
-		dbus_error_free(&dbus_error);
+	if (systemd_units_acquire(units) != 0) {
 		SEXP_t *msg = probe_msg_creat(OVAL_MESSAGE_LEVEL_INFO, "DBus connection failed, could not identify systemd units.");
 		probe_cobj_set_flag(probe_ctx_getresult(ctx), SYSCHAR_FLAG_ERROR);
 		probe_cobj_add_msg(probe_ctx_getresult(ctx), msg);
@@ -282,19 +131,30 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
 	unit_entity = probe_obj_getent(probe_in, "unit", 1);
 	property_entity = probe_obj_getent(probe_in, "property", 1);
 
-	struct unit_callback_vars vars;
+	/* Properties of all matching units are requested at once */
+	struct systemd_unit **matching = malloc(sizeof(struct systemd_unit *) * (units->listed_count + 1));
+	size_t matching_count = 0;
+
+	for (size_t i = 0; i < units->listed_count; ++i) {
+		struct systemd_unit *unit = units->listed[i];
+		SEXP_t *se_unit = SEXP_string_new(unit->name, strlen(unit->name));
+
+		if (probe_entobj_cmp(unit_entity, se_unit) == OVAL_RESULT_TRUE)
+			matching[matching_count++] = unit;
+
+		SEXP_free(se_unit);
+	}
+
+	systemd_units_load_properties(units, matching, matching_count);
 
-	vars.dbus_conn = dbus_conn;
-	vars.ctx = ctx;
-	vars.unit_entity = unit_entity;
-	vars.property_entity = property_entity;
+	for (size_t i = 0; i < matching_count; ++i)
+		collect_unit_properties(ctx, property_entity, matching[i]);
 
-	get_all_systemd_units(dbus_conn, unit_callback, &vars);
+	free(matching);
+	systemd_units_release(units);
 
 	SEXP_free(unit_entity);
 	SEXP_free(property_entity);
-	dbus_error_free(&dbus_error);
-	disconnect_dbus(dbus_conn);
 
 	return 0;
 }
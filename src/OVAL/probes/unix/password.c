@@ -50,8 +50,6 @@
 #include <stdio.h>
 #include <errno.h>
 #include <pwd.h>
-#include <paths.h>
-#include <lastlog.h>
 
 #include "seap.h"
 #include "probe-api.h"
@@ -60,6 +58,7 @@
 #include "common/debug_priv.h"
 #include <probe/probe.h>
 #include <probe/option.h>
+#include "account-db.h"
 
 /* Convenience structure for the results being reported */
 struct result_info {
@@ -97,53 +96,88 @@ static void report_finding(struct result_info *res, probe_ctx *ctx, oval_schema_
         probe_item_collect(ctx, item);
 }
 
-static int read_password(SEXP_t *un_ent, probe_ctx *ctx, oval_schema_version_t over)
+static void report_account(const struct account_db_passwd *pw, struct account_db *db, probe_ctx *ctx, oval_schema_version_t over)
 {
-        struct passwd *pw;
-
-        while ((pw = getpwent())) {
-                SEXP_t *un;
-
-                dI("Have user: %s", pw->pw_name);
-                un = SEXP_string_newf("%s", pw->pw_name);
-                if (probe_entobj_cmp(un_ent, un) == OVAL_RESULT_TRUE) {
-                        struct result_info r;
-
-                        r.username = pw->pw_name;
-                        r.password = pw->pw_passwd;
-                        r.user_id = pw->pw_uid;
-                        r.group_id = pw->pw_gid;
-                        r.gcos = pw->pw_gecos;
-                        r.home_dir = pw->pw_dir;
-                        r.login_shell = pw->pw_shell;
-                        r.last_login = -1;
-
-                        if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0) {
-	                        FILE *ll_fp = fopen(_PATH_LASTLOG, "r");
-
-	                        if (ll_fp != NULL) {
-		                        struct lastlog ll;
-
-		                        if (fseeko(ll_fp, (off_t)pw->pw_uid * sizeof(ll), SEEK_SET) == 0)
-			                        if (fread((char *)&ll, sizeof(ll), 1, ll_fp) == 1)
-				                        r.last_login = (int64_t)ll.ll_time;
-		                        fclose(ll_fp);
-	                        }
-                        }
-
-                        report_finding(&r, ctx, over);
+        struct result_info r;
+
+        r.username = pw->name;
+        r.password = pw->passwd;
+        r.user_id = pw->uid;
+        r.group_id = pw->gid;
+        r.gcos = pw->gecos;
+        r.home_dir = pw->dir;
+        r.login_shell = pw->shell;
+        r.last_login = -1;
+
+        if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.10)) >= 0)
+                r.last_login = account_db_last_login(db, pw->uid);
+
+        report_finding(&r, ctx, over);
+}
+
+static int read_password(SEXP_t *un_ent, struct account_db *db, probe_ctx *ctx, oval_schema_version_t over)
+{
+        const struct account_db_passwd *pw, **found;
+        size_t pw_count;
+        SEXP_t *un;
+
+        /* A single user can be looked up by name */
+        if (probe_ent_getoperation(un_ent, OVAL_OPERATION_EQUALS) == OVAL_OPERATION_EQUALS &&
+            !probe_ent_attrexists(un_ent, "var_ref") &&
+            (un = probe_ent_getval(un_ent)) != NULL) {
+                char *username = SEXP_string_cstr(un);
+
+                SEXP_free(un);
+                if (username != NULL) {
+                        found = account_db_find_passwd(db, username, &pw_count);
+                        for (size_t i = 0; i < pw_count; ++i)
+                                report_account(found[i], db, ctx, over);
+                        free(username);
+                        return 0;
                 }
+        }
+
+        pw = account_db_get_passwd(db, &pw_count);
+        for (size_t i = 0; i < pw_count; ++i) {
+                dI("Have user: %s", pw[i].name);
+                un = SEXP_string_newf("%s", pw[i].name);
+                if (probe_entobj_cmp(un_ent, un) == OVAL_RESULT_TRUE)
+                        report_account(&pw[i], db, ctx, over);
                 SEXP_free(un);
         }
-        endpwent();
         return 0;
 }
 
+int probe_offline_mode_supported(void)
+{
+	return PROBE_OFFLINE_OWN;
+}
+
+void *probe_init(void)
+{
+	return account_db_new(getenv("OSCAP_PROBE_ROOT"), ACCOUNT_DB_PASSWD | ACCOUNT_DB_LASTLOG);
+}
+
+/* Reloaded on every reset of the probe, the accounts may have changed */
+void *probe_reset(void *arg)
+{
+	account_db_free(arg);
+	return probe_init();
+}
+
+void probe_fini(void *arg)
+{
+	account_db_free(arg);
+}
+
 int probe_main(probe_ctx *ctx, void *arg)
 {
 	SEXP_t *ent, *obj;
 	oval_schema_version_t over;
 
+	if (arg == NULL)
+		return PROBE_EINIT;
+
 	obj = probe_ctx_getobject(ctx);
 
 	if (obj == NULL)
@@ -157,7 +191,7 @@ int probe_main(probe_ctx *ctx, void *arg)
         }
 
         // Now we check the file...
-        read_password(ent, ctx, over);
+        read_password(ent, arg, ctx, over);
         SEXP_free(ent);
 
         return 0;
@@ -79,6 +79,7 @@ int probe_main(probe_ctx *ctx, void *arg)
 #else
 /* shadow.h is present */
 #include <shadow.h>
+#include "account-db.h"
 
 /* Convenience structure for the results being reported */
 struct result_info {
@@ -177,42 +178,85 @@ static void report_finding(struct result_info *res, probe_ctx *ctx)
         SEXP_free_r(&se_flg_mem);
 }
 
-static int read_shadow(SEXP_t *un_ent, probe_ctx *ctx)
+static void report_account(const struct account_db_shadow *sp, probe_ctx *ctx)
 {
-	int err = 1;
-	struct spwd *pw;
-
-	while ((pw = getspent())) {
-		SEXP_t *un;
-
-		dI("Have user: %s", pw->sp_namp);
-		err = 0;
-		un = SEXP_string_newf("%s", pw->sp_namp);
-		if (probe_entobj_cmp(un_ent, un) == OVAL_RESULT_TRUE) {
-			struct result_info r;
-
-			r.username = pw->sp_namp;
-			r.password = pw->sp_pwdp;
-			r.chg_lst = pw->sp_lstchg;
-			r.chg_allow = pw->sp_min;
-			r.chg_req = pw->sp_max;
-			r.exp_warn = pw->sp_warn;
-			r.exp_inact = pw->sp_inact;
-			r.exp_date = pw->sp_expire;
-			r.flag = pw->sp_flag;
-
-			report_finding(&r, ctx);
+	struct result_info r;
+
+	r.username = sp->name;
+	r.password = sp->passwd;
+	r.chg_lst = sp->lstchg;
+	r.chg_allow = sp->min;
+	r.chg_req = sp->max;
+	r.exp_warn = sp->warn;
+	r.exp_inact = sp->inact;
+	r.exp_date = sp->expire;
+	r.flag = sp->flag;
+
+	report_finding(&r, ctx);
+}
+
+static int read_shadow(SEXP_t *un_ent, struct account_db *db, probe_ctx *ctx)
+{
+	const struct account_db_shadow *sp, **found;
+	size_t sp_count;
+	SEXP_t *un;
+
+	/* A single user can be looked up by name */
+	if (probe_ent_getoperation(un_ent, OVAL_OPERATION_EQUALS) == OVAL_OPERATION_EQUALS &&
+	    !probe_ent_attrexists(un_ent, "var_ref") &&
+	    (un = probe_ent_getval(un_ent)) != NULL) {
+		char *username = SEXP_string_cstr(un);
+
+		SEXP_free(un);
+		if (username != NULL) {
+			found = account_db_find_shadow(db, username, &sp_count);
+			for (size_t i = 0; i < sp_count; ++i)
+				report_account(found[i], ctx);
+			free(username);
+			return 0;
 		}
+	}
+
+	sp = account_db_get_shadow(db, &sp_count);
+	for (size_t i = 0; i < sp_count; ++i) {
+		dI("Have user: %s", sp[i].name);
+		un = SEXP_string_newf("%s", sp[i].name);
+		if (probe_entobj_cmp(un_ent, un) == OVAL_RESULT_TRUE)
+			report_account(&sp[i], ctx);
 		SEXP_free(un);
 	}
-	endspent();
-	return err;
+	return sp_count == 0 ? 1 : 0;
+}
+
+int probe_offline_mode_supported(void)
+{
+	return PROBE_OFFLINE_OWN;
+}
+
+void *probe_init(void)
+{
+	return account_db_new(getenv("OSCAP_PROBE_ROOT"), ACCOUNT_DB_SHADOW);
+}
+
+/* Reloaded on every reset of the probe, the accounts may have changed */
+void *probe_reset(void *arg)
+{
+	account_db_free(arg);
+	return probe_init();
+}
+
+void probe_fini(void *arg)
+{
+	account_db_free(arg);
 }
 
 int probe_main(probe_ctx *ctx, void *arg)
 {
 	SEXP_t *ent, *obj;
 
+	if (arg == NULL)
+		return PROBE_EINIT;
+
 	obj = probe_ctx_getobject(ctx);
 	over = probe_obj_get_platform_schema_version(obj);
 	ent = probe_obj_getent(obj, "username", 1);
@@ -221,7 +265,7 @@ int probe_main(probe_ctx *ctx, void *arg)
 	}
 
 	// Now we check the file...
-	read_shadow(ent, ctx);
+	read_shadow(ent, arg, ctx);
 	SEXP_free(ent);
 
 	return 0;
@@ -36,30 +36,319 @@
 #if defined(__linux__)
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
 #include "oval_fts.h"
+#include "SEAP/generic/rbt/rbt.h"
 #include "common/debug_priv.h"
 #include "common/assume.h"
 
 #define PROC_SYS_DIR "/proc/sys"
 #define PROC_SYS_MAXDEPTH 7
+#define SYSCTL_VALUE_MAX 8192
 
-int probe_main(probe_ctx *ctx, void *probe_arg)
+struct sysctl_entry {
+	char *name;   ///< MIB name, e.g. "net.ipv4.ip_forward"
+	char *value;  ///< Raw value as read from /proc/sys, NULL if it couldn't be read
+	long length;  ///< Length of the value
+};
+
+/*
+ * All readable sysctls are read at once when the first object is evaluated.
+ * Further objects are answered from this snapshot by a lookup of the name or
+ * by matching the names of all entries. A reset of the probe drops the
+ * snapshot and the next object reads the values again.
+ */
+struct sysctl_snapshot {
+	pthread_mutex_t mutex;
+	bool loaded;
+	struct sysctl_entry *entries;
+	size_t count;
+	rbt_t *index;
+};
+
+static int sysctl_snapshot_read(struct sysctl_snapshot *snapshot, const char *mibpath, const OVAL_FTSENT *ofts_ent)
+{
+	const char *ipv6_conf_path = "/proc/sys/net/ipv6/conf/";
+	size_t ipv6_conf_path_len = strlen(ipv6_conf_path);
+	struct sysctl_entry *entry;
+	struct stat file_stat;
+	char sysval[SYSCTL_VALUE_MAX];
+	char *mib;
+	size_t miblen;
+	long l = 0;
+	FILE *fp;
+
+	/* Skip write-only files, eg. /proc/sys/net/ipv4/route/flush */
+	if (stat(mibpath, &file_stat) == -1) {
+		dE("Stat failed on %s: %u, %s", mibpath, errno, strerror(errno));
+		return (0);
+	}
+	/* the sysctl utility uses same condition in sysctl.c in ReadSetting() */
+	if ((file_stat.st_mode & S_IRUSR) == 0) {
+		dI("Skipping write-only file %s", mibpath);
+		return (0);
+	}
+
+	/*
+	 * read sysctl value
+	 */
+	fp = fopen(mibpath, "r");
+
+	if (fp == NULL) {
+		dE("Can't read sysctl value from \"%s\": %u, %s",
+		   mibpath, errno, strerror(errno));
+		l = -1;
+	} else {
+		l = fread(sysval, 1, sizeof sysval - 1, fp);
+
+		if (ferror(fp)) {
+			/* Linux 4.1.0 introduced a per-NIC IPv6 stable_secret file.
+			 * The stable_secret file cannot be read until it is set,
+			 * so we skip it when it is not readable. Otherwise we collect it.
+			 */
+			if (strncmp(ofts_ent->path, ipv6_conf_path, ipv6_conf_path_len) == 0 &&
+					strcmp(ofts_ent->file, "stable_secret") == 0) {
+				dI("Skipping file %s", mibpath);
+				fclose(fp);
+				return (0);
+			}
+			dE("An error ocured when reading from \"%s\" (fp=%p): l=%ld, %u, %s",
+				mibpath, fp, l, errno, strerror(errno));
+			l = -1;
+		}
+
+		fclose(fp);
+	}
+
+	/* Skip empty values as sysctl tool does.
+	 * See https://bugzilla.redhat.com/show_bug.cgi?id=1473207
+	 */
+	if (l == 0) {
+		dI("Skipping file '%s' because it has no value.", mibpath);
+		return (0);
+	}
+
+	mib    = strdup(mibpath + strlen(PROC_SYS_DIR) + 1);
+	miblen = strlen(mib);
+
+	while (miblen > 0) {
+		if(mib[miblen - 1] == '/')
+			mib[miblen - 1] = '.';
+		--miblen;
+	}
+
+	dI("MIB: %s", mib);
+
+	if (snapshot->count % 256 == 0)
+		snapshot->entries = realloc(snapshot->entries, sizeof(struct sysctl_entry) * (snapshot->count + 256));
+
+	entry = &snapshot->entries[snapshot->count++];
+	entry->name = mib;
+	entry->length = l;
+	entry->value = NULL;
+
+	if (l > 0) {
+		entry->value = malloc(l);
+		memcpy(entry->value, sysval, l);
+	}
+
+	return (0);
+}
+
+static int sysctl_snapshot_load(struct sysctl_snapshot *snapshot, SEXP_t *result)
+{
+	OVAL_FTS    *ofts;
+	OVAL_FTSENT *ofts_ent;
+	SEXP_t *r0, *r1, *r2, *r3;
+	SEXP_t *ent_attrs, *bh_entity, *path_entity, *filename_entity;
+
+	/*
+	 * prepare behaviors
+	 */
+	ent_attrs = probe_attr_creat("max_depth",           r0 = SEXP_string_newf("%d", PROC_SYS_MAXDEPTH),
+	                             "recurse_direction",   r1 = SEXP_string_new("down", 4),
+	                             "recurse_file_system", r2 = SEXP_string_new("local", 7),
+	                             "recurse", r3 = SEXP_string_new("symlinks and directories", 24),
+	                             NULL);
+	bh_entity = probe_ent_creat1("behaviors", ent_attrs, NULL);
+	SEXP_vfree(r0, r1, r2, r3, ent_attrs, NULL);
+
+	/*
+	 * prepare path, filename
+	 */
+	ent_attrs = probe_attr_creat("operation", r0 = SEXP_number_newi(OVAL_OPERATION_EQUALS),
+	                             NULL);
+	path_entity = probe_ent_creat1("path", ent_attrs, r1 = SEXP_string_new(PROC_SYS_DIR, strlen(PROC_SYS_DIR)));
+	SEXP_vfree(r0, r1, NULL);
+
+	ent_attrs = probe_attr_creat("operation", r0 = SEXP_number_newi(OVAL_OPERATION_PATTERN_MATCH),
+	                             NULL);
+	filename_entity = probe_ent_creat1("filename", ent_attrs, r1 = SEXP_string_new(".*", 2));
+	SEXP_vfree(r0, r1, ent_attrs, NULL);
+
+	ofts = oval_fts_open_prefixed(NULL, path_entity, filename_entity, NULL, bh_entity, result);
+
+	if (ofts == NULL) {
+		dE("oval_fts_open_prefixed(%s, %s) failed", PROC_SYS_DIR, ".\\+");
+		SEXP_vfree(path_entity, filename_entity, bh_entity, NULL);
+
+		return (-1);
+	}
+
+	while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
+		char mibpath[PATH_MAX];
+
+		snprintf(mibpath, sizeof mibpath, "%s/%s", ofts_ent->path, ofts_ent->file);
+		sysctl_snapshot_read(snapshot, mibpath, ofts_ent);
+		oval_ftsent_free(ofts_ent);
+	}
+
+	oval_fts_close(ofts);
+	SEXP_vfree(path_entity, filename_entity, bh_entity, NULL);
+
+	/* The first entry of a name wins, the same as when walking the tree */
+	for (size_t i = 0; i < snapshot->count; ++i)
+		rbt_str_add(snapshot->index, snapshot->entries[i].name, &snapshot->entries[i]);
+
+	snapshot->loaded = true;
+	dI("Sysctl snapshot: %zu entries.", snapshot->count);
+
+	return (0);
+}
+
+static void sysctl_collect(probe_ctx *ctx, const struct sysctl_entry *entry, SEXP_t *se_mib, int over_cmp)
+{
+	SEXP_t *item;
+	char    sysval[SYSCTL_VALUE_MAX];
+	char   *sysvals[512];
+	long i, l;
+	size_t s;
+
+	dI("MIB match");
+
+	if (entry->value == NULL) {
+		item = probe_item_creat("sysctl_item", NULL, NULL);
+		probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
+		probe_item_collect(ctx, item);
+		return;
+	}
+
+	l = entry->length;
+	memcpy(sysval, entry->value, l);
+
+	/*
+	 * sanitize the value
+	 *  - only printable and whitespace chars allowed
+	 *  - remove the last '\n'
+	 */
+	sysvals[0] = sysval;
+
+	for(s = 0, i = 0; i < l && s < sizeof sysvals/sizeof(char *) - 1; ++i) {
+		if ((!isprint(sysval[i]) && !isspace(sysval[i]))
+		    || (over_cmp >= 0 && sysval[i] == '\n' /* OVAL 5.10 and above */))
+		{
+			sysval[i] = '\0';
+			sysvals[++s] = sysval + i + 1;
+		}
+	}
+
+	if (sysval[l - 1] == '\n')
+		sysval[l - 1] = '\0';
+	else
+		sysval[l] = '\0';
+
+	if (strlen(sysvals[s]) == 0)
+		sysvals[s] = NULL;
+	else
+		sysvals[++s] = NULL;
+
+	if (over_cmp >= 0) {
+		/* Only in OVAL 5.10 and above */
+		item = probe_item_create(OVAL_UNIX_SYSCTL, NULL,
+		                         "name",  OVAL_DATATYPE_SEXP,   se_mib,
+		                         "value", OVAL_DATATYPE_STRING_M, sysvals,
+		                         NULL);
+	} else {
+		item = probe_item_create(OVAL_UNIX_SYSCTL, NULL,
+		                         "name",  OVAL_DATATYPE_SEXP,   se_mib,
+		                         "value", OVAL_DATATYPE_STRING, sysval,
+		                         NULL);
+	}
+
+	probe_item_collect(ctx, item);
+}
+
+static void sysctl_index_free_cb(struct rbt_str_node *node)
 {
-        OVAL_FTS    *ofts;
-        OVAL_FTSENT *ofts_ent;
+	/* Keys are owned by the entries */
+	(void)node;
+}
+
+static void sysctl_snapshot_clear(struct sysctl_snapshot *snapshot)
+{
+	rbt_str_free_cb(snapshot->index, sysctl_index_free_cb);
+	for (size_t i = 0; i < snapshot->count; ++i) {
+		free(snapshot->entries[i].name);
+		free(snapshot->entries[i].value);
+	}
+	free(snapshot->entries);
+
+	snapshot->index = NULL;
+	snapshot->entries = NULL;
+	snapshot->count = 0;
+	snapshot->loaded = false;
+}
 
-        SEXP_t *name_entity, *probe_in;
-        SEXP_t *r0, *r1, *r2, *r3;
-        SEXP_t *ent_attrs, *bh_entity, *path_entity, *filename_entity;
+void *probe_init(void)
+{
+	struct sysctl_snapshot *snapshot = calloc(1, sizeof(struct sysctl_snapshot));
+
+	pthread_mutex_init(&snapshot->mutex, NULL);
+	snapshot->index = rbt_str_new();
+
+	return (snapshot);
+}
+
+void *probe_reset(void *probe_arg)
+{
+	struct sysctl_snapshot *snapshot = probe_arg;
+
+	if (snapshot != NULL) {
+		sysctl_snapshot_clear(snapshot);
+		snapshot->index = rbt_str_new();
+	}
+
+	return (snapshot);
+}
+
+void probe_fini(void *probe_arg)
+{
+	struct sysctl_snapshot *snapshot = probe_arg;
+
+	if (snapshot == NULL)
+		return;
+
+	sysctl_snapshot_clear(snapshot);
+	pthread_mutex_destroy(&snapshot->mutex);
+	free(snapshot);
+}
+
+int probe_main(probe_ctx *ctx, void *probe_arg)
+{
+        struct sysctl_snapshot *snapshot = probe_arg;
+        SEXP_t *name_entity, *probe_in, *se_mib;
         oval_schema_version_t over;
-        int over_cmp;
+        int over_cmp, ret;
+        char *name = NULL;
 
-	const char *ipv6_conf_path = "/proc/sys/net/ipv6/conf/";
-	size_t ipv6_conf_path_len = strlen(ipv6_conf_path);
+        if (snapshot == NULL)
+                return (PROBE_EINIT);
 
         probe_in    = probe_ctx_getobject(ctx);
         name_entity = probe_obj_getent(probe_in, "name", 1);
@@ -71,187 +360,51 @@ int probe_main(probe_ctx *ctx, void *probe_arg)
                 return (PROBE_ENOENT);
         }
 
-        /*
-         * prepare behaviors
-         */
-        ent_attrs = probe_attr_creat("max_depth",           r0 = SEXP_string_newf("%d", PROC_SYS_MAXDEPTH),
-                                     "recurse_direction",   r1 = SEXP_string_new("down", 4),
-                                     "recurse_file_system", r2 = SEXP_string_new("local", 7),
-                                     "recurse", r3 = SEXP_string_new("symlinks and directories", 24),
-                                     NULL);
-        bh_entity = probe_ent_creat1("behaviors", ent_attrs, NULL);
-        SEXP_vfree(r0, r1, r2, r3, ent_attrs, NULL);
+        pthread_mutex_lock(&snapshot->mutex);
+        ret = snapshot->loaded ? 0 : sysctl_snapshot_load(snapshot, probe_ctx_getresult(ctx));
+        pthread_mutex_unlock(&snapshot->mutex);
 
-        /*
-         * prepare path, filename
-         */
-        ent_attrs = probe_attr_creat("operation", r0 = SEXP_number_newi(OVAL_OPERATION_EQUALS),
-                                     NULL);
-        path_entity = probe_ent_creat1("path", ent_attrs, r1 = SEXP_string_new(PROC_SYS_DIR, strlen(PROC_SYS_DIR)));
-        SEXP_vfree(r0, r1, NULL);
-
-        ent_attrs = probe_attr_creat("operation", r0 = SEXP_number_newi(OVAL_OPERATION_PATTERN_MATCH),
-                                     NULL);
-        filename_entity = probe_ent_creat1("filename", ent_attrs, r1 = SEXP_string_new(".*", 2));
-        SEXP_vfree(r0, r1, ent_attrs, NULL);
+        if (ret != 0) {
+                SEXP_free(name_entity);
+                return (PROBE_EFATAL);
+        }
 
         /*
          * collect sysctls
-         *  XXX: use direct access for the "equals" op
          */
-        ofts = oval_fts_open_prefixed(NULL, path_entity, filename_entity, NULL, bh_entity, probe_ctx_getresult(ctx));
-
-        if (ofts == NULL) {
-                dE("oval_fts_open_prefixed(%s, %s) failed", PROC_SYS_DIR, ".\\+");
-                SEXP_vfree(path_entity, filename_entity, bh_entity, name_entity, NULL);
-
-                return (PROBE_EFATAL);
+        if (probe_ent_getoperation(name_entity, OVAL_OPERATION_EQUALS) == OVAL_OPERATION_EQUALS &&
+            !probe_ent_attrexists(name_entity, "var_ref") &&
+            (se_mib = probe_ent_getval(name_entity)) != NULL) {
+                if (SEXP_stringp(se_mib))
+                        name = SEXP_string_cstr(se_mib);
+                SEXP_free(se_mib);
         }
 
-        while ((ofts_ent = oval_fts_read(ofts)) != NULL) {
-                SEXP_t *se_mib;
-                char    mibpath[PATH_MAX], *mib;
-                size_t  miblen;
-		struct stat file_stat;
-
-                snprintf(mibpath, sizeof mibpath, "%s/%s", ofts_ent->path, ofts_ent->file);
+        if (name != NULL) {
+                /* A single sysctl can be looked up by name */
+                struct sysctl_entry *entry = NULL;
 
-		/* Skip write-only files, eg. /proc/sys/net/ipv4/route/flush */
-		if (stat(mibpath, &file_stat) == -1) {
-			dE("Stat failed on %s: %u, %s", mibpath, errno, strerror(errno));
-			oval_ftsent_free(ofts_ent);
-			continue;
-		}
-		/* the sysctl utility uses same condition in sysctl.c in ReadSetting() */
-		if ((file_stat.st_mode & S_IRUSR) == 0) {
-			dI("Skipping write-only file %s", mibpath);
-			oval_ftsent_free(ofts_ent);
-			continue;
-		}
+                if (rbt_str_get(snapshot->index, name, (void **)&entry) == 0) {
+                        se_mib = SEXP_string_new(entry->name, strlen(entry->name));
+                        sysctl_collect(ctx, entry, se_mib, over_cmp);
+                        SEXP_free(se_mib);
+                }
 
-                mib    = strdup(mibpath + strlen(PROC_SYS_DIR) + 1);
-                miblen = strlen(mib);
+                free(name);
+        } else {
+                for (size_t i = 0; i < snapshot->count; ++i) {
+                        const struct sysctl_entry *entry = &snapshot->entries[i];
 
-                while (miblen > 0) {
-                        if(mib[miblen - 1] == '/')
-                                mib[miblen - 1] = '.';
-                        --miblen;
-                }
+                        se_mib = SEXP_string_new(entry->name, strlen(entry->name));
 
-                dI("MIB: %s", mib);
-                se_mib = SEXP_string_new(mib, strlen(mib));
-                free(mib);
-
-                if (probe_entobj_cmp(name_entity, se_mib) == OVAL_RESULT_TRUE) {
-                        FILE   *fp;
-                        SEXP_t *item;
-                        char    sysval[8192];
-                        char   *sysvals[512];
-                        long i, l;
-                        size_t s;
-
-                        dI("MIB match");
-
-                        /*
-                         * read sysctl value
-                         */
-                        fp = fopen(mibpath, "r");
-
-                        if (fp == NULL) {
-                                dE("Can't read sysctl value from \"%s\": %u, %s",
-                                   mibpath, errno, strerror(errno));
-                                goto fail_item;
-                        }
-
-                        l = fread(sysval, 1, sizeof sysval - 1, fp);
-
-                        if (ferror(fp)) {
-				/* Linux 4.1.0 introduced a per-NIC IPv6 stable_secret file.
-				 * The stable_secret file cannot be read until it is set,
-				 * so we skip it when it is not readable. Otherwise we collect it.
-				 */
-				if (strncmp(ofts_ent->path, ipv6_conf_path, ipv6_conf_path_len) == 0 &&
-						strcmp(ofts_ent->file, "stable_secret") == 0) {
-					dI("Skipping file %s", mibpath);
-					oval_ftsent_free(ofts_ent);
-					SEXP_free(se_mib);
-					fclose(fp);
-					continue;
-				} else {
-					dE("An error ocured when reading from \"%s\" (fp=%p): l=%ld, %u, %s",
-						mibpath, fp, l, errno, strerror(errno));
-					goto fail_item;
-				}
-                        }
-
-                        fclose(fp);
-
-			/* Skip empty values as sysctl tool does.
-			 * See https://bugzilla.redhat.com/show_bug.cgi?id=1473207
-			 */
-			if (l == 0) {
-				dI("Skipping file '%s' because it has no value.", mibpath);
-				oval_ftsent_free(ofts_ent);
-				SEXP_free(se_mib);
-				continue;
-			}
+                        if (probe_entobj_cmp(name_entity, se_mib) == OVAL_RESULT_TRUE)
+                                sysctl_collect(ctx, entry, se_mib, over_cmp);
 
-                        /*
-                         * sanitize the value
-                         *  - only printable and whitespace chars allowed
-                         *  - remove the last '\n'
-                         */
-                        sysvals[0] = sysval;
-
-                        for(s = 0, i = 0; i < l && s < sizeof sysvals/sizeof(char *) - 1; ++i) {
-	                        if ((!isprint(sysval[i]) && !isspace(sysval[i]))
-	                            || (over_cmp >= 0 && sysval[i] == '\n' /* OVAL 5.10 and above */))
-                                {
-                                        sysval[i] = '\0';
-                                        sysvals[++s] = sysval + i + 1;
-                                }
-                        }
-
-                        if (sysval[l - 1] == '\n')
-                                sysval[l - 1] = '\0';
-                        else
-                                sysval[l] = '\0';
-
-                        if (strlen(sysvals[s]) == 0)
-                                sysvals[s] = NULL;
-                        else
-                                sysvals[++s] = NULL;
-
-                        if (over_cmp >= 0) {
-	                        /* Only in OVAL 5.10 and above */
-	                        item = probe_item_create(OVAL_UNIX_SYSCTL, NULL,
-	                                                 "name",  OVAL_DATATYPE_SEXP,   se_mib,
-	                                                 "value", OVAL_DATATYPE_STRING_M, sysvals,
-	                                                 NULL);
-                        } else {
-	                        item = probe_item_create(OVAL_UNIX_SYSCTL, NULL,
-	                                                 "name",  OVAL_DATATYPE_SEXP,   se_mib,
-	                                                 "value", OVAL_DATATYPE_STRING, sysval,
-	                                                 NULL);
-                        }
-
-                        goto add_item;
-                fail_item:
-                        if (fp != NULL)
-                                fclose(fp);
-
-                        item = probe_item_creat("sysctl_item", NULL, NULL);
-                        probe_item_setstatus(item, SYSCHAR_STATUS_ERROR);
-                add_item:
-                        probe_item_collect(ctx, item);
+                        SEXP_free(se_mib);
                 }
-
-                oval_ftsent_free(ofts_ent);
-                SEXP_free(se_mib);
         }
 
-        oval_fts_close(ofts);
-	SEXP_vfree(path_entity, filename_entity, bh_entity, name_entity);
+	SEXP_free(name_entity);
 
         return (0);
 }
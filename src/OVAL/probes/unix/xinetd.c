@@ -1601,6 +1601,13 @@ void *probe_init(void)
 	return xiconf_parse(XINETD_CONFPATH, XINETD_CONFDEPTH);
 }
 
+void *probe_reset(void *arg)
+{
+	if (arg != NULL)
+		xiconf_free(arg);
+	return probe_init();
+}
+
 void probe_fini(void *arg)
 {
 	if (arg != NULL)
@@ -2632,7 +2632,7 @@ void oval_state_content_iterator_free(struct oval_state_content_iterator *);
 /**
  * @memberof oval_value
  */
-struct oval_value *oval_value_new(oval_datatype_t datatype, char *text_value);
+struct oval_value *oval_value_new(oval_datatype_t datatype, const char *text_value);
 /**
  * @return A copy of the specified @ref oval_value.
  * @memberof oval_value
@@ -2866,7 +2866,7 @@ void oval_record_field_set_name(struct oval_record_field *, char *);
 /**
  * @memberof oval_record_field
  */
-void oval_record_field_set_value(struct oval_record_field *, char *);
+void oval_record_field_set_value(struct oval_record_field *, const char *);
 /**
  * @memberof oval_record_field
  */
@@ -736,7 +736,7 @@ void oval_sysent_set_name(struct oval_sysent *sysent, char *name);
 /**
  * @memberof oval_sysent
  */
-void oval_sysent_set_value(struct oval_sysent *sysent, char *value);
+void oval_sysent_set_value(struct oval_sysent *sysent, const char *value);
 /**
  * @memberof oval_sysent
  */
@@ -763,13 +763,13 @@ void oval_sysent_set_mask(struct oval_sysent *sysent, int mask);
  * Get system data item name.
  * @memberof oval_sysent
  */
-char *oval_sysent_get_name(struct oval_sysent *);
+const char *oval_sysent_get_name(struct oval_sysent *);
 
 /**
  * Get system data item value.
  * @memberof oval_sysent
  */
-char *oval_sysent_get_value(struct oval_sysent *);
+const char *oval_sysent_get_value(struct oval_sysent *);
 
 /**
  * @memberof oval_sysent
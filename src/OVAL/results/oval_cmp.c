@@ -28,6 +28,7 @@
 #include <config.h>
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 #include <arpa/inet.h>
@@ -162,3 +163,130 @@ oval_result_t oval_ent_cmp_str(char *state_data, oval_datatype_t state_data_type
 	const char *sys_data = oval_sysent_get_value(sysent);
 	return oval_str_cmp_str(state_data, state_data_type, sys_data, operation);
 }
+
+struct oval_cmp_value {
+	char *text;                  ///< value as defined by state, not owned
+	oval_datatype_t datatype;
+	oval_operation_t operation;
+	bool parsed;                 ///< false if the comparison falls back to oval_str_cmp_str
+	union {
+		intmax_t integer;
+		double real;
+		bool boolean;
+		struct oval_regex *regex;
+		struct oval_evr *evr;
+		struct oval_ipaddr *ipaddr;
+	} val;
+};
+
+struct oval_cmp_value *oval_cmp_value_new(char *state_data, oval_datatype_t state_data_type, oval_operation_t operation)
+{
+	struct oval_cmp_value *value = calloc(1, sizeof(struct oval_cmp_value));
+	value->text = state_data;
+	value->datatype = state_data_type;
+	value->operation = operation;
+
+	/* A state value which cannot be parsed is left to oval_str_cmp_str
+	 * to report the error on each comparison as before. */
+	switch (state_data_type) {
+	case OVAL_DATATYPE_STRING:
+		if (operation == OVAL_OPERATION_PATTERN_MATCH)
+			value->parsed = (value->val.regex = oval_regex_compile(state_data)) != NULL;
+		else
+			value->parsed = true;
+		break;
+	case OVAL_DATATYPE_INTEGER:
+		value->parsed = cstr_to_intmax(state_data, &value->val.integer);
+		break;
+	case OVAL_DATATYPE_FLOAT:
+		value->parsed = cstr_to_double(state_data, &value->val.real);
+		break;
+	case OVAL_DATATYPE_BOOLEAN:
+		value->val.boolean = strcmp(state_data, "true") == 0 || strcmp(state_data, "1") == 0;
+		value->parsed = true;
+		break;
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		value->val.evr = oval_evr_new(state_data);
+		value->parsed = true;
+		break;
+	case OVAL_DATATYPE_IPV4ADDR:
+		value->parsed = (value->val.ipaddr = oval_ipaddr_new(AF_INET, state_data)) != NULL;
+		break;
+	case OVAL_DATATYPE_IPV6ADDR:
+		value->parsed = (value->val.ipaddr = oval_ipaddr_new(AF_INET6, state_data)) != NULL;
+		break;
+	default:
+		break;
+	}
+	return value;
+}
+
+void oval_cmp_value_free(struct oval_cmp_value *value)
+{
+	if (value == NULL)
+		return;
+	if (value->parsed) {
+		switch (value->datatype) {
+		case OVAL_DATATYPE_STRING:
+			oval_regex_free(value->val.regex);
+			break;
+		case OVAL_DATATYPE_EVR_STRING:
+		case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+			oval_evr_free(value->val.evr);
+			break;
+		case OVAL_DATATYPE_IPV4ADDR:
+		case OVAL_DATATYPE_IPV6ADDR:
+			oval_ipaddr_free(value->val.ipaddr);
+			break;
+		default:
+			break;
+		}
+	}
+	free(value);
+}
+
+oval_result_t oval_cmp_value_cmp_str(const struct oval_cmp_value *value, const char *sys_data)
+{
+	if (!value->parsed)
+		return oval_str_cmp_str(value->text, value->datatype, sys_data, value->operation);
+
+	switch (value->datatype) {
+	case OVAL_DATATYPE_STRING:
+		if (value->operation == OVAL_OPERATION_PATTERN_MATCH)
+			return oval_regex_match(value->val.regex, sys_data ? sys_data : "");
+		return oval_string_cmp(value->text, sys_data, value->operation);
+	case OVAL_DATATYPE_INTEGER: {
+		intmax_t syschar_val;
+		if (!cstr_to_intmax(sys_data, &syschar_val)) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL,
+				"Conversion of the string \"%s\" to an integer (%u bits) failed: %s",
+				sys_data, sizeof(intmax_t)*8, strerror(errno));
+			return OVAL_RESULT_ERROR;
+		}
+		return oval_int_cmp(value->val.integer, syschar_val, value->operation);
+	}
+	case OVAL_DATATYPE_FLOAT: {
+		double sys_val;
+		if (!cstr_to_double(sys_data, &sys_val)) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL,
+				"Conversion of the string \"%s\" to a floating type (double) failed: %s",
+				sys_data, strerror(errno));
+			return OVAL_RESULT_ERROR;
+		}
+		return oval_float_cmp(value->val.real, sys_val, value->operation);
+	}
+	case OVAL_DATATYPE_BOOLEAN: {
+		int sys_int = (((strcmp(sys_data, "true")) == 0) || ((strcmp(sys_data, "1")) == 0)) ? 1 : 0;
+		return oval_boolean_cmp(value->val.boolean, sys_int, value->operation);
+	}
+	case OVAL_DATATYPE_EVR_STRING:
+	case OVAL_DATATYPE_DEBIAN_EVR_STRING:
+		return oval_evr_string_cmp_evr(value->val.evr, sys_data, value->operation);
+	case OVAL_DATATYPE_IPV4ADDR:
+	case OVAL_DATATYPE_IPV6ADDR:
+		return oval_ipaddr_cmp_ipaddr(value->val.ipaddr, sys_data, value->operation);
+	default:
+		return oval_str_cmp_str(value->text, value->datatype, sys_data, value->operation);
+	}
+}
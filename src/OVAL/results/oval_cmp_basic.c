@@ -26,6 +26,7 @@
 #endif
 
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #if defined USE_REGEX_PCRE
 #include <pcre.h>
@@ -124,23 +125,50 @@ static int istrcmp(const char *st1, const char *st2)
 	return strcasecmp(st1, st2);
 }
 
-static oval_result_t strregcomp(const char *pattern, const char *test_str)
-{
-	int ret;
-	oval_result_t result = OVAL_RESULT_ERROR;
+struct oval_regex {
 #if defined USE_REGEX_PCRE
 	pcre *re;
+#elif defined USE_REGEX_POSIX
+	regex_t re;
+#endif
+};
+
+struct oval_regex *oval_regex_compile(const char *pattern)
+{
+#if defined USE_REGEX_PCRE
 	const char *err;
 	int errofs;
 
-	re = pcre_compile(pattern, PCRE_UTF8, &err, &errofs, NULL);
+	pcre *re = pcre_compile(pattern, PCRE_UTF8, &err, &errofs, NULL);
 	if (re == NULL) {
 		dE("Unable to compile regex pattern, "
 			       "pcre_compile() returned error (offset: %d): '%s'.\n", errofs, err);
-		return OVAL_RESULT_ERROR;
+		return NULL;
 	}
+	struct oval_regex *regex = malloc(sizeof(struct oval_regex));
+	regex->re = re;
+	return regex;
+#elif defined USE_REGEX_POSIX
+	struct oval_regex *regex = malloc(sizeof(struct oval_regex));
+	int ret = regcomp(&regex->re, pattern, REG_EXTENDED);
+	if (ret != 0) {
+		dE("Unable to compile regex pattern, "
+			       "regcomp() returned error: %d.\n", ret);
+		free(regex);
+		return NULL;
+	}
+	return regex;
+#else
+	return NULL;
+#endif
+}
 
-	ret = pcre_exec(re, NULL, test_str, strlen(test_str), 0, 0, NULL, 0);
+oval_result_t oval_regex_match(const struct oval_regex *regex, const char *test_str)
+{
+	int ret;
+	oval_result_t result = OVAL_RESULT_ERROR;
+#if defined USE_REGEX_PCRE
+	ret = pcre_exec(regex->re, NULL, test_str, strlen(test_str), 0, 0, NULL, 0);
 	if (ret > -1 ) {
 		result = OVAL_RESULT_TRUE;
 	} else if (ret == -1) {
@@ -150,19 +178,8 @@ static oval_result_t strregcomp(const char *pattern, const char *test_str)
 			       "pcre_exec() returned error: %d.\n", ret);
 		result = OVAL_RESULT_ERROR;
 	}
-
-	pcre_free(re);
 #elif defined USE_REGEX_POSIX
-	regex_t re;
-
-	ret = regcomp(&re, pattern, REG_EXTENDED);
-	if (ret != 0) {
-		dE("Unable to compile regex pattern, "
-			       "regcomp() returned error: %d.\n", ret);
-		return OVAL_RESULT_ERROR;
-	}
-
-	ret = regexec(&re, test_str, 0, NULL, 0);
+	ret = regexec(&regex->re, test_str, 0, NULL, 0);
 	if (ret == 0) {
 		result = OVAL_RESULT_TRUE;
 	} else if (ret == REG_NOMATCH) {
@@ -171,9 +188,29 @@ static oval_result_t strregcomp(const char *pattern, const char *test_str)
 		dE("Unable to match regex pattern: %d.", ret);
 		result = OVAL_RESULT_ERROR;
 	}
+#endif
+	return result;
+}
 
-	regfree(&re);
+void oval_regex_free(struct oval_regex *regex)
+{
+	if (regex == NULL)
+		return;
+#if defined USE_REGEX_PCRE
+	pcre_free(regex->re);
+#elif defined USE_REGEX_POSIX
+	regfree(&regex->re);
 #endif
+	free(regex);
+}
+
+static oval_result_t strregcomp(const char *pattern, const char *test_str)
+{
+	struct oval_regex *regex = oval_regex_compile(pattern);
+	if (regex == NULL)
+		return OVAL_RESULT_ERROR;
+	oval_result_t result = oval_regex_match(regex, test_str);
+	oval_regex_free(regex);
 	return result;
 }
 
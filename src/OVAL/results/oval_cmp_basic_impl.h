@@ -39,6 +39,25 @@ oval_result_t oval_string_cmp(const char *state, const char *syschar, oval_opera
 
 oval_result_t oval_binary_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
+/**
+ * Regular expression compiled for repeated matching, see OVAL_OPERATION_PATTERN_MATCH
+ */
+struct oval_regex;
+
+/**
+ * Compile the regular expression
+ * @returns compiled regular expression or NULL if the pattern is invalid
+ */
+struct oval_regex *oval_regex_compile(const char *pattern);
+
+/**
+ * Match the string against the compiled regular expression
+ * @returns OVAL_RESULT_TRUE if it matches, OVAL_RESULT_FALSE if it does not
+ */
+oval_result_t oval_regex_match(const struct oval_regex *regex, const char *test_str);
+
+void oval_regex_free(struct oval_regex *regex);
+
 OSCAP_HIDDEN_END;
 
 #endif
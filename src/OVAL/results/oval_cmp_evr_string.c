@@ -53,10 +53,15 @@ static inline int rpmevrcmp(const char *a, const char *b);
 static int compare_values(const char *str1, const char *str2);
 static void parseEVR(char *evr, const char **ep, const char **vp, const char **rp);
 
-oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
-{
-	int result = rpmevrcmp(sys, state);
+struct oval_evr {
+	char *buffer;
+	const char *epoch;
+	const char *version;
+	const char *release;
+};
 
+static oval_result_t _evr_cmp_result(int result, oval_operation_t operation)
+{
 	if (operation == OVAL_OPERATION_EQUALS) {
 		return ((result == 0) ? OVAL_RESULT_TRUE : OVAL_RESULT_FALSE);
 	} else if (operation == OVAL_OPERATION_NOT_EQUAL) {
@@ -75,30 +80,68 @@ oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_opera
 	return OVAL_RESULT_ERROR;
 }
 
+oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation)
+{
+	return _evr_cmp_result(rpmevrcmp(sys, state), operation);
+}
+
+struct oval_evr *oval_evr_new(const char *evr)
+{
+	struct oval_evr *parsed = malloc(sizeof(struct oval_evr));
+	parsed->buffer = oscap_strdup(evr);
+	parseEVR(parsed->buffer, &parsed->epoch, &parsed->version, &parsed->release);
+	return parsed;
+}
+
+void oval_evr_free(struct oval_evr *evr)
+{
+	if (evr == NULL)
+		return;
+	free(evr->buffer);
+	free(evr);
+}
+
+static int _evr_cmp(const char *a_epoch, const char *a_version, const char *a_release,
+		const struct oval_evr *b)
+{
+	int result = compare_values(a_epoch, b->epoch);
+	if (!result) {
+		result = compare_values(a_version, b->version);
+		if (!result)
+			result = compare_values(a_release, b->release);
+	}
+	return result;
+}
+
+oval_result_t oval_evr_string_cmp_evr(const struct oval_evr *state, const char *sys, oval_operation_t operation)
+{
+	const char *sys_epoch, *sys_version, *sys_release;
+	char *sys_copy = oscap_strdup(sys);
+	parseEVR(sys_copy, &sys_epoch, &sys_version, &sys_release);
+	int result = _evr_cmp(sys_epoch, sys_version, sys_release, state);
+	free(sys_copy);
+	return _evr_cmp_result(result, operation);
+}
+
 static inline int rpmevrcmp(const char *a, const char *b)
 {
 	/* This mimics rpmevrcmp which is not exported by rpmlib version 4.
 	 * Code inspired by rpm.labelCompare() from rpm4/python/header-py.c
 	 */
 	const char *a_epoch, *a_version, *a_release;
-	const char *b_epoch, *b_version, *b_release;
-	char *a_copy, *b_copy;
+	struct oval_evr b_parsed;
+	char *a_copy;
 	int result;
 
 	a_copy = oscap_strdup(a);
-	b_copy = oscap_strdup(b);
+	b_parsed.buffer = oscap_strdup(b);
 	parseEVR(a_copy, &a_epoch, &a_version, &a_release);
-	parseEVR(b_copy, &b_epoch, &b_version, &b_release);
+	parseEVR(b_parsed.buffer, &b_parsed.epoch, &b_parsed.version, &b_parsed.release);
 
-	result = compare_values(a_epoch, b_epoch);
-	if (!result) {
-		result = compare_values(a_version, b_version);
-		if (!result)
-			result = compare_values(a_release, b_release);
-	}
+	result = _evr_cmp(a_epoch, a_version, a_release, &b_parsed);
 
 	free(a_copy);
-	free(b_copy);
+	free(b_parsed.buffer);
 	return result;
 }
 
@@ -48,6 +48,20 @@ OSCAP_HIDDEN_START;
  */
 oval_result_t oval_evr_string_cmp(const char *state, const char *sys, oval_operation_t operation);
 
+/**
+ * EVR string split to epoch, version and release for repeated comparisons
+ */
+struct oval_evr;
+
+struct oval_evr *oval_evr_new(const char *evr);
+void oval_evr_free(struct oval_evr *evr);
+
+/**
+ * Compare the EVR string captured from system to the parsed EVR string of a state.
+ * @see oval_evr_string_cmp
+ */
+oval_result_t oval_evr_string_cmp_evr(const struct oval_evr *state, const char *sys, oval_operation_t operation);
+
 oval_result_t oval_versiontype_cmp(const char *state, const char *syschar, oval_operation_t operation);
 
 OSCAP_HIDDEN_END;
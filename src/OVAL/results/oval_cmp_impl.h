@@ -51,6 +51,30 @@ oval_result_t oval_ent_cmp_str(char *state_data, oval_datatype_t state_data_type
  */
 oval_result_t oval_str_cmp_str(char *state_data, oval_datatype_t state_data_type, const char *sys_data, oval_operation_t operation);
 
+/**
+ * Value of state entity (or variable/value) parsed according to its data type
+ * once, to be compared to many values collected from system.
+ */
+struct oval_cmp_value;
+
+/**
+ * Parse the value for repeated comparisons. Values which cannot be parsed are
+ * accepted too, their comparisons report the error as oval_str_cmp_str does.
+ * This function does not support @datatype="record".
+ * @param state_data Value defined within state/entity/value or variable/value, it has to outlive the parsed value
+ * @param state_data_type Data type of the value
+ * @param operation Comparison type operation
+ */
+struct oval_cmp_value *oval_cmp_value_new(char *state_data, oval_datatype_t state_data_type, oval_operation_t operation);
+
+void oval_cmp_value_free(struct oval_cmp_value *value);
+
+/**
+ * Compare the parsed value to data collected from system.
+ * @returns OVAL Result of comparison, same as oval_str_cmp_str would return
+ */
+oval_result_t oval_cmp_value_cmp_str(const struct oval_cmp_value *value, const char *sys_data);
+
 OSCAP_HIDDEN_END;
 
 #endif
@@ -80,26 +80,69 @@ static inline int ipaddr_parse(int af, const char *oval_ip_string, uint32_t *mas
 	return ipv6addr_parse(oval_ip_string, mask_out, ip_out);
 }
 
+struct oval_ipaddr {
+	int af;
+	uint32_t mask;
+	char addr[INET6_ADDRSTRLEN];
+};
+
+static oval_result_t _ipaddr_cmp(int af, uint32_t mask1, char *addr1, const char *s2, oval_operation_t op);
+
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op)
 {
-	oval_result_t result = OVAL_RESULT_ERROR;
-	uint32_t mask1 = 0, mask2 = 0;
+	uint32_t mask1 = 0;
+	char addr1[INET6_ADDRSTRLEN];
+
+	if (ipaddr_parse(af, s1, &mask1, &addr1)) {
+		return OVAL_RESULT_ERROR;
+	}
+	return _ipaddr_cmp(af, mask1, addr1, s2, op);
+}
+
+struct oval_ipaddr *oval_ipaddr_new(int af, const char *s)
+{
+	struct oval_ipaddr *ipaddr = malloc(sizeof(struct oval_ipaddr));
+	ipaddr->af = af;
+	ipaddr->mask = 0;
+	if (ipaddr_parse(af, s, &ipaddr->mask, &ipaddr->addr)) {
+		free(ipaddr);
+		return NULL;
+	}
+	return ipaddr;
+}
+
+void oval_ipaddr_free(struct oval_ipaddr *ipaddr)
+{
+	free(ipaddr);
+}
+
+oval_result_t oval_ipaddr_cmp_ipaddr(const struct oval_ipaddr *ipaddr1, const char *s2, oval_operation_t op)
+{
+	/* The address gets masked during the comparison */
 	char addr1[INET6_ADDRSTRLEN];
+	memcpy(addr1, ipaddr1->addr, sizeof(addr1));
+	return _ipaddr_cmp(ipaddr1->af, ipaddr1->mask, addr1, s2, op);
+}
+
+static oval_result_t _ipaddr_cmp(int af, uint32_t mask1, char *addr1, const char *s2, oval_operation_t op)
+{
+	oval_result_t result = OVAL_RESULT_ERROR;
+	uint32_t mask2 = 0;
 	char addr2[INET6_ADDRSTRLEN];
 
-	if (ipaddr_parse(af, s1, &mask1, &addr1) || ipaddr_parse(af, s2, &mask2, &addr2)) {
+	if (ipaddr_parse(af, s2, &mask2, &addr2)) {
 		return result;
 	}
 
 	switch (op) {
 	case OVAL_OPERATION_EQUALS:
-		if (!ipaddr_cmp(af, &addr1, &addr2) && mask1 == mask2)
+		if (!ipaddr_cmp(af, addr1, &addr2) && mask1 == mask2)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
 		break;
 	case OVAL_OPERATION_NOT_EQUAL:
-		if (ipaddr_cmp(af, &addr1, &addr2) || mask1 != mask2)
+		if (ipaddr_cmp(af, addr1, &addr2) || mask1 != mask2)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -116,9 +159,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		}
 
 		/* Otherwise, compare the first bits defined by mask1 */
-		ipaddr_mask(af, &addr1, mask1);
+		ipaddr_mask(af, addr1, mask1);
 		ipaddr_mask(af, &addr2, mask1);
-		if (ipaddr_cmp(af, &addr1, &addr2) == 0)
+		if (ipaddr_cmp(af, addr1, &addr2) == 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -127,9 +170,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		if (mask1 != mask2) {
 			return OVAL_RESULT_ERROR;
 		}
-		ipaddr_mask(af, &addr1, mask1);
+		ipaddr_mask(af, addr1, mask1);
 		ipaddr_mask(af, &addr2, mask2);
-		if (ipaddr_cmp(af, &addr1, &addr2) < 0)
+		if (ipaddr_cmp(af, addr1, &addr2) < 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -138,9 +181,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		if (mask1 != mask2) {
 			return OVAL_RESULT_ERROR;
 		}
-		ipaddr_mask(af, &addr1, mask1);
+		ipaddr_mask(af, addr1, mask1);
 		ipaddr_mask(af, &addr2, mask2);
-		if (ipaddr_cmp(af, &addr1, &addr2) <= 0)
+		if (ipaddr_cmp(af, addr1, &addr2) <= 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -157,9 +200,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		}
 
 		/* Otherwise, compare the first bits defined by mask2 */
-		ipaddr_mask(af, &addr1, mask2);
+		ipaddr_mask(af, addr1, mask2);
 		ipaddr_mask(af, &addr2, mask2);
-		if (ipaddr_cmp(af, &addr1, &addr2) == 0)
+		if (ipaddr_cmp(af, addr1, &addr2) == 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -168,9 +211,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		if (mask1 != mask2) {
 			return OVAL_RESULT_ERROR;
 		}
-		ipaddr_mask(af, &addr1, mask1);
+		ipaddr_mask(af, addr1, mask1);
 		ipaddr_mask(af, &addr2, mask2);
-		if (ipaddr_cmp(af, &addr1, &addr2) > 0)
+		if (ipaddr_cmp(af, addr1, &addr2) > 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -179,9 +222,9 @@ oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_opera
 		if (mask1 != mask2) {
 			return OVAL_RESULT_ERROR;
 		}
-		ipaddr_mask(af, &addr1, mask1);
+		ipaddr_mask(af, addr1, mask1);
 		ipaddr_mask(af, &addr2, mask2);
-		if (ipaddr_cmp(af, &addr1, &addr2) >= 0)
+		if (ipaddr_cmp(af, addr1, &addr2) >= 0)
 			result = OVAL_RESULT_TRUE;
 		else
 			result = OVAL_RESULT_FALSE;
@@ -50,6 +50,27 @@ OSCAP_HIDDEN_START;
  */
 oval_result_t oval_ipaddr_cmp(int af, const char *s1, const char *s2, oval_operation_t op);
 
+/**
+ * IP address or address set parsed for repeated comparisons
+ */
+struct oval_ipaddr;
+
+/**
+ * Parse IP address or address set
+ * @param af Internet address family (AF_INET or AF_INET6)
+ * @param s address in the format of oval:SimpleDatatypeEnumeration
+ * @returns parsed address or NULL if it cannot be parsed
+ */
+struct oval_ipaddr *oval_ipaddr_new(int af, const char *s);
+void oval_ipaddr_free(struct oval_ipaddr *ipaddr);
+
+/**
+ * Compare the parsed address as defined by state element to the address
+ * captured from system.
+ * @see oval_ipaddr_cmp
+ */
+oval_result_t oval_ipaddr_cmp_ipaddr(const struct oval_ipaddr *ipaddr1, const char *s2, oval_operation_t op);
+
 OSCAP_HIDDEN_END;
 
 #endif
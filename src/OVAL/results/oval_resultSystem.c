@@ -41,6 +41,7 @@
 #include "oval_agent_api.h"
 #include "oval_agent_api_impl.h"
 #include "results/oval_results_impl.h"
+#include "results/oval_state_program.h"
 #include "adt/oval_collection_impl.h"
 #include "adt/oval_smc_impl.h"
 #include "adt/oval_smc_iterator_impl.h"
@@ -56,6 +57,7 @@ typedef struct oval_result_system {
 	struct oval_smc *definitions;			///< Map contains lists of oval_result_definition
 	struct oval_smc *tests;				///< Map contains lists of oval_result_test
 	struct oval_syschar_model *syschar_model;
+	struct oval_string_map *state_programs;		///< Map of compiled states, see oval_result_system_get_state_program
 } oval_result_system_t;
 
 
@@ -116,6 +118,7 @@ struct oval_result_system *oval_result_system_new(struct oval_results_model *mod
 	sys->tests = oval_smc_new();
 	sys->syschar_model = syschar_model;
 	sys->model = model;
+	sys->state_programs = oval_string_map_new();
 
 	oval_results_model_add_system(model, sys);
 
@@ -144,14 +147,28 @@ void oval_result_system_free(struct oval_result_system *sys)
 
 	oval_smc_free(sys->definitions, (oscap_destruct_func) oval_result_definition_free);
 	oval_smc_free(sys->tests, (oscap_destruct_func) oval_result_test_free);
+	oval_string_map_free(sys->state_programs, (oscap_destruct_func) oval_state_program_free);
 
 	sys->definitions = NULL;
 	sys->syschar_model = NULL;
 	sys->tests = NULL;
+	sys->state_programs = NULL;
 
 	free(sys);
 }
 
+struct oval_state_program *oval_result_system_get_state_program(struct oval_result_system *sys, struct oval_state *state)
+{
+	char *state_id = oval_state_get_id(state);
+	struct oval_state_program *program = oval_string_map_get_value(sys->state_programs, state_id);
+	if (program == NULL) {
+		program = oval_state_program_new(state);
+		if (program != NULL)
+			oval_string_map_put(sys->state_programs, state_id, program);
+	}
+	return program;
+}
+
 bool oval_result_system_iterator_has_more(struct oval_result_system_iterator *sys) {
 	return oval_collection_iterator_has_more((struct oval_iterator *)sys);
 }
@@ -38,8 +38,7 @@
 #include "oval_agent_api_impl.h"
 #include "oval_probe_impl.h"
 #include "results/oval_results_impl.h"
-#include "results/oval_status_counter.h"
-#include "oval_cmp_impl.h"
+#include "results/oval_state_program.h"
 #include "adt/oval_collection_impl.h"
 #include "adt/oval_string_map_impl.h"
 #include "collectVarRefs_impl.h"
@@ -379,300 +378,6 @@ oval_result_t ores_get_result_byopr(struct oresults *ores, oval_operator_t op)
 	return result;
 }
 
-static inline oval_result_t _evaluate_sysent_with_variable(struct oval_syschar_model *syschar_model, struct oval_entity *state_entity, struct oval_sysent *item_entity, oval_operation_t state_entity_operation, struct oval_state_content *content)
-{
-	oval_syschar_collection_flag_t flag;
-	oval_result_t ent_val_res;
-
-	struct oval_variable *state_entity_var;
-	if ((state_entity_var = oval_entity_get_variable(state_entity)) == NULL) {
-		oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL variable");
-		return -1;
-	}
-
-	if (0 != oval_syschar_model_compute_variable(syschar_model, state_entity_var)) {
-		return -1;
-	}
-
-	flag = oval_variable_get_collection_flag(state_entity_var);
-	switch (flag) {
-	case SYSCHAR_FLAG_COMPLETE:
-	case SYSCHAR_FLAG_INCOMPLETE:{
-		struct oresults var_ores;
-		struct oval_value_iterator *val_itr;
-
-		ores_clear(&var_ores);
-
-		val_itr = oval_variable_get_values(state_entity_var);
-		while (oval_value_iterator_has_more(val_itr)) {
-			struct oval_value *var_val;
-			char *state_entity_val_text = NULL;
-			oval_result_t var_val_res;
-
-			var_val = oval_value_iterator_next(val_itr);
-			state_entity_val_text = oval_value_get_text(var_val);
-			if (state_entity_val_text == NULL) {
-				dE("Found NULL variable value text.");
-				ores_add_res(&var_ores, OVAL_RESULT_ERROR);
-				break;
-			}
-			oval_datatype_t state_entity_val_datatype = oval_value_get_datatype(var_val);
-
-			var_val_res = oval_ent_cmp_str(state_entity_val_text, state_entity_val_datatype, item_entity, state_entity_operation);
-			if (var_val_res == OVAL_RESULT_ERROR) {
-				dE("Error occured when comparing a variable '%s' value '%s' with collected item entity = '%s'",
-					oval_variable_get_id(state_entity_var), state_entity_val_text, oval_sysent_get_value(item_entity));
-			}
-			ores_add_res(&var_ores, var_val_res);
-		}
-		oval_value_iterator_free(val_itr);
-
-		oval_check_t var_check = oval_state_content_get_var_check(content);
-		ent_val_res = ores_get_result_bychk(&var_ores, var_check);
-		} break;
-	case SYSCHAR_FLAG_ERROR:
-	case SYSCHAR_FLAG_DOES_NOT_EXIST:
-	case SYSCHAR_FLAG_NOT_COLLECTED:
-	case SYSCHAR_FLAG_NOT_APPLICABLE:
-		ent_val_res = OVAL_RESULT_ERROR;
-		break;
-	default:
-		ent_val_res = -1;
-	}
-
-	return ent_val_res;
-}
-
-struct record_field_instance {
-	char *name;
-	char *value;
-	oval_datatype_t data_type;
-	oval_check_t ent_check;
-};
-
-static struct record_field_instance _oval_record_field_iterator_next_instance(struct oval_record_field_iterator *iterator)
-{
-	struct record_field_instance instance;
-	struct oval_record_field *rf = oval_record_field_iterator_next(iterator);
-	instance.name = oval_record_field_get_name(rf);
-	instance.value = oval_record_field_get_value(rf);
-	instance.data_type = oval_record_field_get_datatype(rf);
-	if (oval_record_field_get_type(rf) == OVAL_RECORD_FIELD_STATE) {
-		instance.ent_check = oval_record_field_get_ent_check(rf);
-	}
-	return instance;
-}
-
-static oval_result_t _evaluate_sysent_record(struct oval_state_content *state_content, struct oval_sysent *item_entity)
-{
-	struct oresults record_ores;
-	ores_clear(&record_ores);
-	/* During analysis of a system characteristics item, each record field is
-	 * analyzed and then the overall result for elements of the record type is
-	 * computed by logically ANDing the results for each field and applying
-	 * the entity_check attribute.
-	 */
-	struct oval_record_field_iterator *state_it = oval_state_content_get_record_fields(state_content);
-	while (oval_record_field_iterator_has_more(state_it)) {
-		struct record_field_instance state_rf = _oval_record_field_iterator_next_instance(state_it);
-		bool field_found = false;
-		struct oresults field_ores;
-		ores_clear(&field_ores);
-		struct oval_record_field_iterator *item_it = oval_sysent_get_record_fields(item_entity);
-		while (oval_record_field_iterator_has_more(item_it)) {
-			struct record_field_instance item_rf = _oval_record_field_iterator_next_instance(item_it);
-			if (strcmp(state_rf.name, item_rf.name) == 0) {
-				field_found = true;
-				oval_result_t fields_comparison_result = oval_str_cmp_str(state_rf.value, state_rf.data_type, item_rf.value, OVAL_OPERATION_EQUALS);
-				ores_add_res(&field_ores, fields_comparison_result);
-			}
-		}
-		oval_record_field_iterator_free(item_it);
-		/* When analyzing system characteristics an error should be reported
-		 * for the result of a field that is present in the OVAL State, but
-		 * not found in the system characteristics item.
-		 */
-		if (!field_found) {
-			ores_add_res(&record_ores, OVAL_RESULT_ERROR);
-		} else {
-			oval_result_t field_result = ores_get_result_bychk(&field_ores, state_rf.ent_check);
-			ores_add_res(&record_ores, field_result);
-		}
-	}
-	oval_record_field_iterator_free(state_it);
-	return ores_get_result_byopr(&record_ores, OVAL_OPERATOR_AND);
-}
-
-static inline oval_result_t _evaluate_sysent(struct oval_syschar_model *syschar_model, struct oval_sysent *item_entity, struct oval_entity *state_entity, oval_operation_t state_entity_operation, struct oval_state_content *content)
-{
-	if (oval_sysent_get_status(item_entity) == SYSCHAR_STATUS_DOES_NOT_EXIST) {
-		return OVAL_RESULT_FALSE;
-	} else if (oval_entity_get_varref_type(state_entity) == OVAL_ENTITY_VARREF_ATTRIBUTE) {
-
-		return _evaluate_sysent_with_variable(syschar_model,
-				state_entity, item_entity,
-				state_entity_operation, content);
-	} else {
-		struct oval_value *state_entity_val;
-		char *state_entity_val_text;
-		oval_datatype_t state_entity_val_datatype;
-
-		oval_datatype_t state_entity_type = oval_entity_get_datatype(state_entity);
-		if (state_entity_type == OVAL_DATATYPE_RECORD) {
-			if (state_entity_operation != OVAL_OPERATION_EQUALS) {
-				dE("The only allowed operation for comparing record types is 'equals'.");
-				return OVAL_RESULT_ERROR;
-			}
-			return _evaluate_sysent_record(content, item_entity);
-		} else {
-			if ((state_entity_val = oval_entity_get_value(state_entity)) == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity value");
-				return -1;
-			}
-			if ((state_entity_val_text = oval_value_get_text(state_entity_val)) == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity value text");
-				return -1;
-			}
-			state_entity_val_datatype = oval_value_get_datatype(state_entity_val);
-
-			return oval_ent_cmp_str(state_entity_val_text, state_entity_val_datatype, item_entity, state_entity_operation);
-		}
-	}
-}
-
-static oval_result_t eval_item(struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem, struct oval_state *state)
-{
-	struct oval_state_content_iterator *state_contents_itr;
-	struct oresults ste_ores;
-	oval_operator_t operator;
-	oval_result_t result = OVAL_RESULT_ERROR;
-
-	ores_clear(&ste_ores);
-
-	state_contents_itr = oval_state_get_contents(state);
-	while (oval_state_content_iterator_has_more(state_contents_itr)) {
-		struct oval_state_content *content;
-		struct oval_entity *state_entity;
-		char *state_entity_name;
-		oval_operation_t state_entity_operation;
-		oval_check_t entity_check;
-		oval_existence_t check_existence;
-		oval_result_t ste_ent_res;
-		struct oval_sysent_iterator *item_entities_itr;
-		struct oresults ent_ores;
-		struct oval_status_counter counter;
-		bool found_matching_item;
-
-		if ((content = oval_state_content_iterator_next(state_contents_itr)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL state content");
-			goto fail;
-		}
-		if ((state_entity = oval_state_content_get_entity(content)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity");
-			goto fail;
-		}
-		if ((state_entity_name = oval_entity_get_name(state_entity)) == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity name");
-			goto fail;
-		}
-
-		if (oscap_streq(state_entity_name, "line") &&
-			oval_state_get_subtype(state) == (oval_subtype_t) OVAL_INDEPENDENT_TEXT_FILE_CONTENT) {
-			/* Hack: textfilecontent_state/line shall be compared against textfilecontent_item/text.
-			 *
-			 * textfilecontent_test and textfilecontent54_test share the same syschar
-			 * (textfilecontent_item). In OVAL 5.3 and below this syschar did not hold any usable
-			 * information ('text' ent). In OVAL 5.4 textfilecontent_test was deprecated. But the
-			 * 'text' ent has been added to textfilecontent_item, making it potentially usable. */
-			oval_schema_version_t over = oval_state_get_platform_schema_version(state);
-			if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.4)) >= 0) {
-				/* The OVAL-5.3 does not have textfilecontent_item/text */
-				state_entity_name = "text";
-			}
-		}
-
-		entity_check = oval_state_content_get_ent_check(content);
-		check_existence = oval_state_content_get_check_existence(content);
-		state_entity_operation = oval_entity_get_operation(state_entity);
-
-		ores_clear(&ent_ores);
-		found_matching_item = false;
-		oval_status_counter_clear(&counter);
-
-		item_entities_itr = oval_sysitem_get_sysents(cur_sysitem);
-		while (oval_sysent_iterator_has_more(item_entities_itr)) {
-			struct oval_sysent *item_entity;
-			oval_result_t ent_val_res;
-			char *item_entity_name;
-			oval_syschar_status_t item_status;
-
-			item_entity = oval_sysent_iterator_next(item_entities_itr);
-			if (item_entity == NULL) {
-				oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
-			}
-			item_status = oval_sysent_get_status(item_entity);
-			oval_status_counter_add_status(&counter, item_status);
-
-			item_entity_name = oval_sysent_get_name(item_entity);
-			if (strcmp(item_entity_name, state_entity_name))
-				continue;
-
-			found_matching_item = true;
-
-			/* copy mask attribute from state to item */
-			if (oval_entity_get_mask(state_entity))
-				oval_sysent_set_mask(item_entity,1);
-
-			ent_val_res = _evaluate_sysent(syschar_model, item_entity, state_entity,
-					state_entity_operation, content);
-			if (ent_val_res == OVAL_RESULT_TRUE) {
-				dI("Entity '%s'='%s' of item '%s' matches corresponding entity in state '%s'.",
-						oval_sysent_get_name(item_entity),
-						oval_sysent_get_value(item_entity),
-						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
-			}
-			if (ent_val_res == OVAL_RESULT_ERROR) {
-				dI("Comparing entity '%s'='%s' of item '%s' to corresponding entity in state '%s' was not successful.",
-						oval_sysent_get_name(item_entity),
-						oval_sysent_get_value(item_entity),
-						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
-			}
-			if (((signed) ent_val_res) == -1) {
-				oval_sysent_iterator_free(item_entities_itr);
-				goto fail;
-			}
-
-			ores_add_res(&ent_ores, ent_val_res);
-		}
-		oval_sysent_iterator_free(item_entities_itr);
-
-		if (!found_matching_item)
-			dW("Entity name '%s' from state (id: '%s') not found in item (id: '%s').",
-			   state_entity_name, oval_state_get_id(state), oval_sysitem_get_id(cur_sysitem));
-
-		ste_ent_res = ores_get_result_bychk(&ent_ores, entity_check);
-		ores_add_res(&ste_ores, ste_ent_res);
-		oval_result_t cres = oval_status_counter_get_result(&counter, check_existence);
-		ores_add_res(&ste_ores, cres);
-	}
-	oval_state_content_iterator_free(state_contents_itr);
-
-	operator = oval_state_get_operator(state);
-	result = ores_get_result_byopr(&ste_ores, operator);
-	dI("Item '%s' compared to state '%s' with result %s.",
-			   oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state),
-			   oval_result_get_text(result));
-
-	return result;
-
- fail:
-	oval_state_content_iterator_free(state_contents_itr);
-
-	return OVAL_RESULT_ERROR;
-}
-
 #define ITEMMAP (struct oval_string_map    *)args[2]
 #define TEST    (struct oval_result_test   *)args[1]
 #define SYSTEM  (struct oval_result_system *)args[0]
@@ -710,13 +415,23 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 		free(state_names);
 	}
 
+	/* The states are compiled once for all the items */
+	struct oval_state_program **programs = NULL;
+	size_t program_count = 0;
+	struct oval_state_iterator *ste_itr = oval_test_get_states(test);
+	while (oval_state_iterator_has_more(ste_itr)) {
+		struct oval_state *ste = oval_state_iterator_next(ste_itr);
+		programs = realloc(programs, (program_count + 1) * sizeof(struct oval_state_program *));
+		programs[program_count++] = oval_result_system_get_state_program(SYSTEM, ste);
+	}
+	oval_state_iterator_free(ste_itr);
+
 	ritems_itr = oval_result_test_get_items(TEST);
 	while (oval_result_item_iterator_has_more(ritems_itr)) {
 		struct oval_result_item *ritem;
 		struct oval_sysitem *item;
 		oval_syschar_status_t item_status;
 		struct oresults ste_ores;
-		struct oval_state_iterator *ste_itr;
 		oval_result_t item_res;
 
 		ritem = oval_result_item_iterator_next(ritems_itr);
@@ -741,22 +456,18 @@ static oval_result_t eval_check_state(struct oval_test *test, void **args)
 
 		ores_clear(&ste_ores);
 
-		ste_itr = oval_test_get_states(test);
-		while (oval_state_iterator_has_more(ste_itr)) {
-			struct oval_state *ste;
-			oval_result_t ste_res;
-
-			ste = oval_state_iterator_next(ste_itr);
-			ste_res = eval_item(syschar_model, item, ste);
+		for (size_t i = 0; i < program_count; i++) {
+			oval_result_t ste_res = programs[i] != NULL ?
+				oval_state_program_eval_item(programs[i], syschar_model, item) : OVAL_RESULT_ERROR;
 			ores_add_res(&ste_ores, ste_res);
 		}
-		oval_state_iterator_free(ste_itr);
 
 		item_res = ores_get_result_byopr(&ste_ores, ste_opr);
 		ores_add_res(&item_ores, item_res);
 		oval_result_item_set_result(ritem, item_res);
 	}
 	oval_result_item_iterator_free(ritems_itr);
+	free(programs);
 
 	result = ores_get_result_bychk(&item_ores, ste_check);
 
@@ -77,6 +77,13 @@ struct oval_result_definition *oval_result_system_get_new_definition(struct oval
 								     int variable_instance);
 struct oval_result_test *oval_result_system_get_test(struct oval_result_system *, char *);
 
+struct oval_state_program;
+/**
+ * Get the state compiled for evaluation of collected items, compile it on first use
+ * @returns compiled state owned by the system or NULL if the state is malformed
+ */
+struct oval_state_program *oval_result_system_get_state_program(struct oval_result_system *sys, struct oval_state *state);
+
 struct oresults {
 	int true_cnt;
 	int false_cnt;
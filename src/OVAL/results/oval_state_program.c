@@ -0,0 +1,419 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "oval_agent_api_impl.h"
+#include "oval_definitions_impl.h"
+#include "oval_system_characteristics_impl.h"
+#include "results/oval_results_impl.h"
+#include "results/oval_status_counter.h"
+#include "results/oval_state_program.h"
+#include "oval_cmp_impl.h"
+#include "common/util.h"
+#include "common/debug_priv.h"
+#include "common/_error.h"
+
+/**
+ * Compiled state entity
+ */
+struct oval_state_program_entity {
+	struct oval_state_content *content;
+	struct oval_entity *entity;
+	const char *name;                 ///< name of the item entities to compare with
+	size_t slot;                      ///< index of the name in oval_state_program.names
+	oval_operation_t operation;
+	oval_check_t entity_check;
+	oval_existence_t check_existence;
+	bool mask;
+	struct oval_cmp_value *value;     ///< parsed value, NULL for variable references and records
+};
+
+struct oval_state_program {
+	struct oval_state *state;
+	oval_operator_t operator;
+	struct oval_state_program_entity *entities;
+	size_t entity_count;
+	const char **names;               ///< distinct entity names of the state
+	size_t name_count;
+	/* Scratch space, entities of the evaluated item and their slots */
+	struct oval_sysent **sysents;
+	size_t *sysent_slots;
+	size_t sysent_alloc;
+};
+
+static inline oval_result_t _evaluate_sysent_with_variable(struct oval_syschar_model *syschar_model, struct oval_entity *state_entity, struct oval_sysent *item_entity, oval_operation_t state_entity_operation, struct oval_state_content *content)
+{
+	oval_syschar_collection_flag_t flag;
+	oval_result_t ent_val_res;
+
+	struct oval_variable *state_entity_var;
+	if ((state_entity_var = oval_entity_get_variable(state_entity)) == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL variable");
+		return -1;
+	}
+
+	if (0 != oval_syschar_model_compute_variable(syschar_model, state_entity_var)) {
+		return -1;
+	}
+
+	flag = oval_variable_get_collection_flag(state_entity_var);
+	switch (flag) {
+	case SYSCHAR_FLAG_COMPLETE:
+	case SYSCHAR_FLAG_INCOMPLETE:{
+		struct oresults var_ores;
+		struct oval_value_iterator *val_itr;
+
+		ores_clear(&var_ores);
+
+		val_itr = oval_variable_get_values(state_entity_var);
+		while (oval_value_iterator_has_more(val_itr)) {
+			struct oval_value *var_val;
+			char *state_entity_val_text = NULL;
+			oval_result_t var_val_res;
+
+			var_val = oval_value_iterator_next(val_itr);
+			state_entity_val_text = oval_value_get_text(var_val);
+			if (state_entity_val_text == NULL) {
+				dE("Found NULL variable value text.");
+				ores_add_res(&var_ores, OVAL_RESULT_ERROR);
+				break;
+			}
+			oval_datatype_t state_entity_val_datatype = oval_value_get_datatype(var_val);
+
+			var_val_res = oval_ent_cmp_str(state_entity_val_text, state_entity_val_datatype, item_entity, state_entity_operation);
+			if (var_val_res == OVAL_RESULT_ERROR) {
+				dE("Error occured when comparing a variable '%s' value '%s' with collected item entity = '%s'",
+					oval_variable_get_id(state_entity_var), state_entity_val_text, oval_sysent_get_value(item_entity));
+			}
+			ores_add_res(&var_ores, var_val_res);
+		}
+		oval_value_iterator_free(val_itr);
+
+		oval_check_t var_check = oval_state_content_get_var_check(content);
+		ent_val_res = ores_get_result_bychk(&var_ores, var_check);
+		} break;
+	case SYSCHAR_FLAG_ERROR:
+	case SYSCHAR_FLAG_DOES_NOT_EXIST:
+	case SYSCHAR_FLAG_NOT_COLLECTED:
+	case SYSCHAR_FLAG_NOT_APPLICABLE:
+		ent_val_res = OVAL_RESULT_ERROR;
+		break;
+	default:
+		ent_val_res = -1;
+	}
+
+	return ent_val_res;
+}
+
+struct record_field_instance {
+	char *name;
+	char *value;
+	oval_datatype_t data_type;
+	oval_check_t ent_check;
+};
+
+static struct record_field_instance _oval_record_field_iterator_next_instance(struct oval_record_field_iterator *iterator)
+{
+	struct record_field_instance instance;
+	struct oval_record_field *rf = oval_record_field_iterator_next(iterator);
+	instance.name = oval_record_field_get_name(rf);
+	instance.value = oval_record_field_get_value(rf);
+	instance.data_type = oval_record_field_get_datatype(rf);
+	if (oval_record_field_get_type(rf) == OVAL_RECORD_FIELD_STATE) {
+		instance.ent_check = oval_record_field_get_ent_check(rf);
+	}
+	return instance;
+}
+
+static oval_result_t _evaluate_sysent_record(struct oval_state_content *state_content, struct oval_sysent *item_entity)
+{
+	struct oresults record_ores;
+	ores_clear(&record_ores);
+	/* During analysis of a system characteristics item, each record field is
+	 * analyzed and then the overall result for elements of the record type is
+	 * computed by logically ANDing the results for each field and applying
+	 * the entity_check attribute.
+	 */
+	struct oval_record_field_iterator *state_it = oval_state_content_get_record_fields(state_content);
+	while (oval_record_field_iterator_has_more(state_it)) {
+		struct record_field_instance state_rf = _oval_record_field_iterator_next_instance(state_it);
+		bool field_found = false;
+		struct oresults field_ores;
+		ores_clear(&field_ores);
+		struct oval_record_field_iterator *item_it = oval_sysent_get_record_fields(item_entity);
+		while (oval_record_field_iterator_has_more(item_it)) {
+			struct record_field_instance item_rf = _oval_record_field_iterator_next_instance(item_it);
+			if (strcmp(state_rf.name, item_rf.name) == 0) {
+				field_found = true;
+				oval_result_t fields_comparison_result = oval_str_cmp_str(state_rf.value, state_rf.data_type, item_rf.value, OVAL_OPERATION_EQUALS);
+				ores_add_res(&field_ores, fields_comparison_result);
+			}
+		}
+		oval_record_field_iterator_free(item_it);
+		/* When analyzing system characteristics an error should be reported
+		 * for the result of a field that is present in the OVAL State, but
+		 * not found in the system characteristics item.
+		 */
+		if (!field_found) {
+			ores_add_res(&record_ores, OVAL_RESULT_ERROR);
+		} else {
+			oval_result_t field_result = ores_get_result_bychk(&field_ores, state_rf.ent_check);
+			ores_add_res(&record_ores, field_result);
+		}
+	}
+	oval_record_field_iterator_free(state_it);
+	return ores_get_result_byopr(&record_ores, OVAL_OPERATOR_AND);
+}
+
+static inline oval_result_t _evaluate_sysent(struct oval_syschar_model *syschar_model, struct oval_sysent *item_entity, const struct oval_state_program_entity *ent)
+{
+	if (oval_sysent_get_status(item_entity) == SYSCHAR_STATUS_DOES_NOT_EXIST) {
+		return OVAL_RESULT_FALSE;
+	} else if (oval_entity_get_varref_type(ent->entity) == OVAL_ENTITY_VARREF_ATTRIBUTE) {
+		return _evaluate_sysent_with_variable(syschar_model,
+				ent->entity, item_entity,
+				ent->operation, ent->content);
+	} else if (ent->value == NULL) {
+		if (ent->operation != OVAL_OPERATION_EQUALS) {
+			dE("The only allowed operation for comparing record types is 'equals'.");
+			return OVAL_RESULT_ERROR;
+		}
+		return _evaluate_sysent_record(ent->content, item_entity);
+	} else {
+		return oval_cmp_value_cmp_str(ent->value, oval_sysent_get_value(item_entity));
+	}
+}
+
+static size_t _oval_state_program_get_slot(struct oval_state_program *program, const char *name)
+{
+	size_t slot;
+	for (slot = 0; slot < program->name_count; slot++) {
+		if (strcmp(program->names[slot], name) == 0)
+			return slot;
+	}
+	return slot;
+}
+
+static int _oval_state_program_add_content(struct oval_state_program *program, struct oval_state_content *content)
+{
+	struct oval_state *state = program->state;
+	struct oval_entity *state_entity;
+	char *state_entity_name;
+
+	if (content == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL state content");
+		return -1;
+	}
+	if ((state_entity = oval_state_content_get_entity(content)) == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity");
+		return -1;
+	}
+	if ((state_entity_name = oval_entity_get_name(state_entity)) == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity name");
+		return -1;
+	}
+
+	if (oscap_streq(state_entity_name, "line") &&
+		oval_state_get_subtype(state) == (oval_subtype_t) OVAL_INDEPENDENT_TEXT_FILE_CONTENT) {
+		/* Hack: textfilecontent_state/line shall be compared against textfilecontent_item/text.
+		 *
+		 * textfilecontent_test and textfilecontent54_test share the same syschar
+		 * (textfilecontent_item). In OVAL 5.3 and below this syschar did not hold any usable
+		 * information ('text' ent). In OVAL 5.4 textfilecontent_test was deprecated. But the
+		 * 'text' ent has been added to textfilecontent_item, making it potentially usable. */
+		oval_schema_version_t over = oval_state_get_platform_schema_version(state);
+		if (oval_schema_version_cmp(over, OVAL_SCHEMA_VERSION(5.4)) >= 0) {
+			/* The OVAL-5.3 does not have textfilecontent_item/text */
+			state_entity_name = "text";
+		}
+	}
+
+	struct oval_cmp_value *value = NULL;
+	oval_operation_t operation = oval_entity_get_operation(state_entity);
+	if (oval_entity_get_varref_type(state_entity) != OVAL_ENTITY_VARREF_ATTRIBUTE &&
+			oval_entity_get_datatype(state_entity) != OVAL_DATATYPE_RECORD) {
+		struct oval_value *state_entity_val;
+		char *state_entity_val_text;
+
+		if ((state_entity_val = oval_entity_get_value(state_entity)) == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity value");
+			return -1;
+		}
+		if ((state_entity_val_text = oval_value_get_text(state_entity_val)) == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL entity value text");
+			return -1;
+		}
+		value = oval_cmp_value_new(state_entity_val_text, oval_value_get_datatype(state_entity_val), operation);
+	}
+
+	size_t slot = _oval_state_program_get_slot(program, state_entity_name);
+	if (slot == program->name_count) {
+		program->names = realloc(program->names, (program->name_count + 1) * sizeof(const char *));
+		program->names[program->name_count++] = state_entity_name;
+	}
+
+	program->entities = realloc(program->entities, (program->entity_count + 1) * sizeof(struct oval_state_program_entity));
+	struct oval_state_program_entity *ent = &program->entities[program->entity_count++];
+	ent->content = content;
+	ent->entity = state_entity;
+	ent->name = state_entity_name;
+	ent->slot = slot;
+	ent->operation = operation;
+	ent->entity_check = oval_state_content_get_ent_check(content);
+	ent->check_existence = oval_state_content_get_check_existence(content);
+	ent->mask = oval_entity_get_mask(state_entity);
+	ent->value = value;
+	return 0;
+}
+
+struct oval_state_program *oval_state_program_new(struct oval_state *state)
+{
+	struct oval_state_program *program = calloc(1, sizeof(struct oval_state_program));
+	program->state = state;
+	program->operator = oval_state_get_operator(state);
+
+	struct oval_state_content_iterator *contents = oval_state_get_contents(state);
+	while (oval_state_content_iterator_has_more(contents)) {
+		if (_oval_state_program_add_content(program, oval_state_content_iterator_next(contents)) != 0) {
+			oval_state_content_iterator_free(contents);
+			oval_state_program_free(program);
+			return NULL;
+		}
+	}
+	oval_state_content_iterator_free(contents);
+	return program;
+}
+
+void oval_state_program_free(struct oval_state_program *program)
+{
+	if (program == NULL)
+		return;
+	for (size_t i = 0; i < program->entity_count; i++)
+		oval_cmp_value_free(program->entities[i].value);
+	free(program->entities);
+	free(program->names);
+	free(program->sysents);
+	free(program->sysent_slots);
+	free(program);
+}
+
+/**
+ * Put the entities of the item into the scratch space and assign them their slots
+ * @returns number of the entities or -1 on error
+ */
+static ssize_t _oval_state_program_load_item(struct oval_state_program *program, struct oval_sysitem *item, struct oval_status_counter *counter)
+{
+	size_t count = 0;
+	struct oval_sysent_iterator *item_entities_itr = oval_sysitem_get_sysents(item);
+	while (oval_sysent_iterator_has_more(item_entities_itr)) {
+		struct oval_sysent *item_entity = oval_sysent_iterator_next(item_entities_itr);
+		if (item_entity == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_OVAL, "OVAL internal error: found NULL sysent");
+			oval_sysent_iterator_free(item_entities_itr);
+			return -1;
+		}
+		if (count == program->sysent_alloc) {
+			program->sysent_alloc = program->sysent_alloc ? 2 * program->sysent_alloc : 16;
+			program->sysents = realloc(program->sysents, program->sysent_alloc * sizeof(struct oval_sysent *));
+			program->sysent_slots = realloc(program->sysent_slots, program->sysent_alloc * sizeof(size_t));
+		}
+		oval_status_counter_add_status(counter, oval_sysent_get_status(item_entity));
+		program->sysents[count] = item_entity;
+		program->sysent_slots[count] = _oval_state_program_get_slot(program, oval_sysent_get_name(item_entity));
+		count++;
+	}
+	oval_sysent_iterator_free(item_entities_itr);
+	return count;
+}
+
+oval_result_t oval_state_program_eval_item(struct oval_state_program *program, struct oval_syschar_model *syschar_model, struct oval_sysitem *cur_sysitem)
+{
+	struct oval_state *state = program->state;
+	struct oresults ste_ores;
+	struct oval_status_counter counter;
+	oval_result_t result;
+
+	ores_clear(&ste_ores);
+	/* Existence of the item entities is checked against all of them,
+	 * the count is the same for all the state entities. */
+	oval_status_counter_clear(&counter);
+	ssize_t sysent_count = _oval_state_program_load_item(program, cur_sysitem, &counter);
+	if (sysent_count == -1)
+		return OVAL_RESULT_ERROR;
+
+	for (size_t i = 0; i < program->entity_count; i++) {
+		const struct oval_state_program_entity *ent = &program->entities[i];
+		struct oresults ent_ores;
+		bool found_matching_item = false;
+
+		ores_clear(&ent_ores);
+		for (ssize_t j = 0; j < sysent_count; j++) {
+			struct oval_sysent *item_entity;
+			oval_result_t ent_val_res;
+
+			if (program->sysent_slots[j] != ent->slot)
+				continue;
+			item_entity = program->sysents[j];
+			found_matching_item = true;
+
+			/* copy mask attribute from state to item */
+			if (ent->mask)
+				oval_sysent_set_mask(item_entity,1);
+
+			ent_val_res = _evaluate_sysent(syschar_model, item_entity, ent);
+			if (ent_val_res == OVAL_RESULT_TRUE) {
+				dI("Entity '%s'='%s' of item '%s' matches corresponding entity in state '%s'.",
+						oval_sysent_get_name(item_entity),
+						oval_sysent_get_value(item_entity),
+						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
+			}
+			if (ent_val_res == OVAL_RESULT_ERROR) {
+				dI("Comparing entity '%s'='%s' of item '%s' to corresponding entity in state '%s' was not successful.",
+						oval_sysent_get_name(item_entity),
+						oval_sysent_get_value(item_entity),
+						oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state));
+			}
+			if (((signed) ent_val_res) == -1)
+				return OVAL_RESULT_ERROR;
+
+			ores_add_res(&ent_ores, ent_val_res);
+		}
+
+		if (!found_matching_item)
+			dW("Entity name '%s' from state (id: '%s') not found in item (id: '%s').",
+			   ent->name, oval_state_get_id(state), oval_sysitem_get_id(cur_sysitem));
+
+		ores_add_res(&ste_ores, ores_get_result_bychk(&ent_ores, ent->entity_check));
+		ores_add_res(&ste_ores, oval_status_counter_get_result(&counter, ent->check_existence));
+	}
+
+	result = ores_get_result_byopr(&ste_ores, program->operator);
+	dI("Item '%s' compared to state '%s' with result %s.",
+			   oval_sysitem_get_id(cur_sysitem), oval_state_get_id(state),
+			   oval_result_get_text(result));
+
+	return result;
+}
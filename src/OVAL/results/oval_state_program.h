@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef OSCAP_OVAL_STATE_PROGRAM_H_
+#define OSCAP_OVAL_STATE_PROGRAM_H_
+
+#include "../common/util.h"
+#include "oval_definitions.h"
+#include "oval_types.h"
+#include "oval_system_characteristics.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * OVAL state compiled for comparison with many collected items.
+ *
+ * Constant values of the state entities are parsed according to their data
+ * types and regular expressions are compiled once. Entity names of the state
+ * are numbered, so that the entities of an item are matched to the state
+ * entities in a single pass over the item. Variable references and records
+ * are compared the same way as without the program.
+ *
+ * A program keeps scratch space for the evaluated item, it must not be used
+ * to evaluate two items at the same time.
+ */
+struct oval_state_program;
+
+/**
+ * Compile the state
+ * @returns new program or NULL if the state is malformed (the error is set)
+ */
+struct oval_state_program *oval_state_program_new(struct oval_state *state);
+
+void oval_state_program_free(struct oval_state_program *program);
+
+/**
+ * Compare the collected item with the compiled state
+ * @param program Compiled state
+ * @param syschar_model System characteristics to compute the referenced variables in
+ * @param item Collected item
+ * @returns OVAL Result of comparison
+ */
+oval_result_t oval_state_program_eval_item(struct oval_state_program *program, struct oval_syschar_model *syschar_model, struct oval_sysitem *item);
+
+OSCAP_HIDDEN_END;
+
+#endif
@@ -231,6 +231,24 @@ struct sce_session* sce_parameters_get_session(struct sce_parameters* v);
  */
 void sce_parameters_allocate_session(struct sce_parameters* v);
 
+/**
+ * Sets the maximal number of scripts running in parallel
+ *
+ * Scripts of all the selected rules are started as soon as the evaluation
+ * of the policy begins, their results are still recorded in the order of
+ * the rules. The default is taken from the OSCAP_SCE_WORKERS environment
+ * variable or it is 1, scripts run one by one unless asked otherwise.
+ *
+ * @param max_workers number of scripts, 1 means that scripts run one by one
+ * @memberof sce_parameters
+ */
+void sce_parameters_set_max_workers(struct sce_parameters* v, unsigned int max_workers);
+
+/**
+ * @memberof sce_parameters
+ */
+unsigned int sce_parameters_get_max_workers(struct sce_parameters* v);
+
 /**
  * Internal rule evaluation callback, don't use directly
  *
@@ -53,6 +53,9 @@
 #include <limits.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <poll.h>
+#include <signal.h>
+#include <errno.h>
 
 struct sce_check_result
 {
@@ -259,17 +262,58 @@ void sce_session_export_to_directory(struct sce_session* s, const char* director
 	sce_check_result_iterator_free(it);
 }
 
+/**
+ * Execution of a script, possibly running in parallel with other scripts
+ */
+struct sce_job
+{
+	struct sce_job *next;
+	char *href;			// check-content-ref/@href
+	char *path;			// path of the script
+	char **env;			// environment of the script, NULL terminated
+	size_t env_count;
+	pid_t pid;
+	bool started;
+	bool finished;
+	bool failed;			// the script could not be started
+	int stdout_fd;			// -1 if closed
+	int stderr_fd;			// -1 if closed
+	struct oscap_string *std_out;
+	struct oscap_string *std_err;
+	int exit_code;
+};
+
 struct sce_parameters
 {
 	char* xccdf_directory;
 	struct sce_session* session;
+	/* Jobs in the order of evaluation, both queued and running ones */
+	struct sce_job *jobs;
+	struct sce_job *jobs_tail;
+	unsigned int running_jobs;
+	unsigned int max_workers;
 };
 
+static void _sce_pool_job_free(struct sce_parameters *parameters, struct sce_job *job);
+
+static unsigned int _sce_default_workers(void)
+{
+	const char *workers = getenv("OSCAP_SCE_WORKERS");
+	if (workers != NULL && atoi(workers) > 0)
+		return atoi(workers);
+	// Scripts may depend on each other's side effects, run them one by one unless asked otherwise.
+	return 1;
+}
+
 struct sce_parameters* sce_parameters_new(void)
 {
 	struct sce_parameters *ret = malloc(sizeof(struct sce_parameters));
 	ret->xccdf_directory = NULL;
 	ret->session = NULL;
+	ret->jobs = NULL;
+	ret->jobs_tail = NULL;
+	ret->running_jobs = 0;
+	ret->max_workers = _sce_default_workers();
 
 	return ret;
 }
@@ -279,6 +323,11 @@ void sce_parameters_free(struct sce_parameters* v)
 	if (!v)
 		return;
 
+	while (v->jobs != NULL) {
+		struct sce_job *job = v->jobs;
+		v->jobs = job->next;
+		_sce_pool_job_free(v, job);
+	}
 	free(v->xccdf_directory);
 	sce_session_free(v->session);
 
@@ -314,100 +363,76 @@ void sce_parameters_allocate_session(struct sce_parameters* v)
 	sce_parameters_set_session(v, sce_session_new());
 }
 
-static void _pipe_try_read_into_string(int fd, struct oscap_string *string, bool *eof)
+void sce_parameters_set_max_workers(struct sce_parameters* v, unsigned int max_workers)
+{
+	v->max_workers = max_workers > 0 ? max_workers : 1;
+}
+
+unsigned int sce_parameters_get_max_workers(struct sce_parameters* v)
+{
+	return v->max_workers;
+}
+
+static void _pipe_try_read_into_string(int *fd, struct oscap_string *string)
 {
-	// FIXME: Read by larger chunks in the future
-	char readbuf;
+	char readbuf[4096];
 	while (true) {
-		const int read_status = read(fd, &readbuf, 1);
-		if (read_status == 1) {  // successful read
-			if (readbuf == '&') {
-				// & is a special case, we have to "escape" it manually
-				// (all else will eventually get handled by libxml)
-				oscap_string_append_string(string, "&amp;");
-			} else {
-				oscap_string_append_char(string, readbuf);
+		const ssize_t read_status = read(*fd, readbuf, sizeof(readbuf));
+		if (read_status > 0) {  // successful read
+			for (ssize_t i = 0; i < read_status; i++) {
+				if (readbuf[i] == '&') {
+					// & is a special case, we have to "escape" it manually
+					// (all else will eventually get handled by libxml)
+					oscap_string_append_string(string, "&amp;");
+				} else {
+					oscap_string_append_char(string, readbuf[i]);
+				}
 			}
 		}
-		else if (read_status == 0) {  // EOF
-			*eof = true;
+		else if (read_status < 0 && errno == EINTR) {
+			continue;
+		}
+		else if (read_status < 0 && errno == EAGAIN) {
+			// NOOP, we are waiting for more input
 			break;
 		}
-		else {
-			if (errno == EAGAIN) {
-				// NOOP, we are waiting for more input
-				break;
-			}
-			else {
-				*eof = true;  // signal EOF to exit the loops
-				break;
-			}
+		else {  // EOF or error, either way there is nothing more to read
+			close(*fd);
+			*fd = -1;
+			break;
 		}
 	}
 }
 
-xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const char *rule_id, const char *id, const char *href,
-		struct xccdf_value_binding_iterator *value_binding_it,
-		struct xccdf_check_import_iterator *check_import_it,
-		void *usr)
-{
-	struct sce_parameters* parameters = (struct sce_parameters*)usr;
-	const char* xccdf_directory = parameters->xccdf_directory;
-
-	char* tmp_href = oscap_sprintf("%s/%s", xccdf_directory, href);
-
-	if (access(tmp_href, F_OK))
-	{
-		// we only do this check to provide helpful error message
-		// there is an inherent race condition, the file might
-		// not exist anymore at the time we execve it!
-
-		// the script hasn't been found, perhaps another sce instance
-		// with a different XCCDF directory can find it?
-		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE couldn't find script file '%s'. "
-				"Expected location: '%s'.", href, tmp_href);
-		free(tmp_href);
-		return XCCDF_RESULT_NOT_CHECKED;
-	}
-
-	if (access(tmp_href, F_OK | X_OK))
-	{
-		// again, only to provide helpful error message
-		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE has found script file '%s' at '%s' "
-				"but it isn't executable!", href, tmp_href);
-		free(tmp_href);
-		return XCCDF_RESULT_ERROR;
-	}
-
-	// all the result codes are shifted by 100, because otherwise syntax errors in scripts
-	// or even their nonexistence would cause XCCDF_RESULT_PASS to be the result
-
-	char* argvp[1 + 1] = {
-		tmp_href,
-		NULL
+/**
+ * Compose environment of the script: result codes and bound values in KEY=VALUE form
+ */
+static char **_sce_environment_new(struct xccdf_value_binding_iterator *value_binding_it, size_t *env_count)
+{
+	static const char *result_codes[] = {
+		"PATH=/bin:/sbin:/usr/bin:/usr/sbin",
+		// all the result codes are shifted by 100, because otherwise syntax errors in scripts
+		// or even their nonexistence would cause XCCDF_RESULT_PASS to be the result
+		"XCCDF_RESULT_PASS=101",
+		"XCCDF_RESULT_FAIL=102",
+		"XCCDF_RESULT_ERROR=103",
+		"XCCDF_RESULT_UNKNOWN=104",
+		"XCCDF_RESULT_NOT_APPLICABLE=105",
+		"XCCDF_RESULT_NOT_CHECKED=106",
+		"XCCDF_RESULT_NOT_SELECTED=107",
+		"XCCDF_RESULT_INFORMATIONAL=108",
+		"XCCDF_RESULT_FIXED=109",
 	};
-
-	// bound values in KEY=VALUE form, ready to be passed as environment variables
-	char ** env_values = malloc(10 * sizeof(char * ));
-	size_t env_value_count = 10;
-
-	env_values[0] = "PATH=/bin:/sbin:/usr/bin:/usr/sbin";
-
-	env_values[1] = "XCCDF_RESULT_PASS=101";
-	env_values[2] = "XCCDF_RESULT_FAIL=102";
-	env_values[3] = "XCCDF_RESULT_ERROR=103";
-	env_values[4] = "XCCDF_RESULT_UNKNOWN=104";
-	env_values[5] = "XCCDF_RESULT_NOT_APPLICABLE=105";
-	env_values[6] = "XCCDF_RESULT_NOT_CHECKED=106";
-	env_values[7] = "XCCDF_RESULT_NOT_SELECTED=107";
-	env_values[8] = "XCCDF_RESULT_INFORMATIONAL=108";
-	env_values[9] = "XCCDF_RESULT_FIXED=109";
+	size_t count = sizeof(result_codes) / sizeof(result_codes[0]);
+	char **env_values = malloc((count + 1) * sizeof(char *));
+	for (size_t i = 0; i < count; ++i)
+		env_values[i] = oscap_strdup(result_codes[i]);
 
 	while (xccdf_value_binding_iterator_has_more(value_binding_it))
 	{
 		struct xccdf_value_binding* binding = xccdf_value_binding_iterator_next(value_binding_it);
 
-		env_values = realloc(env_values, (env_value_count + 3) * sizeof(char*));
+		env_values = realloc(env_values, (count + 3 + 1) * sizeof(char*));
 
 		char* name = xccdf_value_binding_get_name(binding);
 		xccdf_value_type_t type = xccdf_value_binding_get_type(binding);
@@ -436,9 +461,6 @@ xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const
 			break;
 		}
 
-		char* env_type_entry = oscap_sprintf("XCCDF_TYPE_%s=%s", name, type_str);
-		char* env_value_entry = oscap_sprintf("XCCDF_VALUE_%s=%s", name, value);
-
 		char* operator_str;
 		switch (operator)
 		{
@@ -469,217 +491,415 @@ xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const
 			break;
 		}
 
-		char* env_operator_entry = oscap_sprintf("XCCDF_OPERATOR_%s=%s", name, operator_str);
+		env_values[count++] = oscap_sprintf("XCCDF_TYPE_%s=%s", name, type_str);
+		env_values[count++] = oscap_sprintf("XCCDF_VALUE_%s=%s", name, value);
+		env_values[count++] = oscap_sprintf("XCCDF_OPERATOR_%s=%s", name, operator_str);
+	}
+	env_values[count] = NULL;
+
+	*env_count = count;
+	return env_values;
+}
+
+static struct sce_job *sce_job_new(const char *href, char *path, char **env, size_t env_count)
+{
+	struct sce_job *job = calloc(1, sizeof(struct sce_job));
+	job->href = oscap_strdup(href);
+	job->path = path;
+	job->env = env;
+	job->env_count = env_count;
+	job->stdout_fd = -1;
+	job->stderr_fd = -1;
+	job->std_out = oscap_string_new();
+	job->std_err = oscap_string_new();
+	return job;
+}
 
-		env_values[env_value_count] = env_type_entry;
-		env_value_count++;
-		env_values[env_value_count] = env_value_entry;
-		env_value_count++;
-		env_values[env_value_count] = env_operator_entry;
-		env_value_count++;
+static bool _sce_job_matches(const struct sce_job *job, const char *href, char **env, size_t env_count)
+{
+	if (!oscap_streq(job->href, href) || job->env_count != env_count)
+		return false;
+	for (size_t i = 0; i < env_count; ++i) {
+		if (!oscap_streq(job->env[i], env[i]))
+			return false;
 	}
+	return true;
+}
 
-	env_values = realloc(env_values, (env_value_count + 1) * sizeof(char*));
-	env_values[env_value_count] = NULL;
+static void _sce_pool_job_free(struct sce_parameters *parameters, struct sce_job *job)
+{
+	if (job->started && !job->finished) {
+		// Nobody is interested in the result any more
+		kill(job->pid, SIGTERM);
+		waitpid(job->pid, NULL, 0);
+		parameters->running_jobs--;
+	}
+	if (job->stdout_fd != -1)
+		close(job->stdout_fd);
+	if (job->stderr_fd != -1)
+		close(job->stderr_fd);
+	for (size_t i = 0; i < job->env_count; ++i)
+		free(job->env[i]);
+	free(job->env);
+	free(job->href);
+	free(job->path);
+	oscap_string_free(job->std_out);
+	oscap_string_free(job->std_err);
+	free(job);
+}
+
+static int _sce_pipe(int pipefd[2])
+{
+	if (pipe(pipefd) == -1)
+		return -1;
+	// Scripts running in parallel must not inherit pipes of each other,
+	// otherwise we would not get EOF before all of them terminate.
+	fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+	// we have to read from many pipes at the same time to avoid stalling
+	const int flags = fcntl(pipefd[0], F_GETFL, 0);
+	if (flags == -1 || fcntl(pipefd[0], F_SETFL, flags | O_NONBLOCK) == -1) {
+		oscap_seterr(OSCAP_EFAMILY_SCE, "Failed to set nonblocking flag on pipe: %s", strerror(errno));
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return -1;
+	}
+	return 0;
+}
 
-	// We open a pipe for communication with the forked process
+/**
+ * Spawn the script of the job
+ * @returns false if the script could not be started at all
+ */
+static bool _sce_pool_job_start(struct sce_parameters *parameters, struct sce_job *job)
+{
+	// We open a pipe for communication with the spawned process
 	int stdout_pipefd[2];
 	int stderr_pipefd[2];
-	if (pipe(stdout_pipefd) == -1 || pipe(stderr_pipefd) == -1)
-	{
-		perror("pipe");
-		// the first 9 values (0 to 8) are compiled in
-		for (size_t i = 9; i < env_value_count; ++i)
-		{
-			free(env_values[i]);
-		}
-		free(env_values);
-		return XCCDF_RESULT_ERROR;
+	if (_sce_pipe(stdout_pipefd) == -1)
+		return false;
+	if (_sce_pipe(stderr_pipefd) == -1) {
+		close(stdout_pipefd[0]);
+		close(stdout_pipefd[1]);
+		return false;
 	}
 
 	// FIXME: We definitely want to impose security restrictions in the forked child process in the future.
 	//        This would prevent scripts from writing to files or deleting them.
 
-	int fork_result = fork();
-	if (fork_result >= 0)
-	{
-		// fork successful
+	const pid_t parent = getpid();
+	job->pid = fork();
+	if (job->pid == 0) {
+		// forward stdout and stderr to our custom opened pipes, all the other
+		// ends of the pipes get closed on exec
+		dup2(stdout_pipefd[1], STDOUT_FILENO);
+		dup2(stderr_pipefd[1], STDERR_FILENO);
 
-		if (fork_result == 0)
-		{
-		    // we won't read from the pipes, so close the reading fd
-		    close(stdout_pipefd[0]);
-		    close(stderr_pipefd[0]);
-
-			// forward stdout and stderr to our custom opened pipes
-			dup2(stdout_pipefd[1], fileno(stdout));
-			dup2(stderr_pipefd[1], fileno(stderr));
-
-			// we duplicated the file descriptors twice, we can close the original
-			// ones now, stdout and stderr will be closed properly after the execved
-			// script/executable finishes
-			close(stdout_pipefd[1]);
-			close(stderr_pipefd[1]);
-
-			// before we execute the script, lets make sure we get SIGTERM when
-			// oscap is killed, crashes or otherwise terminates
+		// before we execute the script, lets make sure we get SIGTERM when
+		// oscap is killed, crashes or otherwise terminates
 #ifdef PR_SET_PDEATHSIG
-			// requires Linux 2.1.57 or later
-			prctl(PR_SET_PDEATHSIG, SIGTERM);
+		// requires Linux 2.1.57 or later
+		prctl(PR_SET_PDEATHSIG, SIGTERM);
+		if (getppid() != parent)
+			_exit(103);
 #else
-			// TODO: Please provide alternatives
+		// TODO: Please provide alternatives
+		(void) parent;
 #endif
 
-			// we are the child process
-			execve(tmp_href, argvp, env_values);
+		char *argvp[1 + 1] = {
+			job->path,
+			NULL
+		};
+		execve(job->path, argvp, job->env);
+
+		// no need to check the return value of execve, if it returned at all we are in trouble
+		printf("Unexpected error when executing script '%s'. Error message follows.\n", job->href);
+		perror("execve");
+		fflush(stdout);
 
-			// no need to check the return value of execve, if it returned at all we are in trouble
-			printf("Unexpected error when executing script '%s'. Error message follows.\n", href);
-			perror("execve");
+		// the parent process considers us a script check, we have to return a value that will mean XCCDF_RESULT_ERROR
+		_exit(103);
+	}
+
+	// we won't write to the pipes, so close the writing fd
+	close(stdout_pipefd[1]);
+	close(stderr_pipefd[1]);
+
+	if (job->pid == -1) {
+		oscap_seterr(OSCAP_EFAMILY_SCE, "Failed to fork script '%s': %s", job->href, strerror(errno));
+		close(stdout_pipefd[0]);
+		close(stderr_pipefd[0]);
+		return false;
+	}
 
-			// the parent process considers us a script check, we have to return a value that will mean XCCDF_RESULT_ERROR
-			exit(103);
+	job->started = true;
+	job->stdout_fd = stdout_pipefd[0];
+	job->stderr_fd = stderr_pipefd[0];
+	parameters->running_jobs++;
+	return true;
+}
+
+/**
+ * Start queued jobs up to the maximal number of workers
+ */
+static void _sce_pool_schedule(struct sce_parameters *parameters)
+{
+	for (struct sce_job *job = parameters->jobs;
+			job != NULL && parameters->running_jobs < parameters->max_workers; job = job->next) {
+		if (!job->started && !_sce_pool_job_start(parameters, job)) {
+			job->started = true;
+			job->finished = true;
+			job->failed = true;
 		}
-		else
-		{
-			// we won't write to the pipes, so close the writing fd
-			close(stdout_pipefd[1]);
-			close(stderr_pipefd[1]);
-
-			const int flag_stdout = fcntl(stdout_pipefd[0], F_GETFL, 0);
-			if (flag_stdout == -1) {
-				oscap_seterr(OSCAP_EFAMILY_SCE, "Failed to obtain status of stdout pipe: %s",
-						strerror(errno));
-				return XCCDF_RESULT_ERROR;
-			}
-			int retval = fcntl(stdout_pipefd[0], F_SETFL, flag_stdout | O_NONBLOCK);
-			if (retval == -1) {
-				oscap_seterr(OSCAP_EFAMILY_SCE,
-						"Failed to set nonblocking flag on stdout pipe: %s",
-						strerror(errno));
-				return XCCDF_RESULT_ERROR;
-			}
+	}
+}
+
+static void _sce_pool_job_finish(struct sce_parameters *parameters, struct sce_job *job)
+{
+	int wstatus;
+	if (waitpid(job->pid, &wstatus, 0) == -1)
+		wstatus = 0;
+	job->exit_code = WEXITSTATUS(wstatus);
+	job->finished = true;
+	parameters->running_jobs--;
+}
 
-			const int flag_stderr = fcntl(stderr_pipefd[0], F_GETFL, 0);
-			if (flag_stderr == -1) {
-				oscap_seterr(OSCAP_EFAMILY_SCE,
-						"Failed to obtain status of stderr pipe: %s",
-						strerror(errno));
-				return XCCDF_RESULT_ERROR;
+/**
+ * Collect output of all the running jobs until the given one finishes
+ */
+static void _sce_pool_wait(struct sce_parameters *parameters, struct sce_job *job)
+{
+	while (!job->finished) {
+		struct pollfd fds[2 * parameters->running_jobs];
+		struct sce_job *fd_jobs[2 * parameters->running_jobs];
+		nfds_t nfds = 0;
+		for (struct sce_job *j = parameters->jobs; j != NULL; j = j->next) {
+			if (!j->started || j->finished)
+				continue;
+			if (j->stdout_fd != -1) {
+				fds[nfds].fd = j->stdout_fd;
+				fds[nfds].events = POLLIN;
+				fd_jobs[nfds++] = j;
 			}
-			retval = fcntl(stderr_pipefd[0], F_SETFL, flag_stderr | O_NONBLOCK);
-			if (retval == -1) {
-				oscap_seterr(OSCAP_EFAMILY_SCE,
-						"Failed to set nonblocking flag on stderr pipe: %s",
-						strerror(errno));
-				return XCCDF_RESULT_ERROR;
+			if (j->stderr_fd != -1) {
+				fds[nfds].fd = j->stderr_fd;
+				fds[nfds].events = POLLIN;
+				fd_jobs[nfds++] = j;
 			}
+		}
 
-			// we have to read from both pipes at the same time to avoid stalling
-			struct oscap_string *stdout_string = oscap_string_new();
-			struct oscap_string *stderr_string = oscap_string_new();
+		if (nfds > 0 && poll(fds, nfds, -1) == -1) {
+			if (errno == EINTR)
+				continue;
+			oscap_seterr(OSCAP_EFAMILY_SCE, "Failed to poll output of the scripts: %s", strerror(errno));
+			break;
+		}
+		for (nfds_t i = 0; i < nfds; i++) {
+			struct sce_job *j = fd_jobs[i];
+			if (fds[i].revents == 0)
+				continue;
+			if (fds[i].fd == j->stdout_fd)
+				_pipe_try_read_into_string(&j->stdout_fd, j->std_out);
+			else
+				_pipe_try_read_into_string(&j->stderr_fd, j->std_err);
+		}
 
-			bool stdout_eof = false;
-			bool stderr_eof = false;
+		// Both the pipes are closed, the script has terminated (or is about to)
+		for (struct sce_job *j = parameters->jobs; j != NULL; j = j->next) {
+			if (j->started && !j->finished && j->stdout_fd == -1 && j->stderr_fd == -1)
+				_sce_pool_job_finish(parameters, j);
+		}
+		_sce_pool_schedule(parameters);
+	}
+}
 
-			while (!stdout_eof || !stderr_eof) {
-				if (!stdout_eof)
-					_pipe_try_read_into_string(stdout_pipefd[0], stdout_string, &stdout_eof);
+static void _sce_pool_add(struct sce_parameters *parameters, struct sce_job *job)
+{
+	if (parameters->jobs_tail != NULL)
+		parameters->jobs_tail->next = job;
+	else
+		parameters->jobs = job;
+	parameters->jobs_tail = job;
+}
 
-				if (!stderr_eof)
-					_pipe_try_read_into_string(stderr_pipefd[0], stderr_string, &stderr_eof);
+static void _sce_pool_remove(struct sce_parameters *parameters, struct sce_job *job)
+{
+	struct sce_job **prev = &parameters->jobs;
+	struct sce_job *last = NULL;
+	while (*prev != job) {
+		last = *prev;
+		prev = &(*prev)->next;
+	}
+	*prev = job->next;
+	if (parameters->jobs_tail == job)
+		parameters->jobs_tail = last;
+	job->next = NULL;
+}
 
-				// sleep for 10ms to avoid wasting CPU
-				usleep(10 * 1000);
-			}
+static struct sce_job *_sce_pool_find(struct sce_parameters *parameters, const char *href, char **env, size_t env_count)
+{
+	for (struct sce_job *job = parameters->jobs; job != NULL; job = job->next) {
+		if (_sce_job_matches(job, href, env, env_count))
+			return job;
+	}
+	return NULL;
+}
 
-			close(stdout_pipefd[0]);
-			close(stderr_pipefd[0]);
+/**
+ * @returns path of the script or NULL if it cannot be executed
+ */
+static char *_sce_script_path(struct sce_parameters *parameters, const char *href, xccdf_test_result_type_t *result)
+{
+	char* tmp_href = oscap_sprintf("%s/%s", parameters->xccdf_directory, href);
 
-			char *stdout_buffer = oscap_string_bequeath(stdout_string);
-			char *stderr_buffer = oscap_string_bequeath(stderr_string);
+	if (access(tmp_href, F_OK))
+	{
+		// we only do this check to provide helpful error message
+		// there is an inherent race condition, the file might
+		// not exist anymore at the time we execve it!
 
-			// we are the parent process
-			int wstatus;
-			waitpid(fork_result, &wstatus, 0);
+		// the script hasn't been found, perhaps another sce instance
+		// with a different XCCDF directory can find it?
+		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE couldn't find script file '%s'. "
+				"Expected location: '%s'.", href, tmp_href);
+		free(tmp_href);
+		*result = XCCDF_RESULT_NOT_CHECKED;
+		return NULL;
+	}
 
-			// we subtract 100 here to shift the exit code to xccdf_test_result_type_t enum range
-			int raw_result = WEXITSTATUS(wstatus) - 100;
-			if (raw_result <= 0 || raw_result > XCCDF_RESULT_FIXED)
-			{
-				// the script returned invalid exit code, we need to safeguard us against that
-				raw_result = XCCDF_RESULT_ERROR;
-			}
+	if (access(tmp_href, F_OK | X_OK))
+	{
+		// again, only to provide helpful error message
+		oscap_seterr(OSCAP_EFAMILY_SCE, "SCE has found script file '%s' at '%s' "
+				"but it isn't executable!", href, tmp_href);
+		free(tmp_href);
+		*result = XCCDF_RESULT_ERROR;
+		return NULL;
+	}
+	return tmp_href;
+}
 
-			struct sce_session* session = sce_parameters_get_session(parameters);
-			if (session)
-			{
-				struct sce_check_result* check_result = sce_check_result_new();
-				sce_check_result_set_href(check_result, tmp_href);
-				sce_check_result_set_basename(check_result, basename(tmp_href));
-				sce_check_result_set_stdout(check_result, stdout_buffer);
-				sce_check_result_set_stderr(check_result, stderr_buffer);
-				sce_check_result_set_exit_code(check_result, WEXITSTATUS(wstatus));
-				sce_check_result_set_xccdf_result(check_result, (xccdf_test_result_type_t)raw_result);
-
-				for (size_t i = 0; i < env_value_count; ++i)
-				{
-					sce_check_result_add_environment_variable(check_result, env_values[i]);
-				}
+xccdf_test_result_type_t sce_engine_eval_rule(struct xccdf_policy *policy, const char *rule_id, const char *id, const char *href,
+		struct xccdf_value_binding_iterator *value_binding_it,
+		struct xccdf_check_import_iterator *check_import_it,
+		void *usr)
+{
+	struct sce_parameters* parameters = (struct sce_parameters*)usr;
 
-				sce_session_add_check_result(session, check_result);
-			}
+	xccdf_test_result_type_t result;
+	char *tmp_href = _sce_script_path(parameters, href, &result);
+	if (tmp_href == NULL)
+		return result;
 
-			// the first 10 values (0 to 9) are compiled in
-			for (size_t i = 10; i < env_value_count; ++i)
-			{
-				free(env_values[i]);
-			}
-			free(env_values);
-
-			// lets interpret the check imports passed to us
-			xccdf_check_import_iterator_reset(check_import_it);
-			while (xccdf_check_import_iterator_has_more(check_import_it))
-			{
-				struct xccdf_check_import * check_import = xccdf_check_import_iterator_next(check_import_it);
-				const char *name = xccdf_check_import_get_name(check_import);
-
-				if (strcmp(name, "stdout") == 0)
-				{
-					xccdf_check_import_set_content(check_import, stdout_buffer);
-				}
-				else if (strcmp(name, "stderr") == 0)
-				{
-					xccdf_check_import_set_content(check_import, stderr_buffer);
-				}
-			}
+	size_t env_value_count;
+	char **env_values = _sce_environment_new(value_binding_it, &env_value_count);
 
-			free(tmp_href);
-			free(stdout_buffer);
-			free(stderr_buffer);
+	// The script may have been started already by the batch evaluation
+	struct sce_job *job = _sce_pool_find(parameters, href, env_values, env_value_count);
+	if (job != NULL) {
+		for (size_t i = 0; i < env_value_count; ++i)
+			free(env_values[i]);
+		free(env_values);
+		free(tmp_href);
+	} else {
+		job = sce_job_new(href, tmp_href, env_values, env_value_count);
+		_sce_pool_add(parameters, job);
+	}
+	if (!job->started && !_sce_pool_job_start(parameters, job))
+		job->failed = true;
+	if (job->failed) {
+		_sce_pool_remove(parameters, job);
+		_sce_pool_job_free(parameters, job);
+		return XCCDF_RESULT_ERROR;
+	}
+	_sce_pool_wait(parameters, job);
+	_sce_pool_remove(parameters, job);
 
-			return (xccdf_test_result_type_t)raw_result;
+	const char *stdout_buffer = oscap_string_get_cstr(job->std_out);
+	const char *stderr_buffer = oscap_string_get_cstr(job->std_err);
+
+	// we subtract 100 here to shift the exit code to xccdf_test_result_type_t enum range
+	int raw_result = job->exit_code - 100;
+	if (raw_result <= 0 || raw_result > XCCDF_RESULT_FIXED)
+	{
+		// the script returned invalid exit code, we need to safeguard us against that
+		raw_result = XCCDF_RESULT_ERROR;
+	}
+
+	struct sce_session* session = sce_parameters_get_session(parameters);
+	if (session)
+	{
+		struct sce_check_result* check_result = sce_check_result_new();
+		sce_check_result_set_href(check_result, job->path);
+		char *path = oscap_strdup(job->path);
+		sce_check_result_set_basename(check_result, basename(path));
+		free(path);
+		sce_check_result_set_stdout(check_result, stdout_buffer);
+		sce_check_result_set_stderr(check_result, stderr_buffer);
+		sce_check_result_set_exit_code(check_result, job->exit_code);
+		sce_check_result_set_xccdf_result(check_result, (xccdf_test_result_type_t)raw_result);
+
+		for (size_t i = 0; i < job->env_count; ++i)
+		{
+			sce_check_result_add_environment_variable(check_result, job->env[i]);
 		}
+
+		sce_session_add_check_result(session, check_result);
 	}
-	else
+
+	// lets interpret the check imports passed to us
+	xccdf_check_import_iterator_reset(check_import_it);
+	while (xccdf_check_import_iterator_has_more(check_import_it))
 	{
-		// the first 9 values (0 to 8) are compiled in
-		for (size_t i = 9; i < env_value_count; ++i)
+		struct xccdf_check_import * check_import = xccdf_check_import_iterator_next(check_import_it);
+		const char *name = xccdf_check_import_get_name(check_import);
+
+		if (strcmp(name, "stdout") == 0)
 		{
-			free(env_values[i]);
+			xccdf_check_import_set_content(check_import, stdout_buffer);
 		}
-		free(env_values);
+		else if (strcmp(name, "stderr") == 0)
+		{
+			xccdf_check_import_set_content(check_import, stderr_buffer);
+		}
+	}
 
-		close(stdout_pipefd[0]);
-		close(stdout_pipefd[1]);
-		close(stderr_pipefd[0]);
-		close(stderr_pipefd[1]);
-		return XCCDF_RESULT_ERROR;
+	_sce_pool_job_free(parameters, job);
+	return (xccdf_test_result_type_t)raw_result;
+}
+
+/**
+ * Queue all the scripts of the batch, so that they run in parallel
+ * while the rules are being evaluated one by one.
+ */
+static int sce_engine_batch_eval(struct xccdf_policy *policy, const char *href, struct xccdf_policy_batch_check_iterator *checks_it, void *usr)
+{
+	struct sce_parameters* parameters = (struct sce_parameters*)usr;
+
+	char *tmp_href = oscap_sprintf("%s/%s", parameters->xccdf_directory, href);
+	if (access(tmp_href, F_OK | X_OK)) {
+		// The error gets reported when the rule is evaluated
+		free(tmp_href);
+		return 0;
 	}
+
+	while (xccdf_policy_batch_check_iterator_has_more(checks_it)) {
+		struct xccdf_policy_batch_check *check = xccdf_policy_batch_check_iterator_next(checks_it);
+		struct xccdf_value_binding_iterator *value_binding_it = xccdf_policy_batch_check_get_value_bindings(check);
+		size_t env_value_count;
+		char **env_values = _sce_environment_new(value_binding_it, &env_value_count);
+		xccdf_value_binding_iterator_free(value_binding_it);
+		_sce_pool_add(parameters, sce_job_new(href, oscap_strdup(tmp_href), env_values, env_value_count));
+	}
+	free(tmp_href);
+
+	_sce_pool_schedule(parameters);
+	return 0;
 }
 
 bool xccdf_policy_model_register_engine_sce(struct xccdf_policy_model * model, struct sce_parameters *parameters)
 {
-	return xccdf_policy_model_register_engine_and_query_callback(model,
-		"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, NULL);
+	return xccdf_policy_model_register_engine_and_batch_callback(model,
+		"http://open-scap.org/page/SCE", sce_engine_eval_rule, (void*)parameters, NULL, sce_engine_batch_eval);
 }
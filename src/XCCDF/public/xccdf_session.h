@@ -311,6 +311,18 @@ bool xccdf_session_set_xccdf_export(struct xccdf_session *session, const char *x
  */
 bool xccdf_session_set_xccdf_stig_viewer_export(struct xccdf_session *session, const char *xccdf_stig_viewer_file);
 
+/**
+ * Set where to stream XCCDF TestResult during evaluation. Each rule-result
+ * is written to the file right after its rule has been evaluated, so the file
+ * can be followed while the scan is running. Call this before
+ * xccdf_session_evaluate. NULL value means to not stream at all.
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param xccdf_stream_file path to the file with TestResult
+ * @returns true on success
+ */
+bool xccdf_session_set_xccdf_stream_export(struct xccdf_session *session, const char *xccdf_stream_file);
+
 /**
  * Set where to export ARF file. NULL value means to not export at all.
  * @memberof xccdf_session
@@ -456,6 +468,45 @@ int xccdf_session_load_tailoring(struct xccdf_session *session);
  */
 int xccdf_session_evaluate(struct xccdf_session *session);
 
+/**
+ * Callback invoked for every target evaluated by @ref xccdf_session_evaluate_targets.
+ * The session holds the results of the given target when the callback is
+ * invoked, the callback is supposed to export them (e.g. by setting export
+ * file names and calling @ref xccdf_session_export_xccdf).
+ * @param session XCCDF Session
+ * @param root root directory of the target
+ * @param index index of the target in the array of roots
+ * @param arg user data
+ * @returns value between 0 and 254 which is reported as the target status
+ */
+typedef int (*xccdf_session_target_fn)(struct xccdf_session *session, const char *root, size_t index, void *arg);
+
+/**
+ * Evaluate XCCDF Policy against multiple offline targets.
+ *
+ * The loaded content is evaluated against every root directory (e.g. mounted
+ * container or VM images) in the offline mode. Each target is evaluated in a
+ * separate process which shares the already parsed content with the caller,
+ * at most @a jobs targets are evaluated at the same time. OVAL definitions are
+ * imported once by the caller, every target gets just its own OVAL agents. This
+ * function shall be called after @ref xccdf_session_load and the OVAL agents
+ * of the session are released by the call. Call @ref xccdf_session_load_oval to evaluate the session itself
+ * again. Remediation is not supported in the offline mode.
+ *
+ * @memberof xccdf_session
+ * @param session XCCDF Session
+ * @param roots array of root directories of the targets
+ * @param count number of targets
+ * @param jobs maximum number of concurrent evaluations, 0 means number of CPUs
+ * @param fn callback invoked with the results of every target, can be NULL
+ * @param arg user data passed to the callback
+ * @param statuses array of count elements, filled with return values of the
+ * callback, or -1 if the target could not be evaluated
+ * @returns zero if all targets were evaluated
+ */
+int xccdf_session_evaluate_targets(struct xccdf_session *session, const char * const roots[], size_t count,
+		unsigned int jobs, xccdf_session_target_fn fn, void *arg, int statuses[]);
+
 /**
  * Export XCCDF file.
  * @memberof xccdf_session
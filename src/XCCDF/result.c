@@ -933,22 +933,28 @@ void xccdf_result_to_dom(struct xccdf_result *result, xmlNode *result_node, xmlD
 	struct xccdf_score_iterator *scores = xccdf_result_get_scores(result);
 	while (xccdf_score_iterator_has_more(scores)) {
 		struct xccdf_score *score = xccdf_score_iterator_next(scores);
+		xccdf_score_to_dom(score, doc, result_node, version_info);
+	}
+	xccdf_score_iterator_free(scores);
+}
 
-                float value = xccdf_score_get_score(score);
-                char *value_str = oscap_sprintf("%f", value);
-                xmlNode *score_node = xmlNewTextChild(result_node, ns_xccdf, BAD_CAST "score", BAD_CAST value_str);
-                free(value_str);
+xmlNode *xccdf_score_to_dom(struct xccdf_score *score, xmlDoc *doc, xmlNode *parent, const struct xccdf_version_info* version_info)
+{
+	xmlNs *ns_xccdf = lookup_xccdf_ns(doc, parent, version_info);
 
-		const char *sys = xccdf_score_get_system(score);
-		if (sys)
-			xmlNewProp(score_node, BAD_CAST "system", BAD_CAST sys);
+	char *value_str = oscap_sprintf("%f", xccdf_score_get_score(score));
+	xmlNode *score_node = xmlNewTextChild(parent, ns_xccdf, BAD_CAST "score", BAD_CAST value_str);
+	free(value_str);
 
-		float max = xccdf_score_get_maximum(score);
-		char *max_str = oscap_sprintf("%f", max);
-		xmlNewProp(score_node, BAD_CAST "maximum", BAD_CAST max_str);
-        free(max_str);
-	}
-	xccdf_score_iterator_free(scores);
+	const char *sys = xccdf_score_get_system(score);
+	if (sys)
+		xmlNewProp(score_node, BAD_CAST "system", BAD_CAST sys);
+
+	char *max_str = oscap_sprintf("%f", xccdf_score_get_maximum(score));
+	xmlNewProp(score_node, BAD_CAST "maximum", BAD_CAST max_str);
+	free(max_str);
+
+	return score_node;
 }
 
 static struct xccdf_identity *xccdf_identity_new_parse(xmlTextReaderPtr reader)
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <libxml/tree.h>
+#include <libxml/xmlwriter.h>
+
+#include "common/_error.h"
+#include "common/debug_priv.h"
+#include "helpers.h"
+#include "item.h"
+#include "xccdf_impl.h"
+#include "result_stream_priv.h"
+
+struct xccdf_result_stream {
+	char *filepath;                                 ///< Path to the output file
+	int fd;                                         ///< Output file
+	xmlTextWriter *writer;                          ///< Writer of the TestResult element
+	xmlDoc *doc;                                    ///< Scratch document to build children of TestResult in
+	xmlNode *root;                                  ///< TestResult element of the scratch document
+	int root_ns_count;                              ///< Namespaces declared on TestResult in the file
+	const struct xccdf_version_info *version_info;  ///< XCCDF version of the TestResult
+	struct xccdf_benchmark *benchmark;              ///< Benchmark of the TestResult
+	char *start_time;                               ///< Value written as end-time before the evaluation ends
+	off_t end_time_offset;                          ///< Position of the end-time value in the file (or -1)
+	xccdf_result_stream_prepare_fn prepare;
+	void *prepare_arg;
+};
+
+struct xccdf_result_stream *xccdf_result_stream_new(const char *filepath, xccdf_result_stream_prepare_fn prepare, void *arg)
+{
+	int fd = open(filepath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not open %s: %s", filepath, strerror(errno));
+		return NULL;
+	}
+	xmlOutputBuffer *out = xmlOutputBufferCreateFd(fd, NULL);
+	xmlTextWriter *writer = out != NULL ? xmlNewTextWriter(out) : NULL;
+	if (writer == NULL) {
+		oscap_setxmlerr(xmlGetLastError());
+		if (out != NULL)
+			xmlOutputBufferClose(out);
+		close(fd);
+		return NULL;
+	}
+
+	struct xccdf_result_stream *stream = calloc(1, sizeof(struct xccdf_result_stream));
+	stream->filepath = oscap_strdup(filepath);
+	stream->fd = fd;
+	stream->writer = writer;
+	stream->end_time_offset = -1;
+	stream->prepare = prepare;
+	stream->prepare_arg = arg;
+	return stream;
+}
+
+void xccdf_result_stream_free(struct xccdf_result_stream *stream)
+{
+	if (stream == NULL)
+		return;
+	xmlFreeTextWriter(stream->writer);
+	close(stream->fd);
+	xmlFreeDoc(stream->doc);
+	free(stream->start_time);
+	free(stream->filepath);
+	free(stream);
+}
+
+static int xccdf_result_stream_flush(struct xccdf_result_stream *stream)
+{
+	if (xmlTextWriterFlush(stream->writer) < 0) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not write XCCDF results to %s", stream->filepath);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Children of TestResult are built in the scratch document by the same code
+ * which builds the whole TestResult DOM, then they are written out one by one
+ * and disposed.
+ */
+static int xccdf_result_stream_write_node(struct xccdf_result_stream *stream, xmlNode *node)
+{
+	// Namespaces declared on TestResult after its start tag has been
+	// written out need to be declared on the child itself.
+	int i = 0;
+	for (xmlNs *ns = stream->root->nsDef; ns != NULL; ns = ns->next, i++) {
+		if (i >= stream->root_ns_count)
+			xmlNewNs(node, ns->href, ns->prefix);
+	}
+
+	xmlBuffer *buffer = xmlBufferCreate();
+	xmlNodeDump(buffer, stream->doc, node, 1, 1);
+	int ret = xmlTextWriterWriteRaw(stream->writer, BAD_CAST "\n  ") < 0 ||
+		xmlTextWriterWriteRaw(stream->writer, xmlBufferContent(buffer)) < 0 ? -1 : 0;
+	xmlBufferFree(buffer);
+	xmlUnlinkNode(node);
+	xmlFreeNode(node);
+	if (ret != 0)
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not write XCCDF results to %s", stream->filepath);
+	return ret;
+}
+
+/*
+ * Find the value of the end-time attribute among the bytes written to the
+ * file between the given positions. The writer is free to choose quoting
+ * and spacing, so the written attribute is looked up instead of assumed.
+ */
+static off_t xccdf_result_stream_find_end_time(struct xccdf_result_stream *stream, off_t from, off_t to)
+{
+	size_t len = to - from;
+	char *written = malloc(len + 1);
+	off_t offset = -1;
+	if (pread(stream->fd, written, len, from) == (ssize_t) len) {
+		written[len] = '\0';
+		const char *attr = strstr(written, "end-time");
+		const char *value = attr != NULL ? attr + strlen("end-time") : NULL;
+		while (value != NULL && (*value == ' ' || *value == '='))
+			value++;
+		if (value != NULL && (*value == '"' || *value == '\'') &&
+				strncmp(value + 1, stream->start_time, strlen(stream->start_time)) == 0)
+			offset = from + (value + 1 - written);
+	}
+	free(written);
+	return offset;
+}
+
+int xccdf_result_stream_start(struct xccdf_result_stream *stream, struct xccdf_result *result, struct xccdf_benchmark *benchmark)
+{
+	if (stream->prepare != NULL)
+		stream->prepare(result, stream->prepare_arg);
+
+	// The TestResult gets attached to its benchmark only after the evaluation.
+	stream->version_info = xccdf_benchmark_get_schema_version(benchmark);
+	stream->benchmark = benchmark;
+	stream->start_time = oscap_strdup(xccdf_result_get_start_time(result));
+	xccdf_result_set_schema_version(result, stream->version_info);
+
+	// There are no rule-results yet, so this is just the header.
+	stream->doc = xmlNewDoc(BAD_CAST "1.0");
+	xccdf_result_to_dom(result, NULL, stream->doc, NULL, false);
+	stream->root = xmlDocGetRootElement(stream->doc);
+	xmlNode *benchmark_ref = stream->root->children;
+	if (benchmark_ref != NULL && oscap_streq((const char *) benchmark_ref->name, "benchmark") &&
+			xccdf_version_cmp(stream->version_info, "1.2") >= 0 && !xmlHasProp(benchmark_ref, BAD_CAST "id"))
+		xmlNewProp(benchmark_ref, BAD_CAST "id", BAD_CAST xccdf_benchmark_get_id(benchmark));
+
+	if (xmlTextWriterStartDocument(stream->writer, NULL, "UTF-8", NULL) < 0 ||
+			xmlTextWriterStartElementNS(stream->writer, NULL, stream->root->name,
+				BAD_CAST xccdf_version_info_get_namespace_uri(stream->version_info)) < 0) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not write XCCDF results to %s", stream->filepath);
+		return -1;
+	}
+	for (xmlNs *ns = stream->root->nsDef; ns != NULL; ns = ns->next, stream->root_ns_count++) {
+		if (ns->prefix == NULL)
+			continue;
+		char *name = oscap_sprintf("xmlns:%s", (const char *) ns->prefix);
+		int ret = xmlTextWriterWriteAttribute(stream->writer, BAD_CAST name, ns->href);
+		free(name);
+		if (ret < 0)
+			return -1;
+	}
+	for (xmlAttr *attr = stream->root->properties; attr != NULL; attr = attr->next) {
+		xmlChar *value = xmlNodeGetContent((xmlNode *) attr);
+		off_t end_time_from = -1;
+		if (oscap_streq((const char *) attr->name, "end-time") && stream->start_time != NULL) {
+			// The real end-time is written over this once the evaluation finishes.
+			if (xccdf_result_stream_flush(stream) == 0)
+				end_time_from = lseek(stream->fd, 0, SEEK_CUR);
+			xmlFree(value);
+			value = xmlStrdup(BAD_CAST stream->start_time);
+		}
+		int ret = xmlTextWriterWriteAttribute(stream->writer, attr->name, value != NULL ? value : BAD_CAST "");
+		xmlFree(value);
+		if (ret < 0) {
+			oscap_seterr(OSCAP_EFAMILY_XML, "Could not write XCCDF results to %s", stream->filepath);
+			return -1;
+		}
+		if (end_time_from != -1 && xccdf_result_stream_flush(stream) == 0) {
+			off_t end_time_to = lseek(stream->fd, 0, SEEK_CUR);
+			if (end_time_to > end_time_from)
+				stream->end_time_offset = xccdf_result_stream_find_end_time(stream, end_time_from, end_time_to);
+		}
+	}
+
+	while (stream->root->children != NULL) {
+		if (xccdf_result_stream_write_node(stream, stream->root->children) != 0)
+			return -1;
+	}
+	return xccdf_result_stream_flush(stream);
+}
+
+int xccdf_result_stream_write_rule_result(struct xccdf_result_stream *stream, struct xccdf_rule_result *rule_result)
+{
+	if (stream->root == NULL)
+		return 0;
+	xmlNode *node = xccdf_rule_result_to_dom(rule_result, stream->doc, stream->root, stream->version_info, stream->benchmark, false);
+	if (node == NULL)
+		return 0;
+	if (xccdf_result_stream_write_node(stream, node) != 0)
+		return -1;
+	return xccdf_result_stream_flush(stream);
+}
+
+static int xccdf_result_stream_write_scores(struct xccdf_result_stream *stream, struct xccdf_result *result)
+{
+	int ret = 0;
+	struct xccdf_score_iterator *scores = xccdf_result_get_scores(result);
+	while (ret == 0 && xccdf_score_iterator_has_more(scores)) {
+		struct xccdf_score *score = xccdf_score_iterator_next(scores);
+		xmlNode *score_node = xccdf_score_to_dom(score, stream->doc, stream->root, stream->version_info);
+		ret = xccdf_result_stream_write_node(stream, score_node);
+	}
+	xccdf_score_iterator_free(scores);
+	return ret;
+}
+
+int xccdf_result_stream_finish(struct xccdf_result_stream *stream, struct xccdf_result *result)
+{
+	if (stream->root == NULL)
+		return 0;
+	if (xccdf_result_stream_write_scores(stream, result) != 0)
+		return -1;
+	if (xmlTextWriterWriteRaw(stream->writer, BAD_CAST "\n") < 0 ||
+			xmlTextWriterEndDocument(stream->writer) < 0 ||
+			xccdf_result_stream_flush(stream) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_XML, "Could not write XCCDF results to %s", stream->filepath);
+		return -1;
+	}
+
+	// Timestamps have fixed length, the end-time can be overwritten in place.
+	const char *end_time = xccdf_result_get_end_time(result);
+	if (stream->end_time_offset != -1 && end_time != NULL && strlen(end_time) == strlen(stream->start_time)) {
+		if (pwrite(stream->fd, end_time, strlen(end_time), stream->end_time_offset) != (ssize_t) strlen(end_time)) {
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not write end-time to %s: %s", stream->filepath, strerror(errno));
+			return -1;
+		}
+	} else {
+		dW("End time of TestResult has not been written to %s.", stream->filepath);
+	}
+	return 0;
+}
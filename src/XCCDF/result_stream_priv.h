@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef XCCDF_RESULT_STREAM_PRIV_H
+#define XCCDF_RESULT_STREAM_PRIV_H
+
+#include "common/util.h"
+#include "public/xccdf_benchmark.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * Writer of XCCDF TestResult which runs along the evaluation. The TestResult
+ * element is written out as soon as the evaluation starts and every
+ * rule-result is appended (and flushed) right after its rule has been
+ * evaluated, so that the file can be followed while the scan is running.
+ *
+ * The streamed TestResult has the same content as the one exported by
+ * xccdf_result_export, except for the platform elements which are only known
+ * after all rules have been evaluated and would have to precede rule-results.
+ * Until the evaluation finishes, the end-time attribute holds the start time
+ * and the TestResult is not closed.
+ *
+ * Streaming doesn't save memory, rule-results are still kept in the
+ * TestResult because scoring and the other exports need them.
+ */
+struct xccdf_result_stream;
+
+/**
+ * Function to fill in the TestResult before its header gets written out.
+ */
+typedef void (*xccdf_result_stream_prepare_fn)(struct xccdf_result *result, void *arg);
+
+/**
+ * Create new TestResult stream.
+ * @param filepath path to the file to write TestResult into
+ * @param prepare function to complete the TestResult header or NULL
+ * @param arg user argument of prepare
+ * @returns newly created stream or NULL on error
+ */
+struct xccdf_result_stream *xccdf_result_stream_new(const char *filepath, xccdf_result_stream_prepare_fn prepare, void *arg);
+
+/**
+ * Write out the TestResult element up to the first rule-result. Called once
+ * the TestResult has been created, before any rule is evaluated.
+ * @param stream TestResult stream
+ * @param result TestResult being evaluated
+ * @param benchmark benchmark the TestResult is going to be added to
+ * @returns 0 on success
+ */
+int xccdf_result_stream_start(struct xccdf_result_stream *stream, struct xccdf_result *result, struct xccdf_benchmark *benchmark);
+
+/**
+ * Append rule-result to the TestResult and flush it to the file.
+ * @param stream TestResult stream
+ * @param rule_result rule-result to write out
+ * @returns 0 on success
+ */
+int xccdf_result_stream_write_rule_result(struct xccdf_result_stream *stream, struct xccdf_rule_result *rule_result);
+
+/**
+ * Write out scores, close the TestResult and set its real end-time.
+ * @param stream TestResult stream
+ * @param result TestResult which has been evaluated
+ * @returns 0 on success
+ */
+int xccdf_result_stream_finish(struct xccdf_result_stream *stream, struct xccdf_result *result);
+
+/**
+ * Close the file and dispose the stream.
+ */
+void xccdf_result_stream_free(struct xccdf_result_stream *stream);
+
+OSCAP_HIDDEN_END;
+
+#endif
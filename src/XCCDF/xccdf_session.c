@@ -24,8 +24,11 @@
 #include <config.h>
 #endif
 
+#include <fcntl.h>
 #include <libgen.h>
+#include <poll.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include <oscap.h>
@@ -46,9 +49,12 @@
 #include "DS/ds_sds_session_priv.h"
 #include "DS/rds_priv.h"
 #include "DS/sds_priv.h"
+#include "OVAL/oval_agent_api_impl.h"
+#include "OVAL/oval_collection_cache.h"
 #include "OVAL/results/oval_results_impl.h"
 #include "source/xslt_priv.h"
 #include "XCCDF/xccdf_impl.h"
+#include "XCCDF/result_stream_priv.h"
 #include "XCCDF_POLICY/public/xccdf_policy.h"
 #include "XCCDF_POLICY/xccdf_policy_priv.h"
 #include "XCCDF_POLICY/xccdf_policy_model_priv.h"
@@ -86,7 +92,9 @@ struct xccdf_session {
 		download_progress_calllback_t progress;	///< Callback to report progress of download.
 		struct oval_content_resource **custom_resources;///< OVAL files required by user
 		struct oval_content_resource **resources;///< OVAL files referenced from XCCDF
+		struct oval_definition_model **def_models;///< Definition models of the OVAL files, in the order of the files
 		struct oval_agent_session **agents;	///< OVAL Agent Session
+		struct oval_collection_cache *collection_cache;///< Objects collected by any of the agents, shared between them
 		xccdf_policy_engine_eval_fn user_eval_fn;///< Custom OVAL engine callback
 		char *product_cpe;			///< CPE of scanner product.
 		struct oscap_source* arf_report;	///< ARF report
@@ -98,6 +106,7 @@ struct xccdf_session {
 		char *arf_file;				///< Path to ARF file to export
 		char *xccdf_file;			///< Path to XCCDF file to export
 		char *xccdf_stig_viewer_file;		///< Path to STIG Viewer XCCDF file to export
+		char *xccdf_stream_file;		///< Path to XCCDF TestResult file to write during evaluation
 		char *report_file;			///< Path to HTML file to eport
 		bool oval_results;			///< Shall be the OVAL results files exported?
 		bool oval_variables;			///< Shall be the OVAL variable files exported?
@@ -120,6 +129,7 @@ struct xccdf_session {
 static int _xccdf_session_autonegotiate_tailoring_file(struct xccdf_session *session, const char *original_path);
 static void _oval_content_resources_free(struct oval_content_resource **resources);
 static void _xccdf_session_free_oval_agents(struct xccdf_session *session);
+static void _xccdf_session_free_oval_models(struct xccdf_session *session);
 static void _xccdf_session_free_oval_result_sources(struct xccdf_session *session);
 
 static const char *oscap_productname = "cpe:/a:open-scap:oscap";
@@ -152,6 +162,7 @@ struct xccdf_session *xccdf_session_new_from_source(struct oscap_source *source)
 	session->oval.progress = download_progress_empty_calllback;
 	session->check_engine_plugins = oscap_list_new();
 	session->loading_flags = XCCDF_SESSION_LOAD_ALL;
+	session->oval.collection_cache = oval_collection_cache_new();
 
 	// We now have to switch up the oscap_sources in case we were given XCCDF tailoring
 
@@ -248,6 +259,7 @@ void xccdf_session_free(struct xccdf_session *session)
 	free(session->xccdf.profile_id);
 	free(session->export.xccdf_file);
 	free(session->export.xccdf_stig_viewer_file);
+	free(session->export.xccdf_stream_file);
 	free(session->export.report_file);
 	free(session->export.arf_file);
 	_xccdf_session_free_oval_result_sources(session);
@@ -256,12 +268,14 @@ void xccdf_session_free(struct xccdf_session *session)
 	free(session->user_cpe);
 	free(session->oval.product_cpe);
 	_xccdf_session_free_oval_agents(session);
+	_xccdf_session_free_oval_models(session);
 	_oval_content_resources_free(session->oval.custom_resources);
 	_oval_content_resources_free(session->oval.resources);
 	oscap_source_free(session->oval.arf_report);
 	oscap_source_free(session->xccdf.result_source);
 	if (session->xccdf.policy_model != NULL)
 		xccdf_policy_model_free(session->xccdf.policy_model);
+	oval_collection_cache_free(session->oval.collection_cache);
 	free(session->ds.user_datastream_id);
 	free(session->ds.user_component_id);
 	free(session->ds.user_benchmark_id);
@@ -423,6 +437,13 @@ bool xccdf_session_set_xccdf_stig_viewer_export(struct xccdf_session *session, c
 	return true;
 }
 
+bool xccdf_session_set_xccdf_stream_export(struct xccdf_session *session, const char *xccdf_stream_file)
+{
+	free(session->export.xccdf_stream_file);
+	session->export.xccdf_stream_file = oscap_strdup(xccdf_stream_file);
+	return true;
+}
+
 bool xccdf_session_set_report_export(struct xccdf_session *session, const char *report_file)
 {
 	free(session->export.report_file);
@@ -773,6 +794,7 @@ int xccdf_session_load_cpe(struct xccdf_session *session)
 	// to apply the thin results settings to them.
 	struct cpe_session *cpe_session = xccdf_policy_model_get_cpe_session(session->xccdf.policy_model);
 	cpe_session_set_thin_results(cpe_session, session->export.thin_results);
+	cpe_session_set_collection_cache(cpe_session, session->oval.collection_cache);
 
 	/* Use custom CPE dict if given */
 	if (session->user_cpe != NULL) {
@@ -982,21 +1004,37 @@ static int _xccdf_session_get_oval_from_model(struct xccdf_session *session)
 static void _xccdf_session_free_oval_agents(struct xccdf_session *session)
 {
 	if (session->oval.agents != NULL) {
-		for (int i=0; session->oval.agents[i]; i++) {
-			struct oval_definition_model *def_model = oval_agent_get_definition_model(session->oval.agents[i]);
-			oval_definition_model_free(def_model);
+		for (int i=0; session->oval.agents[i]; i++)
 			oval_agent_destroy_session(session->oval.agents[i]);
-		}
 		free(session->oval.agents);
 		session->oval.agents = NULL;
 	}
 }
 
-int xccdf_session_load_oval(struct xccdf_session *session)
+static void _xccdf_session_free_oval_models(struct xccdf_session *session)
+{
+	if (session->oval.def_models != NULL) {
+		for (int i=0; session->oval.def_models[i]; i++)
+			oval_definition_model_free(session->oval.def_models[i]);
+		free(session->oval.def_models);
+		session->oval.def_models = NULL;
+	}
+}
+
+static struct oval_content_resource **_xccdf_session_get_oval_contents(struct xccdf_session *session)
+{
+	return session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
+}
+
+/*
+ * Import definition models of all the OVAL files. The models don't depend
+ * on the scanned system, they can be shared by agents of any target.
+ */
+static int _xccdf_session_import_oval_models(struct xccdf_session *session)
 {
 	struct oval_content_resource **contents = NULL;
 
-	_xccdf_session_free_oval_agents(session);
+	_xccdf_session_free_oval_models(session);
 
 	/* Locate all OVAL files */
 	if (session->oval.custom_resources == NULL) {
@@ -1005,7 +1043,7 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 			return 1;
 	}
 
-	contents = session->oval.custom_resources != NULL ? session->oval.custom_resources : session->oval.resources;
+	contents = _xccdf_session_get_oval_contents(session);
 
 	/* Validate OVAL files. Only validate if the file doesn't come from a datastream
 	 * or if full validation was explicitly requested.
@@ -1022,20 +1060,45 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 		}
 	}
 
+	int count = 0;
+	while (contents[count])
+		count++;
+	session->oval.def_models = calloc(count + 1, sizeof(struct oval_definition_model *));
+
 	for (int idx=0; contents[idx]; idx++) {
 		/* file -> def_model */
 		struct oval_definition_model *tmp_def_model = oval_definition_model_import_source(contents[idx]->source);
 		if (tmp_def_model == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create OVAL definition model from: '%s'.",
 				oscap_source_readable_origin(contents[idx]->source));
+			_xccdf_session_free_oval_models(session);
 			return 1;
 		}
+		session->oval.def_models[idx] = tmp_def_model;
+	}
+	dI("Imported %d OVAL definition models.", count);
+	return 0;
+}
+
+/*
+ * Create OVAL agents of the imported definition models, their probes scan
+ * the system given by OSCAP_PROBE_ROOT.
+ */
+static int _xccdf_session_new_oval_agents(struct xccdf_session *session)
+{
+	struct oval_content_resource **contents = _xccdf_session_get_oval_contents(session);
+
+	_xccdf_session_free_oval_agents(session);
+	/* The system might have changed since the last load (e.g. remediation) */
+	oval_collection_cache_clear(session->oval.collection_cache);
+
+	for (int idx=0; session->oval.def_models[idx]; idx++) {
+		struct oval_definition_model *tmp_def_model = session->oval.def_models[idx];
 
 		/* def_model -> session */
-		struct oval_agent_session *tmp_sess = oval_agent_new_session(tmp_def_model, contents[idx]->href);
+		struct oval_agent_session *tmp_sess = oval_agent_new_session_with_cache(tmp_def_model, contents[idx]->href, session->oval.collection_cache);
 		if (tmp_sess == NULL) {
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Failed to create new OVAL agent session for: '%s'.", contents[idx]->href);
-			oval_definition_model_free(tmp_def_model);
 			return 2;
 		}
 
@@ -1072,6 +1135,16 @@ int xccdf_session_load_oval(struct xccdf_session *session)
 	return 0;
 }
 
+int xccdf_session_load_oval(struct xccdf_session *session)
+{
+	_xccdf_session_free_oval_agents(session);
+
+	int ret = _xccdf_session_import_oval_models(session);
+	if (ret != 0)
+		return ret;
+	return _xccdf_session_new_oval_agents(session);
+}
+
 int xccdf_session_load_check_engine_plugin2(struct xccdf_session *session, const char *plugin_name, bool quiet)
 {
 	struct check_engine_plugin_def *plugin = check_engine_plugin_load2(plugin_name, quiet);
@@ -1185,6 +1258,22 @@ int xccdf_session_load_tailoring(struct xccdf_session *session)
 	return xccdf_policy_model_set_tailoring(session->xccdf.policy_model, tailoring) ? 0 : 1;
 }
 
+static void _xccdf_session_fill_result(struct xccdf_result *result, void *arg)
+{
+	struct xccdf_session *session = arg;
+
+	/* Write results into XCCDF Test Result model */
+	xccdf_result_set_benchmark_uri(result, oscap_source_readable_origin(session->source));
+	struct oscap_text *title = oscap_text_new();
+	oscap_text_set_text(title, "OSCAP Scan Result");
+	xccdf_result_add_title(result, title);
+	struct xccdf_benchmark *benchmark = xccdf_policy_model_get_benchmark(session->xccdf.policy_model);
+	xccdf_result_set_version(result,
+			benchmark != NULL ? xccdf_benchmark_get_version(benchmark) : NULL);
+
+	xccdf_result_fill_sysinfo(result);
+}
+
 int xccdf_session_evaluate(struct xccdf_session *session)
 {
 	struct xccdf_policy *policy = xccdf_session_get_xccdf_policy(session);
@@ -1194,20 +1283,29 @@ int xccdf_session_evaluate(struct xccdf_session *session)
 	}
 	policy->rule = session->rule;
 
+	struct xccdf_result_stream *stream = NULL;
+	if (session->export.xccdf_stream_file != NULL) {
+		// The header of TestResult is filled in before it gets written out.
+		stream = xccdf_result_stream_new(session->export.xccdf_stream_file, _xccdf_session_fill_result, session);
+		if (stream == NULL)
+			return 1;
+	}
+	policy->result_stream = stream;
 	session->xccdf.result = xccdf_policy_evaluate(policy);
-	if (session->xccdf.result == NULL)
+	// The policy drops the stream if writing into it fails, the scan goes on without it.
+	bool stream_failed = stream != NULL && policy->result_stream == NULL;
+	policy->result_stream = NULL;
+	if (session->xccdf.result == NULL) {
+		xccdf_result_stream_free(stream);
 		return 1;
+	}
 
-	/* Write results into XCCDF Test Result model */
-	xccdf_result_set_benchmark_uri(session->xccdf.result, oscap_source_readable_origin(session->source));
-	struct oscap_text *title = oscap_text_new();
-	oscap_text_set_text(title, "OSCAP Scan Result");
-	xccdf_result_add_title(session->xccdf.result, title);
-	struct xccdf_benchmark *benchmark = xccdf_policy_get_benchmark(policy);
-	xccdf_result_set_version(session->xccdf.result,
-			benchmark != NULL ? xccdf_benchmark_get_version(benchmark) : NULL);
-
-	xccdf_result_fill_sysinfo(session->xccdf.result);
+	if (stream == NULL)
+		_xccdf_session_fill_result(session->xccdf.result, session);
+	if (stream_failed) {
+		xccdf_result_stream_free(stream);
+		stream = NULL;
+	}
 
 	struct xccdf_model_iterator *model_it = xccdf_benchmark_get_models(xccdf_policy_model_get_benchmark(session->xccdf.policy_model));
 	while (xccdf_model_iterator_has_more(model_it)) {
@@ -1221,9 +1319,182 @@ int xccdf_session_evaluate(struct xccdf_session *session)
 			session->xccdf.base_score = xccdf_score_get_score(score);
 	}
 	xccdf_model_iterator_free(model_it);
+
+	if (stream != NULL) {
+		if (xccdf_result_stream_finish(stream, session->xccdf.result) != 0)
+			dW("Could not finish streamed TestResult in '%s'.", session->export.xccdf_stream_file);
+		xccdf_result_stream_free(stream);
+	}
 	return 0;
 }
 
+static int _xccdf_session_evaluate_target(struct xccdf_session *session, const char *root, size_t index, xccdf_session_target_fn fn, void *arg)
+{
+	char *target = oscap_sprintf("chroot://%s", root);
+	int ret = -1;
+
+	/* Probes spawned by the OVAL agents below pick up the root from the environment */
+	if (setenv("OSCAP_PROBE_ROOT", root, 1) != 0 || setenv("OSCAP_EVALUATION_TARGET", target, 1) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't set up the environment for target '%s': %s", root, strerror(errno));
+		goto cleanup;
+	}
+	if (_xccdf_session_new_oval_agents(session) != 0 || xccdf_session_evaluate(session) != 0)
+		goto cleanup;
+
+	ret = fn != NULL ? fn(session, root, index, arg) : 0;
+cleanup:
+	free(target);
+	return ret;
+}
+
+static void _xccdf_session_evaluate_target_child(struct xccdf_session *session, const char *root, size_t index, xccdf_session_target_fn fn, void *arg)
+{
+	int ret = _xccdf_session_evaluate_target(session, root, index, fn, arg);
+
+	if (ret < 0 || ret > 254) {
+		if (oscap_err())
+			fprintf(stderr, "Evaluation of target '%s' failed: %s\n", root, oscap_err_desc());
+		ret = 255;
+	}
+	/* Shut down the probes of this target, anything else is released by the exit */
+	_xccdf_session_free_oval_agents(session);
+	fflush(NULL);
+	_exit(ret);
+}
+
+int xccdf_session_evaluate_targets(struct xccdf_session *session, const char * const roots[], size_t count,
+		unsigned int jobs, xccdf_session_target_fn fn, void *arg, int statuses[])
+{
+	size_t next = 0, running = 0;
+	int ret = 0;
+
+	if (session->xccdf.policy_model == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "XCCDF content needs to be loaded before targets are evaluated.");
+		return 1;
+	}
+	if (jobs == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		jobs = cpus > 0 ? (unsigned int) cpus : 1;
+	}
+	for (size_t i = 0; i < count; i++)
+		statuses[i] = -1;
+
+	/*
+	 * Probes are bound to the root they were started in, so every target
+	 * gets its own OVAL agents. Make sure that no probe of this process
+	 * is inherited by the children, neither by the agents of the XCCDF
+	 * checks nor by those of the CPE checks, and that no CPE outcome of
+	 * this system is reused for the targets.
+	 */
+	xccdf_policy_model_unregister_engines(session->xccdf.policy_model, oval_sysname);
+	_xccdf_session_free_oval_agents(session);
+	cpe_session_reset_results(xccdf_policy_model_get_cpe_session(session->xccdf.policy_model));
+
+	/*
+	 * The definition models are the same for all targets, import them
+	 * once here. The children inherit them and create just the agents.
+	 */
+	if (_xccdf_session_import_oval_models(session) != 0)
+		return 1;
+
+	/*
+	 * Every child holds the write end of its own pipe until it exits. The
+	 * end of file tells which child is done, so only the children started
+	 * here are waited for and no other child of the caller gets reaped.
+	 */
+	pid_t *pids = calloc(count, sizeof(pid_t));
+	int *fds = malloc(count * sizeof(int));
+	struct pollfd *pfds = malloc(count * sizeof(struct pollfd));
+	size_t *pfd_targets = malloc(count * sizeof(size_t));
+
+	while (next < count || running > 0) {
+		if (next < count && running < jobs) {
+			int pipefd[2];
+			if (pipe(pipefd) == -1) {
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't create pipe for target '%s': %s", roots[next], strerror(errno));
+				ret = 1;
+				/* Don't start any other target, just collect the running ones */
+				count = next;
+				continue;
+			}
+			/* Neither the probes nor the other targets may keep the pipe open */
+			fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+			fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+
+			fflush(NULL);
+			pid_t pid = fork();
+			if (pid == 0) {
+				close(pipefd[0]);
+				_xccdf_session_evaluate_target_child(session, roots[next], next, fn, arg);
+			}
+			close(pipefd[1]);
+			if (pid == -1) {
+				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't fork evaluation of target '%s': %s", roots[next], strerror(errno));
+				close(pipefd[0]);
+				ret = 1;
+				count = next;
+				continue;
+			}
+			fds[next] = pipefd[0];
+			pids[next++] = pid;
+			running++;
+			continue;
+		}
+
+		nfds_t nfds = 0;
+		for (size_t i = 0; i < next; i++) {
+			if (pids[i] == 0)
+				continue;
+			pfds[nfds].fd = fds[i];
+			pfds[nfds].events = POLLIN;
+			pfd_targets[nfds++] = i;
+		}
+		if (poll(pfds, nfds, -1) == -1) {
+			if (errno == EINTR)
+				continue;
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Can't wait for target evaluations: %s", strerror(errno));
+			ret = 1;
+			break;
+		}
+
+		for (nfds_t j = 0; j < nfds; j++) {
+			if (pfds[j].revents == 0)
+				continue;
+			size_t i = pfd_targets[j];
+			char c;
+			/* The children don't write anything, only the end of file matters */
+			if (read(fds[i], &c, 1) != 0)
+				continue;
+
+			int wstatus;
+			pid_t pid;
+			while ((pid = waitpid(pids[i], &wstatus, 0)) == -1 && errno == EINTR)
+				;
+			close(fds[i]);
+			pids[i] = 0;
+			running--;
+			if (pid != -1 && WIFEXITED(wstatus) && WEXITSTATUS(wstatus) != 255) {
+				statuses[i] = WEXITSTATUS(wstatus);
+			} else {
+				dW("Evaluation of target '%s' failed.", roots[i]);
+				ret = 1;
+			}
+		}
+	}
+	/* A failed poll leaves some of the targets running, don't leave them as zombies */
+	for (size_t i = 0; i < next; i++) {
+		if (pids[i] == 0)
+			continue;
+		close(fds[i]);
+		waitpid(pids[i], NULL, 0);
+	}
+	free(pfd_targets);
+	free(pfds);
+	free(fds);
+	free(pids);
+	return ret;
+}
+
 static size_t _paramlist_size(const char **p) { size_t s = 0; if (!p) return s; while (p[s]) s += 2; return s; }
 
 static size_t _paramlist_cpy(const char **to, const char **p) {
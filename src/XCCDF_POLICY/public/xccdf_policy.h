@@ -97,6 +97,38 @@ typedef void *(*xccdf_policy_engine_query_fn) (void *, xccdf_policy_engine_query
  */
 typedef xccdf_test_result_type_t (*xccdf_policy_engine_eval_fn) (struct xccdf_policy *policy, const char *rule_id, const char *definition_id, const char *href_if, struct xccdf_value_binding_iterator *value_binding_it, struct xccdf_check_import_iterator *check_imports_it, void *user_data);
 
+/**
+ * @struct xccdf_policy_batch_check
+ * Simple check of a selected Rule handed to the checking engine for batch evaluation
+ * @see xccdf_policy_engine_batch_fn
+ */
+struct xccdf_policy_batch_check;
+
+/**
+ * @struct xccdf_policy_batch_check_iterator
+ * Iterate through checks of a batch
+ */
+struct xccdf_policy_batch_check_iterator;
+
+/**
+ * Type of function which implements batch evaluation in OpenSCAP checking engine.
+ *
+ * Before the rules of a policy are evaluated one by one, the xccdf_policy module
+ * hands each checking engine all simple checks of the selected and applicable
+ * rules which refer to the same content file (check-content-ref/@href), in document
+ * order, together with their value bindings. The engine may use it to plan its work
+ * up front (e.g. collect all the data at once or run the checks concurrently).
+ * Results of the rules are still acquired by the xccdf_policy_engine_eval_fn, which
+ * is called for every check afterwards and which has to give the same result as if
+ * the batch function was not called at all.
+ *
+ * First argument is the policy being evaluated, second is the @href of the content
+ * file, third is an iterator over the checks (owned by the caller) and the last one
+ * is user data as registered. The function shall return 0 on success; on error the
+ * evaluation proceeds with the xccdf_policy_engine_eval_fn alone.
+ */
+typedef int (*xccdf_policy_engine_batch_fn) (struct xccdf_policy *policy, const char *href, struct xccdf_policy_batch_check_iterator *checks_it, void *user_data);
+
 /************************************************************/
 
 /**
@@ -265,6 +297,19 @@ OSCAP_DEPRECATED(bool xccdf_policy_model_register_engine_callback(struct xccdf_p
  */
 bool xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn);
 
+/**
+ * Function to register callbacks for checking system which supports batch evaluation
+ * @param model XCCDF Policy Model
+ * @param sys String representing given checking system
+ * @param eval_fn Callback - pointer to function called by XCCDF Policy system when rule parsed
+ * @param usr optional parameter for passing user data to callbacks
+ * @param query_fn - optional parameter for providing xccdf_policy_engine_query_fn implementation for given system.
+ * @param batch_fn - optional parameter for providing xccdf_policy_engine_batch_fn implementation for given system.
+ * @memberof xccdf_policy_model
+ * @return true if callback registered succesfully, false otherwise
+ */
+bool xccdf_policy_model_register_engine_and_batch_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn, xccdf_policy_engine_batch_fn batch_fn);
+
 typedef int (*policy_reporter_output)(struct xccdf_rule_result *, void *);
 
 /**
@@ -693,6 +738,50 @@ void xccdf_value_binding_iterator_free(struct xccdf_value_binding_iterator *it);
  */
 void xccdf_value_binding_iterator_reset(struct xccdf_value_binding_iterator *it);
 
+/**
+ * Get ID of the Rule the check belongs to
+ * @memberof xccdf_policy_batch_check
+ */
+const char *xccdf_policy_batch_check_get_rule_id(const struct xccdf_policy_batch_check *check);
+
+/**
+ * Get the check-content-ref/@name of the check
+ * @memberof xccdf_policy_batch_check
+ * @returns name or NULL if the check-content-ref has no @name (e.g. @multi-check)
+ */
+const char *xccdf_policy_batch_check_get_name(const struct xccdf_policy_batch_check *check);
+
+/**
+ * Get value bindings of the check
+ * @memberof xccdf_policy_batch_check
+ * @returns iterator to be freed by the caller
+ */
+struct xccdf_value_binding_iterator *xccdf_policy_batch_check_get_value_bindings(const struct xccdf_policy_batch_check *check);
+
+/**
+ * Return true if the list is not empty, false otherwise
+ * @memberof xccdf_policy_batch_check_iterator
+ */
+bool xccdf_policy_batch_check_iterator_has_more(struct xccdf_policy_batch_check_iterator *it);
+
+/**
+ * Return the next xccdf_policy_batch_check structure from the list and increment the iterator
+ * @memberof xccdf_policy_batch_check_iterator
+ */
+struct xccdf_policy_batch_check *xccdf_policy_batch_check_iterator_next(struct xccdf_policy_batch_check_iterator *it);
+
+/**
+ * Free the iterator structure (it makes no changes to the list structure)
+ * @memberof xccdf_policy_batch_check_iterator
+ */
+void xccdf_policy_batch_check_iterator_free(struct xccdf_policy_batch_check_iterator *it);
+
+/**
+ * Reset the iterator structure (it will point to the first item in the list)
+ * @memberof xccdf_policy_batch_check_iterator
+ */
+void xccdf_policy_batch_check_iterator_reset(struct xccdf_policy_batch_check_iterator *it);
+
 /**
  * Get score of the XCCDF Benchmark
  * @param policy XCCDF Policy
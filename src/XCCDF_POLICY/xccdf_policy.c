@@ -53,7 +53,9 @@
 #include "common/assume.h"
 #include "common/text_priv.h"
 #include "XCCDF/result_scoring_priv.h"
+#include "XCCDF/result_stream_priv.h"
 #include "xccdf_policy_resolve.h"
+#include "xccdf_policy_plan_priv.h"
 
 /* Macros to generate iterators, getters and setters */
 OSCAP_GETTER(struct xccdf_benchmark *, xccdf_policy_model, benchmark)
@@ -159,6 +161,53 @@ char *xccdf_policy_get_readable_item_description(struct xccdf_policy *policy, st
 	return plaintext;
 }
 
+/**
+ * Put the item into the index under the given key, replacing an item
+ * indexed there before. The index then holds the *LAST* item for every key.
+ */
+static void _xccdf_policy_index_last(struct oscap_htable *index, const char *key, void *item)
+{
+	if (key == NULL)
+		return;
+	oscap_htable_detach(index, key);
+	oscap_htable_add(index, key, item);
+}
+
+/**
+ * Index setvalues and refine-values of the profile by the id of the Value
+ * they refer to, so that value bindings do not have to scan the profile
+ * for every exported Value.
+ */
+static void _xccdf_policy_index_profile_values(struct xccdf_policy *policy, struct xccdf_profile *profile)
+{
+	oscap_htable_free0(policy->setvalues_index);
+	oscap_htable_free0(policy->refine_values_index);
+
+	policy->setvalues_index = oscap_htable_new();
+	struct xccdf_setvalue_iterator *s_value_it = xccdf_profile_get_setvalues(profile);
+	while (xccdf_setvalue_iterator_has_more(s_value_it)) {
+		struct xccdf_setvalue *s_value = xccdf_setvalue_iterator_next(s_value_it);
+		_xccdf_policy_index_last(policy->setvalues_index, xccdf_setvalue_get_item(s_value), s_value);
+	}
+	xccdf_setvalue_iterator_free(s_value_it);
+
+	policy->refine_values_index = oscap_htable_new();
+	struct xccdf_refine_value_iterator *r_value_it = xccdf_profile_get_refine_values(profile);
+	while (xccdf_refine_value_iterator_has_more(r_value_it)) {
+		struct xccdf_refine_value *r_value = xccdf_refine_value_iterator_next(r_value_it);
+		_xccdf_policy_index_last(policy->refine_values_index, xccdf_refine_value_get_item(r_value), r_value);
+	}
+	xccdf_refine_value_iterator_free(r_value_it);
+}
+
+void xccdf_policy_invalidate_value_indexes(struct xccdf_policy *policy)
+{
+	oscap_htable_free0(policy->setvalues_index);
+	oscap_htable_free0(policy->refine_values_index);
+	policy->setvalues_index = NULL;
+	policy->refine_values_index = NULL;
+}
+
 /**
  * Get last setvalue from policy that match specified id
  */
@@ -171,30 +220,15 @@ static struct xccdf_setvalue * xccdf_policy_get_setvalue(struct xccdf_policy * p
     if (id == NULL) return NULL;
     if (policy == NULL) return NULL;
 
-    struct xccdf_setvalue_iterator  * s_value_it;
-    struct xccdf_setvalue           * s_value;
-    struct xccdf_profile            * profile = xccdf_policy_get_profile(policy);;
-
     /* If profile is NULL we don't have setvalue's
      * and we return NULL, otherwise we could cause SIGSEG
      * with accessing NULL structure
      */
-    if (profile == NULL) return NULL;
+    if (policy->profile == NULL) return NULL;
+    if (policy->setvalues_index == NULL)
+        _xccdf_policy_index_profile_values(policy, policy->profile);
 
-    /* We need to return *LAST* setvalue in Profile.
-     * and iterate to the end of setvalue list
-     */
-    struct xccdf_setvalue * final = NULL;
-    s_value_it = xccdf_profile_get_setvalues(profile);
-    while (xccdf_setvalue_iterator_has_more(s_value_it)) {
-        s_value = xccdf_setvalue_iterator_next(s_value_it);
-        if (!strcmp(id, xccdf_setvalue_get_item(s_value))) {
-            final = s_value;
-        }
-    }
-    xccdf_setvalue_iterator_free(s_value_it);
-
-    return final;
+    return oscap_htable_get(policy->setvalues_index, id);
 }
 
 static struct xccdf_refine_value * xccdf_policy_get_refine_value(struct xccdf_policy * policy, const char * id)
@@ -206,30 +240,11 @@ static struct xccdf_refine_value * xccdf_policy_get_refine_value(struct xccdf_po
     if (id == NULL) return NULL;
     if (policy == NULL) return NULL;
 
-    struct xccdf_refine_value_iterator  * r_value_it;
-    struct xccdf_refine_value           * r_value;
-    struct xccdf_profile            * profile = xccdf_policy_get_profile(policy);;
-
-    /* If profile is NULL we don't have setvalue's
-     * and we return NULL, otherwise we could cause SIGSEG
-     * with accessing NULL structure
-     */
-    if (profile == NULL) return NULL;
+    if (policy->profile == NULL) return NULL;
+    if (policy->refine_values_index == NULL)
+        _xccdf_policy_index_profile_values(policy, policy->profile);
 
-    /* We need to return *LAST* setvalue in Profile.
-     * and iterate to the end of setvalue list
-     */
-    struct xccdf_refine_value * final = NULL;
-    r_value_it = xccdf_profile_get_refine_values(profile);
-    while (xccdf_refine_value_iterator_has_more(r_value_it)) {
-        r_value = xccdf_refine_value_iterator_next(r_value_it);
-        if (!strcmp(id, xccdf_refine_value_get_item(r_value))) {
-            final = r_value;
-        }
-    }
-    xccdf_refine_value_iterator_free(r_value_it);
-
-    return final;
+    return oscap_htable_get(policy->refine_values_index, id);
 }
 
 /**
@@ -416,7 +431,7 @@ int xccdf_policy_report_cb(struct xccdf_policy *policy, const char *sysname, voi
     return retval;
 }
 
-static struct oscap_list * xccdf_policy_check_get_value_bindings(struct xccdf_policy * policy, struct xccdf_check_export_iterator * check_it)
+struct oscap_list * xccdf_policy_check_get_value_bindings(struct xccdf_policy * policy, struct xccdf_check_export_iterator * check_it, bool report_errors)
 {
         __attribute__nonnull__(check_it);
 
@@ -437,8 +452,10 @@ static struct oscap_list * xccdf_policy_check_get_value_bindings(struct xccdf_po
 
             value = (struct xccdf_value *) xccdf_benchmark_get_item(benchmark, xccdf_check_export_get_value(check));
             if (value == NULL) {
-                oscap_seterr(OSCAP_EFAMILY_XCCDF, "Value \"%s\" does not exist in benchmark", xccdf_check_export_get_value(check));
+                if (report_errors)
+                    oscap_seterr(OSCAP_EFAMILY_XCCDF, "Value \"%s\" does not exist in benchmark", xccdf_check_export_get_value(check));
 		oscap_list_free(list, free);
+		xccdf_check_export_iterator_free(check_it);
                 return NULL;
             }
             binding = xccdf_value_binding_new();
@@ -461,9 +478,11 @@ static struct oscap_list * xccdf_policy_check_get_value_bindings(struct xccdf_po
 
             const struct xccdf_value_instance * val = xccdf_value_get_instance_by_selector(value, selector);
             if (val == NULL) {
-                oscap_seterr(OSCAP_EFAMILY_XCCDF, "Attempt to get non-existent selector \"%s\" from variable \"%s\"", selector, xccdf_value_get_id(value));
+                if (report_errors)
+                    oscap_seterr(OSCAP_EFAMILY_XCCDF, "Attempt to get non-existent selector \"%s\" from variable \"%s\"", selector, xccdf_value_get_id(value));
 		oscap_list_free(list, free);
 		xccdf_value_binding_free(binding);
+		xccdf_check_export_iterator_free(check_it);
                 return NULL;
             }
             binding->value = oscap_strdup(xccdf_value_instance_get_value(val));
@@ -512,7 +531,7 @@ int xccdf_policy_check_evaluate(struct xccdf_policy * policy, struct xccdf_check
             /* It depends on what operation we process - we do only Compliance Check */
             content_it = xccdf_check_get_content_refs(check);
             system_name = xccdf_check_get_system(check);
-            bindings = xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(check));
+            bindings = xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(check), true);
             if (bindings == NULL) {
                 xccdf_check_content_ref_iterator_free(content_it);
                 return XCCDF_RESULT_UNKNOWN;
@@ -549,11 +568,12 @@ _xccdf_policy_is_engine_registered(struct xccdf_policy *policy, char *sysname)
 	return oscap_list_contains(policy->model->engines, (void *) sysname, (oscap_cmp_func) xccdf_policy_engine_filter);
 }
 
-static struct xccdf_check *
-_xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccdf_item *rule)
+struct xccdf_check *
+xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccdf_item *rule, const char **warning_system)
 {
 	// Citations inline come from NISTIR-7275r4.
 	struct xccdf_check *result = NULL;
+	*warning_system = NULL;
 	{
 		// If an <xccdf:Rule> contains an <xccdf:complex-check>, then the benchmark consumer MUST process
 		// it and MUST ignore any <xccdf:check> elements that are also contained by the <xccdf:Rule>.
@@ -576,7 +596,7 @@ _xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccd
 
 		bool print_general_warning = false;
 		bool print_oval_warning = false;
-		char *warning_check_system;
+		char *warning_check_system = NULL;
 		// Check Processing Algorithm -- Check.System
 		while (xccdf_check_iterator_has_more(candidate_it)) {
 			struct xccdf_check *check = xccdf_check_iterator_next(candidate_it);
@@ -590,16 +610,11 @@ _xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccd
 			}
 		}
 
-		// Only print a warning if we didn't select a check but could've otherwise.
-		if (print_oval_warning) {
-			printf("WARNING: Skipping rule that uses OVAL but is possibly malformed; "
-			       "an incorrect content reference prevents this check from being evaluated.\n");
-		} else if (print_general_warning && result == NULL) {
-			printf("WARNING: Skipping rule that requires an unregistered check system "
-			       "or incorrect content reference to evaluate. "
-			       "Please consider providing a valid SCAP/OVAL instead of %s\n",
-				warning_check_system);
-		}
+		// Only warn if we didn't select a check but could've otherwise.
+		if (print_oval_warning)
+			*warning_system = "http://oval.mitre.org/XMLSchema/oval-definitions-5";
+		else if (print_general_warning && result == NULL)
+			*warning_system = warning_check_system;
 		xccdf_check_iterator_free(candidate_it);
 	}
 	// A tool processing the Benchmark for compliance checking must pick at most one check or
@@ -607,6 +622,25 @@ _xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccd
 	return result;
 }
 
+/**
+ * Print the warning about a check skipped by xccdf_policy_rule_get_applicable_check
+ */
+static void _xccdf_policy_print_check_warning(const char *warning_system)
+{
+	if (warning_system == NULL)
+		return;
+
+	if (strcmp("http://oval.mitre.org/XMLSchema/oval-definitions-5", warning_system) == 0) {
+		printf("WARNING: Skipping rule that uses OVAL but is possibly malformed; "
+		       "an incorrect content reference prevents this check from being evaluated.\n");
+	} else {
+		printf("WARNING: Skipping rule that requires an unregistered check system "
+		       "or incorrect content reference to evaluate. "
+		       "Please consider providing a valid SCAP/OVAL instead of %s\n",
+			warning_system);
+	}
+}
+
 bool
 xccdf_policy_is_item_selected(struct xccdf_policy *policy, const char *id)
 {
@@ -709,6 +743,13 @@ static int _xccdf_policy_report_rule_result(struct xccdf_policy *policy,
 		/* TODO: instance */
 		rule_result = _xccdf_rule_result_new_from_rule(policy, rule, check, res, message);
 		xccdf_result_add_rule_result(result, rule_result);
+		if (policy->result_stream != NULL &&
+				xccdf_result_stream_write_rule_result(policy->result_stream, rule_result) != 0) {
+			/* The stream is just a view of the evaluation, don't let it stop the scan. */
+			dW("Could not stream result of rule '%s', TestResult streaming has been disabled.",
+				xccdf_rule_get_id(rule));
+			policy->result_stream = NULL;
+		}
 	} else
 		xccdf_check_free(check);
 
@@ -825,127 +866,127 @@ static bool _xccdf_policy_cpe_dict_cb(struct cpe_name* name, void* usr)
 	return ret;
 }
 
-static bool xccdf_policy_model_platforms_are_applicable_dict(struct xccdf_policy_model *model, struct cpe_dict_model *dict, struct oscap_string_iterator *platforms)
+static bool xccdf_policy_model_platform_is_applicable_dict(struct xccdf_policy_model *model, struct cpe_dict_model *dict, const char *platform)
 {
-	// at this point we know that the item has 1 or more platforms specified
-	bool ret = false;
-
-	while (oscap_string_iterator_has_more(platforms))
-	{
-		const char* platform = oscap_string_iterator_next(platforms);
-		// Platform could be a reference to CPE2 platform, skip the ones
-		// that aren't valid CPE names.
-		if (!cpe_name_check(platform))
-			continue;
-
-		struct cpe_name* name = cpe_name_new(platform);
-
-		struct cpe_check_cb_usr* usr = malloc(sizeof(struct cpe_check_cb_usr));
-		usr->model = model;
-		usr->dict = dict;
-		usr->lang_model = NULL;
-		const bool applicable = cpe_name_applicable_dict(name, dict, (cpe_check_fn) _xccdf_policy_cpe_check_cb, usr);
-		free(usr);
-
-		cpe_name_free(name);
+	// Platform could be a reference to CPE2 platform, skip the ones
+	// that aren't valid CPE names.
+	if (!cpe_name_check(platform))
+		return false;
 
-		if (applicable)
-		{
-			ret = true;
+	struct cpe_name* name = cpe_name_new(platform);
 
-			if (oscap_htable_get(model->cpe->applicable_platforms, platform) == NULL) {
-				oscap_htable_add(model->cpe->applicable_platforms, platform, 0);
-			}
-		}
-	}
-	oscap_string_iterator_reset(platforms);
+	struct cpe_check_cb_usr* usr = malloc(sizeof(struct cpe_check_cb_usr));
+	usr->model = model;
+	usr->dict = dict;
+	usr->lang_model = NULL;
+	const bool applicable = cpe_name_applicable_dict(name, dict, (cpe_check_fn) _xccdf_policy_cpe_check_cb, usr);
+	free(usr);
 
-	return ret;
+	cpe_name_free(name);
+	return applicable;
 }
 
-static bool xccdf_policy_model_platforms_are_applicable_lang_model(struct xccdf_policy_model *model, struct cpe_lang_model *lang_model, struct oscap_string_iterator *platforms)
+static bool xccdf_policy_model_platform_is_applicable_lang_model(struct xccdf_policy_model *model, struct cpe_lang_model *lang_model, const char *platform)
 {
-	// at this point we know that the item has 1 or more platforms specified
-	bool ret = false;
+	// Specification says that platform should begin with "#" if it is
+	// a reference to a CPE2 platform. However content exists where this
+	// is not strictly followed so we support both with and without "#"
+	// references.
 
-	while (oscap_string_iterator_has_more(platforms))
+	const char* platform_shifted = platform;
+	if (strlen(platform_shifted) >= 1 && *platform_shifted == '#')
 	{
-		const char* platform = oscap_string_iterator_next(platforms);
-		// Specification says that platform should begin with "#" if it is
-		// a reference to a CPE2 platform. However content exists where this
-		// is not strictly followed so we support both with and without "#"
-		// references.
-
-		const char* platform_shifted = platform;
-		if (strlen(platform_shifted) >= 1 && *platform_shifted == '#')
-		{
-			// skip the "#" character
-			platform_shifted++;
-		}
-
-		struct cpe_check_cb_usr* usr = malloc(sizeof(struct cpe_check_cb_usr));
-		usr->model = model;
-		usr->dict = NULL;
-		usr->lang_model = lang_model;
-		const bool applicable = cpe_platform_applicable_lang_model(platform_shifted, lang_model, (cpe_check_fn)_xccdf_policy_cpe_check_cb, (cpe_dict_fn)_xccdf_policy_cpe_dict_cb, usr);
-		free(usr);
-
-		if (applicable)
-		{
-			ret = true;
-
-			if (oscap_htable_get(model->cpe->applicable_platforms, platform) == NULL) {
-				oscap_htable_add(model->cpe->applicable_platforms, platform, 0);
-			}
-		}
+		// skip the "#" character
+		platform_shifted++;
 	}
-	oscap_string_iterator_reset(platforms);
 
-	return ret;
+	struct cpe_check_cb_usr* usr = malloc(sizeof(struct cpe_check_cb_usr));
+	usr->model = model;
+	usr->dict = NULL;
+	usr->lang_model = lang_model;
+	const bool applicable = cpe_platform_applicable_lang_model(platform_shifted, lang_model, (cpe_check_fn)_xccdf_policy_cpe_check_cb, (cpe_dict_fn)_xccdf_policy_cpe_dict_cb, usr);
+	free(usr);
+
+	return applicable;
 }
 
-bool xccdf_policy_model_platforms_are_applicable(struct xccdf_policy_model *model, struct oscap_string_iterator *platforms)
+static bool xccdf_policy_model_platform_evaluate(struct xccdf_policy_model *model, const char *platform)
 {
-	// we have to check whether the item has any platforms at all, if it has none
-	// it should be applicable to all platforms
-	if (!oscap_string_iterator_has_more(platforms))
-		return true;
-
 	bool ret = false;
-	// We do not check whether the platform entries are valid platform refs
-	// or CPE names. We let the policy_model methods do that instead.
+	// We do not check whether the platform entry is a valid platform ref
+	// or CPE name. We let the policy_model methods do that instead.
 	// Therefore we check all 4 (!) places where a platform may match.
 	// CPE2 takes precedence over CPE1 in this implementation. This is not
 	// dictated by the specification, it's an arbitrary choice.
 	struct xccdf_benchmark* benchmark = xccdf_policy_model_get_benchmark(model);
 	struct cpe_lang_model *embedded_lang_model = xccdf_benchmark_get_cpe_lang_model(benchmark);
 	if (embedded_lang_model != NULL) {
-		if (xccdf_policy_model_platforms_are_applicable_lang_model(model, embedded_lang_model, platforms))
+		if (xccdf_policy_model_platform_is_applicable_lang_model(model, embedded_lang_model, platform))
 			ret = true;
 	}
 
 	struct oscap_iterator *lang_models = oscap_iterator_new(model->cpe->lang_models);
 	while (oscap_iterator_has_more(lang_models)) {
 		struct cpe_lang_model *lang_model = (struct cpe_lang_model *) oscap_iterator_next(lang_models);
-		if (xccdf_policy_model_platforms_are_applicable_lang_model(model, lang_model, platforms))
+		if (xccdf_policy_model_platform_is_applicable_lang_model(model, lang_model, platform))
 			ret = true;
 	}
 	oscap_iterator_free(lang_models);
 
 	struct cpe_dict_model *embedded_dict = xccdf_benchmark_get_cpe_list(benchmark);
 	if (embedded_dict != NULL) {
-		if (xccdf_policy_model_platforms_are_applicable_dict(model, embedded_dict, platforms))
+		if (xccdf_policy_model_platform_is_applicable_dict(model, embedded_dict, platform))
 			ret = true;
 	}
 
 	struct oscap_iterator *dicts = oscap_iterator_new(model->cpe->dicts);
 	while (oscap_iterator_has_more(dicts)) {
 		struct cpe_dict_model *dict = (struct cpe_dict_model *) oscap_iterator_next(dicts);
-		if (xccdf_policy_model_platforms_are_applicable_dict(model, dict, platforms))
+		if (xccdf_policy_model_platform_is_applicable_dict(model, dict, platform))
 			ret = true;
 	}
 	oscap_iterator_free(dicts);
 
+	if (ret && oscap_htable_get(model->cpe->applicable_platforms, platform) == NULL) {
+		oscap_htable_add(model->cpe->applicable_platforms, platform, 0);
+	}
+	return ret;
+}
+
+/**
+ * Is the given platform applicable to the scanned system?
+ * Items of the benchmark often share the same platforms, so the outcome
+ * is remembered for the whole life of the CPE session of the model.
+ */
+static bool xccdf_policy_model_platform_is_applicable(struct xccdf_policy_model *model, const char *platform)
+{
+	bool *cached = oscap_htable_get(model->cpe->platform_results, platform);
+	if (cached != NULL)
+		return *cached;
+
+	bool *applicable = malloc(sizeof(bool));
+	*applicable = xccdf_policy_model_platform_evaluate(model, platform);
+	dI("Platform '%s' is %sapplicable.", platform, *applicable ? "" : "not ");
+	oscap_htable_add(model->cpe->platform_results, platform, applicable);
+	return *applicable;
+}
+
+bool xccdf_policy_model_platforms_are_applicable(struct xccdf_policy_model *model, struct oscap_string_iterator *platforms)
+{
+	// we have to check whether the item has any platforms at all, if it has none
+	// it should be applicable to all platforms
+	if (!oscap_string_iterator_has_more(platforms))
+		return true;
+
+	// All the platforms get evaluated, they are all listed in the TestResult
+	bool ret = false;
+	while (oscap_string_iterator_has_more(platforms)) {
+		const char *platform = oscap_string_iterator_next(platforms);
+		if (xccdf_policy_model_platform_is_applicable(model, platform))
+			ret = true;
+	}
+	oscap_string_iterator_reset(platforms);
+
 	return ret;
 }
 
@@ -972,12 +1013,13 @@ bool xccdf_policy_model_item_is_applicable(struct xccdf_policy_model *model, str
  * A possibe child checks will be evaluated by xccdf_policy_check_evaluate.
  * This duplication is needed to handle @multi-check correctly,
  * which is (in general) not predictable in any way.
+ * The selection, role, check and value bindings of the rule come from the evaluation plan.
  */
 static inline int
-_xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rule *rule, struct xccdf_result *result)
+_xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_plan_rule *entry, struct xccdf_result *result)
 {
+	const struct xccdf_rule *rule = entry->rule;
 	const char* rule_id = xccdf_rule_get_id(rule);
-	const bool is_selected = xccdf_policy_is_item_selected(policy, rule_id);
 	const char *message = NULL;
 	int report = 0;
 
@@ -995,10 +1037,9 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 	if (report)
 		return report;
 
-	struct xccdf_refine_rule_internal* r_rule = oscap_htable_get(policy->refine_rules_internal, rule_id);
-	xccdf_role_t role = xccdf_get_final_role(rule, r_rule);
+	xccdf_role_t role = entry->role;
 
-	if (!is_selected) {
+	if (!entry->selected) {
 		dI("Rule '%s' is not selected.", rule_id);
 		return _xccdf_policy_report_rule_result(policy, result, rule, NULL, XCCDF_RESULT_NOT_SELECTED, NULL);
 	}
@@ -1012,7 +1053,8 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 		return _xccdf_policy_report_rule_result(policy, result, rule, NULL, XCCDF_RESULT_NOT_APPLICABLE, NULL);
 	}
 
-	const struct xccdf_check *orig_check = _xccdf_policy_rule_get_applicable_check(policy, (struct xccdf_item *) rule);
+	_xccdf_policy_print_check_warning(entry->check_warning);
+	const struct xccdf_check *orig_check = entry->check;
 	if (orig_check == NULL)
 		// No candidate or applicable check found.
 		return _xccdf_policy_report_rule_result(policy, result, rule, NULL, XCCDF_RESULT_NOT_CHECKED, "No candidate or applicable check found.");
@@ -1029,9 +1071,12 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 	//
 	// Important: if touching this code, please revisit also xccdf_policy_check_evaluate.
 	const char *system_name = xccdf_check_get_system(check);
-	struct oscap_list *bindings = xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(check));
-	if (bindings == NULL)
+	struct oscap_list *bindings = entry->bindings;
+	if (bindings == NULL) {
+		// Resolve the bindings again to report the error, the plan does not keep it.
+		oscap_list_free(xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(check), true), (oscap_destruct_func) xccdf_value_binding_free);
 		return _xccdf_policy_report_rule_result(policy, result, rule, check, XCCDF_RESULT_UNKNOWN, "Value bindings not found.");
+	}
 
 
 	struct xccdf_check_content_ref_iterator *content_it = xccdf_check_get_content_refs(check);
@@ -1058,7 +1103,6 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 					oscap_string_iterator_free(name_it);
 					oscap_stringlist_free(names);
 					xccdf_check_content_ref_iterator_free(content_it);
-					oscap_list_free(bindings, (oscap_destruct_func) xccdf_value_binding_free);
 					return report;
 				}
 				while (oscap_string_iterator_has_more(name_it)) {
@@ -1080,7 +1124,6 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 				oscap_string_iterator_free(name_it);
 				oscap_stringlist_free(names);
 				xccdf_check_content_ref_iterator_free(content_it);
-				oscap_list_free(bindings, (oscap_destruct_func) xccdf_value_binding_free);
 				xccdf_check_free(check);
 				return report;
 			}
@@ -1108,55 +1151,11 @@ _xccdf_policy_rule_evaluate(struct xccdf_policy * policy, const struct xccdf_rul
 		ret = XCCDF_RESULT_INFORMATIONAL;
 
 	xccdf_check_content_ref_iterator_free(content_it);
-	oscap_list_free(bindings, (oscap_destruct_func) xccdf_value_binding_free);
 	/* Negate only once */
 	ret = _resolve_negate(ret, check);
 	return _xccdf_policy_report_rule_result(policy, result, rule, check, ret, message);
 }
 
-/** 
- * Evaluate the XCCDF item. If it is group, start recursive cycle, otherwise get XCCDF check
- * and evaluate it.
- * Name collision with xccdf_item -> changed to xccdf_policy_item 
- */
-static int xccdf_policy_item_evaluate(struct xccdf_policy * policy, struct xccdf_item * item, struct xccdf_result * result)
-{
-    struct xccdf_item_iterator      * child_it;
-    struct xccdf_item               * child;
-    int ret = 0;
-
-    xccdf_type_t itype = xccdf_item_get_type(item);
-
-    switch (itype) {
-        case XCCDF_RULE:{
-			const char *rule_id = xccdf_rule_get_id((const struct xccdf_rule *)item);
-			dI("Evaluating XCCDF rule '%s'.", rule_id);
-			return _xccdf_policy_rule_evaluate(policy, (struct xccdf_rule *) item, result);
-        } break;
-
-        case XCCDF_GROUP:{
-			const char *group_id = xccdf_group_get_id((const struct xccdf_group *)item);
-			dI("Evaluating XCCDF group '%s'.", group_id);
-			child_it = xccdf_group_get_content((const struct xccdf_group *)item);
-			while (xccdf_item_iterator_has_more(child_it)) {
-				child = xccdf_item_iterator_next(child_it);
-				ret = xccdf_policy_item_evaluate(policy, child, result);
-				if (ret != 0)
-					break;
-			}
-			xccdf_item_iterator_free(child_it);
-        } break;
-        
-        default: 
-                    /* TODO: set warning bad argument and return ? */
-			assert(false);
-			return -1;
-            break;
-    } 
-
-    return ret;
-}
-
 struct oscap_file_entry {
 	char* system_name;
 	char* file;
@@ -1588,13 +1587,24 @@ bool
 xccdf_policy_model_register_engine_and_query_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn)
 {
         __attribute__nonnull__(model);
-	struct xccdf_policy_engine *engine = xccdf_policy_engine_new(sys, eval_fn, usr, query_fn);
+	struct xccdf_policy_engine *engine = xccdf_policy_engine_new(sys, eval_fn, usr, query_fn, NULL);
+	model->generation++;
+	return oscap_list_add(model->engines, engine);
+}
+
+bool
+xccdf_policy_model_register_engine_and_batch_callback(struct xccdf_policy_model *model, char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn, xccdf_policy_engine_batch_fn batch_fn)
+{
+	__attribute__nonnull__(model);
+	struct xccdf_policy_engine *engine = xccdf_policy_engine_new(sys, eval_fn, usr, query_fn, batch_fn);
+	model->generation++;
 	return oscap_list_add(model->engines, engine);
 }
 
 void xccdf_policy_model_unregister_engines(struct xccdf_policy_model *model, const char *sys)
 {
 	__attribute__nonnull__(model);
+	model->generation++;
 	if (sys == NULL)
 		oscap_list_free(model->engines, (oscap_destruct_func) free);
 	else {
@@ -1681,11 +1691,21 @@ struct xccdf_policy_model * xccdf_policy_model_new(struct xccdf_benchmark * benc
 	return model;
 }
 
+/**
+ * Discard the evaluation plan, the selection or refinements of the policy have changed.
+ */
+static void _xccdf_policy_drop_plan(struct xccdf_policy *policy)
+{
+	xccdf_policy_plan_free(policy->plan);
+	policy->plan = NULL;
+}
+
 static inline bool
 _xccdf_policy_add_selector_internal(struct xccdf_policy *policy, struct xccdf_benchmark *benchmark, struct xccdf_select *sel, bool resolve)
 {
 	/* This is the only way, how one can add selector to a policy. */
 	bool result = oscap_list_add(policy->selects, sel);
+	_xccdf_policy_drop_plan(policy);
 
 	struct xccdf_item *item = xccdf_benchmark_get_member(benchmark, XCCDF_ITEM, xccdf_select_get_item(sel));
 	if (item != NULL) {
@@ -1907,6 +1927,8 @@ bool xccdf_policy_resolve(struct xccdf_policy * policy)
     struct xccdf_benchmark              * benchmark     = xccdf_policy_model_get_benchmark(policy_model);
     struct xccdf_profile                * profile       = xccdf_policy_get_profile(policy);
 
+    _xccdf_policy_drop_plan(policy);
+
     /* Proccess refine rules; Changing Rules and Groups */
     r_rule_it = xccdf_profile_get_refine_rules(profile);
     while (xccdf_refine_rule_iterator_has_more(r_rule_it)) {
@@ -2002,6 +2024,62 @@ static void xccdf_policy_add_final_setvalues(struct xccdf_policy *policy, struct
 	}
 }
 
+/**
+ * Get the evaluation plan of the policy, compile it if there is none yet or
+ * if the checking engines or the single evaluated rule have changed since it
+ * was compiled. Values are bound again every time, the profile and the
+ * benchmark may have been modified since the last evaluation.
+ */
+static struct xccdf_policy_plan *_xccdf_policy_get_plan(struct xccdf_policy *policy)
+{
+	if (policy->plan != NULL && (xccdf_policy_plan_get_generation(policy->plan) != policy->model->generation ||
+			!oscap_streq(xccdf_policy_plan_get_single_rule(policy->plan), policy->rule))) {
+		xccdf_policy_plan_free(policy->plan);
+		policy->plan = NULL;
+	}
+	if (policy->plan == NULL)
+		policy->plan = xccdf_policy_plan_new(policy, policy->model->generation);
+
+	xccdf_policy_invalidate_value_indexes(policy);
+	xccdf_policy_plan_bind_values(policy->plan, policy);
+	return policy->plan;
+}
+
+/**
+ * Hand the check batches of the plan to the checking engines before the rules
+ * get evaluated one by one. Only checks of the rules which are going to be
+ * evaluated are handed over, the engines shall not do any needless work.
+ */
+static void _xccdf_policy_evaluate_batches(struct xccdf_policy *policy, struct xccdf_policy_plan *plan)
+{
+	if (policy->rule != NULL)
+		return; /* A single rule is not worth the batch */
+
+	struct oscap_iterator *batch_it = xccdf_policy_plan_get_batches(plan);
+	while (oscap_iterator_has_more(batch_it)) {
+		struct xccdf_plan_batch *batch = oscap_iterator_next(batch_it);
+		struct oscap_list *checks = oscap_list_new();
+		struct oscap_iterator *check_it = oscap_iterator_new(batch->checks);
+		while (oscap_iterator_has_more(check_it)) {
+			struct xccdf_policy_batch_check *check = oscap_iterator_next(check_it);
+			if (check->entry->bindings != NULL &&
+					xccdf_policy_model_item_is_applicable(policy->model, (struct xccdf_item *) check->entry->rule))
+				oscap_list_add(checks, check);
+		}
+		oscap_iterator_free(check_it);
+
+		struct oscap_iterator *engine_it = _xccdf_policy_get_engines_by_sysname(policy, batch->system);
+		while (oscap_list_get_itemcount(checks) > 0 && oscap_iterator_has_more(engine_it)) {
+			struct xccdf_policy_engine *engine = oscap_iterator_next(engine_it);
+			if (xccdf_policy_engine_batch(engine, policy, batch->href, checks) != 0)
+				dW("Batch evaluation of '%s' failed, the checks will be evaluated one by one.", batch->href);
+		}
+		oscap_iterator_free(engine_it);
+		oscap_list_free0(checks);
+	}
+	oscap_iterator_free(batch_it);
+}
+
 /**
  * Evaluate XCCDF Policy
  * Iterate through Benchmark items and evalute one by one by calling 
@@ -2062,21 +2140,31 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 
     free(id);
 
-	/** We need to process document top-down order.
+	if (policy->result_stream != NULL) {
+		/* Set-values precede rule-results in the streamed TestResult.
+		 * Values are bound before the evaluation, they can be recorded right away. */
+		xccdf_policy_add_final_setvalues(policy, xccdf_benchmark_to_item(benchmark), result);
+		if (xccdf_result_stream_start(policy->result_stream, result, benchmark) != 0) {
+			xccdf_result_free(result);
+			return NULL;
+		}
+	}
+
+	/** We need to process document top-down order, the plan keeps it.
 	 * See conflicts/requires and Item Processing Algorithm */
-	struct xccdf_item_iterator *item_it = xccdf_benchmark_get_content(benchmark);
-	while (xccdf_item_iterator_has_more(item_it)) {
-		struct xccdf_item *item = xccdf_item_iterator_next(item_it);
-		ret = xccdf_policy_item_evaluate(policy, item, result);
+	struct xccdf_policy_plan *plan = _xccdf_policy_get_plan(policy);
+	_xccdf_policy_evaluate_batches(policy, plan);
+	for (size_t n = 0; n < xccdf_policy_plan_get_rule_count(plan); n++) {
+		const struct xccdf_plan_rule *entry = xccdf_policy_plan_get_rule(plan, n);
+		dI("Evaluating XCCDF rule '%s'.", xccdf_rule_get_id(entry->rule));
+		ret = _xccdf_policy_rule_evaluate(policy, entry, result);
 		if (ret == -1) {
-			xccdf_item_iterator_free(item_it);
 			xccdf_result_free(result);
 			return NULL;
 		}
 		if (ret != 0)
 			break;
 	}
-	xccdf_item_iterator_free(item_it);
 
 	if (policy->rule != NULL && !policy->rule_found) {
 		oscap_seterr(OSCAP_EFAMILY_XCCDF,
@@ -2084,7 +2172,8 @@ struct xccdf_result * xccdf_policy_evaluate(struct xccdf_policy * policy)
 		return NULL;
 	}
 
-	xccdf_policy_add_final_setvalues(policy, xccdf_benchmark_to_item(benchmark), result);
+	if (policy->result_stream == NULL)
+		xccdf_policy_add_final_setvalues(policy, xccdf_benchmark_to_item(benchmark), result);
 
 	struct oscap_htable_iterator *it = oscap_htable_iterator_new(policy->model->cpe->applicable_platforms);
 	while (oscap_htable_iterator_has_more(it)) {
@@ -2298,6 +2387,10 @@ void xccdf_policy_free(struct xccdf_policy * policy) {
 	oscap_htable_free0(policy->selected_internal);
 	oscap_htable_free0(policy->selected_final);
 	oscap_htable_free(policy->refine_rules_internal, (oscap_destruct_func) xccdf_refine_rule_internal_free);
+	oscap_htable_free0(policy->setvalues_index);
+	oscap_htable_free0(policy->refine_values_index);
+	oscap_htable_free(policy->text_templates, (oscap_destruct_func) xccdf_text_template_free);
+	xccdf_policy_plan_free(policy->plan);
         free(policy);
 }
 
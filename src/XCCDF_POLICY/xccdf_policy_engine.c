@@ -35,9 +35,10 @@ struct xccdf_policy_engine {
 	xccdf_policy_engine_eval_fn callback;   ///< format of callback function
 	void * usr;                             ///< User data structure
 	xccdf_policy_engine_query_fn query_fn;  ///< query callback function
+	xccdf_policy_engine_batch_fn batch_fn;  ///< batch evaluation callback function
 };
 
-struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn)
+struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn, xccdf_policy_engine_batch_fn batch_fn)
 {
 	struct xccdf_policy_engine *engine = malloc(sizeof(struct xccdf_policy_engine));
         if (engine != NULL) {
@@ -45,6 +46,7 @@ struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engi
 		engine->callback = eval_fn;
 		engine->usr = usr;
 		engine->query_fn = query_fn;
+		engine->batch_fn = batch_fn;
 	}
 	return engine;
 }
@@ -75,3 +77,13 @@ struct oscap_stringlist *xccdf_policy_engine_query(struct xccdf_policy_engine *e
 		return NULL;
 	return (struct oscap_stringlist *) engine->query_fn(engine->usr, query_type, query_data);
 }
+
+int xccdf_policy_engine_batch(struct xccdf_policy_engine *engine, struct xccdf_policy *policy, const char *href, struct oscap_list *checks)
+{
+	if (engine->batch_fn == NULL)
+		return 0;
+	struct xccdf_policy_batch_check_iterator *check_it = (struct xccdf_policy_batch_check_iterator *) oscap_iterator_new(checks);
+	int ret = engine->batch_fn(policy, href, check_it, engine->usr);
+	xccdf_policy_batch_check_iterator_free(check_it);
+	return ret;
+}
@@ -44,9 +44,10 @@ struct xccdf_policy_engine;
  * @param eval_fn The eval function of newly created checking engine
  * @param usr User data structure
  * @param query_fn The query function of newly created checking engine
+ * @param batch_fn The batch evaluation function of newly created checking engine
  * @returns newly created checking engine
  */
-struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn);
+struct xccdf_policy_engine *xccdf_policy_engine_new(char *sys, xccdf_policy_engine_eval_fn eval_fn, void *usr, xccdf_policy_engine_query_fn query_fn, xccdf_policy_engine_batch_fn batch_fn);
 
 /**
  * Filter function returning true if given callback is for the given checking engine,
@@ -77,6 +78,17 @@ xccdf_test_result_type_t xccdf_policy_engine_eval(struct xccdf_policy_engine *en
  */
 struct oscap_stringlist *xccdf_policy_engine_query(struct xccdf_policy_engine *engine, xccdf_policy_engine_query_t query_type, void *query_data);
 
+/**
+ * Execute the batch evaluation function of the given checking engine, if it has any
+ * @memberof xccdf_policy_engine
+ * @param engine Checking Engine
+ * @param policy XCCDF Policy
+ * @param href The @href attribute of check-content-ref shared by the checks
+ * @param checks List of struct xccdf_policy_batch_check
+ * @returns 0 on success or when the engine does not support batch evaluation
+ */
+int xccdf_policy_engine_batch(struct xccdf_policy_engine *engine, struct xccdf_policy *policy, const char *href, struct oscap_list *checks);
+
 OSCAP_HIDDEN_END;
 
 #endif
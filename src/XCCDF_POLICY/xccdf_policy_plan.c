@@ -0,0 +1,222 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "xccdf_policy_priv.h"
+#include "xccdf_policy_plan_priv.h"
+#include "xccdf_policy_resolve.h"
+#include "public/xccdf_benchmark.h"
+#include "common/list.h"
+#include "common/debug_priv.h"
+
+OSCAP_ITERATOR_GEN(xccdf_policy_batch_check)
+
+struct xccdf_policy_plan {
+	unsigned int generation;         ///< generation of the policy model
+	char *single_rule;               ///< the only rule to evaluate (see xccdf_policy->rule), NULL for all rules
+	struct xccdf_plan_rule *rules;   ///< rules in document order
+	size_t rule_count;
+	size_t rule_alloc;
+	struct oscap_list *batches;      ///< struct xccdf_plan_batch in order of first use
+	struct oscap_htable *batch_index; ///< "system href" -> struct xccdf_plan_batch
+};
+
+static void xccdf_plan_batch_free(struct xccdf_plan_batch *batch)
+{
+	if (batch == NULL)
+		return;
+	oscap_list_free(batch->checks, free);
+	free(batch);
+}
+
+static void _xccdf_policy_plan_add_to_batch(struct xccdf_policy_plan *plan, size_t n)
+{
+	const struct xccdf_check *check = plan->rules[n].check;
+	const char *system = xccdf_check_get_system(check);
+
+	struct xccdf_check_content_ref_iterator *content_it = xccdf_check_get_content_refs(check);
+	const struct xccdf_check_content_ref *content = xccdf_check_content_ref_iterator_has_more(content_it) ?
+		xccdf_check_content_ref_iterator_next(content_it) : NULL;
+	xccdf_check_content_ref_iterator_free(content_it);
+	if (content == NULL || system == NULL || xccdf_check_content_ref_get_href(content) == NULL)
+		return;
+
+	const char *href = xccdf_check_content_ref_get_href(content);
+	char *key = oscap_sprintf("%s %s", system, href);
+	struct xccdf_plan_batch *batch = oscap_htable_get(plan->batch_index, key);
+	if (batch == NULL) {
+		batch = malloc(sizeof(struct xccdf_plan_batch));
+		batch->system = system;
+		batch->href = href;
+		batch->checks = oscap_list_new();
+		oscap_htable_add(plan->batch_index, key, batch);
+		oscap_list_add(plan->batches, batch);
+	}
+	free(key);
+	struct xccdf_policy_batch_check *batch_check = malloc(sizeof(struct xccdf_policy_batch_check));
+	/* The rules array is final at this point, see xccdf_policy_plan_new */
+	batch_check->entry = &plan->rules[n];
+	batch_check->name = xccdf_check_content_ref_get_name(content);
+	oscap_list_add(batch->checks, batch_check);
+}
+
+static void _xccdf_policy_plan_add_rule(struct xccdf_policy_plan *plan, struct xccdf_policy *policy, struct xccdf_rule *rule)
+{
+	if (plan->rule_count == plan->rule_alloc) {
+		plan->rule_alloc = plan->rule_alloc ? 2 * plan->rule_alloc : 64;
+		plan->rules = realloc(plan->rules, plan->rule_alloc * sizeof(struct xccdf_plan_rule));
+	}
+	struct xccdf_plan_rule *entry = &plan->rules[plan->rule_count++];
+	memset(entry, 0, sizeof(struct xccdf_plan_rule));
+
+	const char *rule_id = xccdf_rule_get_id(rule);
+	entry->rule = rule;
+	/* Other rules are reported as notselected without looking at them */
+	if (plan->single_rule != NULL && strcmp(plan->single_rule, rule_id) != 0)
+		return;
+
+	entry->selected = xccdf_policy_is_item_selected(policy, rule_id);
+	if (!entry->selected)
+		return;
+
+	entry->check = xccdf_policy_rule_get_applicable_check(policy, (struct xccdf_item *) rule, &entry->check_warning);
+}
+
+static void _xccdf_policy_plan_add_item(struct xccdf_policy_plan *plan, struct xccdf_policy *policy, struct xccdf_item *item)
+{
+	switch (xccdf_item_get_type(item)) {
+	case XCCDF_RULE:
+		_xccdf_policy_plan_add_rule(plan, policy, (struct xccdf_rule *) item);
+		break;
+	case XCCDF_GROUP: {
+		struct xccdf_item_iterator *child_it = xccdf_group_get_content((const struct xccdf_group *) item);
+		while (xccdf_item_iterator_has_more(child_it))
+			_xccdf_policy_plan_add_item(plan, policy, xccdf_item_iterator_next(child_it));
+		xccdf_item_iterator_free(child_it);
+	} break;
+	default:
+		break;
+	}
+}
+
+struct xccdf_policy_plan *xccdf_policy_plan_new(struct xccdf_policy *policy, unsigned int generation)
+{
+	struct xccdf_policy_plan *plan = calloc(1, sizeof(struct xccdf_policy_plan));
+	plan->generation = generation;
+	plan->single_rule = oscap_strdup(policy->rule);
+	plan->batches = oscap_list_new();
+	plan->batch_index = oscap_htable_new();
+
+	/* We need to keep the document top-down order of the rules. */
+	struct xccdf_benchmark *benchmark = xccdf_policy_model_get_benchmark(xccdf_policy_get_model(policy));
+	struct xccdf_item_iterator *item_it = xccdf_benchmark_get_content(benchmark);
+	while (xccdf_item_iterator_has_more(item_it))
+		_xccdf_policy_plan_add_item(plan, policy, xccdf_item_iterator_next(item_it));
+	xccdf_item_iterator_free(item_it);
+
+	for (size_t n = 0; n < plan->rule_count; n++) {
+		const struct xccdf_check *check = plan->rules[n].check;
+		if (check != NULL && !xccdf_check_get_complex(check))
+			_xccdf_policy_plan_add_to_batch(plan, n);
+	}
+
+	dI("Compiled evaluation plan of %zu rules with %d check batches.",
+		plan->rule_count, oscap_list_get_itemcount(plan->batches));
+	return plan;
+}
+
+void xccdf_policy_plan_bind_values(struct xccdf_policy_plan *plan, struct xccdf_policy *policy)
+{
+	for (size_t n = 0; n < plan->rule_count; n++) {
+		struct xccdf_plan_rule *entry = &plan->rules[n];
+		oscap_list_free(entry->bindings, (oscap_destruct_func) xccdf_value_binding_free);
+		entry->bindings = NULL;
+		if (!entry->selected)
+			continue;
+
+		struct xccdf_refine_rule_internal *r_rule = oscap_htable_get(policy->refine_rules_internal, xccdf_rule_get_id(entry->rule));
+		entry->role = xccdf_get_final_role(entry->rule, r_rule);
+		if (entry->role == XCCDF_ROLE_UNCHECKED || entry->check == NULL || xccdf_check_get_complex(entry->check))
+			continue;
+
+		/* Errors are reported when (and if) the rule gets evaluated */
+		entry->bindings = xccdf_policy_check_get_value_bindings(policy, xccdf_check_get_exports(entry->check), false);
+	}
+}
+
+void xccdf_policy_plan_free(struct xccdf_policy_plan *plan)
+{
+	if (plan == NULL)
+		return;
+
+	for (size_t n = 0; n < plan->rule_count; n++)
+		oscap_list_free(plan->rules[n].bindings, (oscap_destruct_func) xccdf_value_binding_free);
+	free(plan->rules);
+	oscap_htable_free0(plan->batch_index);
+	oscap_list_free(plan->batches, (oscap_destruct_func) xccdf_plan_batch_free);
+	free(plan->single_rule);
+	free(plan);
+}
+
+unsigned int xccdf_policy_plan_get_generation(const struct xccdf_policy_plan *plan)
+{
+	return plan->generation;
+}
+
+const char *xccdf_policy_plan_get_single_rule(const struct xccdf_policy_plan *plan)
+{
+	return plan->single_rule;
+}
+
+size_t xccdf_policy_plan_get_rule_count(const struct xccdf_policy_plan *plan)
+{
+	return plan->rule_count;
+}
+
+const struct xccdf_plan_rule *xccdf_policy_plan_get_rule(const struct xccdf_policy_plan *plan, size_t n)
+{
+	return n < plan->rule_count ? &plan->rules[n] : NULL;
+}
+
+struct oscap_iterator *xccdf_policy_plan_get_batches(const struct xccdf_policy_plan *plan)
+{
+	return oscap_iterator_new(plan->batches);
+}
+
+const char *xccdf_policy_batch_check_get_rule_id(const struct xccdf_policy_batch_check *check)
+{
+	return xccdf_rule_get_id(check->entry->rule);
+}
+
+const char *xccdf_policy_batch_check_get_name(const struct xccdf_policy_batch_check *check)
+{
+	return check->name;
+}
+
+struct xccdf_value_binding_iterator *xccdf_policy_batch_check_get_value_bindings(const struct xccdf_policy_batch_check *check)
+{
+	return (struct xccdf_value_binding_iterator *) oscap_iterator_new(check->entry->bindings);
+}
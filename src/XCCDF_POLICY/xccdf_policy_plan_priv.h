@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#pragma once
+#ifndef _OSCAP_XCCDF_POLICY_PLAN_PRIV_H
+#define _OSCAP_XCCDF_POLICY_PLAN_PRIV_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "common/util.h"
+#include "common/list.h"
+#include "public/xccdf_policy.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * Evaluation plan of an XCCDF policy.
+ *
+ * The plan is everything about the evaluation which depends only on the
+ * benchmark, the selection of the policy and the registered checking
+ * engines: the rules in document order with their final selection and the
+ * check picked for every rule. It also groups the simple checks by checking
+ * system and content file, so that a checking engine can learn about all
+ * of its work up front.
+ *
+ * Roles and value bindings can be changed by refine-rules, refine-values,
+ * setvalues and Values of the content, which all have public mutators.
+ * They are bound again before every evaluation of the plan.
+ *
+ * Applicability of the rules and @multi-check expansion depend on the
+ * scanned system and are left to the evaluation itself.
+ */
+struct xccdf_policy_plan;
+
+/**
+ * One Rule of the plan
+ */
+struct xccdf_plan_rule {
+	const struct xccdf_rule *rule;
+	bool selected;                   ///< final selection of the rule
+	xccdf_role_t role;               ///< final role of the rule after refine-rules, see xccdf_policy_plan_bind_values
+	const struct xccdf_check *check; ///< check or complex-check to evaluate (not owned), NULL if none is usable
+	const char *check_warning;       ///< check system which could not be used to pick the check, if any
+	struct oscap_list *bindings;     ///< value bindings of a simple check, NULL if they cannot be resolved or the rule is not checked
+};
+
+/**
+ * Simple check of the plan as handed to the checking engine for batch evaluation
+ */
+struct xccdf_policy_batch_check {
+	const struct xccdf_plan_rule *entry; ///< rule of the check
+	const char *name;                ///< check-content-ref/@name of the first content reference
+};
+
+/**
+ * Simple checks of the plan which refer to the same content file
+ */
+struct xccdf_plan_batch {
+	const char *system;              ///< check system
+	const char *href;                ///< check-content-ref/@href of the first content reference
+	struct oscap_list *checks;       ///< struct xccdf_policy_batch_check in document order
+};
+
+/**
+ * Compile the evaluation plan of the given policy. If the policy evaluates
+ * a single rule, checks of the other rules are not picked at all.
+ * @param policy XCCDF Policy
+ * @param generation generation of the policy model the plan is compiled for
+ * @returns new plan, its values have to be bound before the evaluation
+ */
+struct xccdf_policy_plan *xccdf_policy_plan_new(struct xccdf_policy *policy, unsigned int generation);
+
+/**
+ * Resolve the final roles of the rules and the value bindings of their checks
+ * from the current state of the policy and its content.
+ */
+void xccdf_policy_plan_bind_values(struct xccdf_policy_plan *plan, struct xccdf_policy *policy);
+
+void xccdf_policy_plan_free(struct xccdf_policy_plan *plan);
+
+/// @returns generation of the policy model the plan has been compiled for
+unsigned int xccdf_policy_plan_get_generation(const struct xccdf_policy_plan *plan);
+
+/// @returns the single rule the plan has been compiled for, NULL if it has been compiled for all rules
+const char *xccdf_policy_plan_get_single_rule(const struct xccdf_policy_plan *plan);
+
+/// @returns number of rules in the plan
+size_t xccdf_policy_plan_get_rule_count(const struct xccdf_policy_plan *plan);
+
+/// @returns n-th rule of the plan in document order
+const struct xccdf_plan_rule *xccdf_policy_plan_get_rule(const struct xccdf_policy_plan *plan, size_t n);
+
+/// @returns iterator over struct xccdf_plan_batch in order of first use
+struct oscap_iterator *xccdf_policy_plan_get_batches(const struct xccdf_policy_plan *plan);
+
+OSCAP_HIDDEN_END;
+
+#endif
@@ -45,6 +45,9 @@ struct xccdf_policy_model {
 	struct oscap_list       * engines;      ///< Callbacks for checking engines (see xccdf_policy_engine)
 
 	struct cpe_session *cpe;
+	/** Bumped whenever the registered checking engines change,
+	 * evaluation plans compiled for older generations are discarded. */
+	unsigned int generation;
 };
 
 /**
@@ -72,10 +75,28 @@ struct xccdf_policy {
 	struct oscap_htable		*selected_final;
 	/* The hash-table contains the latest refine-rule for specified item-id. */
 	struct oscap_htable		*refine_rules_internal;
+	/* The hash-tables contain the latest setvalue and refine-value of the profile for specified value-id
+	 * (not owned). They are built on the first lookup and dropped by xccdf_policy_invalidate_value_indexes,
+	 * so they stay NULL when the policy has no profile. */
+	struct oscap_htable		*setvalues_index;
+	struct oscap_htable		*refine_values_index;
+	/* If not NULL, the TestResult is written there as rules get evaluated (not owned). */
+	struct xccdf_result_stream	*result_stream;
+	/* Evaluation plan compiled by the last evaluation, NULL if the selection has changed since then. */
+	struct xccdf_policy_plan	*plan;
+	/* Compiled substitutable texts of the policy, source text -> struct xccdf_text_template. */
+	struct oscap_htable		*text_templates;
 };
 
 
 
+/**
+ * Substitutable text compiled for repeated resolution
+ */
+struct xccdf_text_template;
+
+void xccdf_text_template_free(struct xccdf_text_template *tmpl);
+
 /**
  * Resolve text substitution in given fix element. Use given xccdf_policy settings
  * for resolving.
@@ -88,6 +109,15 @@ struct xccdf_policy {
  */
 int xccdf_policy_resolve_fix_substitution(struct xccdf_policy *policy, struct xccdf_fix *fix, struct xccdf_rule_result *rule_result, struct xccdf_result *test_result);
 
+/**
+ * Drop the indexes of the profile's setvalues and refine-values. They get rebuilt
+ * on the next lookup, so that changes done to the profile since the last lookup
+ * are taken into account.
+ * @memberof xccdf_policy
+ * @param policy XCCDF Policy
+ */
+void xccdf_policy_invalidate_value_indexes(struct xccdf_policy *policy);
+
 /**
  * Execute fix element for a given rule-result. Or find suitable (most appropriate) fix
  * in the policy, assign it to the rule-result and execute.
@@ -110,6 +140,25 @@ int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf
  */
 int xccdf_policy_check_evaluate(struct xccdf_policy * policy, struct xccdf_check * check);
 
+/**
+ * Pick the check or complex-check of the rule which shall be evaluated.
+ * @param policy XCCDF Policy
+ * @param rule the rule
+ * @param warning_system if a check had to be skipped, its system is stored there,
+ * see xccdf_policy_print_check_warning
+ * @returns the check (not a copy) or NULL if none can be evaluated
+ */
+struct xccdf_check *xccdf_policy_rule_get_applicable_check(struct xccdf_policy *policy, struct xccdf_item *rule, const char **warning_system);
+
+/**
+ * Resolve the values exported by a check with settings of given policy.
+ * @param policy XCCDF Policy
+ * @param check_it iterator of check exports, freed by this function
+ * @param report_errors whether to set the error when a value cannot be resolved
+ * @returns list of struct xccdf_value_binding or NULL on failure
+ */
+struct oscap_list *xccdf_policy_check_get_value_bindings(struct xccdf_policy *policy, struct xccdf_check_export_iterator *check_it, bool report_errors);
+
 /**
  * Remediate all rule-results in the given result, with settings of given policy.
  * @memberof xccdf_policy
@@ -22,7 +22,11 @@
 #endif
 
 #include <string.h>
+#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -40,6 +44,7 @@
 #include "common/assume.h"
 #include "common/debug_priv.h"
 #include "common/oscap_acquire.h"
+#include "common/oscap_string.h"
 #include "xccdf_policy_priv.h"
 #include "xccdf_policy_model_priv.h"
 #include "public/xccdf_policy.h"
@@ -345,36 +350,262 @@ static inline int _xccdf_fix_decode_xml(struct xccdf_fix *fix, char **result)
 	return 0;
 }
 
-static inline int _xccdf_fix_execute(struct xccdf_rule_result *rr, struct xccdf_fix *fix)
+/**
+ * Fix prepared for execution
+ */
+struct _fix_job {
+	struct xccdf_rule_result *rr;
+	struct xccdf_check *check;		///< check to verify the applied fix, NULL if none
+	const char *interpret;
+	char *temp_dir;
+	char *temp_file;
+	struct oscap_stringlist *targets;	///< absolute paths mentioned by the fix
+	bool serial;				///< the fix must not run along with any other fix
+	pid_t pid;
+	int fd;					///< read end of the pipe with output of the fix, -1 if closed
+	struct oscap_string *output;
+	int exit_code;
+	bool started;
+	bool failed;				///< the fix could not be executed at all
+	bool lost;				///< the outcome of the executed fix is not known
+	bool finished;
+};
+
+/* Commands which change state of the system shared by many fixes, e.g. package
+ * database, services or kernel parameters, no matter what files they mention. */
+static const char *_shared_state_commands[] = {
+	"yum", "dnf", "rpm", "apt", "apt-get", "dpkg", "zypper", "pip",
+	"systemctl", "service", "chkconfig", "sysctl", "modprobe",
+	"mount", "umount", "grubby", "grub2-mkconfig", "authconfig", "authselect",
+	"useradd", "usermod", "userdel", "groupadd", "groupmod", "groupdel", "passwd", "chpasswd",
+	"setsebool", "semanage", "restorecon", "setenforce", "auditctl", "augenrules",
+	"firewall-cmd", "iptables", "ip6tables", "update-crypto-policies", "dconf",
+	"reboot", "shutdown", "cd", "source", "eval", "exec",
+	NULL
+};
+
+/* Files which can be shared by fixes without any harm */
+static const char *_harmless_paths[] = {
+	"/dev/null", "/dev/zero", "/dev/stdin", "/dev/stdout", "/dev/stderr",
+	"/dev/random", "/dev/urandom", "/bin/bash", "/bin/sh",
+	NULL
+};
+
+static inline bool _is_word_char(char c)
+{
+	return isalnum((unsigned char) c) || c == '_' || c == '-';
+}
+
+static inline bool _is_path_char(char c)
+{
+	return isalnum((unsigned char) c) || strchr("/._+@%:,=~-", c) != NULL;
+}
+
+static bool _fix_text_mentions_command(const char *text, const char *command)
+{
+	const size_t len = strlen(command);
+	for (const char *pos = strstr(text, command); pos != NULL; pos = strstr(pos + 1, command)) {
+		if ((pos == text || !_is_word_char(pos[-1])) && !_is_word_char(pos[len]))
+			return true;
+	}
+	return false;
+}
+
+static inline bool _is_quote_char(char c)
+{
+	return c == '"' || c == '\'';
+}
+
+/**
+ * Collect absolute paths mentioned by the fix
+ * @returns false if the fix refers to a path which cannot be determined
+ * (e.g. composed of a shell variable or glued to a quoted string)
+ */
+static bool _fix_text_collect_paths(const char *text, struct oscap_stringlist *targets)
+{
+	if (strncmp(text, "#!", 2) == 0) {
+		// skip the shebang
+		text = strchr(text, '\n');
+		if (text == NULL)
+			return true;
+	}
+	char quote = '\0'; // quote of the string we are in
+	for (const char *pos = text; *pos != '\0'; pos++) {
+		if (*pos == '\\' && quote != '\'') {
+			if (pos[1] == '\0')
+				break;
+			pos++;
+			continue;
+		}
+		if (_is_quote_char(*pos)) {
+			if (quote == '\0')
+				quote = *pos;
+			else if (quote == *pos)
+				quote = '\0';
+			continue;
+		}
+		if (*pos != '/')
+			continue;
+		if (pos != text && (pos[-1] == '}' || pos[-1] == ')' || pos[-1] == '~' || pos[-1] == '`'))
+			return false;
+		if (pos != text && _is_quote_char(pos[-1])) {
+			// "$dir"/file, the path continues a quoted string
+			if (quote != pos[-1])
+				return false;
+			// $dir"/file", the quoted path continues a word
+			if (pos - 1 != text && (_is_word_char(pos[-2]) || _is_quote_char(pos[-2]) || strchr("$})`", pos[-2]) != NULL))
+				return false;
+		}
+		if (pos != text && _is_word_char(pos[-1])) {
+			const char *word = pos - 1;
+			while (word > text && (isalnum((unsigned char) word[-1]) || word[-1] == '_'))
+				word--;
+			if (word > text && word[-1] == '$')
+				return false;
+			continue; // not an absolute path, e.g. s/foo/bar/
+		}
+		if (pos != text && (pos[-1] == '.' || pos[-1] == '/'))
+			continue; // relative path
+		const char *end = pos;
+		while (_is_path_char(*end))
+			end++;
+		// /etc/$name, /etc/"$name" or "/etc/"$name, the path continues with an expansion
+		if (*end == '$' || *end == '`')
+			return false;
+		if (_is_quote_char(*end) && (quote != *end || end[1] == '$' || end[1] == '`' || _is_quote_char(end[1])))
+			return false;
+		while (end > pos + 1 && end[-1] == '/')
+			end--;
+		char *path = strndup(pos, end - pos);
+		bool harmless = false;
+		for (const char **h = _harmless_paths; *h != NULL; h++)
+			harmless = harmless || oscap_streq(*h, path);
+		if (!harmless)
+			oscap_stringlist_add_string(targets, path);
+		free(path);
+		pos = end - 1;
+	}
+	return true;
+}
+
+/**
+ * Classify the fix. The fix may run along with other fixes only if it is
+ * a shell script which does not require reboot, has low disruption, does
+ * not use any command which changes state shared by other fixes and all
+ * the files it touches are known.
+ */
+static void _xccdf_fix_job_classify(struct _fix_job *job, struct xccdf_fix *fix, const char *fix_text)
+{
+	const char *sys = xccdf_fix_get_system(fix);
+	const xccdf_level_t disruption = xccdf_fix_get_disruption(fix);
+	const xccdf_strategy_t strategy = xccdf_fix_get_strategy(fix);
+
+	job->serial = true;
+	if (!oscap_streq(sys, "urn:xccdf:fix:script:sh") && !oscap_streq(sys, "urn:xccdf:fix:commands"))
+		return;
+	if (xccdf_fix_get_reboot(fix))
+		return;
+	if (disruption != XCCDF_LEVEL_NOT_DEFINED && disruption != XCCDF_UNKNOWN && disruption != XCCDF_LOW)
+		return;
+	if (strategy == XCCDF_STRATEGY_PATCH || strategy == XCCDF_STRATEGY_UPDATE || strategy == XCCDF_STRATEGY_POLICY)
+		return;
+	for (const char **command = _shared_state_commands; *command != NULL; command++) {
+		if (_fix_text_mentions_command(fix_text, *command))
+			return;
+	}
+	if (!_fix_text_collect_paths(fix_text, job->targets))
+		return;
+	struct oscap_string_iterator *target_it = oscap_stringlist_get_strings(job->targets);
+	// If there is no target, we don't know what the fix touches
+	job->serial = !oscap_string_iterator_has_more(target_it);
+	oscap_string_iterator_free(target_it);
+}
+
+static inline bool _paths_overlap(const char *a, const char *b)
+{
+	const size_t len_a = strlen(a);
+	const size_t len_b = strlen(b);
+	if (len_a > len_b)
+		return _paths_overlap(b, a);
+	return strncmp(a, b, len_a) == 0 &&
+		(b[len_a] == '\0' || b[len_a] == '/' || oscap_streq(a, "/"));
+}
+
+static bool _xccdf_fix_job_conflicts(const struct _fix_job *job, struct oscap_list *group)
+{
+	bool conflict = false;
+	struct oscap_iterator *group_it = oscap_iterator_new(group);
+	while (!conflict && oscap_iterator_has_more(group_it)) {
+		struct _fix_job *other = oscap_iterator_next(group_it);
+		struct oscap_string_iterator *other_it = oscap_stringlist_get_strings(other->targets);
+		while (!conflict && oscap_string_iterator_has_more(other_it)) {
+			const char *other_path = oscap_string_iterator_next(other_it);
+			struct oscap_string_iterator *target_it = oscap_stringlist_get_strings(job->targets);
+			while (!conflict && oscap_string_iterator_has_more(target_it))
+				conflict = _paths_overlap(oscap_string_iterator_next(target_it), other_path);
+			oscap_string_iterator_free(target_it);
+		}
+		oscap_string_iterator_free(other_it);
+	}
+	oscap_iterator_free(group_it);
+	return conflict;
+}
+
+static void _xccdf_fix_job_free(struct _fix_job *job)
+{
+	if (job == NULL)
+		return;
+	if (job->fd != -1)
+		close(job->fd);
+	free(job->temp_file);
+	oscap_acquire_cleanup_dir(&job->temp_dir);
+	oscap_stringlist_free(job->targets);
+	oscap_string_free(job->output);
+	free(job);
+}
+
+/**
+ * Write the fix to a temporary file and classify it
+ * @returns NULL if the fix cannot be executed
+ */
+static struct _fix_job *_xccdf_fix_job_new(struct xccdf_rule_result *rr, struct xccdf_fix *fix)
 {
 	if (fix == NULL || rr == NULL || oscap_streq(xccdf_fix_get_content(fix), NULL))
-		return 1;
+		return NULL;
 
 	const char *interpret = NULL;
 	if ((interpret = _get_supported_interpret(xccdf_fix_get_system(fix), NULL)) == NULL) {
 		_rule_add_info_message(rr, "Not supported xccdf:fix/@system='%s' or missing interpreter.",
 				xccdf_fix_get_system(fix) == NULL ? "" : xccdf_fix_get_system(fix));
-		return 1;
+		return NULL;
 	}
 
 	char *fix_text = NULL;
 	if (_xccdf_fix_decode_xml(fix, &fix_text) != 0) {
 		_rule_add_info_message(rr, "Fix element contains unresolved child elements.");
-		return 1;
+		return NULL;
 	}
 
-	int result = 1;
+	struct _fix_job *job = calloc(1, sizeof(struct _fix_job));
+	job->rr = rr;
+	job->interpret = interpret;
+	job->fd = -1;
+	job->targets = oscap_stringlist_new();
+	job->output = oscap_string_new();
+	_xccdf_fix_job_classify(job, fix, fix_text);
 
-	char *temp_dir = oscap_acquire_temp_dir();
-	if (temp_dir == NULL)
+	job->temp_dir = oscap_acquire_temp_dir();
+	if (job->temp_dir == NULL) {
+		free(fix_text);
 		goto cleanup;
+	}
 	// TODO: Directory and files shall be labeled with SELinux to prevent
 	// confined processes with less priviledges to transit to oscap domain
 	// and become basically unconfined.
-	char *temp_file = NULL;
-	int fd = oscap_acquire_temp_file(temp_dir, "fix-XXXXXXXX", &temp_file);
+	int fd = oscap_acquire_temp_file(job->temp_dir, "fix-XXXXXXXX", &job->temp_file);
 	if (fd == -1) {
 		_rule_add_info_message(rr, "mkstemp failed: %s", strerror(errno));
+		free(fix_text);
 		goto cleanup;
 	}
 
@@ -386,75 +617,197 @@ static inline int _xccdf_fix_execute(struct xccdf_rule_result *rr, struct xccdf_
 
 	if (close(fd) != 0)
 		_rule_add_info_message(rr, "Could not close temp file: %s", strerror(errno));
+	return job;
+
+cleanup:
+	_xccdf_fix_job_free(job);
+	return NULL;
+}
+
+/**
+ * Execute the fix and forward its output to a pipe
+ */
+static void _xccdf_fix_job_start(struct _fix_job *job)
+{
+	job->started = true;
 
 	int pipefd[2];
 	if (pipe(pipefd) == -1) {
-		_rule_add_info_message(rr, "Could not create pipe: %s", strerror(errno));
-		goto cleanup;
+		_rule_add_info_message(job->rr, "Could not create pipe: %s", strerror(errno));
+		job->failed = true;
+		job->finished = true;
+		return;
+	}
+	// Fixes running in parallel must not inherit pipes of each other
+	fcntl(pipefd[0], F_SETFD, FD_CLOEXEC);
+	fcntl(pipefd[1], F_SETFD, FD_CLOEXEC);
+	fcntl(pipefd[0], F_SETFL, fcntl(pipefd[0], F_GETFL, 0) | O_NONBLOCK);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDERR_FILENO);
+
+	char *const argvp[3] = {
+		(char *)job->interpret,
+		job->temp_file,
+		NULL
+	};
+
+	char *const envp[2] = {
+		"PATH=/bin:/sbin:/usr/bin:/usr/sbin",
+		NULL
+	};
+
+	const int spawn_result = posix_spawn(&job->pid, job->interpret, &actions, NULL, argvp, envp);
+	posix_spawn_file_actions_destroy(&actions);
+	close(pipefd[1]);
+	if (spawn_result != 0) {
+		/* In this special case, we failed to execute the fix and we return 0
+		 * from function. At least the following error message will indicate
+		 * the problem in xccdf:message. */
+		close(pipefd[0]);
+		char *error = oscap_sprintf("Error while executing fix script: execve returned: %s\n", strerror(spawn_result));
+		oscap_string_append_string(job->output, error);
+		free(error);
+		job->exit_code = 42;
+		job->finished = true;
+		return;
 	}
+	job->fd = pipefd[0];
+}
 
-	int fork_result = fork();
-	if (fork_result >= 0) {
-		/* fork succeded */
-		if (fork_result == 0) {
-			/* Execute fix and forward output to the parrent. */
-			close(pipefd[0]);
-			dup2(pipefd[1], fileno(stdout));
-			dup2(pipefd[1], fileno(stderr));
-			close(pipefd[1]);
-
-			char *const argvp[3] = {
-				(char *)interpret,
-				temp_file,
-				NULL
-			};
-
-			char *const envp[2] = {
-				"PATH=/bin:/sbin:/usr/bin:/usr/sbin",
-				NULL
-			};
-
-			execve(interpret, argvp, envp);
-			/* Wow, execve returned. In this special case, we failed to execute the fix
-			 * and we return 0 from function. At least the following error message will
-			 * indicate the problem in xccdf:message. */
-			printf("Error while executing fix script: execve returned: %s\n", strerror(errno));
-			exit(42);
+static void _xccdf_fix_job_wait(struct _fix_job *job)
+{
+	close(job->fd);
+	job->fd = -1;
+	job->finished = true;
+
+	int wstatus;
+	pid_t pid;
+	while ((pid = waitpid(job->pid, &wstatus, 0)) == -1 && errno == EINTR)
+		;
+	if (pid == -1) {
+		_rule_add_info_message(job->rr, "Could not wait for the fix: %s", strerror(errno));
+		job->lost = true;
+	} else if (WIFSIGNALED(wstatus)) {
+		_rule_add_info_message(job->rr, "Fix was terminated by signal %d.", WTERMSIG(wstatus));
+		job->lost = true;
+	} else {
+		job->exit_code = WEXITSTATUS(wstatus);
+	}
+}
+
+static void _xccdf_fix_job_read(struct _fix_job *job)
+{
+	char readbuf[4096];
+	while (true) {
+		const ssize_t count = read(job->fd, readbuf, sizeof(readbuf));
+		if (count > 0) {
+			for (ssize_t i = 0; i < count; i++) {
+				if (readbuf[i] == '&') {
+					// & is a special case, we have to "escape" it manually
+					// (all else will eventually get handled by libxml)
+					oscap_string_append_string(job->output, "&amp;");
+				} else {
+					oscap_string_append_char(job->output, readbuf[i]);
+				}
+			}
+		} else if (count < 0 && errno == EINTR) {
+			continue;
+		} else if (count < 0 && errno == EAGAIN) {
+			break;
 		} else {
-			free(temp_file);
-			close(pipefd[1]);
-			char *stdout_buff = oscap_acquire_pipe_to_string(pipefd[0]);
-			int wstatus;
-			waitpid(fork_result, &wstatus, 0);
-			_rule_add_info_message(rr, "Fix execution completed and returned: %d", WEXITSTATUS(wstatus));
-			if (stdout_buff != NULL && stdout_buff[0] != '\0')
-				_rule_add_info_message(rr, stdout_buff);
-			free(stdout_buff);
-			/* We return zero to indicate success. Rather than returning the exit code. */
-			result = 0;
+			_xccdf_fix_job_wait(job);
+			break;
 		}
-	} else {
-		_rule_add_info_message(rr, "Failed to fork. %s", strerror(errno));
-		free(temp_file);
 	}
+}
 
-cleanup:
-	oscap_acquire_cleanup_dir(&temp_dir);
-	return result;
+/**
+ * Execute all the fixes, at most max_workers of them at a time, and capture their output
+ */
+static void _xccdf_fix_jobs_run(struct oscap_list *jobs, unsigned int max_workers)
+{
+	const int count = oscap_list_get_itemcount(jobs);
+	if (count == 0)
+		return;
+	struct _fix_job **job_array = malloc(count * sizeof(struct _fix_job *));
+	struct _fix_job **fd_jobs = malloc(count * sizeof(struct _fix_job *));
+	struct pollfd *fds = malloc(count * sizeof(struct pollfd));
+	int n = 0;
+	struct oscap_iterator *job_it = oscap_iterator_new(jobs);
+	while (oscap_iterator_has_more(job_it))
+		job_array[n++] = oscap_iterator_next(job_it);
+	oscap_iterator_free(job_it);
+
+	int next = 0;
+	while (true) {
+		unsigned int running = 0;
+		for (n = 0; n < next; n++)
+			running += !job_array[n]->finished;
+		while (running < max_workers && next < count) {
+			_xccdf_fix_job_start(job_array[next++]);
+			running += !job_array[next - 1]->finished;
+		}
+		if (running == 0 && next == count)
+			break;
+
+		nfds_t nfds = 0;
+		for (n = 0; n < next; n++) {
+			if (job_array[n]->fd == -1)
+				continue;
+			fds[nfds].fd = job_array[n]->fd;
+			fds[nfds].events = POLLIN;
+			fd_jobs[nfds++] = job_array[n];
+		}
+		if (nfds == 0)
+			continue;
+		if (poll(fds, nfds, -1) == -1) {
+			if (errno == EINTR)
+				continue;
+			dE("Failed to poll output of the fixes: %s", strerror(errno));
+			/* Don't leave the running fixes behind, the rest is not executed */
+			for (n = 0; n < next; n++) {
+				if (!job_array[n]->finished) {
+					_rule_add_info_message(job_array[n]->rr, "Could not collect output of the fix.");
+					_xccdf_fix_job_wait(job_array[n]);
+					job_array[n]->lost = true;
+				}
+			}
+			for (n = next; n < count; n++)
+				job_array[n]->failed = true;
+			break;
+		}
+		for (nfds_t i = 0; i < nfds; i++) {
+			if (fds[i].revents != 0)
+				_xccdf_fix_job_read(fd_jobs[i]);
+		}
+	}
+	free(fds);
+	free(fd_jobs);
+	free(job_array);
 }
 
-int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf_rule_result *rr, struct xccdf_fix *fix, struct xccdf_result *test_result)
+/**
+ * Find the fix for the rule-result, resolve it and prepare it for execution
+ * @param ret return value of the remediation when no fix is to be executed
+ */
+static struct _fix_job *_xccdf_policy_rule_result_prepare_fix(struct xccdf_policy *policy, struct xccdf_rule_result *rr, struct xccdf_fix *fix, struct xccdf_result *test_result, int *ret)
 {
-	if (policy == NULL || rr == NULL)
-		return 1;
+	*ret = 0;
+	if (policy == NULL || rr == NULL) {
+		*ret = 1;
+		return NULL;
+	}
 	if (xccdf_rule_result_get_result(rr) != XCCDF_RESULT_FAIL)
-		return 0;
+		return NULL;
 
 	if (fix == NULL) {
 		fix = _find_suitable_fix(policy, rr);
 		if (fix == NULL)
 			// We may want to append xccdf:message about missing fix.
-			return 0;
+			return NULL;
 	}
 
 	struct xccdf_check *check = NULL;
@@ -464,7 +817,7 @@ int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf
 	xccdf_check_iterator_free(check_it);
 	if (check != NULL && xccdf_check_get_multicheck(check))
 		// Do not try to apply fix for multi-check.
-		return 0;
+		return NULL;
 
 	/* Initialize the fix. */
 	struct xccdf_fix *cfix = xccdf_fix_clone(fix);
@@ -472,15 +825,39 @@ int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf
 	xccdf_rule_result_add_fix(rr, cfix);
 	if (res != 0) {
 		_rule_add_info_message(rr, "Fix execution was aborted: Text substitution failed.");
-		return res;
+		*ret = res;
+		return NULL;
 	}
 
-	/* Execute the fix. */
-	res = _xccdf_fix_execute(rr, cfix);
-	if (res != 0) {
+	struct _fix_job *job = _xccdf_fix_job_new(rr, cfix);
+	if (job == NULL) {
 		_rule_add_info_message(rr, "Fix was not executed. Execution was aborted.");
-		return res;
+		*ret = 1;
+		return NULL;
 	}
+	job->check = check;
+	return job;
+}
+
+/**
+ * Record output of the executed fix and verify it
+ */
+static int _xccdf_policy_fix_job_finish(struct xccdf_policy *policy, struct _fix_job *job)
+{
+	struct xccdf_rule_result *rr = job->rr;
+	if (job->failed) {
+		_rule_add_info_message(rr, "Fix was not executed. Execution was aborted.");
+		return 1;
+	}
+	if (job->lost) {
+		xccdf_rule_result_set_result(rr, XCCDF_RESULT_ERROR);
+		if (!oscap_string_empty(job->output))
+			_rule_add_info_message(rr, "%s", oscap_string_get_cstr(job->output));
+		return 1;
+	}
+	_rule_add_info_message(rr, "Fix execution completed and returned: %d", job->exit_code);
+	if (!oscap_string_empty(job->output))
+		_rule_add_info_message(rr, "%s", oscap_string_get_cstr(job->output));
 
 	/* We report rule during remediation only when the fix was actually executed */
 	int report = 0;
@@ -496,11 +873,11 @@ int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf
 	}
 
 	/* Verify applied fix by calling OVAL again */
-	if (check == NULL) {
+	if (job->check == NULL) {
 		xccdf_rule_result_set_result(rr, XCCDF_RESULT_ERROR);
 		_rule_add_info_message(rr, "Failed to verify applied fix: Missing xccdf:check.");
 	} else {
-		int new_result = xccdf_policy_check_evaluate(policy, check);
+		int new_result = xccdf_policy_check_evaluate(policy, job->check);
 		if (new_result == XCCDF_RESULT_PASS)
 			xccdf_rule_result_set_result(rr, XCCDF_RESULT_FIXED);
 		else {
@@ -514,15 +891,75 @@ int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf
 	return rule == NULL ? 0 : xccdf_policy_report_cb(policy, XCCDF_POLICY_OUTCB_END, (void *) rr);
 }
 
+int xccdf_policy_rule_result_remediate(struct xccdf_policy *policy, struct xccdf_rule_result *rr, struct xccdf_fix *fix, struct xccdf_result *test_result)
+{
+	int ret;
+	struct _fix_job *job = _xccdf_policy_rule_result_prepare_fix(policy, rr, fix, test_result, &ret);
+	if (job == NULL)
+		return ret;
+
+	struct oscap_list *jobs = oscap_list_new();
+	oscap_list_add(jobs, job);
+	_xccdf_fix_jobs_run(jobs, 1);
+	ret = _xccdf_policy_fix_job_finish(policy, job);
+	oscap_list_free(jobs, (oscap_destruct_func) _xccdf_fix_job_free);
+	return ret;
+}
+
+/**
+ * Fixes run one by one unless more workers are asked for explicitly
+ */
+static unsigned int _xccdf_policy_remediation_workers(void)
+{
+	const char *workers = getenv("OSCAP_REMEDIATION_WORKERS");
+	if (workers != NULL && atoi(workers) > 0)
+		return atoi(workers);
+	return 1;
+}
+
+/**
+ * Execute the group of mutually independent fixes in parallel and verify them in rule order
+ */
+static void _xccdf_policy_remediate_group(struct xccdf_policy *policy, struct oscap_list **group_ptr, unsigned int max_workers)
+{
+	struct oscap_list *group = *group_ptr;
+	if (oscap_list_get_itemcount(group) > 1)
+		dI("Executing %d independent fixes in parallel.", oscap_list_get_itemcount(group));
+	_xccdf_fix_jobs_run(group, max_workers);
+	struct oscap_iterator *job_it = oscap_iterator_new(group);
+	while (oscap_iterator_has_more(job_it))
+		_xccdf_policy_fix_job_finish(policy, oscap_iterator_next(job_it));
+	oscap_iterator_free(job_it);
+	oscap_list_free(group, (oscap_destruct_func) _xccdf_fix_job_free);
+	*group_ptr = oscap_list_new();
+}
+
 int xccdf_policy_remediate(struct xccdf_policy *policy, struct xccdf_result *result)
 {
 	__attribute__nonnull__(result);
+	const unsigned int max_workers = _xccdf_policy_remediation_workers();
+	xccdf_policy_invalidate_value_indexes(policy);
+
+	/* Consecutive fixes which may run along with each other form a group. The fixes
+	 * of a group touch disjoint sets of files. A fix which touches shared state
+	 * runs alone and gets verified before any following fix is executed. */
+	struct oscap_list *group = oscap_list_new();
 	struct xccdf_rule_result_iterator *rr_it = xccdf_result_get_rule_results(result);
 	while (xccdf_rule_result_iterator_has_more(rr_it)) {
 		struct xccdf_rule_result *rr = xccdf_rule_result_iterator_next(rr_it);
-		xccdf_policy_rule_result_remediate(policy, rr, NULL, result);
+		int ret;
+		struct _fix_job *job = _xccdf_policy_rule_result_prepare_fix(policy, rr, NULL, result, &ret);
+		if (job == NULL)
+			continue;
+		if (job->serial || max_workers == 1 || _xccdf_fix_job_conflicts(job, group))
+			_xccdf_policy_remediate_group(policy, &group, max_workers);
+		oscap_list_add(group, job);
+		if (job->serial || max_workers == 1)
+			_xccdf_policy_remediate_group(policy, &group, max_workers);
 	}
 	xccdf_rule_result_iterator_free(rr_it);
+	_xccdf_policy_remediate_group(policy, &group, max_workers);
+	oscap_list_free0(group);
 	xccdf_result_set_end_time_current(result);
 	return 0;
 }
@@ -910,6 +1347,7 @@ int xccdf_policy_generate_fix(struct xccdf_policy *policy, struct xccdf_result *
 {
 	__attribute__nonnull__(policy);
 	int ret = 0;
+	xccdf_policy_invalidate_value_indexes(policy);
 
 	struct oscap_list *rules_to_fix = oscap_list_new();
 	if (result == NULL) {
@@ -25,9 +25,9 @@
 #include <libxml/tree.h>
 
 #include "util.h"
-#include "xml_iterate.h"
+#include "list.h"
+#include "oscap_string.h"
 #include "debug_priv.h"
-#include "assume.h"
 #include "_error.h"
 #include "XCCDF/elements.h"
 #include "XCCDF/xccdf_impl.h"
@@ -51,146 +51,363 @@ static bool _xhtml_is_supported_namespace(xmlNs *ns)
 	return ns != NULL && oscap_streq((const char *) ns->href, (const char *) XCCDF_XHTML_NAMESPACE);
 }
 
-static int _xccdf_text_substitution_cb(xmlNode **node, void *user_data)
+/**
+ * Substitution element of a compiled text
+ */
+struct xccdf_text_slot {
+	enum {
+		_SLOT_SUB_INVALID,	// xccdf:sub without @idref
+		_SLOT_SUB,		// xccdf:sub
+		_SLOT_OBJECT_VALUE,	// xhtml:object/@data="#xccdf:value:..."
+		_SLOT_OBJECT_TITLE,	// xhtml:object/@data="#xccdf:title:..."
+		_SLOT_INSTANCE		// xccdf:instance
+	} type;
+	char *idref;			// id of the referenced item
+	char *use;			// xccdf:sub/@use
+};
+
+/**
+ * Substitutable text split into literal segments and substitution slots.
+ * The literal segments are already serialized XML; the text is resolved
+ * by concatenating them with the (escaped) values of the slots:
+ * segments[0] slots[0] segments[1] ... slots[count-1] segments[count]
+ */
+struct xccdf_text_template {
+	bool broken;			// the text is not well-formed XML
+	size_t count;			// number of slots
+	struct xccdf_text_slot *slots;
+	char **segments;		// count + 1 literal segments
+};
+
+struct _xccdf_text_compilation {
+	const char *marker;		// prefix of the comments which stand for the slots
+	struct xccdf_text_slot *slots;
+	size_t count;
+	size_t alloc;
+};
+
+static void _xccdf_text_compilation_replace(struct _xccdf_text_compilation *comp, xmlNode *node, int type, char *idref, char *use)
 {
-	struct _xccdf_text_substitution_data *data = (struct _xccdf_text_substitution_data *) user_data;
-	if (node == NULL || *node == NULL || data == NULL)
-		return 1;
+	if (comp->count == comp->alloc) {
+		comp->alloc = comp->alloc ? 2 * comp->alloc : 8;
+		comp->slots = realloc(comp->slots, comp->alloc * sizeof(struct xccdf_text_slot));
+	}
+	struct xccdf_text_slot *slot = &comp->slots[comp->count];
+	slot->type = type;
+	slot->idref = idref;
+	slot->use = use;
 
-	if (oscap_streq((const char *) (*node)->name, "sub") && xccdf_is_supported_namespace((*node)->ns)) {
-		if ((*node)->children != NULL)
-			dW("The xccdf:sub element SHALL NOT have any content.");
-		char *sub_idref = (char *) xmlGetProp(*node, BAD_CAST "idref");
-		if (oscap_streq(sub_idref, NULL)) {
-			oscap_seterr(OSCAP_EFAMILY_XCCDF, "The xccdf:sub MUST have a single @idref attribute.");
-			free(sub_idref); // It may be an empty string.
-			return 2;
+	char *comment = oscap_sprintf("%s%zu", comp->marker, comp->count++);
+	xmlNode *marker = xmlNewComment(BAD_CAST comment);
+	free(comment);
+	xmlReplaceNode(node, marker);
+	xmlFreeNode(node);
+}
+
+static void _xccdf_text_compile_children(xmlNode *parent, struct _xccdf_text_compilation *comp)
+{
+	xmlNode *node = parent->children;
+	while (node != NULL) {
+		xmlNode *next = node->next;
+		if (node->type != XML_ELEMENT_NODE) {
+			node = next;
+			continue;
 		}
-		// Sub element may refer to xccdf:Value or to xccdf:plain-text
 
-		struct xccdf_benchmark *benchmark = xccdf_policy_get_benchmark(data->policy);
-		if (benchmark == NULL)
+		if (oscap_streq((const char *) node->name, "sub") && xccdf_is_supported_namespace(node->ns)) {
+			if (node->children != NULL)
+				dW("The xccdf:sub element SHALL NOT have any content.");
+			char *sub_idref = (char *) xmlGetProp(node, BAD_CAST "idref");
+			if (oscap_streq(sub_idref, NULL)) {
+				free(sub_idref); // It may be an empty string.
+				_xccdf_text_compilation_replace(comp, node, _SLOT_SUB_INVALID, NULL, NULL);
+			} else {
+				char *sub_use = (char *) xmlGetProp(node, BAD_CAST "use");
+				_xccdf_text_compilation_replace(comp, node, _SLOT_SUB, sub_idref, sub_use);
+			}
+		} else if (oscap_streq((const char *) node->name, "object") && _xhtml_is_supported_namespace(node->ns)) {
+			char *object_data = (char *) xmlGetProp(node, BAD_CAST "data");
+			if (object_data != NULL && strncmp(object_data, "#xccdf:value:", strlen("#xccdf:value:")) == 0) {
+				_xccdf_text_compilation_replace(comp, node, _SLOT_OBJECT_VALUE,
+					oscap_strdup(object_data + strlen("#xccdf:value:")), NULL);
+			} else if (object_data != NULL && strncmp(object_data, "#xccdf:title:", strlen("#xccdf:title:")) == 0) {
+				_xccdf_text_compilation_replace(comp, node, _SLOT_OBJECT_TITLE,
+					oscap_strdup(object_data + strlen("#xccdf:title:")), NULL);
+			} else {
+				if (object_data != NULL && strncmp(object_data, "#xccdf:", strlen("#xccdf:")) == 0)
+					// Let's not consider this as an error. Since in similar cases NISTIR-7275r4
+					// suggests to retain the <object> element.
+					dW("Unsupported XCCDF uri: xhtml:object/@data='%s'", object_data);
+				// Not an error, unless it shall be resolved by XCCDF
+				_xccdf_text_compile_children(node, comp);
+			}
+			free(object_data);
+		} else if (oscap_streq((const char *) node->name, "instance") && xccdf_is_supported_namespace(node->ns)) {
+			if (node->children != NULL)
+				dW("The xccdf:instance element SHALL NOT have any content.");
+			_xccdf_text_compilation_replace(comp, node, _SLOT_INSTANCE, NULL, NULL);
+		} else {
+			_xccdf_text_compile_children(node, comp);
+		}
+		node = next;
+	}
+}
+
+/**
+ * Compile the given substitutable text. The text is parsed only once, all
+ * the elements to substitute are replaced by XML comments with unique
+ * content and the serialized document is split at these comments.
+ */
+static struct xccdf_text_template *xccdf_text_template_new(const char *text)
+{
+	struct xccdf_text_template *tmpl = calloc(1, sizeof(struct xccdf_text_template));
+
+	char *input_document = oscap_sprintf("<x xmlns='http://www.w3.org/1999/xhtml'>%s</x>", text);
+	xmlDoc *doc = xmlParseMemory(input_document, strlen(input_document));
+	xmlNode *root = doc != NULL ? xmlDocGetRootElement(doc) : NULL;
+	if (root == NULL) {
+		dW("Could not parse substitutable text: '%s'", input_document);
+		free(input_document);
+		xmlFreeDoc(doc);
+		tmpl->broken = true;
+		return tmpl;
+	}
+	free(input_document);
+
+	/* The marker must not be a part of the text itself. */
+	struct oscap_string *marker = oscap_string_new();
+	oscap_string_append_string(marker, "xccdf-slot-");
+	while (strstr(text, oscap_string_get_cstr(marker)) != NULL)
+		oscap_string_append_char(marker, '-');
+
+	struct _xccdf_text_compilation comp = {
+		.marker = oscap_string_get_cstr(marker),
+	};
+	_xccdf_text_compile_children(root, &comp);
+
+	/* We cannot simply xmlDumpMemory, because we need to skip the upper <x/> element. */
+	xmlBuffer *buff = xmlBufferCreate();
+	for (xmlNode *child = root->children; child != NULL; child = child->next) {
+		if (xmlNodeDump(buff, doc, child, 0, 0) < 0)
+			dE("xmlNodeDump failed!");
+	}
+	xmlFreeDoc(doc);
+
+	tmpl->count = comp.count;
+	tmpl->slots = comp.slots;
+	tmpl->segments = calloc(comp.count + 1, sizeof(char *));
+	const char *pos = (const char *) xmlBufferContent(buff);
+	for (size_t n = 0; n < comp.count && !tmpl->broken; n++) {
+		char *comment = oscap_sprintf("<!--%s%zu-->", comp.marker, n);
+		const char *end = strstr(pos, comment);
+		if (end != NULL) {
+			tmpl->segments[n] = strndup(pos, end - pos);
+			pos = end + strlen(comment);
+		} else {
+			dE("Could not find substitution slot %zu in '%s'.", n, text);
+			tmpl->broken = true;
+		}
+		free(comment);
+	}
+	tmpl->segments[comp.count] = oscap_strdup(pos);
+	xmlBufferFree(buff);
+	oscap_string_free(marker);
+	return tmpl;
+}
+
+void xccdf_text_template_free(struct xccdf_text_template *tmpl)
+{
+	if (tmpl == NULL)
+		return;
+	for (size_t n = 0; n < tmpl->count; n++) {
+		free(tmpl->slots[n].idref);
+		free(tmpl->slots[n].use);
+	}
+	free(tmpl->slots);
+	if (tmpl->segments != NULL) {
+		for (size_t n = 0; n <= tmpl->count; n++)
+			free(tmpl->segments[n]);
+		free(tmpl->segments);
+	}
+	free(tmpl);
+}
+
+static struct xccdf_text_template *_xccdf_policy_get_text_template(struct xccdf_policy *policy, const char *text)
+{
+	if (policy->text_templates == NULL)
+		policy->text_templates = oscap_htable_new();
+	struct xccdf_text_template *tmpl = oscap_htable_get(policy->text_templates, text);
+	if (tmpl == NULL) {
+		tmpl = xccdf_text_template_new(text);
+		oscap_htable_add(policy->text_templates, text, tmpl);
+	}
+	return tmpl;
+}
+
+/**
+ * Append text as it would be serialized in XML text node
+ */
+static void _xccdf_text_append_escaped(struct oscap_string *out, const char *text)
+{
+	if (text == NULL)
+		return;
+	const char *c = text;
+	while (*c != '\0' && *c != '<' && *c != '>' && *c != '&' && *c != '\r' && (unsigned char) *c < 0x80)
+		c++;
+	if (*c == '\0') {
+		oscap_string_append_string(out, text);
+		return;
+	}
+	/* Leave the rest to libxml, so that the result is the same as if the text
+	 * had been substituted in the tree. */
+	xmlNode *node = xmlNewText(BAD_CAST text);
+	xmlBuffer *buff = xmlBufferCreate();
+	xmlNodeDump(buff, NULL, node, 0, 0);
+	oscap_string_append_string(out, (const char *) xmlBufferContent(buff));
+	xmlBufferFree(buff);
+	xmlFreeNode(node);
+}
+
+static const char *_xccdf_item_get_first_title(struct xccdf_item *item)
+{
+	// TODO: @xml:lang
+	const char *result = NULL;
+	struct oscap_text_iterator *title_it = xccdf_item_get_title(item);
+	if (oscap_text_iterator_has_more(title_it))
+		result = oscap_text_get_text(oscap_text_iterator_next(title_it));
+	oscap_text_iterator_free(title_it);
+	return result;
+}
+
+/**
+ * Resolve a slot of compiled text
+ * @returns 0 on success, 1 on failure (the substitution shall be aborted), 2 on error
+ */
+static int _xccdf_text_slot_resolve(const struct xccdf_text_slot *slot, struct _xccdf_text_substitution_data *data, const char **result)
+{
+	*result = NULL;
+	if (slot->type == _SLOT_SUB_INVALID) {
+		oscap_seterr(OSCAP_EFAMILY_XCCDF, "The xccdf:sub MUST have a single @idref attribute.");
+		return 2;
+	}
+
+	if (slot->type == _SLOT_INSTANCE) {
+		if (data->rule_result == NULL)
 			return 1;
-		struct xccdf_item *value = xccdf_benchmark_get_item(benchmark, sub_idref);
+		struct xccdf_instance_iterator *instances = xccdf_rule_result_get_instances(data->rule_result);
+		if (xccdf_instance_iterator_has_more(instances)) {
+			struct xccdf_instance *instance = xccdf_instance_iterator_next(instances);
+			*result = xccdf_instance_get_content(instance);
+			xccdf_instance_iterator_free(instances);
+		}
+		else {
+			xccdf_instance_iterator_free(instances);
+			dW("The xccdf:rule-result/xccdf:instance element was not found.");
+			return 1;
+		}
+		return 0;
+	}
 
-		const char *result = NULL;
-		if (value != NULL && xccdf_item_get_type(value) == XCCDF_VALUE) {
+	struct xccdf_benchmark *benchmark = xccdf_policy_get_benchmark(data->policy);
+	if (benchmark == NULL)
+		return 1;
+	struct xccdf_item *item = xccdf_benchmark_get_item(benchmark, slot->idref);
+
+	switch (slot->type) {
+	case _SLOT_SUB:
+		// Sub element may refer to xccdf:Value or to xccdf:plain-text
+		if (item != NULL && xccdf_item_get_type(item) == XCCDF_VALUE) {
 			// When the <xccdf:sub> element's @idref attribute holds the id of an <xccdf:Value>
 			// element, the <xccdf:sub> element's @use attribute MUST be consulted.
-			char *sub_use = (char *) xmlGetProp(*node, BAD_CAST "use");
+			const char *sub_use = slot->use;
 			if (oscap_streq(sub_use, NULL) || oscap_streq(sub_use, "legacy")) {
 				// If the value of the @use attribute is "legacy", then during Tailoring,
 				// process the <xccdf:sub> element as if @use was set to "title". but
 				// during Document Generation or Assessment, process the <xccdf:sub>
 				// element as if @use was set to "value".
-				free(sub_use);
-				sub_use = oscap_strdup((data->processing_type & _TAILORING_TYPE) ? "title" : "value");
+				sub_use = (data->processing_type & _TAILORING_TYPE) ? "title" : "value";
 			}
 
 			if (oscap_streq(sub_use, "title")) {
-				// TODO: @xml:lang
-				struct oscap_text_iterator *title_it = xccdf_item_get_title(value);
-				if (oscap_text_iterator_has_more(title_it))
-					result = oscap_text_get_text(oscap_text_iterator_next(title_it));
-				oscap_text_iterator_free(title_it);
+				*result = _xccdf_item_get_first_title(item);
 			} else {
 				if (!oscap_streq(sub_use, "value"))
-					dW("xccdf:sub/@idref='%s' has incorrect @use='%s'! Using @use='value' instead.", sub_idref, sub_use);
-				result = xccdf_policy_get_value_of_item(data->policy, value);
+					dW("xccdf:sub/@idref='%s' has incorrect @use='%s'! Using @use='value' instead.", slot->idref, sub_use);
+				*result = xccdf_policy_get_value_of_item(data->policy, item);
 			}
-			free(sub_use);
 		} else { // This xccdf:sub probably refers to the xccdf:plain-text
-			result = xccdf_benchmark_get_plain_text(benchmark, sub_idref);
+			*result = xccdf_benchmark_get_plain_text(benchmark, slot->idref);
 		}
 
-		if (result == NULL) {
-			oscap_seterr(OSCAP_EFAMILY_XCCDF, "Could not resolve xccdf:sub/@idref='%s'!", sub_idref);
-			free(sub_idref);
+		if (*result == NULL) {
+			oscap_seterr(OSCAP_EFAMILY_XCCDF, "Could not resolve xccdf:sub/@idref='%s'!", slot->idref);
 			return 2;
 		}
-		free(sub_idref);
-
-		xmlNode *new_node = xmlNewText(BAD_CAST result);
-		xmlReplaceNode(*node, new_node);
-		xmlFreeNode(*node);
-		*node = new_node;
 		return 0;
-	} else if (oscap_streq((const char *) (*node)->name, "object") && _xhtml_is_supported_namespace((*node)->ns)) {
-		char *object_data = (char *) xmlGetProp(*node, BAD_CAST "data");
-		if (object_data == NULL || strncmp(object_data, "#xccdf:", strlen("#xccdf:")) != 0) {
-			free(object_data);
-			return 0; // Not an error, unless it shall be resolved by XCCDF
+	case _SLOT_OBJECT_VALUE:
+		if (item != NULL && xccdf_item_get_type(item) == XCCDF_VALUE) {
+			*result = xccdf_policy_get_value_of_item(data->policy, item);
+		} else {
+			*result = xccdf_benchmark_get_plain_text(benchmark, slot->idref);
+			if (*result == NULL) {
+				dW("Text substitution for xccdf:fact is not supported!"); // TODO.
+			}
 		}
+		return 0;
+	case _SLOT_OBJECT_TITLE:
+		if (item != NULL)
+			*result = _xccdf_item_get_first_title(item);
+		return 0;
+	default:
+		break;
+	}
+	return 1;
+}
 
-		struct xccdf_benchmark *benchmark = xccdf_policy_get_benchmark(data->policy);
-		if (benchmark == NULL)
-			return 1;
+/**
+ * Resolve the compiled text
+ * @returns 0 on success, 1 on failure, 2 if any of the slots could not be resolved
+ */
+static int _xccdf_text_template_resolve(const struct xccdf_text_template *tmpl, struct _xccdf_text_substitution_data *data, char **resolved)
+{
+	*resolved = NULL;
+	if (tmpl->broken)
+		return 1;
 
+	int res = 0;
+	struct oscap_string *out = oscap_string_new();
+	oscap_string_append_string(out, tmpl->segments[0]);
+	for (size_t n = 0; n < tmpl->count; n++) {
 		const char *result = NULL;
-		if (strncmp(object_data, "#xccdf:value:", strlen("#xccdf:value:")) == 0) {
-			const char *value_id = object_data + strlen("#xccdf:value:");
-
-			struct xccdf_item *item = xccdf_benchmark_get_item(benchmark, value_id);
-			if (item != NULL && xccdf_item_get_type(item) == XCCDF_VALUE) {
-				result = xccdf_policy_get_value_of_item(data->policy, item);
-			} else {
-				result = xccdf_benchmark_get_plain_text(benchmark, value_id);
-				if (result == NULL) {
-					dW("Text substitution for xccdf:fact is not supported!"); // TODO.
-				}
-			}
-		}
-		else if (strncmp(object_data, "#xccdf:title:", strlen("#xccdf:title:")) == 0) {
-			const char *title_id = object_data + strlen("#xccdf:title:");
-
-			struct xccdf_item *item = xccdf_benchmark_get_item(benchmark, title_id);
-			if (item != NULL) {
-				// TODO: @xml:lang
-				struct oscap_text_iterator *title_it = xccdf_item_get_title(item);
-				if (oscap_text_iterator_has_more(title_it))
-					result = oscap_text_get_text(oscap_text_iterator_next(title_it));
-				oscap_text_iterator_free(title_it);
-			}
-		}
-		else {
-			// Let's not consider this as an error. Since in similar cases NISTIR-7275r4
-			// suggests to retain the <object> element.
-			dW("Unsupported XCCDF uri: xhtml:object/@data='%s'", object_data);
-			free(object_data);
-			return 0;
-		}
-		free(object_data);
-		xmlNode *new_node = xmlNewText(BAD_CAST result);
-		xmlReplaceNode(*node, new_node);
-		xmlFreeNode(*node);
-		*node = new_node;
-		return 0;
-	} else if (oscap_streq((const char *) (*node)->name, "instance") && xccdf_is_supported_namespace((*node)->ns)) {
-		const char *result;
-		// <instance> elements
-		if ((*node)->children != NULL)
-			dW("The xccdf:instance element SHALL NOT have any content.");
-		if (data->rule_result == NULL)
-			return 1;
-		struct xccdf_instance_iterator *instances = xccdf_rule_result_get_instances(data->rule_result);
-		if (xccdf_instance_iterator_has_more(instances)) {
-			struct xccdf_instance *instance = xccdf_instance_iterator_next(instances);
-			result = xccdf_instance_get_content(instance);
-			xccdf_instance_iterator_free(instances);
-		}
-		else {
-			xccdf_instance_iterator_free(instances);
-			dW("The xccdf:rule-result/xccdf:instance element was not found.");
+		int slot_res = _xccdf_text_slot_resolve(&tmpl->slots[n], data, &result);
+		if (slot_res == 1) {
+			oscap_string_free(out);
 			return 1;
 		}
-		xmlNode *new_node = xmlNewText(BAD_CAST result);
-		xmlReplaceNode(*node, new_node);
-		xmlFreeNode(*node);
-		*node = new_node;
-		return 0;
-	} else {
-		return 0;
+		if (res == 0)
+			res = slot_res;
+		_xccdf_text_append_escaped(out, result);
+		oscap_string_append_string(out, tmpl->segments[n + 1]);
+	}
+	if (res != 0) {
+		oscap_string_free(out);
+		return res;
 	}
+	*resolved = oscap_string_bequeath(out);
+	return 0;
+}
+
+static int _xccdf_policy_substitute(const char *text, struct _xccdf_text_substitution_data *data, char **resolved)
+{
+	if (text == NULL)
+		text = "";
+	if (data->policy == NULL) {
+		struct xccdf_text_template *tmpl = xccdf_text_template_new(text);
+		int res = _xccdf_text_template_resolve(tmpl, data, resolved);
+		xccdf_text_template_free(tmpl);
+		return res;
+	}
+	return _xccdf_text_template_resolve(_xccdf_policy_get_text_template(data->policy, text), data, resolved);
 }
 
 int xccdf_policy_resolve_fix_substitution(struct xccdf_policy *policy, struct xccdf_fix *fix, struct xccdf_rule_result *rule_result, struct xccdf_result *test_result)
@@ -201,7 +418,7 @@ int xccdf_policy_resolve_fix_substitution(struct xccdf_policy *policy, struct xc
 	data.rule_result = rule_result;
 
 	char *result = NULL;
-	int res = xml_iterate_dfs(xccdf_fix_get_content(fix), &result, _xccdf_text_substitution_cb, &data);
+	int res = _xccdf_policy_substitute(xccdf_fix_get_content(fix), &data, &result);
 	if (res == 0)
 		xccdf_fix_set_content(fix, result);
 	free(result);
@@ -216,11 +433,8 @@ char* xccdf_policy_substitute(const char *text, struct xccdf_policy *policy) {
 	data.processing_type = _DOCUMENT_GENERATION_TYPE | _ASSESSMENT_TYPE;
 
 	char *resolved_text = NULL;
-	if (xml_iterate_dfs(text, &resolved_text, _xccdf_text_substitution_cb, &data) != 0) {
-		// Either warning or error occured. Since prototype of this function
-		// does not make possible warning notification -> We better scratch that.
-		free(resolved_text);
-		resolved_text = NULL;
-	}
+	// Either warning or error occured. Since prototype of this function
+	// does not make possible warning notification -> We better scratch that.
+	_xccdf_policy_substitute(text, &data, &resolved_text);
 	return resolved_text;
 }
@@ -110,6 +110,7 @@ void oscap_init(void)
 void oscap_cleanup(void)
 {
 	oscap_clearerr();
+	oscap_xslt_cache_free();
 	xsltCleanupGlobals();
 	xmlCleanupParser();
 }
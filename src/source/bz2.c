@@ -25,10 +25,8 @@
 #include "config.h"
 #endif
 
-#include <libxml/tree.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
 
 #include "bz2_priv.h"
 #include "common/_error.h"
@@ -37,179 +35,102 @@
 
 #include <bzlib.h>
 
-struct bz2_file {
-	FILE *f;
-	BZFILE *file;
-	bool eof;
-};
-
-static struct bz2_file *bz2_fd_open(int fd)
-{
-	struct bz2_file *b = NULL;
-	FILE* f;
-	int bzerror;
-
-	f = fdopen (fd, "r" );
-	if (f) {
-		b = malloc(sizeof(struct bz2_file));
-		b->f = f;
-		b->file = BZ2_bzReadOpen(&bzerror, f, 0, 0, NULL, 0);
-		b->eof = false;
-		if (bzerror != BZ_OK) {
-			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build BZ2FILE from %s: %s",
-					BZ2_bzerror(b->file, &bzerror));
-			BZ2_bzReadClose(&bzerror, b->file);
-			free(b);
-			b = NULL;
-		}
-	}
-	return b;
-}
-
-//xmlInputReadCallback
-static int bz2_file_read(struct bz2_file *bzfile, char *buffer, int len)
-{
-	int bzerror;
-	if (bzfile->eof) {
-		// If we run bzRead on closed file we will get SEQUENCE_ERROR
-		return 0;
-	}
-	int size = BZ2_bzRead(&bzerror, (bzfile)->file, buffer, len);
-	if (bzerror == BZ_STREAM_END) {
-		bzfile->eof = true;
-	}
-	if (bzerror == BZ_OK || bzerror == BZ_STREAM_END)
-		return size;
-	else {
-		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not read from bZ2FILE: %s",
-				BZ2_bzerror(bzfile->file, &bzerror));
-		return -1;
-	}
-}
-
-// xmlInputCloseCallback
-static int bz2_file_close(void *bzfile)
-{
-	int bzerror;
-	BZ2_bzReadClose(&bzerror, ((struct bz2_file *)bzfile)->file);
-	fclose(((struct bz2_file *)bzfile)->f);
-	free(bzfile);
-	return bzerror == BZ_OK ? 0 : -1;
-}
-
-xmlDoc *bz2_fd_read_doc(int fd)
+static void *bz2_decoder_new(void)
 {
-	struct bz2_file *bzfile = bz2_fd_open(fd);
-	if (bzfile == NULL) {
+	bz_stream *stream = calloc(1, sizeof(bz_stream));
+	int bzerror = BZ2_bzDecompressInit(stream, 0, 0);
+	if (bzerror != BZ_OK) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build bz_stream: BZ2_bzDecompressInit returns %d", bzerror);
+		free(stream);
 		return NULL;
 	}
-	return xmlReadIO((xmlInputReadCallback) bz2_file_read, bz2_file_close, bzfile, "url", NULL, XML_PARSE_PEDANTIC);
-}
-
-struct bz2_mem {
-	bz_stream *stream;
-	bool eof;
-};
-
-static void bz2_mem_free(struct bz2_mem *bzmem)
-{
-	free(bzmem->stream);
-	free(bzmem);
+	return stream;
 }
 
-static struct bz2_mem *bz2_mem_open(const char *buffer, size_t size)
+static oscap_codec_status_t bz2_decode(void *decoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out)
 {
-	struct bz2_mem *b = calloc(sizeof(struct bz2_mem), 1);
-	b->stream = calloc(sizeof(bz_stream), 1);
+	bz_stream *stream = decoder;
 	// next_in should point at the compressed data
-	b->stream->next_in = (char *) buffer;
+	stream->next_in = in->data + in->pos;
 	// and avail_in should indicate how many bytes the library may read
-	b->stream->avail_in = size;
-	int bzerror = BZ2_bzDecompressInit(b->stream, 0, 0);
-	if (bzerror != BZ_OK) {
-		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build bz_stream from memory buffer: BZ2_bzDecompressInit returns %d", bzerror);
-		bz2_mem_free(b);
-		return NULL;
-	}
-	return b;
-}
-
-// xmlInputReadCallback
-static int bz2_mem_read(struct bz2_mem *bzmem, char *buffer, int len)
-{
-	if (len < 1) {
-		// ensure that at least one byte of output space is available at each BZ2_bzDecompress call.
-		return 0;
-	}
-	if (bzmem->eof) {
-		// If we run BZ2_bzDecompress on processed buffer we will get -1 (SEQUENCE_ERROR)
-		return 0;
-	}
+	stream->avail_in = in->size - in->pos;
 	// next_out should point to a buffer in which the uncompressed output is to be placed
-	bzmem->stream->next_out = buffer;
+	stream->next_out = out->data + out->pos;
 	// with avail_out indicating how much output space is available.
-	bzmem->stream->avail_out = len;
-	int bzerror = BZ2_bzDecompress(bzmem->stream);
-	if (bzerror == BZ_STREAM_END) {
-		bzmem->eof = true;
-	}
-	if (bzerror == BZ_OK || bzerror == BZ_STREAM_END)
-		return (len - bzmem->stream->avail_out);
-	else {
+	stream->avail_out = out->size - out->pos;
+	int bzerror = BZ2_bzDecompress(stream);
+	in->pos = in->size - stream->avail_in;
+	out->pos = out->size - stream->avail_out;
+	switch (bzerror) {
+	case BZ_OK:
+		return OSCAP_CODEC_OK;
+	case BZ_STREAM_END:
+		return OSCAP_CODEC_STREAM_END;
+	default:
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not read from bz_stream: BZ2_bzDecompress returns %d", bzerror);
-		return -1;
+		return OSCAP_CODEC_ERROR;
 	}
 }
 
-// xmlInputCloseCallback
-static int bz2_mem_close(void *bzmem) {
-	int bzerror = BZ2_bzDecompressEnd(((struct bz2_mem *)bzmem)->stream);
-	bz2_mem_free(bzmem);
-	if (bzerror != BZ_OK) {
-		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not close bz_stream: BZ2_bzDecompressEnd returns %d", bzerror);
-	}
-	return bzerror == BZ_OK ? 0 : -1;
+static void bz2_decoder_free(void *decoder)
+{
+	BZ2_bzDecompressEnd((bz_stream *) decoder);
+	free(decoder);
 }
 
-xmlDoc *bz2_mem_read_doc(const char *buffer, size_t size)
+static void *bz2_encoder_new(void)
 {
-	struct bz2_mem *bzmem = bz2_mem_open(buffer, size);
-	if (bzmem == NULL) {
+	bz_stream *stream = calloc(1, sizeof(bz_stream));
+	int bzerror = BZ2_bzCompressInit(stream, 9, 0, 0);
+	if (bzerror != BZ_OK) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build bz_stream: BZ2_bzCompressInit returns %d", bzerror);
+		free(stream);
 		return NULL;
 	}
-	return xmlReadIO((xmlInputReadCallback) bz2_mem_read, bz2_mem_close, bzmem, "url", NULL, XML_PARSE_PEDANTIC);
+	return stream;
 }
 
-#endif
-
-static const char magic_number[] = {'B','Z'};
-
-bool bz2_memory_is_bzip(const char* memory, const size_t size){
-	if (size < 2){
-		return false; // Cannot read magic number
+static oscap_codec_status_t bz2_encode(void *encoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out, bool finish)
+{
+	bz_stream *stream = encoder;
+	stream->next_in = in->data + in->pos;
+	stream->avail_in = in->size - in->pos;
+	stream->next_out = out->data + out->pos;
+	stream->avail_out = out->size - out->pos;
+	int bzerror = BZ2_bzCompress(stream, finish ? BZ_FINISH : BZ_RUN);
+	in->pos = in->size - stream->avail_in;
+	out->pos = out->size - stream->avail_out;
+	switch (bzerror) {
+	case BZ_RUN_OK:
+	case BZ_FINISH_OK:
+		return OSCAP_CODEC_OK;
+	case BZ_STREAM_END:
+		return OSCAP_CODEC_STREAM_END;
+	default:
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not write to bz_stream: BZ2_bzCompress returns %d", bzerror);
+		return OSCAP_CODEC_ERROR;
 	}
-
-	// compare memory header with reference magic_number of bz2
-	return ((memory[0] == magic_number[0]) && (memory[1] == magic_number[1]));
 }
 
-bool bz2_fd_is_bzip(int fd)
+static void bz2_encoder_free(void *encoder)
 {
-	int fd_dup = dup(fd);
-	if (fd_dup == -1) {
-		return false;
-	}
-	FILE* file = fdopen(fd_dup, "r");
-	bool is_bzip;
-	if (file == NULL) {
-		return false; // cannot open/determine file type
-	} else {
-		// Compare magic number with file header. Type casting to integer solve EOF (-1) returned by fgetc()
-		is_bzip = (fgetc(file) == (int)magic_number[0]) && (fgetc(file) == (int)magic_number[1]);
-	}
+	BZ2_bzCompressEnd((bz_stream *) encoder);
+	free(encoder);
+}
 
-	fclose(file);
-	lseek(fd, 0, SEEK_SET);
-	return is_bzip;
+#endif
 
-}
+const struct oscap_codec oscap_codec_bz2 = {
+	.name = "bz2",
+	.suffix = ".bz2",
+	.magic = "BZh",
+	.magic_size = 3,
+#ifdef HAVE_BZ2
+	.decoder_new = bz2_decoder_new,
+	.decode = bz2_decode,
+	.decoder_free = bz2_decoder_free,
+	.encoder_new = bz2_encoder_new,
+	.encode = bz2_encode,
+	.encoder_free = bz2_encoder_free,
+#endif
+};
@@ -25,47 +25,15 @@
 #include <config.h>
 #endif
 
-#include "common/public/oscap.h"
 #include "common/util.h"
-#include <libxml/tree.h>
+#include "source/compress_priv.h"
 
 OSCAP_HIDDEN_START;
 
-#ifdef HAVE_BZ2
-
-/**
- * Parse *.xml.bz2 file to XML DOM
- * @param fd The file descriptor to bz2 file
- * @returns DOM representation of the file
- */
-xmlDoc *bz2_fd_read_doc(int fd);
-
-/**
- * Parse bzip2ed memory to XML DOM.
- * @param buffer data in memory to process (contains bzip2ed XML)
- * @param size length of data
- * @returns DOM representation of the data
- */
-xmlDoc *bz2_mem_read_doc(const char *buffer, size_t size);
-
-#endif // HAVE_BZ2
-
-/**
- * Recognize whether the file can be parsed by this
- * bz2 parser. Do not close the file.
- * @param file descriptor to opened file
- * @returns true if can be parsed.
- */
-bool bz2_fd_is_bzip(int fd);
-
 /**
- * @brief Recognize whether the file can be parsed by this
- * bz2 parser
- * @param memory Raw memory with file content
- * @param size Size of memory
- * @return true if can be parsed
+ * Codec of bzip2 compressed content (*.xml.bz2).
  */
-bool bz2_memory_is_bzip(const char* memory, const size_t size);
+extern const struct oscap_codec oscap_codec_bz2;
 
 OSCAP_HIDDEN_END;
 
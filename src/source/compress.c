@@ -0,0 +1,372 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libxml/parser.h>
+#include <libxml/xmlsave.h>
+
+#include "compress_priv.h"
+#include "bz2_priv.h"
+#include "xz_priv.h"
+#include "zstd_priv.h"
+#include "common/_error.h"
+#include "common/debug_priv.h"
+
+#define OSCAP_CODEC_CHUNK_SIZE 65536
+
+static const struct oscap_codec *codecs[] = {
+	&oscap_codec_bz2,
+	&oscap_codec_xz,
+	&oscap_codec_zstd,
+	NULL
+};
+
+const struct oscap_codec *oscap_codec_detect_memory(const char *memory, size_t size)
+{
+	for (const struct oscap_codec **codec = codecs; *codec != NULL; codec++) {
+		if (size >= (*codec)->magic_size && memcmp(memory, (*codec)->magic, (*codec)->magic_size) == 0)
+			return *codec;
+	}
+	return NULL;
+}
+
+const struct oscap_codec *oscap_codec_detect_fd(int fd)
+{
+	char header[8];
+	// pread does not move the file offset
+	ssize_t size = pread(fd, header, sizeof(header), 0);
+	if (size <= 0) {
+		return NULL; // cannot open/determine file type
+	}
+	return oscap_codec_detect_memory(header, size);
+}
+
+const struct oscap_codec *oscap_codec_from_filename(const char *filename)
+{
+	if (filename == NULL)
+		return NULL;
+	size_t len = strlen(filename);
+	for (const struct oscap_codec **codec = codecs; *codec != NULL; codec++) {
+		size_t suffix_len = strlen((*codec)->suffix);
+		if (len > suffix_len && strcmp(filename + len - suffix_len, (*codec)->suffix) == 0)
+			return *codec;
+	}
+	return NULL;
+}
+
+bool oscap_codec_is_supported(const struct oscap_codec *codec, const char *origin)
+{
+	if (codec->decode == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unable to process %s compressed '%s'. Please compile OpenSCAP with %s support.",
+				codec->name, origin, codec->name);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Decompressing input stream, the compressed data are either read from file
+ * descriptor in chunks or taken from memory buffer supplied by the caller.
+ */
+struct oscap_codec_istream {
+	const struct oscap_codec *codec;
+	void *decoder;
+	int fd;                                 ///< -1 when reading from memory
+	struct oscap_codec_buffer in;
+	bool input_eof;
+	bool stream_end;
+};
+
+static struct oscap_codec_istream *oscap_codec_istream_new(const struct oscap_codec *codec)
+{
+	void *decoder = codec->decoder_new();
+	if (decoder == NULL)
+		return NULL;
+	struct oscap_codec_istream *stream = calloc(1, sizeof(struct oscap_codec_istream));
+	stream->codec = codec;
+	stream->decoder = decoder;
+	stream->fd = -1;
+	return stream;
+}
+
+static struct oscap_codec_istream *oscap_codec_istream_fd_open(const struct oscap_codec *codec, int fd)
+{
+	// Keep our own descriptor, the caller may close theirs before the stream is done
+	int fd_dup = dup(fd);
+	if (fd_dup == -1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not duplicate file descriptor: %s", strerror(errno));
+		return NULL;
+	}
+	struct oscap_codec_istream *stream = oscap_codec_istream_new(codec);
+	if (stream == NULL) {
+		close(fd_dup);
+		return NULL;
+	}
+	lseek(fd_dup, 0, SEEK_SET);
+	stream->fd = fd_dup;
+	stream->in.data = malloc(OSCAP_CODEC_CHUNK_SIZE);
+	return stream;
+}
+
+static struct oscap_codec_istream *oscap_codec_istream_mem_open(const struct oscap_codec *codec, const char *buffer, size_t size)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_new(codec);
+	if (stream == NULL)
+		return NULL;
+	stream->in.data = (char *) buffer;
+	stream->in.size = size;
+	stream->input_eof = true;
+	return stream;
+}
+
+// xmlInputReadCallback
+static int oscap_codec_istream_read(void *context, char *buffer, int len)
+{
+	struct oscap_codec_istream *stream = context;
+	struct oscap_codec_buffer out = { buffer, len, 0 };
+
+	while (out.pos == 0 && !stream->stream_end && len > 0) {
+		if (stream->in.pos == stream->in.size && !stream->input_eof) {
+			ssize_t size = read(stream->fd, stream->in.data, OSCAP_CODEC_CHUNK_SIZE);
+			if (size < 0) {
+				if (errno == EINTR)
+					continue;
+				oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not read %s compressed file: %s",
+						stream->codec->name, strerror(errno));
+				return -1;
+			}
+			stream->in.size = size;
+			stream->in.pos = 0;
+			stream->input_eof = (size == 0);
+		}
+		size_t in_before = stream->in.pos;
+		oscap_codec_status_t status = stream->codec->decode(stream->decoder, &stream->in, &out);
+		if (status == OSCAP_CODEC_ERROR)
+			return -1;
+		if (status == OSCAP_CODEC_STREAM_END) {
+			stream->stream_end = true;
+		} else if (out.pos == 0 && stream->in.pos == in_before && stream->input_eof) {
+			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unexpected end of %s compressed data.", stream->codec->name);
+			return -1;
+		}
+	}
+	return out.pos;
+}
+
+// xmlInputCloseCallback
+static int oscap_codec_istream_close(void *context)
+{
+	struct oscap_codec_istream *stream = context;
+	stream->codec->decoder_free(stream->decoder);
+	if (stream->fd != -1) {
+		close(stream->fd);
+		free(stream->in.data);
+	}
+	free(stream);
+	return 0;
+}
+
+xmlDoc *oscap_codec_fd_read_doc(const struct oscap_codec *codec, int fd, const char *url)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_fd_open(codec, fd);
+	if (stream == NULL)
+		return NULL;
+	return xmlReadIO(oscap_codec_istream_read, oscap_codec_istream_close, stream, url, NULL, XML_PARSE_PEDANTIC);
+}
+
+xmlDoc *oscap_codec_mem_read_doc(const struct oscap_codec *codec, const char *buffer, size_t size, const char *url)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_mem_open(codec, buffer, size);
+	if (stream == NULL)
+		return NULL;
+	return xmlReadIO(oscap_codec_istream_read, oscap_codec_istream_close, stream, url, NULL, XML_PARSE_PEDANTIC);
+}
+
+xmlTextReader *oscap_codec_fd_get_reader(const struct oscap_codec *codec, int fd, const char *url)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_fd_open(codec, fd);
+	if (stream == NULL)
+		return NULL;
+	return xmlReaderForIO(oscap_codec_istream_read, oscap_codec_istream_close, stream, url, NULL, 0);
+}
+
+xmlTextReader *oscap_codec_mem_get_reader(const struct oscap_codec *codec, const char *buffer, size_t size, const char *url)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_mem_open(codec, buffer, size);
+	if (stream == NULL)
+		return NULL;
+	return xmlReaderForIO(oscap_codec_istream_read, oscap_codec_istream_close, stream, url, NULL, 0);
+}
+
+int oscap_codec_mem_decompress(const struct oscap_codec *codec, const char *buffer, size_t size, char **out_buffer, size_t *out_size)
+{
+	struct oscap_codec_istream *stream = oscap_codec_istream_mem_open(codec, buffer, size);
+	if (stream == NULL)
+		return -1;
+	size_t allocated = OSCAP_CODEC_CHUNK_SIZE;
+	size_t used = 0;
+	char *result = malloc(allocated);
+	int len = 0;
+	while (result != NULL && (len = oscap_codec_istream_read(stream, result + used, allocated - used)) > 0) {
+		used += len;
+		if (used == allocated) {
+			char *grown = realloc(result, allocated * 2);
+			if (grown == NULL)
+				free(result);
+			result = grown;
+			allocated *= 2;
+		}
+	}
+	oscap_codec_istream_close(stream);
+	if (result == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not allocate memory for %s decompressed data.", codec->name);
+		return -1;
+	}
+	if (len < 0) {
+		free(result);
+		return -1;
+	}
+	*out_buffer = result;
+	*out_size = used;
+	return 0;
+}
+
+/*
+ * Compressing output stream, libxml2 serializer pushes the document through
+ * the encoder which writes compressed chunks to the file descriptor.
+ */
+struct oscap_codec_ostream {
+	const struct oscap_codec *codec;
+	void *encoder;
+	int fd;
+	struct oscap_codec_buffer out;
+	bool failed;
+};
+
+static int oscap_codec_ostream_flush(struct oscap_codec_ostream *stream)
+{
+	size_t written = 0;
+	while (written < stream->out.pos) {
+		ssize_t ret = write(stream->fd, stream->out.data + written, stream->out.pos - written);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not write %s compressed file: %s",
+					stream->codec->name, strerror(errno));
+			return -1;
+		}
+		written += ret;
+	}
+	stream->out.pos = 0;
+	return 0;
+}
+
+static int oscap_codec_ostream_code(struct oscap_codec_ostream *stream, const char *buffer, size_t len, bool finish)
+{
+	struct oscap_codec_buffer in = { (char *) buffer, len, 0 };
+	for (;;) {
+		oscap_codec_status_t status = stream->codec->encode(stream->encoder, &in, &stream->out, finish);
+		if (status == OSCAP_CODEC_ERROR)
+			return -1;
+		if (stream->out.pos == stream->out.size || status == OSCAP_CODEC_STREAM_END) {
+			if (oscap_codec_ostream_flush(stream) != 0)
+				return -1;
+		}
+		if (status == OSCAP_CODEC_STREAM_END || (!finish && in.pos == in.size))
+			return 0;
+	}
+}
+
+// xmlOutputWriteCallback
+static int oscap_codec_ostream_write(void *context, const char *buffer, int len)
+{
+	struct oscap_codec_ostream *stream = context;
+	if (oscap_codec_ostream_code(stream, buffer, len, false) != 0) {
+		stream->failed = true;
+		return -1;
+	}
+	return len;
+}
+
+// xmlOutputCloseCallback
+static int oscap_codec_ostream_close(void *context)
+{
+	struct oscap_codec_ostream *stream = context;
+	if (!stream->failed && oscap_codec_ostream_code(stream, NULL, 0, true) != 0)
+		stream->failed = true;
+	stream->codec->encoder_free(stream->encoder);
+	free(stream->out.data);
+	int ret = stream->failed ? -1 : 0;
+	free(stream);
+	return ret;
+}
+
+int oscap_codec_save_doc(const struct oscap_codec *codec, const char *filename, xmlDoc *doc)
+{
+	if (codec->encode == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unable to compress '%s'. Please compile OpenSCAP with %s support.",
+				filename, codec->name);
+		return -1;
+	}
+	void *encoder = codec->encoder_new();
+	if (encoder == NULL)
+		return -1;
+	int fd = open(filename, O_CREAT|O_TRUNC|O_WRONLY,
+			S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP|S_IROTH|S_IWOTH);
+	if (fd < 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "%s '%s'", strerror(errno), filename);
+		codec->encoder_free(encoder);
+		return -1;
+	}
+	struct oscap_codec_ostream *stream = calloc(1, sizeof(struct oscap_codec_ostream));
+	stream->codec = codec;
+	stream->encoder = encoder;
+	stream->fd = fd;
+	stream->out.data = malloc(OSCAP_CODEC_CHUNK_SIZE);
+	stream->out.size = OSCAP_CODEC_CHUNK_SIZE;
+
+	xmlOutputBuffer *buff = xmlOutputBufferCreateIO(oscap_codec_ostream_write, oscap_codec_ostream_close, stream, NULL);
+	if (buff == NULL) {
+		oscap_codec_ostream_close(stream);
+		close(fd);
+		oscap_setxmlerr(xmlGetLastError());
+		dW("xmlOutputBufferCreateIO() failed.");
+		return -1;
+	}
+	// xmlSaveFormatFileTo closes the output buffer and thus flushes the encoder
+	int xmlCode = xmlSaveFormatFileTo(buff, doc, "UTF-8", 1);
+	if (close(fd) != 0 && xmlCode >= 1) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "%s '%s'", strerror(errno), filename);
+		return -1;
+	}
+	if (xmlCode <= 0) {
+		oscap_setxmlerr(xmlGetLastError());
+		dW("No bytes exported: xmlCode: %d.", xmlCode);
+	}
+	return (xmlCode >= 1) ? 1 : -1;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OSCAP_SOURCE_COMPRESS_H
+#define OSCAP_SOURCE_COMPRESS_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <libxml/tree.h>
+#include <libxml/xmlreader.h>
+
+#include "common/public/oscap.h"
+#include "common/util.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * In-memory window used to pass data in and out of a codec. The codec
+ * consumes bytes of the input buffer starting at pos and produces bytes
+ * into the output buffer starting at pos, advancing pos accordingly.
+ */
+struct oscap_codec_buffer {
+	char *data;                     ///< Start of the buffer
+	size_t size;                    ///< Size of the buffer
+	size_t pos;                     ///< Bytes already consumed (input) or produced (output)
+};
+
+typedef enum oscap_codec_status {
+	OSCAP_CODEC_ERROR = -1,         ///< Corrupted data or library failure
+	OSCAP_CODEC_OK = 0,             ///< Progress has been made, call again
+	OSCAP_CODEC_STREAM_END = 1,     ///< Whole stream has been decoded (or flushed when encoding)
+} oscap_codec_status_t;
+
+/**
+ * Description of a single compression format. Every format is always
+ * registered so that we can recognize it by its magic number. The coding
+ * callbacks are NULL when OpenSCAP has been compiled without the respective
+ * library.
+ */
+struct oscap_codec {
+	const char *name;               ///< Human readable name, used in error messages
+	const char *suffix;             ///< Filename suffix, including the dot
+	const char *magic;              ///< Magic number at the start of compressed data
+	size_t magic_size;              ///< Size of the magic number
+
+	void *(*decoder_new)(void);
+	oscap_codec_status_t (*decode)(void *decoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out);
+	void (*decoder_free)(void *decoder);
+
+	void *(*encoder_new)(void);
+	/* When finish is set the codec shall flush everything and return
+	 * OSCAP_CODEC_STREAM_END once the trailer has been written out. */
+	oscap_codec_status_t (*encode)(void *encoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out, bool finish);
+	void (*encoder_free)(void *encoder);
+};
+
+/**
+ * Recognize compressed data in memory.
+ * @param memory Raw memory with file content
+ * @param size Size of memory
+ * @returns codec of the data or NULL if data are not compressed
+ */
+const struct oscap_codec *oscap_codec_detect_memory(const char *memory, size_t size);
+
+/**
+ * Recognize compressed file. The file offset is not changed.
+ * @param fd file descriptor to opened file
+ * @returns codec of the file or NULL if the file is not compressed
+ */
+const struct oscap_codec *oscap_codec_detect_fd(int fd);
+
+/**
+ * Find codec by the suffix of given filename (e.g. arf.xml.bz2).
+ * @param filename path to the file
+ * @returns codec or NULL if the suffix is not known
+ */
+const struct oscap_codec *oscap_codec_from_filename(const char *filename);
+
+/**
+ * Check whether OpenSCAP has been compiled with support for the codec.
+ * Sets oscap error when the support is missing.
+ * @param codec codec to check
+ * @param origin human readable origin of the data, used in error message
+ * @returns true if data can be coded by this codec
+ */
+bool oscap_codec_is_supported(const struct oscap_codec *codec, const char *origin);
+
+/**
+ * Parse compressed file to XML DOM. The data are decompressed in chunks
+ * as libxml2 asks for them, the file is never held in memory as a whole.
+ * The file descriptor is not closed.
+ * @param codec codec of the file
+ * @param fd file descriptor to compressed file
+ * @param url base URL of the document (or NULL)
+ * @returns DOM representation of the file
+ */
+xmlDoc *oscap_codec_fd_read_doc(const struct oscap_codec *codec, int fd, const char *url);
+
+/**
+ * Parse compressed memory to XML DOM.
+ * @param codec codec of the data
+ * @param buffer data in memory to process
+ * @param size length of data
+ * @param url base URL of the document (or NULL)
+ * @returns DOM representation of the data
+ */
+xmlDoc *oscap_codec_mem_read_doc(const struct oscap_codec *codec, const char *buffer, size_t size, const char *url);
+
+/**
+ * Get streaming xmlTextReader over compressed file. The reader holds its own
+ * duplicate of the file descriptor, caller may close fd right away.
+ * @param codec codec of the file
+ * @param fd file descriptor to compressed file
+ * @param url base URL of the document (or NULL)
+ * @returns xmlTextReader to be disposed by caller
+ */
+xmlTextReader *oscap_codec_fd_get_reader(const struct oscap_codec *codec, int fd, const char *url);
+
+/**
+ * Get streaming xmlTextReader over compressed memory. The memory needs to
+ * outlive the reader.
+ * @param codec codec of the data
+ * @param buffer data in memory to process
+ * @param size length of data
+ * @param url base URL of the document (or NULL)
+ * @returns xmlTextReader to be disposed by caller
+ */
+xmlTextReader *oscap_codec_mem_get_reader(const struct oscap_codec *codec, const char *buffer, size_t size, const char *url);
+
+/**
+ * Decompress memory buffer into a newly allocated buffer.
+ * @param codec codec of the data
+ * @param buffer data in memory to process
+ * @param size length of data
+ * @param out_buffer newly allocated buffer with decompressed data
+ * @param out_size length of decompressed data
+ * @returns 0 on success
+ */
+int oscap_codec_mem_decompress(const struct oscap_codec *codec, const char *buffer, size_t size, char **out_buffer, size_t *out_size);
+
+/**
+ * Serialize XML DOM into a compressed file. The output is compressed as
+ * libxml2 writes it out.
+ * @param codec codec to use
+ * @param filename path to the output file
+ * @param doc DOM to serialize
+ * @returns 1 on success, -1 on failure (same as oscap_xml_save_filename)
+ */
+int oscap_codec_save_doc(const struct oscap_codec *codec, const char *filename, xmlDoc *doc);
+
+OSCAP_HIDDEN_END;
+
+#endif // OSCAP_SOURCE_COMPRESS_H
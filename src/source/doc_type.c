@@ -36,9 +36,9 @@ int oscap_determine_document_type_reader(xmlTextReader *reader, oscap_document_t
         const char* elm_name = NULL;
         *doc_type = 0;
 
-        /* find root element */
-        while (xmlTextReaderRead(reader) == 1
-               && xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+        /* find root element, unless the reader is already there */
+        while (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT
+               && xmlTextReaderRead(reader) == 1);
 
         /* identify document type */
         elm_name = (const char *) xmlTextReaderConstLocalName(reader);
@@ -34,7 +34,8 @@ OSCAP_HIDDEN_START;
 
 /**
  * Determines the SCAP type of the document xmlTextReder. This function is deemed
- * to be private forever, as it moves with the reader context.
+ * to be private forever, as it moves with the reader context. The reader may
+ * already be positioned at the root element.
  * @param reader xmlTextReader to determine document type
  * @param doc_type determined document type (output parameter)
  * @returns -1 on error, 0 otherwise
@@ -24,9 +24,12 @@
 #include <config.h>
 #endif
 
+#include <limits.h>
 #include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <libxml/parser.h>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlerror.h>
@@ -46,7 +49,7 @@
 #include "oscap_source_priv.h"
 #include "OVAL/oval_parser_impl.h"
 #include "OVAL/public/oval_definitions.h"
-#include "source/bz2_priv.h"
+#include "source/compress_priv.h"
 #include "source/schematron_priv.h"
 #include "source/validate_priv.h"
 #include "XCCDF/elements.h"
@@ -59,6 +62,18 @@ typedef enum oscap_source_type {
 	// TODO: downloaded from an http address (XCCDF can refer to remote sources)
 } oscap_source_type_t;
 
+/*
+ * Plain XML files are mapped to memory instead of being read. The mapping
+ * lives only while the file is being peeked at or parsed, it's never kept
+ * by the source nor shared with other sources. Writing the file later,
+ * e.g. by oscap_source_save_as(), can't pull pages from under a mapping
+ * still in use.
+ */
+struct oscap_source_map {
+	char *data;                                     ///< Content of the file
+	size_t size;                                    ///< Size of the file
+};
+
 struct oscap_source {
 	oscap_document_type_t scap_type;                ///< Type of SCAP document (XCCDF, OVAL, ...)
 	struct {
@@ -73,6 +88,47 @@ struct oscap_source {
 	} xml;
 };
 
+/*
+ * Map a plain file, release the mapping by oscap_source_unmap() as soon as
+ * it's not needed.
+ */
+static bool oscap_source_map(struct oscap_source *source, struct oscap_source_map *map)
+{
+	map->data = NULL;
+	map->size = 0;
+	if (source->origin.type != OSCAP_SRC_FROM_USER_XML_FILE)
+		return false;
+
+	int fd = open(source->origin.filepath, O_RDONLY);
+	if (fd == -1)
+		return false;
+
+	// Compressed files are left to the codecs, they never get mapped.
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 ||
+			(uintmax_t) st.st_size > INT_MAX || oscap_codec_detect_fd(fd) != NULL) {
+		close(fd);
+		return false;
+	}
+
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+
+	map->data = data;
+	map->size = st.st_size;
+	return true;
+}
+
+static void oscap_source_unmap(struct oscap_source_map *map)
+{
+	if (map->data != NULL)
+		munmap(map->data, map->size);
+	map->data = NULL;
+	map->size = 0;
+}
+
 struct oscap_source *oscap_source_new_from_file(const char *filepath)
 {
 	/* TODO: At the end of the day, this shall be the only place in
@@ -159,13 +215,61 @@ const char *oscap_source_readable_origin(const struct oscap_source *source)
 	return source->origin.filepath;
 }
 
+/*
+ * Get a streaming xmlTextReader over compressed content of the source, the
+ * content is decompressed as the reader advances and no DOM gets built.
+ * Sets compressed to false and returns NULL for content which is not
+ * compressed.
+ */
+static xmlTextReader *oscap_source_get_codec_reader(struct oscap_source *source, bool *compressed)
+{
+	const struct oscap_codec *codec;
+	xmlTextReader *reader = NULL;
+
+	*compressed = false;
+	if (source->origin.memory != NULL) {
+		codec = oscap_codec_detect_memory(source->origin.memory, source->origin.memory_size);
+		if (codec == NULL)
+			return NULL;
+		*compressed = true;
+		if (oscap_codec_is_supported(codec, oscap_source_readable_origin(source)))
+			reader = oscap_codec_mem_get_reader(codec, source->origin.memory, source->origin.memory_size, NULL);
+		return reader;
+	}
+	if (source->origin.filepath == NULL)
+		return NULL;
+	// Errors of opening the file are left for the DOM parser which reports them
+	int fd = open(source->origin.filepath, O_RDONLY);
+	if (fd == -1)
+		return NULL;
+	codec = oscap_codec_detect_fd(fd);
+	if (codec != NULL) {
+		*compressed = true;
+		if (oscap_codec_is_supported(codec, oscap_source_readable_origin(source)))
+			reader = oscap_codec_fd_get_reader(codec, fd, NULL);
+	}
+	close(fd);
+	return reader;
+}
+
 xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 {
+	xmlTextReader *reader;
+	if (source->xml.doc == NULL) {
+		bool compressed;
+		reader = oscap_source_get_codec_reader(source, &compressed);
+		if (compressed) {
+			if (reader == NULL && !oscap_err())
+				oscap_seterr(OSCAP_EFAMILY_XML, "Unable to create xmlTextReader for %s", oscap_source_readable_origin(source));
+			return reader;
+		}
+	}
+
 	xmlDoc *doc = oscap_source_get_xmlDoc(source);
 	if (doc == NULL) {
 		return NULL;
 	}
-	xmlTextReader *reader = xmlReaderWalker(doc);
+	reader = xmlReaderWalker(doc);
 	if (reader == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_XML, "Unable to create xmlTextReader for %s", oscap_source_readable_origin(source));
 		oscap_setxmlerr(xmlGetLastError());
@@ -173,9 +277,63 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source)
 	return reader;
 }
 
+/*
+ * Get a streaming xmlTextReader over raw content of a file or memory buffer.
+ * Unlike oscap_source_get_xmlTextReader, this does not build the DOM, so it
+ * is suitable for peeking at the beginning of the document. Errors are not
+ * reported, anything unusual is left for the DOM parser which reports it
+ * properly. Returns NULL when the content is not at hand in plain form.
+ * The file may be mapped to map, call oscap_source_unmap() on it once the
+ * reader is freed.
+ */
+static xmlTextReader *oscap_source_get_peek_reader(struct oscap_source *source, struct oscap_source_map *map)
+{
+	if (source->xml.doc != NULL)
+		return NULL;
+
+	if (source->origin.memory != NULL) {
+		if (source->origin.memory_size > INT_MAX ||
+				oscap_codec_detect_memory(source->origin.memory, source->origin.memory_size) != NULL)
+			return NULL;
+		return xmlReaderForMemory(source->origin.memory, source->origin.memory_size,
+				NULL, NULL, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	}
+	if (!oscap_source_map(source, map))
+		return NULL;
+
+	xmlTextReader *reader = xmlReaderForMemory(map->data, map->size, NULL, NULL, XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	if (reader == NULL)
+		oscap_source_unmap(map);
+	return reader;
+}
+
+/*
+ * Determine type of the document from its root element without building
+ * the DOM. The DOM may not be needed at all, e.g. data stream components can
+ * be read from the file directly using the index.
+ */
+static bool oscap_source_sniff_scap_type(struct oscap_source *source)
+{
+	struct oscap_source_map map = {NULL, 0};
+	xmlTextReader *reader = oscap_source_get_peek_reader(source, &map);
+	if (reader == NULL)
+		return false;
+
+	bool ret = false;
+	while (xmlTextReaderRead(reader) == 1) {
+		if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
+			ret = oscap_determine_document_type_reader(reader, &(source->scap_type)) == 0;
+			break;
+		}
+	}
+	xmlFreeTextReader(reader);
+	oscap_source_unmap(&map);
+	return ret;
+}
+
 oscap_document_type_t oscap_source_get_scap_type(struct oscap_source *source)
 {
-	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN) {
+	if (source->scap_type == OSCAP_DOCUMENT_UNKNOWN && !oscap_source_sniff_scap_type(source)) {
 		xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
 		if (reader == NULL) {
 			// the oscap error is already set
@@ -196,6 +354,16 @@ const char *oscap_source_get_filepath(struct oscap_source *source)
 	return source->origin.filepath;
 }
 
+const char *oscap_source_get_origin_file(const struct oscap_source *source)
+{
+	return source->origin.type == OSCAP_SRC_FROM_USER_XML_FILE ? source->origin.filepath : NULL;
+}
+
+bool oscap_source_has_xmlDoc(const struct oscap_source *source)
+{
+	return source->xml.doc != NULL;
+}
+
 static void xmlErrorCb(struct oscap_string *buffer, const char * format, ...)
 {
 	va_list ap;
@@ -253,14 +421,14 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 	struct oscap_string *xml_error_string = oscap_string_new();
 	xmlSetGenericErrorFunc(xml_error_string, (xmlGenericErrorFunc)xmlErrorCb);
 
+	struct oscap_source_map map;
 	if (source->xml.doc == NULL) {
 		if (source->origin.memory != NULL) {
-			if (bz2_memory_is_bzip(source->origin.memory, source->origin.memory_size)) {
-#ifdef HAVE_BZ2
-				source->xml.doc = bz2_mem_read_doc(source->origin.memory, source->origin.memory_size);
-#else
-				oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unable to unpack bz2 from buffer memory '%s'. Please compile OpenSCAP with bz2 support.", oscap_source_readable_origin(source));
-#endif
+			const struct oscap_codec *codec = oscap_codec_detect_memory(source->origin.memory, source->origin.memory_size);
+			if (codec != NULL) {
+				if (oscap_codec_is_supported(codec, oscap_source_readable_origin(source))) {
+					source->xml.doc = oscap_codec_mem_read_doc(codec, source->origin.memory, source->origin.memory_size, NULL);
+				}
 			} else
 			{
 				source->xml.doc = xmlReadMemory(source->origin.memory, source->origin.memory_size, NULL, NULL, 0);
@@ -277,19 +445,32 @@ xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source)
 				}
 			}
 		}
+		else if (oscap_source_map(source, &map)) {
+			source->xml.doc = xmlReadMemory(map.data, map.size, NULL, NULL, 0);
+			if (source->xml.doc == NULL) {
+				if (memory_file_is_executable(map.data, map.size)) {
+					dI("oscap-source file was detected as executable file. Skipped XML parsing", oscap_source_readable_origin(source));
+					oscap_string_clear(xml_error_string);
+				} else {
+					oscap_setxmlerr(xmlGetLastError());
+					const char *error_msg = oscap_string_get_cstr(xml_error_string);
+					oscap_seterr(OSCAP_EFAMILY_XML, "%sUnable to parse XML at: '%s'", error_msg, oscap_source_readable_origin(source));
+					oscap_string_clear(xml_error_string);
+				}
+			}
+			oscap_source_unmap(&map);
+		}
 		else {
 			int fd = open(source->origin.filepath, O_RDONLY);
 			if ( fd == -1 ){
 				source->xml.doc = NULL;
 				oscap_seterr(OSCAP_EFAMILY_GLIBC, "Unable to open file: '%s'", oscap_source_readable_origin(source));
 			} else {
-				if (bz2_fd_is_bzip(fd)) {
-#ifdef HAVE_BZ2
-					source->xml.doc = bz2_fd_read_doc(fd);
-#else
-					source->xml.doc = NULL;
-					oscap_seterr(OSCAP_EFAMILY_OSCAP, "Unable to unpack bz2 file '%s'. Please compile OpenSCAP with bz2 support.", oscap_source_readable_origin(source));
-#endif
+				const struct oscap_codec *codec = oscap_codec_detect_fd(fd);
+				if (codec != NULL) {
+					if (oscap_codec_is_supported(codec, oscap_source_readable_origin(source))) {
+						source->xml.doc = oscap_codec_fd_read_doc(codec, fd, NULL);
+					}
 				} else
 				{
 					source->xml.doc = xmlReadFd(fd, NULL, NULL, 0);
@@ -354,7 +535,11 @@ int oscap_source_validate_schematron(struct oscap_source *source, const char *ou
 const char *oscap_source_get_schema_version(struct oscap_source *source)
 {
 	if (source->origin.version == NULL) {
-		xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
+		// Version is given by the root element or by the generator right below it.
+		struct oscap_source_map map = {NULL, 0};
+		xmlTextReader *reader = oscap_source_get_peek_reader(source, &map);
+		if (reader == NULL)
+			reader = oscap_source_get_xmlTextReader(source);
 		if (reader == NULL) {
 			return NULL;
 		}
@@ -399,6 +584,7 @@ const char *oscap_source_get_schema_version(struct oscap_source *source)
 				break;
 		}
 		xmlFreeTextReader(reader);
+		oscap_source_unmap(&map);
 	}
 	return source->origin.version;
 }
@@ -412,12 +598,24 @@ int oscap_source_save_as(struct oscap_source *source, const char *filename)
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not save document to %s: DOM representation not available.", target);
 		return -1;
 	}
+	// Results may get large, compress them on the fly when asked to by the suffix
+	const struct oscap_codec *codec = oscap_codec_from_filename(target);
+	if (codec != NULL) {
+		return oscap_codec_save_doc(codec, target, doc) == 1 ? 0 : -1;
+	}
 	return oscap_xml_save_filename(target, doc) == 1 ? 0 : -1;
 }
 
 int oscap_source_get_raw_memory(struct oscap_source *source, char **buffer, size_t *size)
 {
 	if (source->origin.memory != NULL) {
+		const struct oscap_codec *codec = oscap_codec_detect_memory(source->origin.memory, source->origin.memory_size);
+		if (codec != NULL) {
+			if (!oscap_codec_is_supported(codec, oscap_source_readable_origin(source))) {
+				return 1;
+			}
+			return oscap_codec_mem_decompress(codec, source->origin.memory, source->origin.memory_size, buffer, size) == 0 ? 0 : 1;
+		}
 		char *ret = (char*)malloc(source->origin.memory_size);
 		memcpy(ret, source->origin.memory, source->origin.memory_size);
 		*buffer = ret;
@@ -61,7 +61,8 @@ struct oscap_source *oscap_source_new_from_xmlDoc(xmlDoc *doc, const char *filep
 
 /**
  * Get an xmlTextReader assigned with this resource. The reader needs to be
- * disposed by caller.
+ * disposed by caller. Compressed content which has not been parsed to DOM
+ * yet is decompressed as the reader advances.
  * @memberof oscap_source
  * @param source Resource to read the content
  * @returns xmlTextReader structure to read the content
@@ -77,6 +78,22 @@ xmlTextReader *oscap_source_get_xmlTextReader(struct oscap_source *source);
  */
 xmlDoc *oscap_source_get_xmlDoc(struct oscap_source *source);
 
+/**
+ * Get path to the local file this resource has been loaded from.
+ * @memberof oscap_source
+ * @param source Resource to query
+ * @returns path to the file or NULL if the resource was not loaded from file
+ */
+const char *oscap_source_get_origin_file(const struct oscap_source *source);
+
+/**
+ * Find out whether DOM representation of this resource has already been built.
+ * @memberof oscap_source
+ * @param source Resource to query
+ * @returns true if oscap_source_get_xmlDoc would not need to parse the content
+ */
+bool oscap_source_has_xmlDoc(const struct oscap_source *source);
+
 OSCAP_HIDDEN_END;
 
 #endif
@@ -149,6 +149,8 @@ const char *oscap_source_readable_origin(const struct oscap_source *source);
 
 /**
  * Store the resource represented by oscap_source to the file.
+ * When the filename ends with .bz2, .xz or .zst the output is compressed
+ * by the respective format as it is written.
  * @memberof oscap_source
  * @param source The oscap_source to save
  * @param filename The filename or NULL, the previously supplied name will
@@ -161,6 +163,7 @@ int oscap_source_save_as(struct oscap_source *source, const char *filename);
  * Retrieve contents refered to by oscap_source as raw memory.
  * The memory is always copied. If the origin of oscap_source is raw memory,
  * this function will simply duplicate it and the operation is relatively cheap.
+ * Compressed raw memory is decompressed.
  * If however the origin is xmlDoc or an XML file this function has to serialize
  * it and then copy the results to given buffer. Keep in mind that this may be
  * performance intensive.
@@ -28,10 +28,13 @@
 #include <libxslt/transform.h>
 #include <libxslt/xsltutils.h>
 #include <libexslt/exslt.h>
+#include <pthread.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include "common/_error.h"
+#include "common/list.h"
 #include "common/util.h"
 #include "oscap.h"
 #include "oscap_source.h"
@@ -75,6 +78,145 @@ static int xccdf_ns_xslt_workaround(xmlDocPtr doc, xmlNodePtr node)
 	return 0;
 }
 
+/*
+ * Compiled stylesheets are kept for the lifetime of the library (until
+ * oscap_cleanup) and shared by all transformations. Our stylesheets are
+ * large and their compilation used to be paid on every report and guide
+ * generation. An entry is recompiled when any file it has been compiled
+ * from changes, be it the stylesheet itself or a file it imports or includes.
+ * The cache and every transformation using an entry hold a reference to it,
+ * so a recompiled or freed entry stays alive until the last user is done.
+ *
+ * TODO: Reports are still rendered by xccdf-report.xsl from the whole DOM of
+ * results. A native renderer streaming HTML while results are read would
+ * avoid the DOM, but it has to produce everything the stylesheet does.
+ */
+struct xslt_cache_file {
+	char *path;
+	time_t mtime;
+	off_t size;
+};
+
+struct xslt_cache_entry {
+	xsltStylesheet *stylesheet;
+	struct oscap_list *files;	///< xslt_cache_file for every document of the stylesheet
+	unsigned int refcount;
+};
+
+static struct oscap_htable *xslt_cache = NULL;
+static pthread_mutex_t xslt_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void xslt_cache_file_free(struct xslt_cache_file *file)
+{
+	if (file != NULL) {
+		free(file->path);
+		free(file);
+	}
+}
+
+static void xslt_cache_add_file(struct oscap_list *files, xmlDoc *doc)
+{
+	if (doc == NULL || doc->URL == NULL)
+		return;
+	struct xslt_cache_file *file = calloc(1, sizeof(struct xslt_cache_file));
+	file->path = oscap_strdup((const char *) doc->URL);
+	struct stat st;
+	// A file we can't stat makes the entry look changed every time.
+	if (stat(file->path, &st) == 0) {
+		file->mtime = st.st_mtime;
+		file->size = st.st_size;
+	} else {
+		file->size = -1;
+	}
+	oscap_list_add(files, file);
+}
+
+/* Record documents of the stylesheet, its includes and (recursively) its imports */
+static void xslt_cache_add_stylesheet_files(struct oscap_list *files, xsltStylesheet *stylesheet)
+{
+	for (; stylesheet != NULL; stylesheet = stylesheet->next) {
+		xslt_cache_add_file(files, stylesheet->doc);
+		for (xsltDocument *included = stylesheet->docList; included != NULL; included = included->next)
+			xslt_cache_add_file(files, included->doc);
+		xslt_cache_add_stylesheet_files(files, stylesheet->imports);
+	}
+}
+
+static bool xslt_cache_entry_changed(struct xslt_cache_entry *entry)
+{
+	bool changed = false;
+	struct oscap_iterator *it = oscap_iterator_new(entry->files);
+	while (!changed && oscap_iterator_has_more(it)) {
+		struct xslt_cache_file *file = oscap_iterator_next(it);
+		struct stat st;
+		changed = stat(file->path, &st) != 0 || file->mtime != st.st_mtime || file->size != st.st_size;
+	}
+	oscap_iterator_free(it);
+	return changed;
+}
+
+/* Drop a reference, xslt_cache_mutex has to be held */
+static void xslt_cache_entry_unref_locked(void *ptr)
+{
+	struct xslt_cache_entry *entry = ptr;
+	if (entry != NULL && --entry->refcount == 0) {
+		xsltFreeStylesheet(entry->stylesheet);
+		oscap_list_free(entry->files, (oscap_destruct_func) xslt_cache_file_free);
+		free(entry);
+	}
+}
+
+static void xslt_cache_entry_unref(struct xslt_cache_entry *entry)
+{
+	pthread_mutex_lock(&xslt_cache_mutex);
+	xslt_cache_entry_unref_locked(entry);
+	pthread_mutex_unlock(&xslt_cache_mutex);
+}
+
+/* Get a referenced entry with compiled stylesheet, release it by xslt_cache_entry_unref */
+static struct xslt_cache_entry *xslt_cache_get(const char *xsltpath)
+{
+	struct stat st;
+	if (stat(xsltpath, &st) != 0) {
+		oscap_seterr(OSCAP_EFAMILY_GLIBC, "Could not stat XSLT file '%s'", xsltpath);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&xslt_cache_mutex);
+	if (xslt_cache == NULL)
+		xslt_cache = oscap_htable_new();
+
+	struct xslt_cache_entry *entry = oscap_htable_get(xslt_cache, xsltpath);
+	if (entry != NULL && xslt_cache_entry_changed(entry)) {
+		oscap_htable_detach(xslt_cache, xsltpath);
+		xslt_cache_entry_unref_locked(entry);
+		entry = NULL;
+	}
+	if (entry == NULL) {
+		xsltStylesheet *stylesheet = xsltParseStylesheetFile(BAD_CAST xsltpath);
+		if (stylesheet != NULL) {
+			entry = calloc(1, sizeof(struct xslt_cache_entry));
+			entry->stylesheet = stylesheet;
+			entry->files = oscap_list_new();
+			xslt_cache_add_stylesheet_files(entry->files, stylesheet);
+			entry->refcount = 1;
+			oscap_htable_add(xslt_cache, xsltpath, entry);
+		}
+	}
+	if (entry != NULL)
+		entry->refcount++;
+	pthread_mutex_unlock(&xslt_cache_mutex);
+	return entry;
+}
+
+void oscap_xslt_cache_free(void)
+{
+	pthread_mutex_lock(&xslt_cache_mutex);
+	oscap_htable_free(xslt_cache, xslt_cache_entry_unref_locked);
+	xslt_cache = NULL;
+	pthread_mutex_unlock(&xslt_cache_mutex);
+}
+
 static inline int save_stylesheet_result_to_file(xmlDoc *resulting_doc, xsltStylesheet *stylesheet, const char *outfile)
 {
 	FILE *f = NULL;
@@ -97,10 +239,10 @@ static inline int save_stylesheet_result_to_file(xmlDoc *resulting_doc, xsltStyl
 	return ret;
 }
 
-static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt, xsltStylesheet **stylesheet)
+static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt, struct xslt_cache_entry **cached)
 {
 	xmlDoc *doc = oscap_source_get_xmlDoc(source);
-	if (doc == NULL || stylesheet == NULL) {
+	if (doc == NULL || cached == NULL) {
 		return NULL;
 	}
 
@@ -141,8 +283,8 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 			ns_workaround = true;
 	}
 
-	*stylesheet = xsltParseStylesheetFile(BAD_CAST xsltpath);
-	if (*stylesheet == NULL) {
+	*cached = xslt_cache_get(xsltpath);
+	if (*cached == NULL) {
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not parse XSLT file '%s'", xsltpath);
 		free(xsltpath);
 		return NULL;
@@ -153,8 +295,8 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 			oscap_seterr(OSCAP_EFAMILY_OSCAP, "Had problems employing XCCDF XSLT namespace workaround for XML document '%s'",
 				oscap_source_readable_origin(source));
 			free(xsltpath);
-			xsltFreeStylesheet(*stylesheet);
-			*stylesheet = NULL;
+			xslt_cache_entry_unref(*cached);
+			*cached = NULL;
 			return NULL;
 		}
 	}
@@ -164,7 +306,7 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 		if (params[i+1]) args[i+1] = oscap_sprintf("'%s'", params[i+1]);
 	}
 
-	xmlDoc *transformed = xsltApplyStylesheet(*stylesheet, doc, (const char **) args);
+	xmlDoc *transformed = xsltApplyStylesheet((*cached)->stylesheet, doc, (const char **) args);
 	for (size_t i = 0; args[i]; i += 2) {
 		free(args[i+1]);
 	}
@@ -172,8 +314,8 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not apply XSLT %s to XML file: %s", xsltpath,
 			oscap_source_readable_origin(source));
 		free(xsltpath);
-		xsltFreeStylesheet(*stylesheet);
-		*stylesheet = NULL;
+		xslt_cache_entry_unref(*cached);
+		*cached = NULL;
 		return NULL;
 	}
 	free(xsltpath);
@@ -183,31 +325,33 @@ static xmlDoc *apply_xslt_path_internal(struct oscap_source *source, const char
 
 int oscap_source_apply_xslt_path(struct oscap_source *source, const char *xsltfile, const char *outfile, const char **params, const char *path_to_xslt)
 {
-	xsltStylesheet *stylesheet = NULL;
-	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &stylesheet);
+	struct xslt_cache_entry *cached = NULL;
+	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &cached);
 	if (transformed == NULL) {
 		return -1;
 	}
-	int ret = save_stylesheet_result_to_file(transformed, stylesheet, outfile);
-	xsltFreeStylesheet(stylesheet);
+	int ret = save_stylesheet_result_to_file(transformed, cached->stylesheet, outfile);
 	xmlFreeDoc(transformed);
+	xslt_cache_entry_unref(cached);
 	return ret;
 }
 
 char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt)
 {
-	xsltStylesheet *stylesheet = NULL;
-	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &stylesheet);
+	struct xslt_cache_entry *cached = NULL;
+	xmlDocPtr transformed = apply_xslt_path_internal(source, xsltfile, params, path_to_xslt, &cached);
 	if (transformed == NULL) {
 		return NULL;
 	}
 	xmlChar *result = NULL;
 	int len;
-	if (xsltSaveResultToString(&result, &len, transformed, stylesheet) != 0) {
+	if (xsltSaveResultToString(&result, &len, transformed, cached->stylesheet) != 0) {
 		oscap_seterr(OSCAP_EFAMILY_XML, "Could not save transformend content to buffer, after applying XSLT %s",
 				xsltfile);
 		free(result);
 		result = NULL;
 	}
+	xmlFreeDoc(transformed);
+	xslt_cache_entry_unref(cached);
 	return (char *)result;
 }
@@ -56,5 +56,11 @@ int oscap_source_apply_xslt_path(struct oscap_source *source, const char *xsltfi
  */
 char *oscap_source_apply_xslt_path_mem(struct oscap_source *source, const char *xsltfile, const char **params, const char *path_to_xslt);
 
+/**
+ * Dispose all compiled stylesheets kept by the XSLT cache. Stylesheets are
+ * compiled once and reused by subsequent transformations until this is called.
+ */
+void oscap_xslt_cache_free(void);
+
 OSCAP_HIDDEN_END;
 #endif
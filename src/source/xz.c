@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "xz_priv.h"
+#include "common/_error.h"
+
+#ifdef HAVE_LZMA
+
+#include <lzma.h>
+
+static void *xz_decoder_new(void)
+{
+	lzma_stream *stream = malloc(sizeof(lzma_stream));
+	*stream = (lzma_stream) LZMA_STREAM_INIT;
+	lzma_ret ret = lzma_stream_decoder(stream, UINT64_MAX, 0);
+	if (ret != LZMA_OK) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build lzma_stream: lzma_stream_decoder returns %d", ret);
+		free(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+static oscap_codec_status_t xz_code(lzma_stream *stream, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out, lzma_action action)
+{
+	stream->next_in = (const uint8_t *) in->data + in->pos;
+	stream->avail_in = in->size - in->pos;
+	stream->next_out = (uint8_t *) out->data + out->pos;
+	stream->avail_out = out->size - out->pos;
+	lzma_ret ret = lzma_code(stream, action);
+	in->pos = in->size - stream->avail_in;
+	out->pos = out->size - stream->avail_out;
+	switch (ret) {
+	case LZMA_OK:
+		return OSCAP_CODEC_OK;
+	case LZMA_STREAM_END:
+		return OSCAP_CODEC_STREAM_END;
+	case LZMA_BUF_ERROR:
+		// No progress was possible, caller is going to supply more data
+		return OSCAP_CODEC_OK;
+	default:
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not process lzma_stream: lzma_code returns %d", ret);
+		return OSCAP_CODEC_ERROR;
+	}
+}
+
+static oscap_codec_status_t xz_decode(void *decoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out)
+{
+	return xz_code(decoder, in, out, LZMA_RUN);
+}
+
+static void xz_stream_free(void *stream)
+{
+	lzma_end((lzma_stream *) stream);
+	free(stream);
+}
+
+static void *xz_encoder_new(void)
+{
+	lzma_stream *stream = malloc(sizeof(lzma_stream));
+	*stream = (lzma_stream) LZMA_STREAM_INIT;
+	lzma_ret ret = lzma_easy_encoder(stream, LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64);
+	if (ret != LZMA_OK) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build lzma_stream: lzma_easy_encoder returns %d", ret);
+		free(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+static oscap_codec_status_t xz_encode(void *encoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out, bool finish)
+{
+	return xz_code(encoder, in, out, finish ? LZMA_FINISH : LZMA_RUN);
+}
+
+#endif
+
+const struct oscap_codec oscap_codec_xz = {
+	.name = "xz",
+	.suffix = ".xz",
+	.magic = "\xFD" "7zXZ\0",
+	.magic_size = 6,
+#ifdef HAVE_LZMA
+	.decoder_new = xz_decoder_new,
+	.decode = xz_decode,
+	.decoder_free = xz_stream_free,
+	.encoder_new = xz_encoder_new,
+	.encode = xz_encode,
+	.encoder_free = xz_stream_free,
+#endif
+};
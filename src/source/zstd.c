@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include "zstd_priv.h"
+#include "common/_error.h"
+
+#ifdef HAVE_ZSTD
+
+#include <zstd.h>
+
+static void *zstd_decoder_new(void)
+{
+	ZSTD_DStream *stream = ZSTD_createDStream();
+	if (stream == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build ZSTD_DStream.");
+		return NULL;
+	}
+	size_t ret = ZSTD_initDStream(stream);
+	if (ZSTD_isError(ret)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not initialize ZSTD_DStream: %s", ZSTD_getErrorName(ret));
+		ZSTD_freeDStream(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+static oscap_codec_status_t zstd_decode(void *decoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out)
+{
+	ZSTD_inBuffer input = { in->data, in->size, in->pos };
+	ZSTD_outBuffer output = { out->data, out->size, out->pos };
+	size_t ret = ZSTD_decompressStream(decoder, &output, &input);
+	in->pos = input.pos;
+	out->pos = output.pos;
+	if (ZSTD_isError(ret)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not read from ZSTD_DStream: %s", ZSTD_getErrorName(ret));
+		return OSCAP_CODEC_ERROR;
+	}
+	// Zero is returned when a frame is completely decoded and fully flushed
+	return ret == 0 ? OSCAP_CODEC_STREAM_END : OSCAP_CODEC_OK;
+}
+
+static void zstd_decoder_free(void *decoder)
+{
+	ZSTD_freeDStream(decoder);
+}
+
+static void *zstd_encoder_new(void)
+{
+	ZSTD_CStream *stream = ZSTD_createCStream();
+	if (stream == NULL) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not build ZSTD_CStream.");
+		return NULL;
+	}
+	size_t ret = ZSTD_initCStream(stream, ZSTD_CLEVEL_DEFAULT);
+	if (ZSTD_isError(ret)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not initialize ZSTD_CStream: %s", ZSTD_getErrorName(ret));
+		ZSTD_freeCStream(stream);
+		return NULL;
+	}
+	return stream;
+}
+
+static oscap_codec_status_t zstd_encode(void *encoder, struct oscap_codec_buffer *in, struct oscap_codec_buffer *out, bool finish)
+{
+	ZSTD_inBuffer input = { in->data, in->size, in->pos };
+	ZSTD_outBuffer output = { out->data, out->size, out->pos };
+	size_t ret = ZSTD_compressStream2(encoder, &output, &input, finish ? ZSTD_e_end : ZSTD_e_continue);
+	in->pos = input.pos;
+	out->pos = output.pos;
+	if (ZSTD_isError(ret)) {
+		oscap_seterr(OSCAP_EFAMILY_OSCAP, "Could not write to ZSTD_CStream: %s", ZSTD_getErrorName(ret));
+		return OSCAP_CODEC_ERROR;
+	}
+	return (finish && ret == 0) ? OSCAP_CODEC_STREAM_END : OSCAP_CODEC_OK;
+}
+
+static void zstd_encoder_free(void *encoder)
+{
+	ZSTD_freeCStream(encoder);
+}
+
+#endif
+
+const struct oscap_codec oscap_codec_zstd = {
+	.name = "zstd",
+	.suffix = ".zst",
+	.magic = "\x28\xB5\x2F\xFD",
+	.magic_size = 4,
+#ifdef HAVE_ZSTD
+	.decoder_new = zstd_decoder_new,
+	.decode = zstd_decode,
+	.decoder_free = zstd_decoder_free,
+	.encoder_new = zstd_encoder_new,
+	.encode = zstd_encode,
+	.encoder_free = zstd_encoder_free,
+#endif
+};
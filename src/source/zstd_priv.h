@@ -0,0 +1,39 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OSCAP_SOURCE_ZSTD_H
+#define OSCAP_SOURCE_ZSTD_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "common/util.h"
+#include "source/compress_priv.h"
+
+OSCAP_HIDDEN_START;
+
+/**
+ * Codec of zstd compressed content (*.xml.zst).
+ */
+extern const struct oscap_codec oscap_codec_zstd;
+
+OSCAP_HIDDEN_END;
+
+#endif // OSCAP_SOURCE_ZSTD_H
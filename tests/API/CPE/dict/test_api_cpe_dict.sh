@@ -45,6 +45,18 @@ function test_api_cpe_dict_match_existing_cpe {
     return 0 
 }
 
+function test_api_cpe_dict_match_existing_cpe_ignore_case {
+    require "grep" || return 255
+    CPE_URIS=(`grep "cpe:" $srcdir/dict.xml | \
+               sed 's/^.*cpe:/cpe:/g' | sed 's/".*$//g' | \
+               sed 's/^\(cpe:\/.:\)\(.*\)$/\1\U\2/' | tr '\n' ' '`)
+    for URI in ${CPE_URIS[@]}; do
+	./test_api_cpe_dict --match $srcdir/dict.xml "UTF-8" "$URI"
+	[ ! $? -eq 0 ] && return 1
+    done
+    return 0
+}
+
 function test_api_cpe_dict_export_xml {
     ./test_api_cpe_dict --export $srcdir/dict.xml "UTF-8" \
 	dict.xml.out "UTF-8" && \
@@ -126,6 +138,8 @@ if [ -z ${CUSTOM_OSCAP+x} ] ; then
         test_api_cpe_dict_match_non_existing_cpe   
     test_run "test_api_cpe_dict_match_existing_cpe" \
         test_api_cpe_dict_match_existing_cpe
+    test_run "test_api_cpe_dict_match_existing_cpe_ignore_case" \
+        test_api_cpe_dict_match_existing_cpe_ignore_case
     test_run "test_api_cpe_dict_export_xml"  test_api_cpe_dict_export_xml
     #test_run "test_api_cpe_dict_import_cp1250_xml" \
     #    test_api_cpe_dict_import_cp1250_xml   
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "OVAL/adt/oval_string_pool_impl.h"
+
+#include <../../../assume.h>
+
+/* Size of the blocks and of the initial hash table of the pool */
+#define BLOCK_SIZE (64 * 1024)
+#define INITIAL_SLOTS 256
+
+/* The same FNV-1a hash as the pool uses */
+static uint32_t _hash(const char *str)
+{
+	uint32_t hash = 2166136261u;
+	for (; *str != '\0'; str++) {
+		hash ^= (unsigned char) *str;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void test_identity(void)
+{
+	struct oval_string_pool *pool = oval_string_pool_new();
+	char buf[16];
+
+	assume(oval_string_pool_intern(pool, NULL) == NULL);
+
+	const char *a = oval_string_pool_intern(pool, "owner");
+	/* A different buffer with the same content yields the same pointer */
+	strcpy(buf, "owner");
+	assume(oval_string_pool_intern(pool, buf) == a);
+	assume(a != buf && strcmp(a, "owner") == 0);
+
+	const char *b = oval_string_pool_intern(pool, "group");
+	assume(b != a && strcmp(b, "group") == 0);
+	const char *empty = oval_string_pool_intern(pool, "");
+	assume(empty != NULL && *empty == '\0' && empty != a && empty != b);
+	assume(oval_string_pool_intern(pool, "") == empty);
+	assume(oval_string_pool_get_count(pool) == 3);
+
+	oval_string_pool_free(pool);
+	printf("identity: PASS\n");
+}
+
+static void test_collisions(void)
+{
+	struct oval_string_pool *pool = oval_string_pool_new();
+	char first[32], second[32];
+
+	/* Find two strings which fall into the same slot of the initial table */
+	snprintf(first, sizeof first, "entity_0");
+	const uint32_t slot = _hash(first) & (INITIAL_SLOTS - 1);
+	for (int i = 1; ; i++) {
+		snprintf(second, sizeof second, "entity_%d", i);
+		if ((_hash(second) & (INITIAL_SLOTS - 1)) == slot)
+			break;
+	}
+
+	const char *a = oval_string_pool_intern(pool, first);
+	const char *b = oval_string_pool_intern(pool, second);
+	assume(a != b);
+	assume(strcmp(a, first) == 0 && strcmp(b, second) == 0);
+	assume(oval_string_pool_intern(pool, first) == a);
+	assume(oval_string_pool_intern(pool, second) == b);
+	assume(oval_string_pool_get_count(pool) == 2);
+
+	oval_string_pool_free(pool);
+	printf("collisions: PASS\n");
+}
+
+static void test_growth(void)
+{
+	struct oval_string_pool *pool = oval_string_pool_new();
+	/* Many more strings than slots of the initial table, filling several blocks */
+	const size_t count = 4 * BLOCK_SIZE / 64;
+	const char **interned = malloc(count * sizeof(const char *));
+	char buf[128];
+
+	for (size_t i = 0; i < count; i++) {
+		snprintf(buf, sizeof buf, "%06zu-%s", i, "0123456789abcdef0123456789abcdef0123456789abcdef0123456");
+		interned[i] = oval_string_pool_intern(pool, buf);
+		assume(interned[i] != NULL);
+	}
+	/* A string longer than a block and one long enough to get its own block */
+	char *huge = malloc(BLOCK_SIZE + 100);
+	memset(huge, 'x', BLOCK_SIZE + 99);
+	huge[BLOCK_SIZE + 99] = '\0';
+	const char *huge_interned = oval_string_pool_intern(pool, huge);
+	char *large = malloc(BLOCK_SIZE / 2);
+	memset(large, 'y', BLOCK_SIZE / 2 - 1);
+	large[BLOCK_SIZE / 2 - 1] = '\0';
+	const char *large_interned = oval_string_pool_intern(pool, large);
+	const char *after = oval_string_pool_intern(pool, "after the long strings");
+	assume(oval_string_pool_get_count(pool) == count + 3);
+
+	/* Nothing moved nor got overwritten while the table and the blocks grew */
+	for (size_t i = 0; i < count; i++) {
+		snprintf(buf, sizeof buf, "%06zu-%s", i, "0123456789abcdef0123456789abcdef0123456789abcdef0123456");
+		assume(strcmp(interned[i], buf) == 0);
+		assume(oval_string_pool_intern(pool, buf) == interned[i]);
+	}
+	assume(strcmp(huge_interned, huge) == 0);
+	assume(oval_string_pool_intern(pool, huge) == huge_interned);
+	assume(strcmp(large_interned, large) == 0);
+	assume(oval_string_pool_intern(pool, large) == large_interned);
+	assume(strcmp(after, "after the long strings") == 0);
+	assume(oval_string_pool_get_count(pool) == count + 3);
+
+	free(large);
+	free(huge);
+	free(interned);
+	oval_string_pool_free(pool);
+	printf("growth: PASS\n");
+}
+
+int main(int argc, char *argv[])
+{
+	test_identity();
+	test_collisions();
+	test_growth();
+	return 0;
+}
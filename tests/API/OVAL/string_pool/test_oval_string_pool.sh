@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+# Copyright 2018 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Test Suite
+
+. ../../../test_common.sh
+
+# Test cases.
+
+function test_oval_string_pool {
+    ./test_oval_string_pool
+}
+
+# Testing.
+
+test_init "test_oval_string_pool.log"
+
+if [ -z ${CUSTOM_OSCAP+x} ] ; then
+    test_run "test_oval_string_pool" test_oval_string_pool
+fi
+
+test_exit
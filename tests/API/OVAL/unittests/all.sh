@@ -34,4 +34,5 @@ test_run "test platform schema version" $srcdir/test_platform_version.sh
 test_run "state entity check_existence attribute" $srcdir/test_state_check_existence.sh
 test_run "skip validation" $srcdir/test_skip_valid.sh
 test_run "object component data type evaluation" $srcdir/test_object_component_type.sh
+test_run "compiled state entities comparison" $srcdir/test_state_program.sh
 test_exit
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Platforms shared by several items are evaluated only once per scan
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+result=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+echo "Stderr file = $stderr"
+echo "Result file = $result"
+
+$OSCAP xccdf eval --verbose INFO --results $result $srcdir/${name}.xccdf.xml 2> $stderr
+
+[ $(grep -c "Platform '#platform1' is applicable" $stderr) -eq 1 ]
+[ $(grep -c "Platform '#platform2' is not applicable" $stderr) -eq 1 ]
+
+for n in 1 2 5; do
+	assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_'$n'"]/result[text()="pass"]'
+done
+for n in 3 4 6; do
+	assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_'$n'"]/result[text()="notapplicable"]'
+done
+assert_exists 1 '//TestResult/platform'
+assert_exists 1 '//TestResult/platform[@idref="#platform1"]'
+
+rm $result $stderr
@@ -14,6 +14,8 @@ if [ -z ${CUSTOM_OSCAP+x} ] ; then
     test_run "Certain id's of xccdf_items may overlap" ./test_xccdf_shall_pass $srcdir/test_xccdf_overlaping_IDs.xccdf.xml
     test_run "Test Abstract data types." ./test_oscap_common
     test_run "xccdf_rule_result_override" $srcdir/test_xccdf_overrides.sh
+    test_run "Evaluation plan follows selection and engines" $srcdir/test_xccdf_policy_plan.sh
+    test_run "xccdf_session_evaluate_targets" $srcdir/test_xccdf_session_targets.sh
 
     test_run "Assert for environment" [ ! -x $srcdir/not_executable ]
     test_run "Assert for environment better" $OSCAP oval eval --id oval:moc.elpmaxe.www:def:1 $srcdir/test_xccdf_check_content_ref_without_name_attr.oval.xml
@@ -52,6 +54,7 @@ test_run "Deriving XCCDF Check Results from OVAL Definition Results 2" $srcdir/t
 test_run "Deriving XCCDF Check Results from OVAL without definition." $srcdir/test_oval_without_definition.sh
 test_run "Deriving XCCDF Check Results from OVAL Definition Results + multi-check" $srcdir/test_deriving_xccdf_result_from_oval_multicheck.sh
 test_run "Multiple oval files with the same basename." $srcdir/test_multiple_oval_files_with_same_basename.sh
+test_run "Objects shared by multiple oval files are collected once." $srcdir/test_oval_collection_cache.sh
 test_run "Unsupported Check System" $srcdir/test_xccdf_check_unsupported_check_system.sh
 test_run "Multiple xccdf:TestResult elements" $srcdir/test_xccdf_multiple_testresults.sh
 test_run "default selector for xccdf value" $srcdir/test_default_selector.sh
@@ -61,6 +64,7 @@ test_run "test xccdf resolve" $srcdir/test_xccdf_resolve.sh
 test_run "Exported arf results from xccdf without reference to oval" $srcdir/test_xccdf_results_arf_no_oval.sh
 test_run "XCCDF Substitute within Title" $srcdir/test_xccdf_sub_title.sh
 test_run "TestResult element should contain test-system attribute" $srcdir/test_xccdf_test_system.sh
+test_run "TestResult streamed during evaluation" $srcdir/test_xccdf_results_stream.sh
 test_run "Profile suffix matching" $srcdir/test_profile_selection_by_suffix.sh
 
 test_run "libxml errors handled correctly" $srcdir/test_unfinished.sh
@@ -72,6 +76,7 @@ test_run "Test STIG viewer output for single-rule evaluation" $srcdir/test_singl
 # Tests for 'oscap xccdf eval --remediate' and substitution
 #
 test_run "XCCDF Remediation Simple Test" $srcdir/test_remediation_simple.sh
+test_run "XCCDF Remediation Independent Fixes in Parallel" $srcdir/test_remediation_parallel.sh
 test_run "XCCDF Remediation Contains Metadata Test" $srcdir/test_remediation_metadata.sh
 test_run "XCCDF Remediation Bad Fix Fails to Remedy" $srcdir/test_remediation_bad_fix.sh
 test_run "XCCDF Remediation Substitute Simple plain-text" $srcdir/test_remediation_subs_plain_text.sh
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Objects defined in several OVAL files are collected only once per XCCDF session
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+tmpdir=$(mktemp -d -t ${name}.out.XXXXXX)
+result=$(mktemp -t ${name}.out.XXXXXX)
+stdout=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+target=$tmpdir/setting.conf
+
+cp $srcdir/${name}.xccdf.xml $tmpdir/
+for oval in first second; do
+	sed "s|@FILE@|$target|" $srcdir/${name}.${oval}.oval.xml > $tmpdir/${oval}.oval.xml
+done
+
+echo "enabled=yes" > $target
+ret=0
+$OSCAP xccdf eval --verbose INFO --results-arf $result $tmpdir/${name}.xccdf.xml > $stdout 2> $stderr || ret=$?
+[ $ret -eq 2 ]
+
+echo "Stdout file = $stdout"
+echo "Result file = $result"
+
+# The second file reuses the textfilecontent54 object and the system info collected for the first one
+[ $(grep -c "Object collected by another session, probe .*/probe_textfilecontent54 not queried" $stderr) -eq 1 ]
+[ $(grep -c "Object collected by another session, probe .*/probe_system_info not queried" $stderr) -eq 1 ]
+
+assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_1"]/result[text()="pass"]'
+assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_2"]/result[text()="pass"]'
+assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_3"]/result[text()="fail"]'
+
+# Both OVAL results contain the collected object under its own ID
+assert_exists 1 '//*[local-name()="object"][@id="oval:moc.elpmaxe.first:obj:1"][@flag="complete"]/*[local-name()="reference"]'
+assert_exists 1 '//*[local-name()="object"][@id="oval:moc.elpmaxe.second:obj:7"][@flag="complete"]/*[local-name()="reference"]'
+assert_exists 1 '//*[local-name()="object"][@id="oval:moc.elpmaxe.second:obj:8"][@flag="does not exist"]'
+
+rm -rf $tmpdir $result $stdout $stderr
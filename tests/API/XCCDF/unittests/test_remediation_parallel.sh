@@ -0,0 +1,42 @@
+#!/bin/bash
+
+# Independent fixes run in parallel, the fix which depends on another one
+# runs after it. Results are reported in the order of the rules.
+#
+# Each of the first four fixes leaves a marker in the working directory and
+# waits for the markers of the others, so they succeed only if they overlap.
+# The last fix refers to its files through a shell variable, so it must
+# wait for the slow fix before it which creates the file it depends on.
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+result=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+dir=$(mktemp -d -t ${name}.dir.XXXXXX)
+ret=0
+
+# The fixes refer to absolute paths
+sed "s|@DIR@|$dir|g" $srcdir/${name}.xccdf.xml > $dir/${name}.xccdf.xml
+sed "s|@DIR@|$dir|g" $srcdir/${name}.oval.xml > $dir/${name}.oval.xml
+
+mkdir $dir/markers
+(cd $dir/markers && OSCAP_REMEDIATION_WORKERS=4 $OSCAP xccdf eval --remediate --results $result $dir/${name}.xccdf.xml 2> $stderr)
+
+echo "Stderr file = $stderr"
+echo "Result file = $result"
+[ -f $stderr ]; [ ! -s $stderr ]; rm $stderr
+
+$OSCAP xccdf validate-xml $result
+
+assert_exists 7 '//rule-result'
+assert_exists 7 '//rule-result/result[text()="fixed"]'
+for n in 1 2 3 4 5 6 7; do
+	assert_exists 1 '//rule-result['$n'][@idref="xccdf_moc.elpmaxe.www_rule_'$n'"]'
+	assert_exists 1 '//rule-result['$n']/message[text()="Fix execution completed and returned: 0"]'
+done
+assert_exists 1 '//score[text()="100.000000"]'
+
+rm -r $dir
+rm $result
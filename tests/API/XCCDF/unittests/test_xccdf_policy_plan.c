@@ -0,0 +1,215 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <oscap_source.h>
+#include <xccdf_benchmark.h>
+#include <xccdf_policy.h>
+
+#include <../../../assume.h>
+
+#define TEST_SYSTEM "http://example.org/test-engine"
+#define RULE_1 "xccdf_moc.elpmaxe.www_rule_1"
+#define RULE_2 "xccdf_moc.elpmaxe.www_rule_2"
+#define VALUE_1 "xccdf_moc.elpmaxe.www_value_1"
+#define PROFILE_1 "xccdf_moc.elpmaxe.www_profile_1"
+
+/* Value of var_1 bound to the last evaluated check */
+static char bound_value[16];
+
+static void _remember_bound_value(struct xccdf_value_binding_iterator *value_binding_it)
+{
+	bound_value[0] = '\0';
+	while (xccdf_value_binding_iterator_has_more(value_binding_it)) {
+		struct xccdf_value_binding *binding = xccdf_value_binding_iterator_next(value_binding_it);
+		assume(strcmp(xccdf_value_binding_get_name(binding), "var_1") == 0);
+		const char *value = xccdf_value_binding_get_setvalue(binding);
+		snprintf(bound_value, sizeof(bound_value), "%s", value != NULL ? value : xccdf_value_binding_get_value(binding));
+	}
+}
+
+static xccdf_test_result_type_t _test_engine_eval(struct xccdf_policy *policy, const char *rule_id, const char *definition_id, const char *href, struct xccdf_value_binding_iterator *value_binding_it, struct xccdf_check_import_iterator *check_imports_it, void *usr)
+{
+	int *calls = usr;
+	(*calls)++;
+	if (strcmp(definition_id, "first") != 0)
+		return XCCDF_RESULT_FAIL;
+	_remember_bound_value(value_binding_it);
+	/* The value set by the profile fails until the profile gets changed */
+	return strcmp(bound_value, "profiled") == 0 ? XCCDF_RESULT_FAIL : XCCDF_RESULT_PASS;
+}
+
+static int _test_engine_batch(struct xccdf_policy *policy, const char *href, struct xccdf_policy_batch_check_iterator *checks_it, void *usr)
+{
+	int *calls = usr;
+	(*calls)++;
+	assume(strcmp(href, "test.txt") == 0);
+	/* All the checks of selected rules in document order */
+	const char *expected[] = {RULE_1, "first", RULE_2, "second"};
+	int n = 0;
+	while (xccdf_policy_batch_check_iterator_has_more(checks_it)) {
+		struct xccdf_policy_batch_check *check = xccdf_policy_batch_check_iterator_next(checks_it);
+		assume(n < 4);
+		assume(strcmp(xccdf_policy_batch_check_get_rule_id(check), expected[n++]) == 0);
+		assume(strcmp(xccdf_policy_batch_check_get_name(check), expected[n++]) == 0);
+		struct xccdf_value_binding_iterator *binding_it = xccdf_policy_batch_check_get_value_bindings(check);
+		if (n == 2) {
+			_remember_bound_value(binding_it);
+			assume(strcmp(bound_value, "old") == 0);
+		} else
+			assume(!xccdf_value_binding_iterator_has_more(binding_it));
+		xccdf_value_binding_iterator_free(binding_it);
+	}
+	assume(n == 4);
+	return 0;
+}
+
+/* Generate the profile-oriented fix and check that the value got substituted into it */
+static void _assert_fix_value(struct xccdf_policy *policy, const char *value)
+{
+	char path[] = "/tmp/test_xccdf_policy_plan.XXXXXX";
+	int fd = mkstemp(path);
+	assume(fd >= 0);
+	assume(xccdf_policy_generate_fix(policy, NULL, "urn:xccdf:fix:script:sh", fd) == 0);
+	close(fd);
+
+	char line[64], expected[64];
+	bool found = false;
+	snprintf(expected, sizeof(expected), "echo %s\n", value);
+	FILE *fp = fopen(path, "r");
+	assume(fp != NULL);
+	while (fgets(line, sizeof(line), fp) != NULL)
+		found |= strcmp(line, expected) == 0;
+	fclose(fp);
+	unlink(path);
+	assume(found);
+}
+
+static xccdf_test_result_type_t _rule_result(struct xccdf_result *result, const char *rule_id)
+{
+	struct xccdf_rule_result *rr = xccdf_result_get_rule_result_by_id(result, rule_id);
+	assume(rr != NULL);
+	return xccdf_rule_result_get_result(rr);
+}
+
+int main(int argc, char *argv[])
+{
+	int calls = 0;
+	struct xccdf_result *result;
+
+	assume(argc == 2);
+	struct oscap_source *source = oscap_source_new_from_file(argv[1]);
+	struct xccdf_benchmark *benchmark = xccdf_benchmark_import_source(source);
+	oscap_source_free(source);
+	assume(benchmark != NULL);
+
+	struct xccdf_policy_model *model = xccdf_policy_model_new(benchmark);
+	struct xccdf_policy *policy = xccdf_policy_model_get_policy_by_id(model, NULL);
+	assume(policy != NULL);
+
+	/* No checking engine, no check to evaluate */
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(_rule_result(result, RULE_1) == XCCDF_RESULT_NOT_CHECKED);
+	assume(_rule_result(result, RULE_2) == XCCDF_RESULT_NOT_CHECKED);
+
+	/* Changed checking engines, the second evaluation reuses the plan of the first one */
+	assume(xccdf_policy_model_register_engine_and_query_callback(model, TEST_SYSTEM, _test_engine_eval, &calls, NULL));
+	for (int i = 1; i <= 2; i++) {
+		result = xccdf_policy_evaluate(policy);
+		assume(result != NULL);
+		assume(calls == 2 * i);
+		assume(_rule_result(result, RULE_1) == XCCDF_RESULT_PASS);
+		assume(_rule_result(result, RULE_2) == XCCDF_RESULT_FAIL);
+		assume(strcmp(bound_value, "old") == 0);
+	}
+
+	/* Changed Value, the plan is reused but the check gets the new value */
+	struct xccdf_value *value = (struct xccdf_value *) xccdf_benchmark_get_item(benchmark, VALUE_1);
+	assume(value != NULL);
+	struct xccdf_value_instance_iterator *instance_it = xccdf_value_get_instances(value);
+	assume(xccdf_value_instance_iterator_has_more(instance_it));
+	assume(xccdf_value_instance_set_value_string(xccdf_value_instance_iterator_next(instance_it), "new"));
+	xccdf_value_instance_iterator_free(instance_it);
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(calls == 6);
+	assume(strcmp(bound_value, "new") == 0);
+
+	/* Changed selection */
+	struct xccdf_select *sel = xccdf_select_new();
+	xccdf_select_set_item(sel, RULE_2);
+	xccdf_select_set_selected(sel, false);
+	assume(xccdf_policy_add_select(policy, sel));
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(calls == 7);
+	assume(_rule_result(result, RULE_1) == XCCDF_RESULT_PASS);
+	assume(_rule_result(result, RULE_2) == XCCDF_RESULT_NOT_SELECTED);
+
+	/* A set-value added to the profile after the evaluation is seen
+	 * by the generated fix and by the next evaluation */
+	policy = xccdf_policy_model_get_policy_by_id(model, PROFILE_1);
+	assume(policy != NULL);
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(strcmp(bound_value, "profiled") == 0);
+	assume(_rule_result(result, RULE_1) == XCCDF_RESULT_FAIL);
+	_assert_fix_value(policy, "profiled");
+	struct xccdf_setvalue *setvalue = xccdf_setvalue_new();
+	xccdf_setvalue_set_item(setvalue, VALUE_1);
+	xccdf_setvalue_set_value(setvalue, "changed");
+	assume(xccdf_profile_add_setvalue(xccdf_policy_get_profile(policy), setvalue));
+	_assert_fix_value(policy, "changed");
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(strcmp(bound_value, "changed") == 0);
+	assume(_rule_result(result, RULE_1) == XCCDF_RESULT_PASS);
+
+	xccdf_policy_model_free(model);
+
+	/* Batch evaluation precedes the evaluation of single checks. The first
+	 * engine answers all the checks, the second one only gets the batch. */
+	int batch_calls = 0;
+	calls = 0;
+	source = oscap_source_new_from_file(argv[1]);
+	benchmark = xccdf_benchmark_import_source(source);
+	oscap_source_free(source);
+	model = xccdf_policy_model_new(benchmark);
+	policy = xccdf_policy_model_get_policy_by_id(model, NULL);
+	assume(xccdf_policy_model_register_engine_and_batch_callback(model, TEST_SYSTEM, _test_engine_eval, &calls, NULL, NULL));
+	assume(xccdf_policy_model_register_engine_and_batch_callback(model, TEST_SYSTEM, _test_engine_eval, &batch_calls, NULL, _test_engine_batch));
+	result = xccdf_policy_evaluate(policy);
+	assume(result != NULL);
+	assume(batch_calls == 1);
+	assume(calls == 2);
+	assume(_rule_result(result, RULE_1) == XCCDF_RESULT_PASS);
+	assume(_rule_result(result, RULE_2) == XCCDF_RESULT_FAIL);
+
+	xccdf_policy_model_free(model);
+	return 0;
+}
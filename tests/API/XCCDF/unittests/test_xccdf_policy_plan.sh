@@ -0,0 +1,8 @@
+#!/bin/bash
+
+# Evaluate one policy repeatedly while its selection, values and checking engines change
+
+set -e
+set -o pipefail
+
+./test_xccdf_policy_plan $srcdir/test_xccdf_policy_plan.xccdf.xml
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+results=$(mktemp -t ${name}.out.XXXXXX)
+stream=$(mktemp -t ${name}.out.XXXXXX)
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+
+# Borrow the content of another test, it has 8 rules checked by OVAL.
+$OSCAP xccdf eval --results $results --results-stream $stream \
+	$srcdir/test_deriving_xccdf_result_from_oval.xccdf.xml 2> $stderr
+
+echo "Stderr file = $stderr"
+echo "Results file = $results"
+echo "Stream file = $stream"
+[ -f $stderr ]; [ ! -s $stderr ]
+
+result=$stream
+assert_exists 1 '/TestResult'
+assert_exists 1 '/TestResult/benchmark'
+assert_exists 1 '/TestResult/title[text()="OSCAP Scan Result"]'
+assert_exists 1 '/TestResult/target'
+assert_exists 8 '/TestResult/rule-result'
+assert_exists 8 '/TestResult/rule-result/result[text()="pass"]'
+assert_exists 8 '/TestResult/rule-result/check/check-content-ref'
+assert_exists 1 '/TestResult/score[@system="urn:xccdf:scoring:default"][text()="100.000000"]'
+assert_exists 1 '/TestResult/score[@system="urn:xccdf:scoring:flat"][text()="8.000000"]'
+
+# The streamed TestResult matches the exported one.
+for attr in id start-time end-time test-system; do
+	[ "$($XPATH $stream "string(/TestResult/@$attr)")" == \
+		"$($XPATH $results "string(//TestResult/@$attr)")" ]
+done
+[ "$($XPATH $stream 'string(/TestResult/@end-time)')" != "" ]
+for i in $(seq 1 8); do
+	[ "$($XPATH $stream "string(/TestResult/rule-result[$i]/@idref)")" == \
+		"$($XPATH $results "string(//TestResult/rule-result[$i]/@idref)")" ]
+done
+
+# Failure to write the stream doesn't stop the scan. File size limit lets
+# the header through but not all the rule-results.
+stdout=$(mktemp -t ${name}.out.XXXXXX)
+(trap '' XFSZ; ulimit -f 2; $OSCAP xccdf eval --results-stream $stream \
+	$srcdir/test_deriving_xccdf_result_from_oval.xccdf.xml > $stdout 2> $stderr)
+[ "$(grep -c '^Result.*pass$' $stdout)" == "8" ]
+grep -q "Could not write XCCDF results to $stream" $stderr
+[ "$(grep -c '<rule-result' $stream)" -lt "8" ]
+
+rm $results $stream $stdout $stderr
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <oscap_debug.h>
+#include <oscap_error.h>
+#include <xccdf_session.h>
+
+#include <../../../assume.h>
+
+static int _export_target(struct xccdf_session *session, const char *root, size_t index, void *arg)
+{
+	char path[4096];
+
+	snprintf(path, sizeof(path), "%s.%zu.xml", (const char *) arg, index);
+	if (!xccdf_session_set_xccdf_export(session, path))
+		return 1;
+	return xccdf_session_export_xccdf(session) == 0 ? 0 : 2;
+}
+
+/*
+ * Usage: test_xccdf_session_targets XCCDF RESULTS_PREFIX ROOT...
+ * Results of ROOT at position N are exported to RESULTS_PREFIX.N.xml
+ */
+int main(int argc, char *argv[])
+{
+	assume(argc > 3);
+	size_t count = argc - 3;
+	int *statuses = calloc(count, sizeof(int));
+
+	/* The script checks in the log what is done once and what per target */
+	const char *log = getenv("TEST_VERBOSE_LOG");
+	if (log != NULL)
+		assume(oscap_set_verbose("INFO", log, false));
+
+	struct xccdf_session *session = xccdf_session_new(argv[1]);
+	assume(session != NULL);
+	assume(xccdf_session_load(session) == 0);
+
+	/* A child of the caller which has nothing to do with the targets */
+	pid_t foreign = fork();
+	assume(foreign != -1);
+	if (foreign == 0)
+		_exit(7);
+
+	int ret = xccdf_session_evaluate_targets(session, (const char * const *) argv + 3, count,
+			2, _export_target, argv[2], statuses);
+	if (oscap_err())
+		fprintf(stderr, "%s\n", oscap_err_desc());
+	assume(ret == 0);
+	for (size_t i = 0; i < count; i++) {
+		printf("Target %s: %d\n", argv[3 + i], statuses[i]);
+		assume(statuses[i] == 0);
+	}
+
+	/* It must be left for the caller to reap */
+	int wstatus;
+	assume(waitpid(foreign, &wstatus, 0) == foreign);
+	assume(WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 7);
+
+	xccdf_session_free(session);
+	free(statuses);
+	return 0;
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Evaluate one content against several offline roots at once
+
+set -e
+set -o pipefail
+
+name=$(basename $0 .sh)
+
+roots=$(mktemp -d -t ${name}.out.XXXXXX)
+prefix="$roots/results"
+stderr=$(mktemp -t ${name}.out.XXXXXX)
+log=$(mktemp -t ${name}.out.XXXXXX)
+
+for target in 0 1 2 3; do
+	mkdir -p "$roots/$target/etc"
+done
+touch "$roots/1/etc/target-marker" "$roots/3/etc/target-marker"
+
+TEST_VERBOSE_LOG=$log ./test_xccdf_session_targets $srcdir/${name}.xccdf.xml "$prefix" \
+	"$roots/0" "$roots/1" "$roots/2" "$roots/3" 2> $stderr
+
+echo "Stderr file = $stderr"
+[ -f $stderr ]; [ ! -s $stderr ]; rm $stderr
+
+# OVAL definitions are imported by xccdf_session_load() and once more for
+# all the targets, not by each of them. Every target gets its own agent.
+[ "$(grep -c "Imported 1 OVAL definition models" $log)" = 2 ]
+[ "$(grep -c "Started new OVAL agent" $log)" = 5 ]
+rm $log
+
+for target in 0 1 2 3; do
+	result="$prefix.$target.xml"
+	echo "Result file = $result"
+	$OSCAP xccdf validate $result
+	assert_exists 1 '//rule-result'
+	assert_exists 1 '//TestResult/target[text()="chroot://'"$roots/$target"'"]'
+done
+
+result="$prefix.0.xml"; assert_exists 1 '//rule-result/result[text()="fail"]'
+result="$prefix.1.xml"; assert_exists 1 '//rule-result/result[text()="pass"]'
+result="$prefix.2.xml"; assert_exists 1 '//rule-result/result[text()="fail"]'
+result="$prefix.3.xml"; assert_exists 1 '//rule-result/result[text()="pass"]'
+
+rm -rf "$roots"
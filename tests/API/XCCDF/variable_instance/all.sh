@@ -388,6 +388,8 @@ function xccdf_export_A_second_subset(){
 # Evaluate XCCDF while exporting two values from XCCDF document to a single OVAL
 # variable that it should result in multiple (two) variable sets each with a single
 # value. This tests asserts for correctly collected system characteristics.
+# The object does not depend on the variable, so both of its instances refer
+# to the single item collected for the first one.
 #
 function xccdf_eval_2_multiset(){
 	local variables0="requires_both-oval.xml-0.variables-0.xml"
@@ -464,14 +466,14 @@ function xccdf_eval_2_multiset(){
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/generator'
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_info'
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item[count(*) = 5]'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:filepath'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:path'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:filename'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:xpath'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:value_of'
-	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:value_of[text()="300"]'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item[count(*) = 5]'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:filepath'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:path'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:filename'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:xpath'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:value_of'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:value_of[text()="300"]'
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/collected_objects'
 	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/collected_objects/object'
 	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/collected_objects/object[count(@*) = 4]'
@@ -483,6 +485,7 @@ function xccdf_eval_2_multiset(){
 	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/collected_objects/object[reference/@item_ref]'
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/collected_objects/object[@variable_instance="1"]'
 	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/collected_objects/object[@variable_instance="2"]'
+	assert_exists 2 '/oval_results/results/system/oval_system_characteristics/collected_objects/object/reference[@item_ref=/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/@id]'
 	assert_exists 4 '/oval_results/results/system/oval_system_characteristics/*'
 	assert_exists 1 '/oval_results/results/system/tests'
 	assert_exists 3 '/oval_results/results/system/tests/test'
@@ -666,6 +669,76 @@ function xccdf_eval_1_multiset_syschar(){
 	done
 }
 
+#
+# Local variable computed from an external variable which gets two
+# different values from two rules. The local variable has to be computed
+# again for the second variable instance.
+#
+function xccdf_eval_local_variable_multiset(){
+	local oval_result="local_variable-oval.xml.result.xml"
+	local xccdf_result=$(mktemp -t ${FUNCNAME}.xml.XXXXXX)
+	local stderr=$(mktemp -t ${FUNCNAME}.err.XXXXXX)
+	local profile="xccdf_moc.elpmaxe.www_profile_1"
+	local tested_file="testing_file.xml"
+	echo "Stderr file = $stderr"
+	cp $srcdir/testing_file_300.xml $tested_file
+
+	[ ! -f $oval_result ] || rm $oval_result
+	local res=0
+	$OSCAP xccdf eval --profile $profile --oval-results --results $xccdf_result \
+		$srcdir/test_xccdf_variable_instance_local.xccdf.xml 2> $stderr || res=$?
+	[ $res -eq 2 ]
+	[ -f $stderr ]; [ ! -s $stderr ]
+	local result="$xccdf_result"
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_1"]/result[text()="pass"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_2"]/result[text()="fail"]'
+	result="$oval_result"
+	assert_exists 2 '/oval_results/results/system/tests/test[@test_id="oval:com.example.www:tst:1"]'
+	assert_exists 1 '/oval_results/results/system/tests/test[not(@variable_instance) and @result="true"]/tested_variable[@variable_id="oval:com.example.www:var:2" and text()="300"]'
+	assert_exists 1 '/oval_results/results/system/tests/test[@variable_instance="2" and @result="false"]/tested_variable[@variable_id="oval:com.example.www:var:2" and text()="600"]'
+	rm $stderr
+	rm $xccdf_result
+	rm $oval_result
+	rm $tested_file
+}
+
+#
+# Object chosen by the count of the values of an external variable which
+# gets a different number of values from each of two rules. The object has
+# to be collected again for the second variable instance.
+#
+function xccdf_eval_count_variable_multiset(){
+	local oval_result="count_variable-oval.xml.result.xml"
+	local xccdf_result=$(mktemp -t ${FUNCNAME}.xml.XXXXXX)
+	local stderr=$(mktemp -t ${FUNCNAME}.err.XXXXXX)
+	local profile="xccdf_moc.elpmaxe.www_profile_1"
+	echo "Stderr file = $stderr"
+	cp $srcdir/testing_file_300.xml testing_file_count_1.xml
+	cp $srcdir/testing_file_600.xml testing_file_count_2.xml
+
+	[ ! -f $oval_result ] || rm $oval_result
+	local res=0
+	$OSCAP xccdf eval --profile $profile --oval-results --results $xccdf_result \
+		$srcdir/test_xccdf_variable_instance_count.xccdf.xml 2> $stderr || res=$?
+	[ $res -eq 2 ]
+	[ -f $stderr ]; [ ! -s $stderr ]
+	local result="$xccdf_result"
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_1"]/result[text()="pass"]'
+	assert_exists 1 '/Benchmark/TestResult/rule-result[@idref="xccdf_moc.elpmaxe.www_rule_2"]/result[text()="fail"]'
+	# Both local variables computed from the count are computed again
+	result="$oval_result"
+	assert_exists 2 '/oval_results/results/system/tests/test[@test_id="oval:com.example.www:tst:1"]'
+	assert_exists 1 '/oval_results/results/system/tests/test[not(@variable_instance) and @result="true"]/tested_variable[@variable_id="oval:com.example.www:var:3" and text()="./testing_file_count_1.xml"]'
+	assert_exists 1 '/oval_results/results/system/tests/test[@variable_instance="2" and @result="false"]/tested_variable[@variable_id="oval:com.example.www:var:3" and text()="./testing_file_count_2.xml"]'
+	assert_exists 1 '/oval_results/results/system/oval_system_characteristics/system_data/ind-sys:xmlfilecontent_item/ind-sys:filename[text()="testing_file_count_2.xml"]'
+	rm $stderr
+	rm $xccdf_result
+	rm $oval_result
+	for f in testing_file_count_1.xml testing_file_count_2.xml; do
+		chmod u+w $f ; rm $f
+	done
+}
+
 test_init test_api_xccdf_variable_instance.log
 
 test_run "Export from XCCDF to variables: 1x2 values (multival)" xccdf_export_1_multival
@@ -681,5 +754,7 @@ test_run "Export from XCCDF to variables: 3x3 the last is subset (multiset,multi
 
 test_run "Evaluate XCCDF: 2x1 values (multiset)" xccdf_eval_2_multiset
 test_run "Evaluate XCCDF: 2x1 values (multiset) in syschar" xccdf_eval_1_multiset_syschar
+test_run "Evaluate XCCDF: 2x1 values (multiset) through local variable" xccdf_eval_local_variable_multiset
+test_run "Evaluate XCCDF: 2x1 values (multiset) through count of values" xccdf_eval_count_variable_multiset
 
 test_exit
@@ -7,6 +7,8 @@ test_init "test_api_probes.log"
 if [ -z ${CUSTOM_OSCAP+x} ] ; then
     test_run "fts test" $srcdir/fts.sh
     test_run "probe api smoke test" ./test_api_probes_smoke
+    test_run "probe host" $srcdir/probe_host.sh
+    test_run "probe reset" $srcdir/probe_reset.sh
 fi
 
 test_exit
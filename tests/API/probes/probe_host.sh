@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Probes running in the probe host mode serve one session after another
+
+. ../../test_common.sh
+
+set -e -o pipefail
+
+probecheck "textfilecontent54" || exit 255
+probecheck "password" || exit 255
+
+host_dir=$(mktemp -d -t probe_host.out.XXXXXX)
+target=$(mktemp -t probe_host.out.XXXXXX)
+oval=$(mktemp -t probe_host.out.XXXXXX)
+stdout=$(mktemp -t probe_host.out.XXXXXX)
+root=$(mktemp -d -t probe_host.out.XXXXXX)
+
+mkdir $root/etc
+echo "root:x:0:0:root:/root:/bin/bash" > $root/etc/passwd
+
+sed "s|@TARGET@|$target|" $srcdir/probe_host.oval.xml > $oval
+
+pids=""
+for probe in probe_system_info probe_textfilecontent54; do
+	$OVAL_PROBE_DIR/$probe --listen $host_dir/$probe &
+	pids="$pids $!"
+done
+# The password probe host scans the given root
+OSCAP_PROBE_ROOT=$root $OVAL_PROBE_DIR/probe_password --listen $host_dir/probe_password &
+pids="$pids $!"
+trap "kill $pids 2> /dev/null || true" EXIT
+
+for probe in probe_system_info probe_textfilecontent54 probe_password; do
+	for i in $(seq 50); do
+		[ -S $host_dir/$probe ] && break
+		sleep 0.1
+	done
+	[ -S $host_dir/$probe ]
+done
+
+export OSCAP_PROBE_HOST_DIR=$host_dir
+
+echo "value=1" > $target
+$OSCAP oval eval --verbose INFO $oval > $stdout 2>&1
+grep -q "Starting probe on URI 'unix://$host_dir/probe_textfilecontent54'" $stdout
+grep -q "Definition oval:x:def:1: true" $stdout
+
+# The result of the previous session must not be reused
+echo "value=2" > $target
+$OSCAP oval eval $oval > $stdout
+grep -q "Definition oval:x:def:1: false" $stdout
+
+# Neither the state of the probe, e.g. the account database, is reused
+$OSCAP oval eval $srcdir/probe_reset.oval.xml > $stdout
+grep -q "Definition oval:x:def:1: false" $stdout
+echo "probe_reset_user:x:1000:1000::/home/probe_reset_user:/bin/bash" >> $root/etc/passwd
+$OSCAP oval eval $srcdir/probe_reset.oval.xml > $stdout
+grep -q "Definition oval:x:def:1: true" $stdout
+
+# The probe host is used only for the local system
+OSCAP_PROBE_ROOT=/ $OSCAP oval eval --verbose INFO $oval > $stdout 2>&1
+! grep -q "unix://" $stdout
+
+kill $pids
+wait $pids || true
+trap - EXIT
+
+# Sockets are removed when the probe host exits
+[ ! -e $host_dir/probe_textfilecontent54 ]
+[ ! -e $host_dir/probe_system_info ]
+[ ! -e $host_dir/probe_password ]
+
+rm -rf $host_dir $target $oval $stdout $root
@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Probes see changes of the scanned system made before the probe session
+# has been reset
+
+. ../../test_common.sh
+
+set -e -o pipefail
+
+probecheck "password" || exit 255
+
+# The mount table and sysctl checks change the scanned system, run them only
+# in private mount and UTS namespaces
+if [ -z "$PROBE_RESET_UNSHARED" ] && unshare -mu true 2> /dev/null; then
+	PROBE_RESET_UNSHARED=1 exec unshare -mu bash "$0" "$@"
+fi
+
+root=$(mktemp -d -t probe_reset.out.XXXXXX)
+stdout=$(mktemp -t probe_reset.out.XXXXXX)
+
+mkdir $root/etc
+echo "root:x:0:0:root:/root:/bin/bash" > $root/etc/passwd
+
+OSCAP_PROBE_ROOT=$root ./test_probe_reset $srcdir/probe_reset.oval.xml oval:x:obj:1 \
+	"echo 'probe_reset_user:x:1000:1000::/home/probe_reset_user:/bin/bash' >> $root/etc/passwd" > $stdout
+cat $stdout
+grep -q "^first: 0$" $stdout
+grep -q "^second: 1$" $stdout
+
+if probecheck "shadow"; then
+	echo "root:*:17000:0:99999:7:::" > $root/etc/shadow
+	OSCAP_PROBE_ROOT=$root ./test_probe_reset $srcdir/probe_reset.oval.xml oval:x:obj:4 \
+		"echo 'probe_reset_user:*:17000:0:99999:7:::' >> $root/etc/shadow" > $stdout
+	cat $stdout
+	grep -q "^first: 0$" $stdout
+	grep -q "^second: 1$" $stdout
+fi
+
+# The mount table snapshot is read again as well
+if [ -n "$PROBE_RESET_UNSHARED" ] && probecheck "partition"; then
+	oval=$(mktemp -t probe_reset.out.XXXXXX)
+	sed "s|@MOUNT_POINT@|$root|" $srcdir/probe_reset.oval.xml > $oval
+
+	./test_probe_reset $oval oval:x:obj:2 "mount -t tmpfs probe_reset $root" > $stdout
+	umount $root
+	cat $stdout
+	grep -q "^first: 0$" $stdout
+	grep -q "^second: 1$" $stdout
+
+	rm -f $oval
+fi
+
+# The rest of the probe state is kept, only the snapshots are dropped
+if probecheck "sysctl"; then
+	log=$(mktemp -t probe_reset.out.XXXXXX)
+	OSCAP_PROBE_VERBOSITY_LEVEL=DEVEL OSCAP_PROBE_VERBOSE_LOG_FILE=$log \
+		./test_probe_reset $srcdir/probe_reset.oval.xml oval:x:obj:3 true > $stdout
+	[ "$(grep -c "Probe initialized" $log)" = 1 ]
+	arg=$(sed -n 's/.*Probe initialized, probe_arg=\(0x[0-9a-f]*\)\..*/\1/p' $log)
+	grep -q "Probe reset, probe_arg=$arg\." $log
+	rm -f $log
+fi
+
+# So are the sysctl values
+domainname=/proc/sys/kernel/domainname
+if [ -n "$PROBE_RESET_UNSHARED" ] && probecheck "sysctl"; then
+	./test_probe_reset $srcdir/probe_reset.oval.xml oval:x:obj:3 "echo probe_reset > $domainname" > $stdout
+	cat $stdout
+	grep -q "^first: 0$" $stdout
+	grep -q "^second: 1$" $stdout
+fi
+
+rm -rf $root $stdout
@@ -0,0 +1,84 @@
+/*
+ * Collect an OVAL object, run a command which changes the scanned system,
+ * reset the probe session and collect the object again. The number of
+ * items collected each time is printed to the standard output.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <oval_definitions.h>
+#include <oval_probe.h>
+#include <oval_probe_session.h>
+#include <oval_system_characteristics.h>
+#include <oscap_source.h>
+
+static int collect_object(oval_probe_session_t *session, struct oval_object *object, const char *label)
+{
+	struct oval_syschar *syschar = NULL;
+
+	if (oval_probe_query_object(session, object, 0, &syschar) != 0 || syschar == NULL) {
+		fprintf(stderr, "Failed to collect %s.\n", oval_object_get_id(object));
+		return -1;
+	}
+
+	int count = 0;
+	struct oval_sysitem_iterator *items = oval_syschar_get_sysitem(syschar);
+	while (oval_sysitem_iterator_has_more(items)) {
+		oval_sysitem_iterator_next(items);
+		++count;
+	}
+	oval_sysitem_iterator_free(items);
+
+	printf("%s: %d\n", label, count);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 4) {
+		fprintf(stderr, "Usage: %s OVAL_FILE OBJECT_ID COMMAND\n", argv[0]);
+		return 1;
+	}
+
+	struct oscap_source *source = oscap_source_new_from_file(argv[1]);
+	struct oval_definition_model *model = oval_definition_model_import_source(source);
+	oscap_source_free(source);
+	if (model == NULL)
+		return 1;
+
+	struct oval_object *object = oval_definition_model_get_object(model, argv[2]);
+	if (object == NULL) {
+		fprintf(stderr, "Object %s not found.\n", argv[2]);
+		oval_definition_model_free(model);
+		return 1;
+	}
+
+	struct oval_syschar_model *first_model = oval_syschar_model_new(model);
+	struct oval_syschar_model *second_model = oval_syschar_model_new(model);
+	oval_probe_session_t *session = oval_probe_session_new(first_model);
+
+	int ret = 1;
+	if (collect_object(session, object, "first") != 0)
+		goto cleanup;
+	if (system(argv[3]) != 0) {
+		fprintf(stderr, "Command '%s' failed.\n", argv[3]);
+		goto cleanup;
+	}
+	/* The probes keep running, they only reset their state */
+	if (oval_probe_session_reset(session, second_model) != 0)
+		goto cleanup;
+	if (collect_object(session, object, "second") != 0)
+		goto cleanup;
+	ret = 0;
+
+cleanup:
+	oval_probe_session_destroy(session);
+	oval_syschar_model_free(second_model);
+	oval_syschar_model_free(first_model);
+	oval_definition_model_free(model);
+	return ret;
+}
@@ -228,6 +228,76 @@ function test_eval_benchmark_id {
     echo "$OUT" | grep $3 > /dev/null
 }
 
+function test_sds_index_cache {
+	local name=${FUNCNAME}
+	local DS="${srcdir}/$1"
+	local cache_dir=$(mktemp -d -t ${name}.cache.XXXXXX)
+	local stderr=$(mktemp -t ${name}.err.XXXXXX)
+	local cold=$(mktemp -t ${name}.cold.XXXXXX)
+	local warm=$(mktemp -t ${name}.warm.XXXXXX)
+	local plain=$(mktemp -t ${name}.plain.XXXXXX)
+
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP info $DS > $cold 2> $stderr
+	diff $stderr /dev/null
+	# Index of the data stream has been stored, including all components.
+	[ "$(ls $cache_dir | wc -l)" == "1" ]
+	local sidecar=$cache_dir/$(ls $cache_dir)
+	[ "$($XPATH $sidecar 'count(/sds-index/component)')" == "$($XPATH $DS 'count(/ds:data-stream-collection/ds:component)')" ]
+
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP info $DS > $warm 2> $stderr
+	diff $stderr /dev/null
+	diff $cold $warm
+	# The cache is used only when asked for.
+	local home=$(mktemp -d -t ${name}.home.XXXXXX)
+	env -u OSCAP_SDS_INDEX_CACHE -u XDG_CACHE_HOME HOME=$home $OSCAP info $DS > $plain 2> $stderr
+	diff $stderr /dev/null
+	diff $cold $plain
+	[ -z "$(ls -A $home)" ]
+	rm -r $home
+
+	# A modified file gets indexed again instead of using the stale sidecar.
+	local copy=$(mktemp -t ${name}.copy.XXXXXX)
+	cp $DS $copy
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP info $copy > /dev/null 2> $stderr
+	diff $stderr /dev/null
+	local copy_sidecar=$cache_dir/$(stat -c '%d-%i' $copy).xml
+	local key=$($XPATH $copy_sidecar 'string(/sds-index/@key)')
+	echo "<!-- modified -->" >> $copy
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP info $copy > $plain 2> $stderr
+	diff $stderr /dev/null
+	[ "$($XPATH $copy_sidecar 'string(/sds-index/@key)')" != "$key" ]
+	# So does a file with the same size and mtime but with moved components,
+	# attributes are decoded the same way as by the regular parser.
+	key=$($XPATH $copy_sidecar 'string(/sds-index/@key)')
+	# Rewrite the copy in place, it keeps the inode and so the sidecar.
+	sed -e 's/use-case="OTHER">/use-case="OTHER" timestamp="\&amp;\&#45;2">/' \
+		-e '0,/            <xccdf:status/s//<xccdf:status/' \
+		-e '0,/            <xccdf:title>/s//<xccdf:title>/' $DS > $copy
+	[ "$(stat -c %s $copy)" == "$(stat -c %s $DS)" ]
+	touch -r $DS $copy
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP info $copy > $warm 2> $stderr
+	diff $stderr /dev/null
+	[ "$($XPATH $copy_sidecar 'string(/sds-index/@key)')" != "$key" ]
+	grep "^Generated: &-2$" $warm
+	$OSCAP info $copy > $plain 2> $stderr
+	diff $warm $plain
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP xccdf eval --skip-valid $copy > $warm 2> $stderr
+	diff $stderr /dev/null
+	$OSCAP xccdf eval --skip-valid $copy > $plain 2> $stderr
+	diff $warm $plain
+	rm $copy
+
+	# Without validation the components are read from the file using offsets.
+	OSCAP_SDS_INDEX_CACHE=$cache_dir $OSCAP xccdf eval --skip-valid $DS > $warm 2> $stderr
+	diff $stderr /dev/null
+	$OSCAP xccdf eval $DS > $plain 2> $stderr
+	diff $stderr /dev/null
+	diff $warm $plain
+
+	rm -r $cache_dir
+	rm $stderr $cold $warm $plain
+}
+
 function test_eval_complex()
 {
 	local name=${FUNCNAME}
@@ -432,6 +502,7 @@ test_run "sds_extended_component_plain_text_whitespace" test_sds sds_extended_co
 test_run "sds_tailoring" test_sds_tailoring sds_tailoring sds_tailoring/sds.ds.xml scap_com.example_datastream_with_tailoring xccdf_com.example_cref_tailoring_01 xccdf_com.example_profile_tailoring
 
 test_run "eval_simple" test_eval eval_simple/sds.xml
+test_run "sds_index_cache" test_sds_index_cache eval_simple/sds.xml
 test_run "cpe_in_ds" test_eval cpe_in_ds/sds.xml
 test_run "eval_invalid" test_invalid_eval eval_invalid/sds.xml
 test_run "eval_invalid_oval" test_invalid_oval_eval eval_invalid/sds-oval.xml
@@ -9,6 +9,15 @@ set -e -o pipefail
 
 test_init "test_bz2.log"
 
-test_run "DataStream operations .xml.bz2" $srcdir/test_bz2_datastream.sh
+if [ -n "$HAVE_BZIP2" ]; then
+	test_run "DataStream operations .xml.bz2" $srcdir/test_bz2_datastream.sh
+	test_run "Compressed results .xml.bz2" $srcdir/test_compressed_results.sh bzip2 .bz2
+fi
+if [ -n "$HAVE_XZ" ]; then
+	test_run "Compressed results .xml.xz" $srcdir/test_compressed_results.sh xz .xz
+fi
+if [ -n "$HAVE_ZSTD" ]; then
+	test_run "Compressed results .xml.zst" $srcdir/test_compressed_results.sh zstd .zst
+fi
 
 test_exit
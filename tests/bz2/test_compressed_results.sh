@@ -0,0 +1,55 @@
+#!/bin/bash
+#
+# Copyright 2018 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# Usage: test_compressed_results.sh <compressor> <suffix>
+
+set -e -o pipefail
+set -x
+
+compressor=$1
+suffix=$2
+name=$(basename $0 .sh)
+dir=$(mktemp -d -t ${name}.XXXXXX)
+stderr=$(mktemp -t ${name}.err.XXXXXX)
+echo "Stderr file = $stderr"
+sds=$dir/sds.xml
+xccdf=$dir/xccdf.xml
+cp $srcdir/../DS/sds_multiple_oval/*.xml $dir/
+mv $dir/multiple-oval-xccdf.xml $xccdf
+
+$OSCAP ds sds-compose "$xccdf" "$sds" 2>&1 > $stderr
+[ ! -s $stderr ]
+
+#
+# Compressed input
+#
+$compressor -k -q "$sds"
+[ -f "${sds}${suffix}" ]
+$OSCAP info "${sds}${suffix}" 2> $stderr
+[ ! -s $stderr ]
+./test_compressed_source "${sds}${suffix}" "$sds" | grep 'SCAP Source Datastream'
+
+#
+# Compressed output
+#
+ret=0
+arf=$dir/arf.xml${suffix}
+results=$dir/results.xml${suffix}
+$OSCAP xccdf eval --results $results --results-arf $arf "${sds}${suffix}" 2> $stderr || ret=$?
+[ $ret -eq 2 ]
+[ ! -s $stderr ]
+
+$compressor -t $arf
+$compressor -dc $arf | grep 'asset-report-collection' > /dev/null
+$compressor -dc $results | grep 'TestResult' > /dev/null
+./test_compressed_source "$arf" | grep 'ARF Result Datastream'
+
+report=$dir/report.html
+$OSCAP xccdf generate report --output $report "$arf" 2> $stderr
+[ ! -s $stderr ]
+grep 'OVAL details' $report
+
+rm $stderr
+rm -rf $dir
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/xmlreader.h>
+#include <oscap_error.h>
+#include <oscap_source.h>
+#include "source/oscap_source_priv.h"
+#include <../assume.h>
+
+/*
+ * Usage: test_compressed_source COMPRESSED [PLAIN]
+ *
+ * Reads the compressed file through the codecs, both from memory and from
+ * the file, and prints the type of the document. When the PLAIN file is
+ * given, the content read from COMPRESSED must be the same.
+ */
+
+static size_t read_file(const char *filename, char **buffer)
+{
+	FILE *file = fopen(filename, "rb");
+	assume(file != NULL);
+
+	fseek(file, 0, SEEK_END);
+	size_t len = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	*buffer = malloc(len + 1);
+	assume(*buffer != NULL);
+	assume(fread(*buffer, 1, len, file) == len);
+	fclose(file);
+	return len;
+}
+
+/* Count the elements seen by the streaming reader of the source */
+static int count_elements(struct oscap_source *source)
+{
+	xmlTextReader *reader = oscap_source_get_xmlTextReader(source);
+	assume(reader != NULL);
+
+	int count = 0, ret;
+	while ((ret = xmlTextReaderRead(reader)) == 1) {
+		if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT)
+			count++;
+	}
+	assume(ret == 0);
+	xmlFreeTextReader(reader);
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	oscap_init();
+	assume(argc == 2 || argc == 3);
+
+	char *buffer;
+	size_t size = read_file(argv[1], &buffer);
+	assume(size != 0);
+
+	/* Compressed memory */
+	struct oscap_source *mem_src = oscap_source_new_from_memory(buffer, size, argv[1]);
+	oscap_document_type_t type = oscap_source_get_scap_type(mem_src);
+	printf("SCAP TYPE: %s\n", oscap_document_type_to_string(type));
+	const int mem_count = count_elements(mem_src);
+	/* The reader decompresses the data as it goes, no DOM is needed */
+	assume(!oscap_source_has_xmlDoc(mem_src));
+	assume(oscap_source_validate(mem_src, NULL, NULL) == 0);
+
+	/* Compressed file */
+	struct oscap_source *file_src = oscap_source_new_from_file(argv[1]);
+	assume(oscap_source_get_scap_type(file_src) == type);
+	assume(count_elements(file_src) == mem_count);
+	assume(!oscap_source_has_xmlDoc(file_src));
+
+	if (argc == 3) {
+		char *raw, *plain;
+		size_t raw_size;
+		size_t plain_size = read_file(argv[2], &plain);
+		assume(oscap_source_get_raw_memory(mem_src, &raw, &raw_size) == 0);
+		assume(raw_size == plain_size && memcmp(raw, plain, plain_size) == 0);
+
+		struct oscap_source *plain_src = oscap_source_new_from_file(argv[2]);
+		assume(count_elements(plain_src) == mem_count);
+		oscap_source_free(plain_src);
+		free(raw);
+		free(plain);
+	}
+
+	oscap_source_free(file_src);
+	oscap_source_free(mem_src);
+	free(buffer);
+
+	if (oscap_err()) {
+		char *err = oscap_err_get_full_error();
+		fprintf(stderr, "%s", err);
+		assume(strlen(err)==0);
+		free(err);
+	}
+
+	oscap_cleanup();
+	return 0;
+}
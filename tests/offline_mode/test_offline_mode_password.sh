@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Copyright 2018 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenSCAP Test Suite
+
+. ../test_common.sh
+
+set -e -o pipefail
+
+function test_offline_mode_password {
+    probecheck "password" || return 255
+    probecheck "shadow" || return 255
+
+    temp_dir="$(mktemp -d)"
+
+    mkdir -p "$temp_dir/etc"
+    cat > "$temp_dir/etc/passwd" <<PASSWD
+alice:x:1001:1001:Alice:/home/alice:/bin/bash
+bob:x:1002:1002:Bob:/home/bob:/bin/sh
+betty:x:1003:100::/home/betty:/sbin/nologin
+alice:x:2001:2001:Alice again:/home/alice2:/bin/bash
+PASSWD
+    cat > "$temp_dir/etc/shadow" <<SHADOW
+alice:\$6\$salt\$hash:17000:0:99999:7:::
+bob:!!:17000:0:99999:7:::
+alice:!!:17001:0:99999:7:::
+SHADOW
+
+    result="$(mktemp)"
+
+    export OSCAP_PROBE_ROOT
+    OSCAP_PROBE_ROOT="$temp_dir"
+    $OSCAP oval eval --results $result $srcdir/password.oval.xml
+
+    [ -s "$result" ]
+
+    sd='/oval_results/results/system/oval_system_characteristics/system_data'
+    assert_exists 4 $sd'/unix-sys:password_item'
+    # Every entry of a user listed twice is reported
+    assert_exists 1 $sd'/unix-sys:password_item[unix-sys:username="alice"][unix-sys:user_id="1001"][unix-sys:home_dir="/home/alice"]'
+    assert_exists 1 $sd'/unix-sys:password_item[unix-sys:username="alice"][unix-sys:user_id="2001"][unix-sys:home_dir="/home/alice2"]'
+    assert_exists 1 $sd'/unix-sys:password_item[unix-sys:username="bob"][unix-sys:login_shell="/bin/sh"]'
+    assert_exists 1 $sd'/unix-sys:password_item[unix-sys:username="betty"][unix-sys:group_id="100"]'
+
+    assert_exists 2 $sd'/unix-sys:shadow_item'
+    assert_exists 1 $sd'/unix-sys:shadow_item[unix-sys:username="alice"][unix-sys:chg_lst="17000"][unix-sys:encrypt_method="SHA-512"]'
+    assert_exists 1 $sd'/unix-sys:shadow_item[unix-sys:username="alice"][unix-sys:chg_lst="17001"]'
+
+    rm -rf "$temp_dir"
+    rm -f "$result"
+}
+
+# Testing.
+
+test_init "test_offline_mode_password.log"
+
+test_run "test_offline_mode_password" test_offline_mode_password
+
+test_exit
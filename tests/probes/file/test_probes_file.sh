@@ -120,6 +120,42 @@ function test_probes_file_invalid_utf8 {
 	return $ret_val
 }
 
+function test_probes_file_filter {
+
+	probecheck "file" || return 255
+
+	local ret_val=0
+	local DF="$srcdir/test_probes_file_filter.xml"
+	result="results.xml"
+	files_dir=$(mktemp -d)
+	DF_INJECTED=$(mktemp)
+
+	echo "Files dir:	${files_dir}"
+	echo "Content file:	${DF_INJECTED}"
+
+	# filters refer to stat data only and are evaluated before items are built
+	touch "$files_dir"/{ww_1,ww_2,ro_1,ro_2,ro_3}
+	chmod 0666 "$files_dir"/ww_*
+	chmod 0644 "$files_dir"/ro_*
+
+	# inject real path to content
+	sed "s;<!--injected-path -->;${files_dir};" "$DF" > $DF_INJECTED
+
+	$OSCAP oval eval --results $result $DF_INJECTED || ret_val=1
+	$OSCAP oval validate $result || ret_val=1
+
+	assert_exists 1 '//results//definition[@result="true"]' || ret_val=1
+	assert_exists 2 '//collected_objects/object[@id="oval:1:obj:1"]/reference' || ret_val=1
+	assert_exists 3 '//collected_objects/object[@id="oval:1:obj:2"]/reference' || ret_val=1
+	assert_exists 2 '//collected_objects/object[@id="oval:1:obj:3"]/reference' || ret_val=1
+	assert_exists 1 '//collected_objects/object[@id="oval:1:obj:4"]/reference' || ret_val=1
+
+	rm $DF_INJECTED
+	rm -rf "$files_dir"
+
+	return $ret_val
+}
+
 # Testing.
 
 test_init "test_probes_file.log"
@@ -128,5 +164,6 @@ test_run "test_probes_file with verbose mode" test_probes_file verbose
 test_run "test_probes_file" test_probes_file
 test_run "test_probes_file_filenames" test_probes_file_filenames
 test_run "test_probes_file_invalid_utf8" test_probes_file_invalid_utf8
+test_run "test_probes_file_filter" test_probes_file_filter
 
 test_exit
@@ -5,4 +5,5 @@
 test_init "test_probes_systemdunitproperty.log"
 test_run "systemdunitproperty general functionality" $srcdir/test_probes_systemdunitproperty.sh
 test_run "systemdunitproperty mount Wants - only on some systems" $srcdir/test_probes_systemdunitproperty_mount_wants.sh
+test_run "systemdunitproperty against a mock of systemd" $srcdir/test_probes_systemdunitproperty_mock.sh
 test_exit
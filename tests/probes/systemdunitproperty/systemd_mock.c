@@ -0,0 +1,306 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Minimal stand-in for the systemd manager on the system bus, serving the
+ * calls used by the systemd probes: ListUnits, LoadUnit and GetAll of the
+ * org.freedesktop.systemd1.Unit properties.
+ *
+ * Usage: systemd_mock UNITS_DIR
+ *
+ * Every file in UNITS_DIR is a unit named after the file, its lines are
+ * "Property=value" pairs. A property given on several lines is an array.
+ * The directory is read for every call, so the units can be changed while
+ * the mock is running. Once the bus name is acquired, the mock goes to the
+ * background and prints its pid.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <ctype.h>
+#include <dbus/dbus.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SYSTEMD_NAME "org.freedesktop.systemd1"
+#define SYSTEMD_PATH "/org/freedesktop/systemd1"
+#define UNIT_PATH_PREFIX SYSTEMD_PATH "/unit/"
+
+static const char *units_dir;
+
+static void unit_path(const char *name, char *path, size_t size)
+{
+	size_t len = strlen(UNIT_PATH_PREFIX);
+
+	/* Escape the same way systemd does, e.g. "a.service" is "a_2eservice" */
+	memcpy(path, UNIT_PATH_PREFIX, len + 1);
+	for (; *name != '\0' && len + 4 < size; ++name) {
+		if (isalnum((unsigned char)*name))
+			path[len++] = *name;
+		else
+			len += sprintf(path + len, "_%02x", (unsigned char)*name);
+	}
+	path[len] = '\0';
+}
+
+/* Find the unit file which belongs to an object path */
+static int unit_by_path(const char *path, char *name, size_t size)
+{
+	DIR *dir = opendir(units_dir);
+	struct dirent *de;
+	char candidate[PATH_MAX];
+	int ret = -1;
+
+	if (dir == NULL)
+		return -1;
+
+	while ((de = readdir(dir)) != NULL) {
+		if (de->d_name[0] == '.')
+			continue;
+		unit_path(de->d_name, candidate, sizeof candidate);
+		if (strcmp(candidate, path) == 0) {
+			snprintf(name, size, "%s", de->d_name);
+			ret = 0;
+			break;
+		}
+	}
+	closedir(dir);
+
+	return ret;
+}
+
+static DBusMessage *list_units(DBusMessage *msg)
+{
+	DBusMessage *reply = dbus_message_new_method_return(msg);
+	DBusMessageIter args, array, unit;
+	DIR *dir = opendir(units_dir);
+	struct dirent *de;
+
+	dbus_message_iter_init_append(reply, &args);
+	dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "(ssssssouso)", &array);
+
+	while (dir != NULL && (de = readdir(dir)) != NULL) {
+		const char *name = de->d_name, *empty = "", *loaded = "loaded", *active = "active";
+		char path[PATH_MAX];
+		const char *path_ptr = path, *job_path = "/";
+		dbus_uint32_t job_id = 0;
+
+		if (name[0] == '.')
+			continue;
+		unit_path(name, path, sizeof path);
+
+		dbus_message_iter_open_container(&array, DBUS_TYPE_STRUCT, NULL, &unit);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &name);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &empty);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &loaded);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &active);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &active);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &empty);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_OBJECT_PATH, &path_ptr);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_UINT32, &job_id);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_STRING, &empty);
+		dbus_message_iter_append_basic(&unit, DBUS_TYPE_OBJECT_PATH, &job_path);
+		dbus_message_iter_close_container(&array, &unit);
+	}
+	if (dir != NULL)
+		closedir(dir);
+
+	dbus_message_iter_close_container(&args, &array);
+
+	return reply;
+}
+
+static DBusMessage *load_unit(DBusMessage *msg)
+{
+	DBusMessage *reply;
+	const char *name = NULL;
+	char file[PATH_MAX], path[PATH_MAX];
+	const char *path_ptr = path;
+
+	if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID))
+		return dbus_message_new_error(msg, DBUS_ERROR_INVALID_ARGS, "Unit name expected");
+
+	snprintf(file, sizeof file, "%s/%s", units_dir, name);
+	if (access(file, F_OK) != 0)
+		return dbus_message_new_error(msg, "org.freedesktop.systemd1.NoSuchUnit", name);
+
+	unit_path(name, path, sizeof path);
+	reply = dbus_message_new_method_return(msg);
+	dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &path_ptr, DBUS_TYPE_INVALID);
+
+	return reply;
+}
+
+/* Append a property, collecting the values of all of its lines */
+static void append_property(DBusMessageIter *dict, const char *file, const char *property)
+{
+	DBusMessageIter entry, variant, array;
+	char line[1024];
+	size_t plen = strlen(property), count = 0;
+	FILE *fp;
+
+	/* Count the values first, a single one is a string and more an array */
+	if ((fp = fopen(file, "r")) == NULL)
+		return;
+	while (fgets(line, sizeof line, fp) != NULL) {
+		if (strncmp(line, property, plen) == 0 && line[plen] == '=')
+			++count;
+	}
+	rewind(fp);
+
+	dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+	dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &property);
+	dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, count > 1 ? "as" : "s", &variant);
+	if (count > 1)
+		dbus_message_iter_open_container(&variant, DBUS_TYPE_ARRAY, "s", &array);
+
+	while (fgets(line, sizeof line, fp) != NULL) {
+		const char *value = line + plen + 1;
+
+		if (strncmp(line, property, plen) != 0 || line[plen] != '=')
+			continue;
+		line[strcspn(line, "\n")] = '\0';
+		dbus_message_iter_append_basic(count > 1 ? &array : &variant, DBUS_TYPE_STRING, &value);
+	}
+	fclose(fp);
+
+	if (count > 1)
+		dbus_message_iter_close_container(&variant, &array);
+	dbus_message_iter_close_container(&entry, &variant);
+	dbus_message_iter_close_container(dict, &entry);
+}
+
+static DBusMessage *get_all(DBusMessage *msg)
+{
+	DBusMessage *reply;
+	DBusMessageIter args, dict;
+	char name[NAME_MAX + 1], file[PATH_MAX], line[1024];
+	char **seen = NULL;
+	size_t seen_count = 0;
+	FILE *fp;
+
+	if (unit_by_path(dbus_message_get_path(msg), name, sizeof name) != 0)
+		return dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_OBJECT, dbus_message_get_path(msg));
+
+	snprintf(file, sizeof file, "%s/%s", units_dir, name);
+	if ((fp = fopen(file, "r")) == NULL)
+		return dbus_message_new_error(msg, DBUS_ERROR_FAILED, file);
+
+	reply = dbus_message_new_method_return(msg);
+	dbus_message_iter_init_append(reply, &args);
+	dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &dict);
+
+	/* Properties are reported in the order of their first appearance */
+	while (fgets(line, sizeof line, fp) != NULL) {
+		char *eq = strchr(line, '=');
+		size_t i;
+
+		if (eq == NULL)
+			continue;
+		*eq = '\0';
+		for (i = 0; i < seen_count && strcmp(seen[i], line) != 0; ++i);
+		if (i < seen_count)
+			continue;
+
+		seen = realloc(seen, sizeof(char *) * (seen_count + 1));
+		seen[seen_count++] = strdup(line);
+		append_property(&dict, file, line);
+	}
+	fclose(fp);
+
+	while (seen_count > 0)
+		free(seen[--seen_count]);
+	free(seen);
+
+	dbus_message_iter_close_container(&args, &dict);
+
+	return reply;
+}
+
+static void handle(DBusConnection *conn, DBusMessage *msg)
+{
+	DBusMessage *reply = NULL;
+
+	if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL)
+		return;
+
+	if (dbus_message_is_method_call(msg, SYSTEMD_NAME ".Manager", "ListUnits"))
+		reply = list_units(msg);
+	else if (dbus_message_is_method_call(msg, SYSTEMD_NAME ".Manager", "LoadUnit"))
+		reply = load_unit(msg);
+	else if (dbus_message_is_method_call(msg, DBUS_INTERFACE_PROPERTIES, "GetAll"))
+		reply = get_all(msg);
+	else
+		reply = dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_METHOD, dbus_message_get_member(msg));
+
+	dbus_connection_send(conn, reply, NULL);
+	dbus_message_unref(reply);
+}
+
+int main(int argc, char *argv[])
+{
+	DBusConnection *conn;
+	DBusMessage *msg;
+	DBusError err;
+	pid_t pid;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s UNITS_DIR\n", argv[0]);
+		return 2;
+	}
+	units_dir = argv[1];
+
+	dbus_error_init(&err);
+	conn = dbus_bus_get(DBUS_BUS_SYSTEM, &err);
+	if (conn == NULL) {
+		fprintf(stderr, "Can't connect to the system bus: %s\n", err.message);
+		return 1;
+	}
+	if (dbus_bus_request_name(conn, SYSTEMD_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE, &err) != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+		fprintf(stderr, "Can't own %s: %s\n", SYSTEMD_NAME, dbus_error_is_set(&err) ? err.message : "taken");
+		return 1;
+	}
+
+	/* The name is ours, the callers can start using the mock */
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return 1;
+	}
+	if (pid > 0) {
+		printf("%d\n", (int)pid);
+		return 0;
+	}
+	fclose(stdout);
+
+	while (dbus_connection_read_write(conn, -1)) {
+		while ((msg = dbus_connection_pop_message(conn)) != NULL) {
+			handle(conn, msg);
+			dbus_message_unref(msg);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env bash
+
+# Copyright 2018 Red Hat Inc., Durham, North Carolina.
+# All Rights Reserved.
+#
+# OpenScap Probes Test Suite.
+#
+# The probe talks to systemd_mock on a private bus instead of systemd, so
+# the expected results don't depend on the units of the host.
+
+set -e -o pipefail
+
+. ../../test_common.sh
+
+function test_probes_systemdunitproperty_mock {
+    probecheck "systemdunitproperty" || return 255
+    require "dbus-daemon" || return 255
+
+    local DF="${srcdir}/test_probes_systemdunitproperty_mock.xml"
+    local RF="results.xml"
+    local units=$(mktemp -d -t systemdunitproperty.units.XXXXXX)
+    local host_dir=$(mktemp -d -t systemdunitproperty.host.XXXXXX)
+    local stdout=$(mktemp -t systemdunitproperty.out.XXXXXX)
+
+    printf "Description=OpenSSH server daemon\nActiveState=active\n" > $units/sshd.service
+    printf "Description=Multi-User System\nActiveState=active\nWants=sshd.service\nWants=crond.service\n" > $units/multi-user.target
+    # More units than fit in one batch of pipelined GetAll calls
+    for i in $(seq 100); do
+        printf "Description=Unit $i\nActiveState=active\n" > $units/unit$i.service
+    done
+
+    local bus=($(dbus-daemon --session --fork --print-address=1 --print-pid=1))
+    export DBUS_SYSTEM_BUS_ADDRESS=${bus[0]}
+    local mock_pid=$(./systemd_mock $units)
+    trap "kill $mock_pid ${bus[1]} \$host_pid 2> /dev/null || true" EXIT
+
+    [ -f $RF ] && rm -f $RF
+
+    $OSCAP oval eval --results $RF $DF
+
+    [ -f $RF ]
+    verify_results "def" $DF $RF 5
+    verify_results "tst" $DF $RF 5
+    rm $RF
+
+    # A probe host doesn't reuse the units of the previous session
+    $OVAL_PROBE_DIR/probe_systemdunitproperty --listen $host_dir/probe_systemdunitproperty &
+    host_pid=$!
+    for i in $(seq 50); do
+        [ -S $host_dir/probe_systemdunitproperty ] && break
+        sleep 0.1
+    done
+
+    OSCAP_PROBE_HOST_DIR=$host_dir $OSCAP oval eval --id oval:0:def:4 $DF > $stdout
+    grep -q "Definition oval:0:def:4: true" $stdout
+    printf "Description=Added later\n" > $units/missing.service
+    OSCAP_PROBE_HOST_DIR=$host_dir $OSCAP oval eval --id oval:0:def:4 $DF > $stdout
+    grep -q "Definition oval:0:def:4: false" $stdout
+
+    kill $host_pid $mock_pid ${bus[1]}
+    trap - EXIT
+    rm -rf $units $host_dir $stdout
+}
+
+test_probes_systemdunitproperty_mock
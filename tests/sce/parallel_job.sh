@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# Leave a marker in the working directory and wait for as many markers as
+# the file "expected" asks for, i.e. until that many scripts run at once.
+# The number of markers seen is recorded for the test.
+
+set -- $XCCDF_VALUE_JOB
+touch "started_$1"
+tries=0
+while [ $(ls started_* | wc -l) -lt $(cat expected) ] && [ $tries -lt 300 ]; do
+	sleep 0.1
+	tries=$((tries + 1))
+done
+ls started_* | wc -l > "seen_$1"
+echo "job_$1"
+if [ "$2" == "pass" ]; then
+	exit $XCCDF_RESULT_PASS
+fi
+exit $XCCDF_RESULT_FAIL
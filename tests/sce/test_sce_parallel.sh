@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Test that SCE scripts running in parallel get their results recorded
+# for the right rules and in the order of the rules.
+
+. ../test_common.sh
+
+set -e -o pipefail
+
+function test_sce_parallel {
+
+    local xccdf_file=$(cd ${srcdir}; pwd)/$1
+    local workers=$2
+    local env="OSCAP_SCE_WORKERS=$workers"
+    local stderr=$(mktemp)
+    local result=$(mktemp)
+    local markers=$(mktemp -d)
+
+    # The scripts leave markers in the working directory, with more workers
+    # each of them waits until all four are running.
+    if [ "$workers" == "default" ]; then
+        workers=1
+        env="-u OSCAP_SCE_WORKERS"
+    fi
+    echo $workers > $markers/expected
+    (cd $markers && env $env $OSCAP xccdf eval --results "$result" "$xccdf_file" 2> $stderr) || [ $? -eq 2 ]
+    echo "===== result ====="
+    cat $result
+    [ ! -s $stderr ]
+
+    for n in 1 2 3 4; do
+        if [ $workers -gt 1 ]; then
+            [ $(cat $markers/seen_rule_$n) -eq 4 ]
+        else
+            [ $(cat $markers/seen_rule_$n) -eq $n ]
+        fi
+    done
+
+    assert_exists 4 '//rule-result'
+    for n in 1 2 3 4; do
+        assert_exists 1 '//rule-result['$n'][@idref="xccdf_moc.elpmaxe.www_rule_'$n'"]'
+        assert_exists 1 '//rule-result['$n']/check/check-import[@import-name="stdout"][normalize-space(text())="job_rule_'$n'"]'
+    done
+    assert_exists 2 '//rule-result[result="pass"]'
+    assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_1"][result="pass"]'
+    assert_exists 1 '//rule-result[@idref="xccdf_moc.elpmaxe.www_rule_4"][result="fail"]'
+
+    rm -r $stderr $result $markers
+}
+
+# Testing.
+test_init "test_sce_parallel.log"
+
+test_run "SCE scripts in parallel" test_sce_parallel test_sce_parallel.xccdf.xml 4
+test_run "SCE scripts one by one" test_sce_parallel test_sce_parallel.xccdf.xml 1
+test_run "SCE scripts one by one by default" test_sce_parallel test_sce_parallel.xccdf.xml default
+
+test_exit
@@ -23,10 +23,24 @@ function test_config_h(){
 	done
 }
 
+function test_source_save_as(){
+	local file=$(mktemp -t test_source_save_as.XXXXXX)
+	./test_source_save_as $file
+	rm -f $file
+}
+
+function test_xslt_cache(){
+	local dir=$(mktemp -d -t test_xslt_cache.XXXXXX)
+	./test_xslt_cache $dir
+	rm -r $dir
+}
+
 test_init "test_config_h.log"
 
 if [ -z ${CUSTOM_OSCAP+x} ] ; then
     test_run "Check existence including config.h in every .c file" test_config_h
 fi
+test_run "Overwrite the file of a source shared by other sources" test_source_save_as
+test_run "Recompile a cached stylesheet when its import changes" test_xslt_cache
 
 test_exit
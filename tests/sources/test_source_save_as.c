@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <oscap.h>
+#include <oscap_source.h>
+#include <../assume.h>
+
+/*
+ * Usage: test_source_save_as FILE
+ *
+ * Two sources of the same file are opened, then the file is overwritten
+ * with a much shorter document by a third source. The second source must
+ * parse the new content of the file instead of touching a stale mapping
+ * of the old one.
+ */
+
+#define SHORT_BENCHMARK "<Benchmark xmlns=\"http://checklists.nist.gov/xccdf/1.2\" id=\"xccdf_com.example.www_benchmark_test\"/>"
+
+int main(int argc, char *argv[])
+{
+	oscap_init();
+	assume(argc == 2);
+
+	FILE *fp = fopen(argv[1], "w");
+	assume(fp != NULL);
+	fprintf(fp, "<?xml version=\"1.0\"?>\n<Benchmark xmlns=\"http://checklists.nist.gov/xccdf/1.2\" id=\"xccdf_com.example.www_benchmark_test\">\n");
+	for (int i = 0; i < 10000; ++i)
+		fprintf(fp, "  <title>Padding of the benchmark %d</title>\n", i);
+	fprintf(fp, "</Benchmark>\n");
+	assume(fclose(fp) == 0);
+
+	struct oscap_source *first = oscap_source_new_from_file(argv[1]);
+	struct oscap_source *second = oscap_source_new_from_file(argv[1]);
+	assume(oscap_source_get_scap_type(first) == OSCAP_DOCUMENT_XCCDF);
+	assume(oscap_source_get_scap_type(second) == OSCAP_DOCUMENT_XCCDF);
+
+	struct oscap_source *shorter = oscap_source_new_from_memory(SHORT_BENCHMARK, strlen(SHORT_BENCHMARK), argv[1]);
+	assume(oscap_source_save_as(shorter, NULL) == 0);
+	oscap_source_free(shorter);
+
+	char *buffer;
+	size_t size;
+	assume(oscap_source_get_raw_memory(second, &buffer, &size) == 0);
+	assume(strstr(buffer, "Padding") == NULL);
+	free(buffer);
+
+	oscap_source_free(first);
+	oscap_source_free(second);
+	oscap_cleanup();
+	return 0;
+}
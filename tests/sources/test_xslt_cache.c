@@ -0,0 +1,103 @@
+/*
+ * Copyright 2018 Red Hat Inc., Durham, North Carolina.
+ * All Rights Reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <oscap.h>
+#include <../assume.h>
+
+/*
+ * Usage: test_xslt_cache DIRECTORY
+ *
+ * A stylesheet importing another one is applied twice by the same process.
+ * The imported stylesheet changes in between, the second transformation
+ * must not use the stylesheet compiled for the first one.
+ */
+
+static void write_file(const char *dir, const char *name, const char *content)
+{
+	char *path = malloc(strlen(dir) + strlen(name) + 2);
+	sprintf(path, "%s/%s", dir, name);
+	FILE *fp = fopen(path, "w");
+	assume(fp != NULL);
+	fputs(content, fp);
+	assume(fclose(fp) == 0);
+	free(path);
+}
+
+static void write_imported(const char *dir, const char *output)
+{
+	char content[512];
+	snprintf(content, sizeof(content),
+		"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\">\n"
+		"<xsl:output method=\"text\"/>\n"
+		"<xsl:template match=\"/\">%s</xsl:template>\n"
+		"</xsl:stylesheet>\n", output);
+	write_file(dir, "imported.xsl", content);
+}
+
+static void assert_transformation(const char *dir, const char *expected)
+{
+	char *input = malloc(strlen(dir) + 16);
+	char *xslt = malloc(strlen(dir) + 16);
+	char *output = malloc(strlen(dir) + 16);
+	sprintf(input, "%s/input.xml", dir);
+	sprintf(xslt, "%s/main.xsl", dir);
+	sprintf(output, "%s/output.txt", dir);
+
+	const char *params[] = { NULL };
+	assume(oscap_apply_xslt(input, xslt, output, params) >= 0);
+
+	char buffer[64] = { 0 };
+	FILE *fp = fopen(output, "r");
+	assume(fp != NULL);
+	assume(fgets(buffer, sizeof(buffer), fp) != NULL);
+	fclose(fp);
+	assume(strcmp(buffer, expected) == 0);
+
+	free(input);
+	free(xslt);
+	free(output);
+}
+
+int main(int argc, char *argv[])
+{
+	oscap_init();
+	assume(argc == 2);
+
+	write_file(argv[1], "input.xml", "<input/>\n");
+	write_file(argv[1], "main.xsl",
+		"<xsl:stylesheet version=\"1.0\" xmlns:xsl=\"http://www.w3.org/1999/XSL/Transform\">\n"
+		"<xsl:import href=\"imported.xsl\"/>\n"
+		"</xsl:stylesheet>\n");
+
+	write_imported(argv[1], "first");
+	assert_transformation(argv[1], "first");
+	write_imported(argv[1], "second transformation");
+	assert_transformation(argv[1], "second transformation");
+
+	oscap_cleanup();
+	return 0;
+}
@@ -122,6 +122,7 @@ struct oscap_action {
 	char *f_directives;
         char *f_results;
 	char *f_results_stig;
+	char *f_results_stream;
 	char *f_results_arf;
         char *f_report;
 	char *f_variables;
@@ -158,6 +158,7 @@ static struct oscap_module XCCDF_EVAL = {
 		"   --results <file>              - Write XCCDF Results into file.\n"
 		"   --results-arf <file>          - Write ARF (result data stream) into file.\n"
 		"   --stig-viewer <file>          - Writes XCCDF results into FILE in a format readable by DISA STIG Viewer\n"
+		"   --results-stream <file>       - Write XCCDF TestResult into file rule by rule during the evaluation.\n"
 		"   --thin-results                - Thin Results provides only minimal amount of information in OVAL/ARF results.\n"
 		"                                   The option --without-syschar is automatically enabled when you use Thin Results.\n"
 		"   --without-syschar             - Don't provide system characteristic in OVAL/ARF result files.\n"
@@ -537,6 +538,7 @@ int app_evaluate_xccdf(const struct oscap_action *action)
 	xccdf_session_set_custom_oval_files(session, action->f_ovals);
 	xccdf_session_set_product_cpe(session, OSCAP_PRODUCTNAME);
 	xccdf_session_set_rule(session, action->rule);
+	xccdf_session_set_xccdf_stream_export(session, action->f_results_stream);
 
 	if (xccdf_session_load(session) != 0)
 		goto cleanup;
@@ -1014,6 +1016,7 @@ enum oval_opt {
     XCCDF_OPT_RESULT_FILE = 1,
     XCCDF_OPT_RESULT_FILE_STIG,
     XCCDF_OPT_RESULT_FILE_ARF,
+    XCCDF_OPT_RESULT_FILE_STREAM,
     XCCDF_OPT_DATASTREAM_ID,
     XCCDF_OPT_XCCDF_ID,
     XCCDF_OPT_BENCHMARK_ID,
@@ -1051,6 +1054,7 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		{"results", 		required_argument, NULL, XCCDF_OPT_RESULT_FILE},
 		{"results-arf",		required_argument, NULL, XCCDF_OPT_RESULT_FILE_ARF},
 		{"stig-viewer", 	required_argument, NULL, XCCDF_OPT_RESULT_FILE_STIG},
+		{"results-stream",	required_argument, NULL, XCCDF_OPT_RESULT_FILE_STREAM},
 		{"datastream-id",		required_argument, NULL, XCCDF_OPT_DATASTREAM_ID},
 		{"xccdf-id",		required_argument, NULL, XCCDF_OPT_XCCDF_ID},
 		{"benchmark-id",		required_argument, NULL, XCCDF_OPT_BENCHMARK_ID},
@@ -1095,6 +1099,7 @@ bool getopt_xccdf(int argc, char **argv, struct oscap_action *action)
 		case XCCDF_OPT_OUTPUT:
 		case XCCDF_OPT_RESULT_FILE:	action->f_results = optarg;	break;
 		case XCCDF_OPT_RESULT_FILE_STIG: action->f_results_stig = optarg;	break;
+		case XCCDF_OPT_RESULT_FILE_STREAM: action->f_results_stream = optarg;	break;
 		case XCCDF_OPT_RESULT_FILE_ARF:	action->f_results_arf = optarg;	break;
 		case XCCDF_OPT_DATASTREAM_ID:	action->f_datastream_id = optarg;	break;
 		case XCCDF_OPT_XCCDF_ID:	action->f_xccdf_id = optarg; break;